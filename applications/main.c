@@ -17,6 +17,9 @@
 #include "fal.h"
 #include "dfs_fs.h"
 #include "flashdb.h"
+#if defined(PKG_USING_CAN_UDS) && defined(FDB_USING_ERASE_COUNT)
+#include "rtt_uds_service.h"
+#endif
 
 #ifdef LOG_TAG
 #undef LOG_TAG
@@ -81,14 +84,143 @@ static struct fdb_default_kv_node default_kv_table[] = {
     { "boot_count", &boot_count, sizeof(boot_count) },    /* int type KV */
 };
 
+static struct rt_mutex kvdb_mutex;
+#ifdef FDB_USING_RW_LOCK
+/* the readers are counted under the mutex, a writer holds the mutex and waits until the readers leave */
+static struct rt_event kvdb_rd_event;
+static volatile rt_uint16_t kvdb_readers;
+#endif
+
+static void kvdb_lock(fdb_db_t db)
+{
+    rt_mutex_take(&kvdb_mutex, RT_WAITING_FOREVER);
+#ifdef FDB_USING_RW_LOCK
+    while (kvdb_readers)
+    {
+        rt_event_recv(&kvdb_rd_event, 1, RT_EVENT_FLAG_OR | RT_EVENT_FLAG_CLEAR, RT_WAITING_FOREVER, RT_NULL);
+    }
+#endif
+}
+
+static void kvdb_unlock(fdb_db_t db)
+{
+    rt_mutex_release(&kvdb_mutex);
+}
+
+#ifdef FDB_USING_RW_LOCK
+/* a reader never takes the write lock inside, it would wait for itself */
+static void kvdb_rdlock(fdb_db_t db)
+{
+    rt_base_t level;
+
+    rt_mutex_take(&kvdb_mutex, RT_WAITING_FOREVER);
+    level = rt_hw_interrupt_disable();
+    kvdb_readers++;
+    rt_hw_interrupt_enable(level);
+    rt_mutex_release(&kvdb_mutex);
+}
+
+static void kvdb_rdunlock(fdb_db_t db)
+{
+    rt_base_t level;
+    rt_uint16_t readers;
+
+    level = rt_hw_interrupt_disable();
+    readers = --kvdb_readers;
+    rt_hw_interrupt_enable(level);
+    if (readers == 0)
+    {
+        rt_event_send(&kvdb_rd_event, 1);
+    }
+}
+#endif /* FDB_USING_RW_LOCK */
+
+#ifdef FDB_KV_USING_GC_STEP
+#define KVDB_GC_THREAD_PRIORITY  (RT_THREAD_PRIORITY_MAX - 2)
+#define KVDB_GC_IDLE_MS          500
+/* a snapshot erases a 4 KB slot of "kvsnap", it's saved on the first idle loop then every 10 minutes at most */
+#define KVDB_SNAPSHOT_IDLE_LOOPS (10 * 60 * 1000 / KVDB_GC_IDLE_MS)
+
+/* compact the dirty sectors a KV or an erase at a time, the writers take the lock between steps */
+static void kvdb_gc_thread_entry(void *parameter)
+{
+#ifdef FDB_KV_USING_SNAPSHOT
+    rt_uint32_t idle_loops = KVDB_SNAPSHOT_IDLE_LOOPS;
+#endif
+
+    while (1)
+    {
+        while (fdb_kv_gc_step(&kvdb))
+        {
+            rt_thread_yield();
+        }
+#ifdef FDB_KV_USING_SNAPSHOT
+        /* nothing is saved when no KV is changed since the last snapshot */
+        if (++idle_loops >= KVDB_SNAPSHOT_IDLE_LOOPS)
+        {
+            fdb_kv_snapshot(&kvdb);
+            idle_loops = 0;
+        }
+#endif
+        rt_thread_mdelay(KVDB_GC_IDLE_MS);
+    }
+}
+#endif /* FDB_KV_USING_GC_STEP */
+
+#if defined(PKG_USING_CAN_UDS) && defined(FDB_USING_ERASE_COUNT)
+#ifndef FDB_WEAR_UDS_DID
+#define FDB_WEAR_UDS_DID 0xF3A1
+#endif
+
+static void put_be32(uint8_t *buf, uint32_t value)
+{
+    buf[0] = value >> 24;
+    buf[1] = value >> 16;
+    buf[2] = value >> 8;
+    buf[3] = value;
+}
+
+/* ReadDataByIdentifier FDB_WEAR_UDS_DID returns the min, avg, max erase counts and the lifetime hours of "kvdb" */
+static UDS_HANDLER(handle_fdb_wear)
+{
+    UDSRDBIArgs_t *args = (UDSRDBIArgs_t *)data;
+    struct fdb_erase_stat stat;
+    uint8_t buf[16];
+
+    if (args->dataId != FDB_WEAR_UDS_DID)
+        return UDS_NRC_RequestOutOfRange;
+    if (fdb_kvdb_erase_stat(&kvdb, &stat) != FDB_NO_ERR || stat.sec_num == 0)
+        return UDS_NRC_ConditionsNotCorrect;
+
+    put_be32(&buf[0], stat.min);
+    put_be32(&buf[4], stat.total / stat.sec_num);
+    put_be32(&buf[8], stat.max);
+    put_be32(&buf[12], fdb_erase_lifetime(&stat, rt_tick_get() / RT_TICK_PER_SECOND));
+
+    return args->copy(srv, buf, sizeof(buf));
+}
+RTT_UDS_SERVICE_DEFINE_OPS(fdb_wear_node, UDS_EVT_ReadDataByIdent, handle_fdb_wear);
+#endif /* defined(PKG_USING_CAN_UDS) && defined(FDB_USING_ERASE_COUNT) */
+
 int flashdb_init(void)
 {
     struct fdb_default_kv default_kv = { 0 };
     default_kv.kvs = default_kv_table;
     default_kv.num = sizeof(default_kv_table) / sizeof(default_kv_table[0]);
 
-    // fdb_kvdb_control(&kvdb, FDB_KVDB_CTRL_SET_LOCK, lock);
-    // fdb_kvdb_control(&kvdb, FDB_KVDB_CTRL_SET_UNLOCK, unlock);
+    rt_mutex_init(&kvdb_mutex, "kvdb", RT_IPC_FLAG_PRIO);
+    fdb_kvdb_control(&kvdb, FDB_KVDB_CTRL_SET_LOCK, (void *)kvdb_lock);
+    fdb_kvdb_control(&kvdb, FDB_KVDB_CTRL_SET_UNLOCK, (void *)kvdb_unlock);
+#ifdef FDB_USING_RW_LOCK
+    /* the UDS reads and the application reads share the KVDB, the cached KVs are read without lock */
+    rt_event_init(&kvdb_rd_event, "kvdb_rd", RT_IPC_FLAG_PRIO);
+    fdb_kvdb_control(&kvdb, FDB_KVDB_CTRL_SET_RDLOCK, (void *)kvdb_rdlock);
+    fdb_kvdb_control(&kvdb, FDB_KVDB_CTRL_SET_RDUNLOCK, (void *)kvdb_rdunlock);
+#endif
+#ifdef FDB_KV_USING_SNAPSHOT
+    /* only the sectors written since the last snapshot are scanned when loading */
+    fdb_kvdb_control(&kvdb, FDB_KVDB_CTRL_SET_SNAPSHOT, (void *)"kvsnap");
+#endif
 
     int result = fdb_kvdb_init(&kvdb, "kvdb", "kvdb", &default_kv, NULL);
 
@@ -111,6 +243,14 @@ int flashdb_init(void)
     fdb_kv_set_blob(&kvdb, "boot_count", fdb_blob_make(&blob, &boot_count, sizeof(boot_count)));
     LOG_I("set the 'boot_count' value to %d", boot_count);
 
+#ifdef FDB_KV_USING_GC_STEP
+    rt_thread_t tid = rt_thread_create("kvdb_gc", kvdb_gc_thread_entry, RT_NULL, 1024, KVDB_GC_THREAD_PRIORITY, 10);
+    if (tid)
+    {
+        rt_thread_startup(tid);
+    }
+#endif
+
     return 0;
 }
 INIT_ENV_EXPORT(flashdb_init);
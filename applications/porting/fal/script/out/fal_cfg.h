@@ -32,6 +32,8 @@
 #define FAL_NORFLASH_MAX_LEN_log                    (2048*1024)
 #define FAL_NORFLASH_START_ADDR_reserved            6815744
 #define FAL_NORFLASH_MAX_LEN_reserved               (1024*1024)
+#define FAL_NORFLASH_START_ADDR_kvsnap              7864320
+#define FAL_NORFLASH_MAX_LEN_kvsnap                 (64*1024)
 
 /* ===================== Flash device Configuration ========================= */
 extern const struct fal_flash_dev at32_onchip_flash;
@@ -61,6 +63,7 @@ extern struct fal_flash_dev nor_flash0;
     {FAL_PART_MAGIC_WORD,   "userdata"    , "w25q64"      ,      4194304,       524288, 0}, \
     {FAL_PART_MAGIC_WORD,   "log"         , "w25q64"      ,      4718592,      2097152, 0}, \
     {FAL_PART_MAGIC_WORD,   "reserved"    , "w25q64"      ,      6815744,      1048576, 0}, \
+    {FAL_PART_MAGIC_WORD,   "kvsnap"      , "w25q64"      ,      7864320,        65536, 0}, \
 }
 #endif /* FAL_PART_HAS_TABLE_CFG */
 
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2006-2021, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     RT-Thread    first version
+ */
+#include <rtthread.h>
+#include <stdlib.h>
+
+#if defined(RT_USING_FAL) && defined(RT_USING_FINSH) && defined(RT_USING_IDLE_HOOK)
+#include <fal.h>
+
+#define SPI_DMA_LOAD_READ_SIZE  4096
+
+static volatile rt_uint32_t spi_dma_load_idle;
+
+static void spi_dma_load_idle_hook(void)
+{
+    spi_dma_load_idle++;
+}
+
+/* read the partition in a loop for the ticks, or sleep when part is null, return the idle loop count */
+static rt_uint32_t spi_dma_load_run(const struct fal_partition *part, rt_uint8_t *buf, rt_tick_t ticks,
+                                    rt_uint32_t *read_kb)
+{
+    rt_uint32_t addr = 0, size = 0;
+    rt_tick_t start;
+
+    spi_dma_load_idle = 0;
+    start = rt_tick_get();
+    if (part == RT_NULL)
+    {
+        rt_thread_delay(ticks);
+    }
+    else
+    {
+        while (rt_tick_get() - start < ticks)
+        {
+            if (fal_partition_read(part, addr, buf, SPI_DMA_LOAD_READ_SIZE) < 0)
+            {
+                break;
+            }
+            size += SPI_DMA_LOAD_READ_SIZE;
+            addr = (addr + SPI_DMA_LOAD_READ_SIZE) % part->len;
+        }
+        *read_kb = size / 1024;
+    }
+
+    return spi_dma_load_idle;
+}
+
+/*
+ * The CPU load of reading a FAL partition. The idle hook counts the idle loops, first while this thread sleeps, then
+ * while it reads the partition. The load is the idle time lost against the sleeping run, so it doesn't include the
+ * other threads. The 4 KB reads bypass the FAL cache. The polled baseline is the build with SPI_DMA_TRANS_MIN_LEN
+ * above the read size, or without the SPI RX DMA.
+ */
+static int spi_dma_load(int argc, char **argv)
+{
+    const struct fal_partition *part;
+    rt_uint32_t ms = 1000, idle_ref, idle, read_kb = 0, load;
+    rt_uint8_t *buf;
+
+    if (argc < 2)
+    {
+        rt_kprintf("Usage: spi_dma_load <partition> [ms]\n");
+        return -RT_EINVAL;
+    }
+    part = fal_partition_find(argv[1]);
+    if (part == RT_NULL || part->len < SPI_DMA_LOAD_READ_SIZE)
+    {
+        rt_kprintf("partition %s not found\n", argv[1]);
+        return -RT_EINVAL;
+    }
+    if (argc > 2)
+    {
+        ms = atoi(argv[2]);
+    }
+    buf = rt_malloc(SPI_DMA_LOAD_READ_SIZE);
+    if (buf == RT_NULL)
+    {
+        return -RT_ENOMEM;
+    }
+    if (rt_thread_idle_sethook(spi_dma_load_idle_hook) != RT_EOK)
+    {
+        rt_free(buf);
+        return -RT_EFULL;
+    }
+
+    idle_ref = spi_dma_load_run(RT_NULL, buf, rt_tick_from_millisecond(ms), &read_kb);
+    idle = spi_dma_load_run(part, buf, rt_tick_from_millisecond(ms), &read_kb);
+    rt_thread_idle_delhook(spi_dma_load_idle_hook);
+    rt_free(buf);
+
+    if (idle_ref == 0)
+    {
+        rt_kprintf("no idle loop in %u ms\n", ms);
+        return -RT_ERROR;
+    }
+    if (idle > idle_ref)
+    {
+        idle = idle_ref;
+    }
+    load = (rt_uint32_t)(1000 - (rt_uint64_t)idle * 1000 / idle_ref);
+    rt_kprintf("%d B reads of %s for %u ms: load %u.%u%%, %u KB/s\n", SPI_DMA_LOAD_READ_SIZE, part->name, ms,
+               load / 10, load % 10, read_kb * 1000 / ms);
+
+    return RT_EOK;
+}
+MSH_CMD_EXPORT(spi_dma_load, CPU load of FAL partition reads);
+#endif /* defined(RT_USING_FAL) && defined(RT_USING_FINSH) && defined(RT_USING_IDLE_HOOK) */
@@ -605,6 +605,41 @@ static rt_err_t _can_control(struct rt_can_device *can, int cmd, void *arg)
     return RT_EOK;
 }
 
+static void _can_fill_tx_message(const struct rt_can_msg *pmsg, can_tx_message_type *tx_message)
+{
+    if (RT_CAN_STDID == pmsg->ide)
+    {
+        tx_message->id_type = CAN_ID_STANDARD;
+        tx_message->standard_id = pmsg->id;
+    }
+    else
+    {
+        tx_message->id_type = CAN_ID_EXTENDED;
+        tx_message->extended_id = pmsg->id;
+    }
+
+    if (RT_CAN_DTR == pmsg->rtr)
+    {
+        tx_message->frame_type = CAN_TFT_DATA;
+    }
+    else
+    {
+        tx_message->frame_type = CAN_TFT_REMOTE;
+    }
+
+    /* set up the dlc */
+    tx_message->dlc = pmsg->len & 0x0FU;
+    /* set up the data field */
+    tx_message->data[0] = (uint32_t)pmsg->data[0];
+    tx_message->data[1] = (uint32_t)pmsg->data[1];
+    tx_message->data[2] = (uint32_t)pmsg->data[2];
+    tx_message->data[3] = (uint32_t)pmsg->data[3];
+    tx_message->data[4] = (uint32_t)pmsg->data[4];
+    tx_message->data[5] = (uint32_t)pmsg->data[5];
+    tx_message->data[6] = (uint32_t)pmsg->data[6];
+    tx_message->data[7] = (uint32_t)pmsg->data[7];
+}
+
 static rt_ssize_t _can_sendmsg(struct rt_can_device *can, const void *buf, rt_uint32_t box_num)
 {
     struct can_config *hcan;
@@ -641,39 +676,24 @@ static rt_ssize_t _can_sendmsg(struct rt_can_device *can, const void *buf, rt_ui
         break;
     }
 
-    if (RT_CAN_STDID == pmsg->ide)
-    {
-        tx_message.id_type = CAN_ID_STANDARD;
-        tx_message.standard_id = pmsg->id;
-    }
-    else
-    {
-        tx_message.id_type = CAN_ID_EXTENDED;
-        tx_message.extended_id = pmsg->id;
-    }
+    _can_fill_tx_message(pmsg, &tx_message);
+    can_message_transmit(hcan->can_x, &tx_message);
 
-    if (RT_CAN_DTR == pmsg->rtr)
-    {
-        tx_message.frame_type = CAN_TFT_DATA;
-    }
-    else
-    {
-        tx_message.frame_type = CAN_TFT_REMOTE;
-    }
+    return RT_EOK;
+}
 
-    /* set up the dlc */
-    tx_message.dlc = pmsg->len & 0x0FU;
-    /* set up the data field */
-    tx_message.data[0] = (uint32_t)pmsg->data[0];
-    tx_message.data[1] = (uint32_t)pmsg->data[1];
-    tx_message.data[2] = (uint32_t)pmsg->data[2];
-    tx_message.data[3] = (uint32_t)pmsg->data[3];
-    tx_message.data[4] = (uint32_t)pmsg->data[4];
-    tx_message.data[5] = (uint32_t)pmsg->data[5];
-    tx_message.data[6] = (uint32_t)pmsg->data[6];
-    tx_message.data[7] = (uint32_t)pmsg->data[7];
+static rt_ssize_t _can_sendmsg_nonblocking(struct rt_can_device *can, const void *buf)
+{
+    struct can_config *hcan;
+    hcan = &((struct at32_can *) can->parent.user_data)->config;
+    can_tx_message_type tx_message;
 
-    can_message_transmit(hcan->can_x, &tx_message);
+    _can_fill_tx_message((const struct rt_can_msg *)buf, &tx_message);
+    /* any empty mailbox will do */
+    if (can_message_transmit(hcan->can_x, &tx_message) == CAN_TX_STATUS_NO_EMPTY)
+    {
+        return -RT_EBUSY;
+    }
 
     return RT_EOK;
 }
@@ -724,6 +744,7 @@ static const struct rt_can_ops _can_ops =
     _can_control,
     _can_sendmsg,
     _can_recvmsg,
+    _can_sendmsg_nonblocking,
 };
 
 static void _can_rx_isr(struct rt_can_device *can, rt_uint32_t fifo)
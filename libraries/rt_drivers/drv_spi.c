@@ -30,6 +30,11 @@
 #define LOG_TAG             "drv.pwm"
 #include <drv_log.h>
 
+/* only transfer length >= SPI_DMA_TRANS_MIN_LEN will use dma mode, the shorter ones are polled */
+#ifndef SPI_DMA_TRANS_MIN_LEN
+#define SPI_DMA_TRANS_MIN_LEN   32
+#endif
+
 enum
 {
 #ifdef BSP_USING_SPI1
@@ -64,6 +69,8 @@ static struct at32_spi_config spi_config[] = {
 #endif
 };
 
+static struct at32_spi spis[sizeof(spi_config) / sizeof(spi_config[0])] = {0};
+
 /* private rt-thread spi ops function */
 static rt_err_t configure(struct rt_spi_device* device, struct rt_spi_configuration* configuration);
 static rt_ssize_t xfer(struct rt_spi_device* device, struct rt_spi_message* message);
@@ -285,10 +292,46 @@ static void _spi_dma_transmit(struct at32_spi *instance, rt_uint8_t *buffer, rt_
 
     /* mark dma flag */
     instance->config->dma_tx->dma_done = RT_FALSE;
+    /* drop a done left by a timed out transfer */
+    rt_completion_init(&instance->dma_completion);
     /* enable dma channel */
     dma_channel_enable(dma_channel, TRUE);
 }
 
+static rt_err_t _spi_dma_wait(struct at32_spi *instance, rt_uint32_t size, rt_uint32_t max_hz)
+{
+    rt_int32_t timeout;
+    rt_err_t result;
+
+    /* twice the transfer time at max_hz plus 10ms, in ticks */
+    timeout = rt_tick_from_millisecond(size / (max_hz / 16000 + 1) + 10);
+
+    /* sleep until the last dma channel of this transfer is done */
+    result = rt_completion_wait(&instance->dma_completion, timeout);
+    if (result != RT_EOK)
+    {
+        LOG_E("spi dma transfer %d bytes timeout\n", size);
+        /* stop the dma channels */
+        dma_interrupt_enable(instance->config->dma_tx->dma_channel, DMA_FDT_INT, FALSE);
+        dma_channel_enable(instance->config->dma_tx->dma_channel, FALSE);
+        instance->config->dma_tx->dma_done = RT_TRUE;
+        if (instance->config->spi_dma_flag & RT_DEVICE_FLAG_DMA_RX)
+        {
+            dma_interrupt_enable(instance->config->dma_rx->dma_channel, DMA_FDT_INT, FALSE);
+            dma_channel_enable(instance->config->dma_rx->dma_channel, FALSE);
+            instance->config->dma_rx->dma_done = RT_TRUE;
+        }
+    }
+    /* the last data is still shifting out */
+    while(spi_i2s_flag_get(instance->config->spi_x, SPI_I2S_BF_FLAG) != RESET);
+    /* clear rx overrun flag */
+    spi_i2s_flag_clear(instance->config->spi_x, SPI_I2S_ROERR_FLAG);
+    spi_enable(instance->config->spi_x, FALSE);
+    spi_enable(instance->config->spi_x, TRUE);
+
+    return result;
+}
+
 static void _spi_polling_receive_transmit(struct at32_spi *instance, rt_uint8_t *recv_buf, rt_uint8_t *send_buf, \
                                           rt_uint32_t size, rt_uint8_t data_mode)
 {
@@ -369,6 +412,7 @@ static rt_ssize_t xfer(struct rt_spi_device* device, struct rt_spi_message* mess
     rt_uint16_t send_length = 0;
     rt_uint8_t *recv_buf;
     const rt_uint8_t *send_buf;
+    rt_err_t result = RT_EOK;
 
     RT_ASSERT(device != NULL);
     RT_ASSERT(message != NULL);
@@ -413,17 +457,13 @@ static rt_ssize_t xfer(struct rt_spi_device* device, struct rt_spi_message* mess
         if (message->send_buf && message->recv_buf)
         {
             if ((instance->config->spi_dma_flag & RT_DEVICE_FLAG_DMA_RX) && \
-                (instance->config->spi_dma_flag & RT_DEVICE_FLAG_DMA_TX))
+                (instance->config->spi_dma_flag & RT_DEVICE_FLAG_DMA_TX) && \
+                (send_length >= SPI_DMA_TRANS_MIN_LEN))
             {
                 _spi_dma_receive(instance, (uint8_t *)recv_buf, send_length);
                 _spi_dma_transmit(instance, (uint8_t *)send_buf, send_length);
                 /* wait transfer complete */
-                while(spi_i2s_flag_get(instance->config->spi_x, SPI_I2S_BF_FLAG) != RESET);
-                while((instance->config->dma_tx->dma_done == RT_FALSE) || (instance->config->dma_rx->dma_done == RT_FALSE));
-                /* clear rx overrun flag */
-                spi_i2s_flag_clear(instance->config->spi_x, SPI_I2S_ROERR_FLAG);
-                spi_enable(instance->config->spi_x, FALSE);
-                spi_enable(instance->config->spi_x, TRUE);
+                result = _spi_dma_wait(instance, send_length, config->max_hz);
             }
             else
             {
@@ -432,16 +472,12 @@ static rt_ssize_t xfer(struct rt_spi_device* device, struct rt_spi_message* mess
         }
         else if (message->send_buf)
         {
-            if (instance->config->spi_dma_flag & RT_DEVICE_FLAG_DMA_TX)
+            if ((instance->config->spi_dma_flag & RT_DEVICE_FLAG_DMA_TX) && \
+                (send_length >= SPI_DMA_TRANS_MIN_LEN))
             {
                 _spi_dma_transmit(instance, (uint8_t *)send_buf, send_length);
                 /* wait transfer complete */
-                while(spi_i2s_flag_get(instance->config->spi_x, SPI_I2S_BF_FLAG) != RESET);
-                while(instance->config->dma_tx->dma_done == RT_FALSE);
-                /* clear rx overrun flag */
-                spi_i2s_flag_clear(instance->config->spi_x, SPI_I2S_ROERR_FLAG);
-                spi_enable(instance->config->spi_x, FALSE);
-                spi_enable(instance->config->spi_x, TRUE);
+                result = _spi_dma_wait(instance, send_length, config->max_hz);
             }
             else
             {
@@ -457,17 +493,13 @@ static rt_ssize_t xfer(struct rt_spi_device* device, struct rt_spi_message* mess
         else
         {
             memset((void *)recv_buf, 0xff, send_length);
-            if (instance->config->spi_dma_flag & RT_DEVICE_FLAG_DMA_RX)
+            if ((instance->config->spi_dma_flag & RT_DEVICE_FLAG_DMA_RX) && \
+                (send_length >= SPI_DMA_TRANS_MIN_LEN))
             {
                 _spi_dma_receive(instance, (uint8_t *)recv_buf, send_length);
                 _spi_dma_transmit(instance, (uint8_t *)recv_buf, send_length);
                 /* wait transfer complete */
-                while(spi_i2s_flag_get(instance->config->spi_x, SPI_I2S_BF_FLAG) != RESET);
-                while((instance->config->dma_tx->dma_done == RT_FALSE) || (instance->config->dma_rx->dma_done == RT_FALSE));
-                /* clear rx overrun flag */
-                spi_i2s_flag_clear(instance->config->spi_x, SPI_I2S_ROERR_FLAG);
-                spi_enable(instance->config->spi_x, FALSE);
-                spi_enable(instance->config->spi_x, TRUE);
+                result = _spi_dma_wait(instance, send_length, config->max_hz);
             }
             else
             {
@@ -476,6 +508,11 @@ static rt_ssize_t xfer(struct rt_spi_device* device, struct rt_spi_message* mess
                 _spi_polling_receive_transmit(instance, (uint8_t *)recv_buf, (uint8_t *)recv_buf, send_length, config->data_width);
             }
         }
+
+        if (result != RT_EOK)
+        {
+            break;
+        }
     }
 
     /* release cs */
@@ -485,6 +522,11 @@ static rt_ssize_t xfer(struct rt_spi_device* device, struct rt_spi_message* mess
         LOG_D("spi release cs\n");
     }
 
+    if (result != RT_EOK)
+    {
+        return result;
+    }
+
     return message->length;
 }
 
@@ -579,7 +621,7 @@ static void at32_spi_dma_init(struct at32_spi *instance)
     }
 }
 
-void spi_dma_isr(struct dma_config *dma_instance)
+void spi_dma_isr(struct at32_spi *instance, struct dma_config *dma_instance)
 {
     volatile rt_uint32_t reg_sts = 0, index = 0;
 
@@ -597,6 +639,12 @@ void spi_dma_isr(struct dma_config *dma_instance)
         dma_channel_enable(dma_instance->dma_channel, FALSE);
         /* mark done flag */
         dma_instance->dma_done = RT_TRUE;
+        /* wake up the waiting thread when both channels of the transfer are done */
+        if ((instance->config->dma_tx->dma_done == RT_TRUE) && \
+            (!(instance->config->spi_dma_flag & RT_DEVICE_FLAG_DMA_RX) || (instance->config->dma_rx->dma_done == RT_TRUE)))
+        {
+            rt_completion_done(&instance->dma_completion);
+        }
     }
 }
 
@@ -632,7 +680,7 @@ void SPI1_RX_DMA_IRQHandler(void)
     /* enter interrupt */
     rt_interrupt_enter();
 
-    spi_dma_isr(spi_config[SPI1_INDEX].dma_rx);
+    spi_dma_isr(&spis[SPI1_INDEX], spi_config[SPI1_INDEX].dma_rx);
 
     /* leave interrupt */
     rt_interrupt_leave();
@@ -644,7 +692,7 @@ void SPI1_TX_DMA_IRQHandler(void)
     /* enter interrupt */
     rt_interrupt_enter();
 
-    spi_dma_isr(spi_config[SPI1_INDEX].dma_tx);
+    spi_dma_isr(&spis[SPI1_INDEX], spi_config[SPI1_INDEX].dma_tx);
 
     /* leave interrupt */
     rt_interrupt_leave();
@@ -668,7 +716,7 @@ void SPI2_RX_DMA_IRQHandler(void)
     /* enter interrupt */
     rt_interrupt_enter();
 
-    spi_dma_isr(spi_config[SPI2_INDEX].dma_rx);
+    spi_dma_isr(&spis[SPI2_INDEX], spi_config[SPI2_INDEX].dma_rx);
 
     /* leave interrupt */
     rt_interrupt_leave();
@@ -680,7 +728,7 @@ void SPI2_TX_DMA_IRQHandler(void)
     /* enter interrupt */
     rt_interrupt_enter();
 
-    spi_dma_isr(spi_config[SPI2_INDEX].dma_tx);
+    spi_dma_isr(&spis[SPI2_INDEX], spi_config[SPI2_INDEX].dma_tx);
 
     /* leave interrupt */
     rt_interrupt_leave();
@@ -704,7 +752,7 @@ void SPI3_RX_DMA_IRQHandler(void)
     /* enter interrupt */
     rt_interrupt_enter();
 
-    spi_dma_isr(spi_config[SPI3_INDEX].dma_rx);
+    spi_dma_isr(&spis[SPI3_INDEX], spi_config[SPI3_INDEX].dma_rx);
 
     /* leave interrupt */
     rt_interrupt_leave();
@@ -716,7 +764,7 @@ void SPI3_TX_DMA_IRQHandler(void)
     /* enter interrupt */
     rt_interrupt_enter();
 
-    spi_dma_isr(spi_config[SPI3_INDEX].dma_tx);
+    spi_dma_isr(&spis[SPI3_INDEX], spi_config[SPI3_INDEX].dma_tx);
 
     /* leave interrupt */
     rt_interrupt_leave();
@@ -740,7 +788,7 @@ void SPI4_RX_DMA_IRQHandler(void)
     /* enter interrupt */
     rt_interrupt_enter();
 
-    spi_dma_isr(spi_config[SPI4_INDEX].dma_rx);
+    spi_dma_isr(&spis[SPI4_INDEX], spi_config[SPI4_INDEX].dma_rx);
 
     /* leave interrupt */
     rt_interrupt_leave();
@@ -752,7 +800,7 @@ void SPI4_TX_DMA_IRQHandler(void)
     /* enter interrupt */
     rt_interrupt_enter();
 
-    spi_dma_isr(spi_config[SPI4_INDEX].dma_tx);
+    spi_dma_isr(&spis[SPI4_INDEX], spi_config[SPI4_INDEX].dma_tx);
 
     /* leave interrupt */
     rt_interrupt_leave();
@@ -816,8 +864,6 @@ void SPI3_2_TX_RX_DMA_IRQHandler(void)
 }
 #endif
 
-static struct at32_spi spis[sizeof(spi_config) / sizeof(spi_config[0])] = {0};
-
 static void at32_spi_get_dma_config(void)
 {
 #ifdef BSP_USING_SPI1
@@ -889,6 +935,7 @@ int rt_hw_spi_init(void)
     {
         spis[i].config = &spi_config[i];
         spis[i].spi_bus.parent.user_data = (void *)&spis[i];
+        rt_completion_init(&spis[i].dma_completion);
 
         if(spis[i].config->spi_dma_flag & (RT_DEVICE_FLAG_DMA_RX | RT_DEVICE_FLAG_DMA_TX))
         {
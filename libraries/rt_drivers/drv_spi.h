@@ -30,6 +30,7 @@ struct at32_spi
 {
     struct at32_spi_config *config;
     struct rt_spi_bus spi_bus;
+    struct rt_completion dma_completion;
 };
 
 struct at32_spi_cs
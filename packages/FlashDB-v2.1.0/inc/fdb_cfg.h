@@ -30,4 +30,55 @@
 
 #define FDB_PRINT(...) rt_kprintf(__VA_ARGS__)
 
+/* index all KVs of the 512 KB "kvdb" partition, 12 bytes per slot, 192 KVs at most */
+#ifndef FDB_KV_INDEX_SIZE
+#define FDB_KV_INDEX_SIZE 256
+#endif
+
+/* collect the 128 sectors by steps in the GC task when fewer than 4 are empty, until 8 are */
+#ifndef FDB_KV_GC_LOW_WATERMARK
+#define FDB_KV_GC_LOW_WATERMARK 4
+#define FDB_KV_GC_HIGH_WATERMARK 8
+#endif
+
+/* save the caches and index of the 128 sectors to the "kvsnap" partition, only the sectors written since are scanned */
+#ifndef FDB_KV_SNAPSHOT_SEC_NUM
+#define FDB_KV_SNAPSHOT_SEC_NUM 128
+#endif
+
+/* count the sector erases in the headers, the GC by steps moves the cold KVs when the counts spread over 100 */
+#define FDB_USING_ERASE_COUNT
+#ifndef FDB_KV_WEAR_LEVEL_DELTA
+#define FDB_KV_WEAR_LEVEL_DELTA 100
+#endif
+
+/* share the databases by the readers, the cached and indexed KVs are read without lock */
+#define FDB_USING_RW_LOCK
+
+/* index all 128 sectors of the 512 KB "tsdb" partition, and read 16 TSL indexes at a time */
+#ifndef FDB_TSDB_SEC_INDEX_NUM
+#define FDB_TSDB_SEC_INDEX_NUM 128
+#endif
+#ifndef FDB_TSDB_READ_AHEAD_SIZE
+#define FDB_TSDB_READ_AHEAD_SIZE 256
+#endif
+
+/* keep the count, min, max and sum of the typed TSL values for each indexed sector */
+#define FDB_TSDB_USING_SUMMARY
+
+/* encode the sensor samples in 256 bytes blocks, each block is saved as one TSL */
+#ifndef FDB_TSDB_SERIES_BLOCK_SIZE
+#define FDB_TSDB_SERIES_BLOCK_SIZE 256
+#endif
+
+/* stage the appended TSLs and program them by the 256 bytes pages of the W25Q128 */
+#ifndef FDB_TSDB_APPEND_BUF_SIZE
+#define FDB_TSDB_APPEND_BUF_SIZE 256
+#endif
+
+/* the utests cut the flash writes like a power failure */
+#ifdef RT_USING_UTEST
+#define FDB_USING_POWER_CUT_TEST
+#endif
+
 #endif /* _FDB_CFG_H_ */
@@ -43,10 +43,121 @@ extern "C" {
 #define FDB_KV_USING_CACHE
 #endif
 
+/* the KV index table size, 0: disable. It must be a power of 2 and hold all KVs with 1/4 spare slots.
+ * Every KV is indexed at load, then a KV is found without searching the flash. */
+#ifndef FDB_KV_INDEX_SIZE
+#define FDB_KV_INDEX_SIZE              0
+#endif
+
+#if FDB_KV_INDEX_SIZE > 0
+#if (FDB_KV_INDEX_SIZE & (FDB_KV_INDEX_SIZE - 1)) != 0 || FDB_KV_INDEX_SIZE > 32768
+#error "FDB_KV_INDEX_SIZE must be a power of 2, 32768 at most"
+#endif
+#define FDB_KV_USING_INDEX
+#endif
+
+/* the empty sector watermarks of the GC by steps, 0: disable. fdb_kv_gc_step() starts to collect the dirty sectors
+ * when the empty sectors are fewer than the low watermark, and stops when there are the high watermark. */
+#ifndef FDB_KV_GC_LOW_WATERMARK
+#define FDB_KV_GC_LOW_WATERMARK        0
+#endif
+#ifndef FDB_KV_GC_HIGH_WATERMARK
+#define FDB_KV_GC_HIGH_WATERMARK       (FDB_KV_GC_LOW_WATERMARK * 2)
+#endif
+
+#if FDB_KV_GC_LOW_WATERMARK > 0
+#if FDB_KV_GC_HIGH_WATERMARK <= FDB_KV_GC_LOW_WATERMARK
+#error "FDB_KV_GC_HIGH_WATERMARK must be greater than FDB_KV_GC_LOW_WATERMARK"
+#endif
+#define FDB_KV_USING_GC_STEP
+#endif
+
+/* the KVDB snapshot sector number, 0: disable. A KVDB which has no more sectors than it saves its caches and index
+ * to a snapshot partition by fdb_kv_snapshot(), then only the sectors written since the snapshot are checked when
+ * it's loaded. The snapshot partition is set by FDB_KVDB_CTRL_SET_SNAPSHOT. */
+#ifndef FDB_KV_SNAPSHOT_SEC_NUM
+#define FDB_KV_SNAPSHOT_SEC_NUM        0
+#endif
+
+#if FDB_KV_SNAPSHOT_SEC_NUM > 0
+#define FDB_KV_USING_SNAPSHOT
+#endif
+
+#ifdef FDB_USING_ERASE_COUNT
+/* the rated erase cycles of a sector, the lifetime is projected until the most erased sector reaches it */
+#ifndef FDB_ERASE_ENDURANCE
+#define FDB_ERASE_ENDURANCE            100000
+#endif
+#endif /* FDB_USING_ERASE_COUNT */
+
+/* the erase count spread of the KVDB static wear leveling, 0: disable. The GC by steps moves the KVs of the least
+ * erased sector without dirty KV when the erase counts of the sectors differ by more than it. */
+#ifndef FDB_KV_WEAR_LEVEL_DELTA
+#define FDB_KV_WEAR_LEVEL_DELTA        0
+#endif
+
+#if FDB_KV_WEAR_LEVEL_DELTA > 0
+#if !defined(FDB_USING_ERASE_COUNT) || !defined(FDB_KV_USING_GC_STEP)
+#error "FDB_KV_WEAR_LEVEL_DELTA needs FDB_USING_ERASE_COUNT and the GC by steps"
+#endif
+#define FDB_KV_USING_WEAR_LEVEL
+#endif
+
+/* the TSDB sector index size, 0: disable. A TSDB is indexed when it has no more sectors than it, 12 bytes per
+ * sector, then the first sector of a time range is found by a binary search in RAM. */
+#ifndef FDB_TSDB_SEC_INDEX_NUM
+#define FDB_TSDB_SEC_INDEX_NUM         0
+#endif
+
+#if FDB_TSDB_SEC_INDEX_NUM > 0
+#define FDB_TSDB_USING_SEC_INDEX
+#endif
+
+/* the TSDB sector summaries of the typed TSL values, 20 more bytes per indexed sector. The count, min, max and sum of
+ * each sector are kept up to date by the appends, then an aggregate query reads the sectors at its range edges only. */
+#if defined(FDB_TSDB_USING_SUMMARY) && !defined(FDB_TSDB_USING_SEC_INDEX)
+#error "FDB_TSDB_USING_SUMMARY needs the TSDB sector index"
+#endif
+
+/* the TSL index read-ahead buffer size, 0: disable. The TSL indexes in a sector are read by the buffer size. */
+#ifndef FDB_TSDB_READ_AHEAD_SIZE
+#define FDB_TSDB_READ_AHEAD_SIZE       0
+#endif
+
+#if FDB_TSDB_READ_AHEAD_SIZE > 0
+#define FDB_TSDB_USING_READ_AHEAD
+#endif
+
+/* the compressed series block size, 0: disable. The samples are encoded in a RAM block, then saved as one TSL. */
+#ifndef FDB_TSDB_SERIES_BLOCK_SIZE
+#define FDB_TSDB_SERIES_BLOCK_SIZE     0
+#endif
+
+#if FDB_TSDB_SERIES_BLOCK_SIZE > 0
+#define FDB_TSDB_USING_SERIES
+#endif
+
+/* the TSL append buffer size, 0: disable. It's the flash page size, the appended TSLs are staged in RAM and
+ * programmed by pages, the staged TSLs are lost on power down until flushed. */
+#ifndef FDB_TSDB_APPEND_BUF_SIZE
+#define FDB_TSDB_APPEND_BUF_SIZE       0
+#endif
+
+#if FDB_TSDB_APPEND_BUF_SIZE > 0
+#define FDB_TSDB_USING_APPEND_BUF
+#endif
+
 #if defined(FDB_USING_FILE_LIBC_MODE) || defined(FDB_USING_FILE_POSIX_MODE)
 #define FDB_USING_FILE_MODE
 #endif
 
+#ifdef FDB_USING_RW_LOCK
+/* the memory barrier of the lock-free KV reads, it orders the KV lookup sequence against the cache accesses */
+#ifndef FDB_MEM_BARRIER
+#define FDB_MEM_BARRIER()              __sync_synchronize()
+#endif
+#endif /* FDB_USING_RW_LOCK */
+
 /* the file cache table size, it will improve GC speed in file mode when using cache */
 #ifndef FDB_FILE_CACHE_TABLE_SIZE
 #define FDB_FILE_CACHE_TABLE_SIZE    2
@@ -56,6 +167,10 @@ extern "C" {
 #define FDB_WRITE_GRAN 1
 #endif
 
+#if defined(FDB_USING_ERASE_COUNT) && (FDB_WRITE_GRAN > 32)
+#error "FDB_USING_ERASE_COUNT only supports the write granularity up to 32 bits"
+#endif
+
 /* log function. default FDB_PRINT macro is printf() */
 #ifndef FDB_PRINT
 #define FDB_PRINT(...)                 printf(__VA_ARGS__)
@@ -91,6 +206,9 @@ if (!(EXPR))                                                                  \
 #define FDB_KVDB_CTRL_SET_FILE_MODE    0x09             /**< set file mode control command, this change MUST before database initialization */
 #define FDB_KVDB_CTRL_SET_MAX_SIZE     0x0A             /**< set database max size in file mode control command, this change MUST before database initialization */
 #define FDB_KVDB_CTRL_SET_NOT_FORMAT   0x0B             /**< set database NOT format mode control command, this change MUST before database initialization */
+#define FDB_KVDB_CTRL_SET_SNAPSHOT     0x0C             /**< set snapshot partition name control command, this change MUST before database initialization */
+#define FDB_KVDB_CTRL_SET_RDLOCK       0x0D             /**< set the shared read lock function control command */
+#define FDB_KVDB_CTRL_SET_RDUNLOCK     0x0E             /**< set the shared read unlock function control command */
 
 #define FDB_TSDB_CTRL_SET_SEC_SIZE     0x00             /**< set sector size control command, this change MUST before database initialization */
 #define FDB_TSDB_CTRL_GET_SEC_SIZE     0x01             /**< get sector size control command */
@@ -102,6 +220,12 @@ if (!(EXPR))                                                                  \
 #define FDB_TSDB_CTRL_SET_FILE_MODE    0x09             /**< set file mode control command, this change MUST before database initialization */
 #define FDB_TSDB_CTRL_SET_MAX_SIZE     0x0A             /**< set database max size in file mode control command, this change MUST before database initialization */
 #define FDB_TSDB_CTRL_SET_NOT_FORMAT   0x0B             /**< set database NOT formatable mode control command, this change MUST before database initialization */
+#define FDB_TSDB_CTRL_SET_FLUSH_DEADLINE 0x0C           /**< set the staged TSLs flush deadline control command, this change MUST after database initialization */
+#define FDB_TSDB_CTRL_GET_FLUSH_DEADLINE 0x0D           /**< get the staged TSLs flush deadline control command */
+#define FDB_TSDB_CTRL_SET_RDLOCK       0x0E             /**< set the shared read lock function control command */
+#define FDB_TSDB_CTRL_SET_RDUNLOCK     0x0F             /**< set the shared read unlock function control command */
+#define FDB_TSDB_CTRL_SET_VALUE_TYPE   0x10             /**< set the TSL value type control command, this change MUST before database initialization */
+#define FDB_TSDB_CTRL_GET_VALUE_TYPE   0x11             /**< get the TSL value type control command */
 
 #ifdef FDB_USING_TIMESTAMP_64BIT
     typedef int64_t fdb_time_t;
@@ -157,6 +281,21 @@ enum fdb_tsl_status {
 };
 typedef enum fdb_tsl_status fdb_tsl_status_t;
 
+/* the TSL value type, a typed TSL starts with its value */
+enum fdb_tsl_value_type {
+    FDB_TSL_VALUE_NONE,
+    FDB_TSL_VALUE_INT32,
+    FDB_TSL_VALUE_FLOAT,
+};
+typedef enum fdb_tsl_value_type fdb_tsl_value_type_t;
+
+/* the typed TSL value */
+union fdb_tsl_value {
+    int32_t i32;
+    float f32;
+};
+typedef union fdb_tsl_value fdb_tsl_value_t;
+
 /* key-value node object */
 struct fdb_kv {
     fdb_kv_status_t status;                      /**< node status, @see fdb_kv_status_t */
@@ -183,6 +322,43 @@ struct fdb_kv_iterator {
 };
 typedef struct fdb_kv_iterator *fdb_kv_iterator_t;
 
+struct fdb_kv_batch_node {
+    const char *key;                             /**< KV name, it MUST be valid until the batch is committed */
+    const void *value;                           /**< KV value, NULL: delete the KV */
+    size_t value_len;                            /**< value length */
+    uint32_t addr;                               /**< new KV node address. DO NOT touch it. */
+    uint32_t old_addr;                           /**< old KV node address. DO NOT touch it. */
+};
+typedef struct fdb_kv_batch_node *fdb_kv_batch_node_t;
+
+/* the KVs which are set or deleted together, all of them are changed or none after power failure */
+struct fdb_kv_batch {
+    struct fdb_kvdb *db;                         /**< database object */
+    struct fdb_kv_batch_node *nodes;             /**< node buffer given by user */
+    size_t max_num;                              /**< node buffer size */
+    size_t num;                                  /**< used nodes */
+};
+typedef struct fdb_kv_batch *fdb_kv_batch_t;
+
+/* the erase count statistics of the database sectors */
+struct fdb_erase_stat {
+    uint32_t sec_num;                            /**< sector number */
+    uint32_t min;                                /**< the least erase count of a sector */
+    uint32_t max;                                /**< the most erase count of a sector */
+    uint32_t total;                              /**< the erase count of all sectors */
+    uint32_t session;                            /**< the sectors erased since the database is initialized */
+};
+typedef struct fdb_erase_stat *fdb_erase_stat_t;
+
+/* the aggregate of the typed TSL values in a time range, the average is sum / count */
+struct fdb_tsl_agg {
+    uint32_t count;                              /**< the aggregated TSL count, 0: no value in the range */
+    double min;                                  /**< the least value */
+    double max;                                  /**< the greatest value */
+    double sum;                                  /**< the sum of the values */
+};
+typedef struct fdb_tsl_agg *fdb_tsl_agg_t;
+
 /* time series log node object */
 struct fdb_tsl {
     fdb_tsl_status_t status;                     /**< node status, @see fdb_log_status_t */
@@ -233,6 +409,9 @@ struct kvdb_sec_info {
     uint32_t combined;                           /**< the combined next sector number, 0xFFFFFFFF: not combined */
     size_t remain;                               /**< remain size */
     uint32_t empty_kv;                           /**< the next empty KV node start address */
+#ifdef FDB_USING_ERASE_COUNT
+    uint32_t erase_count;                        /**< sector erase count, 0: formatted before the counter */
+#endif
 };
 typedef struct kvdb_sec_info *kv_sec_info_t;
 
@@ -249,9 +428,27 @@ struct tsdb_sec_info {
     size_t remain;                               /**< remain size */
     uint32_t empty_idx;                          /**< the next empty node index address */
     uint32_t empty_data;                         /**< the next empty node's data end address */
+#ifdef FDB_USING_ERASE_COUNT
+    uint32_t erase_count;                        /**< sector erase count, 0: formatted before the counter */
+#endif
 };
 typedef struct tsdb_sec_info *tsdb_sec_info_t;
 
+struct tsdb_sec_index_node {
+    fdb_time_t start_time;                       /**< the first TSL's timestamp */
+    fdb_time_t end_time;                         /**< the last TSL's timestamp */
+    uint16_t count;                              /**< TSL count */
+    uint8_t status;                              /**< sector store status @see fdb_sector_store_status_t */
+#ifdef FDB_TSDB_USING_SUMMARY
+    bool val_ok;                                 /**< the summary is up to date, else it's built by an aggregate query */
+    uint16_t val_num;                            /**< the aggregated TSL count */
+    fdb_tsl_value_t val_min;                     /**< the least TSL value */
+    fdb_tsl_value_t val_max;                     /**< the greatest TSL value */
+    double val_sum;                              /**< the sum of the TSL values */
+#endif
+};
+typedef struct tsdb_sec_index_node *tsdb_sec_index_node_t;
+
 struct kv_cache_node {
     uint16_t name_crc;                           /**< KV name's CRC32 low 16bit value */
     uint16_t active;                             /**< KV node access active degree */
@@ -259,6 +456,15 @@ struct kv_cache_node {
 };
 typedef struct kv_cache_node *kv_cache_node_t;
 
+struct kv_index_node {
+    uint32_t hash;                               /**< KV name's FNV-1a 32bit hash value */
+    uint32_t addr;                               /**< KV node address, FDB_DATA_UNUSED: empty slot */
+    uint16_t value_len;                          /**< KV value length */
+    uint8_t name_len;                            /**< KV name length */
+    uint8_t long_value;                          /**< the value is too long for value_len, the KV header is read on flash */
+};
+typedef struct kv_index_node *kv_index_node_t;
+
 /* database structure */
 typedef struct fdb_db *fdb_db_t;
 struct fdb_db {
@@ -289,6 +495,16 @@ struct fdb_db {
 #endif
     void (*lock)(fdb_db_t db);                   /**< lock the database operate */
     void (*unlock)(fdb_db_t db);                 /**< unlock the database operate */
+#ifdef FDB_USING_RW_LOCK
+    void (*rdlock)(fdb_db_t db);                 /**< lock the database shared by the readers, NULL: use the lock */
+    void (*rdunlock)(fdb_db_t db);               /**< unlock the database shared by the readers */
+    bool rd_locked;                              /**< hold by the readers, the caches are NOT updated */
+#endif
+
+#ifdef FDB_USING_ERASE_COUNT
+    uint32_t erase_max;                          /**< the most erase count read, a count lost on power failure restarts from it */
+    uint32_t erase_num;                          /**< the sectors erased since initialized */
+#endif
 
     void *user_data;
 };
@@ -310,6 +526,37 @@ struct fdb_kvdb {
     struct kvdb_sec_info sector_cache_table[FDB_SECTOR_CACHE_TABLE_SIZE];
 #endif /* FDB_KV_USING_CACHE */
 
+#ifdef FDB_KV_USING_INDEX
+    /* KV index table, open addressing by the name hash, it holds every KV which status is FDB_KV_WRITE */
+    struct kv_index_node kv_index_table[FDB_KV_INDEX_SIZE];
+    uint16_t kv_index_num;                       /**< used slots of KV index table */
+    bool kv_index_ok;                            /**< the index is complete, a KV is absent when not found in it */
+    bool kv_index_full;                          /**< too many KVs, the index is dropped until formatted */
+#endif /* FDB_KV_USING_INDEX */
+
+#ifdef FDB_USING_RW_LOCK
+    volatile uint32_t lookup_seq;                /**< KV cache and index sequence, it's odd while they are changing */
+#endif
+
+#ifdef FDB_KV_USING_GC_STEP
+    uint32_t gc_step_sec;                        /**< the sector is collecting by steps, FAILED_ADDR: none */
+    uint32_t gc_step_kv;                         /**< the next KV to move in the sector, FAILED_ADDR: erase it */
+    bool gc_step_on;                             /**< below the low watermark, until the high watermark is reached */
+#ifdef FDB_KV_USING_WEAR_LEVEL
+    bool gc_step_cold;                           /**< the last collected sector has cold KVs only */
+#endif
+#endif /* FDB_KV_USING_GC_STEP */
+
+#ifdef FDB_KV_USING_SNAPSHOT
+    const char *snap_name;                       /**< snapshot partition name, NULL: no snapshot */
+    const struct fal_partition *snap_part;       /**< snapshot partition, NULL: no snapshot */
+    uint32_t snap_slot_size;                     /**< a snapshot slot size, the partition is a ring of slots */
+    uint32_t snap_addr;                          /**< the valid snapshot slot address, 0xFFFFFFFF: none */
+    uint32_t snap_gen;                           /**< the valid snapshot generation */
+    /* the sectors written since the snapshot, they are marked on the snapshot before written */
+    uint8_t snap_touched[(FDB_KV_SNAPSHOT_SEC_NUM + 7) / 8];
+#endif /* FDB_KV_USING_SNAPSHOT */
+
 #ifdef FDB_KV_AUTO_UPDATE
     uint32_t ver_num;                            /**< setting version number for update */
 #endif
@@ -327,10 +574,56 @@ struct fdb_tsdb {
     size_t max_len;                              /**< the maximum length of each log */
     bool rollover;                               /**< the oldest data will rollover by newest data, default is true */
 
+#ifdef FDB_TSDB_USING_SEC_INDEX
+    /* sector index table, the node of a sector is at its address / sector size */
+    struct tsdb_sec_index_node sec_index_table[FDB_TSDB_SEC_INDEX_NUM];
+    bool sec_index_ok;                           /**< all sectors are indexed */
+#endif /* FDB_TSDB_USING_SEC_INDEX */
+
+#ifdef FDB_TSDB_USING_SUMMARY
+    fdb_tsl_value_type_t value_type;             /**< the TSL value type, default is FDB_TSL_VALUE_NONE */
+    bool summary_ok;                             /**< all sector summaries are up to date */
+#endif
+
+#ifdef FDB_TSDB_USING_READ_AHEAD
+    uint32_t ra_buf[FDB_TSDB_READ_AHEAD_SIZE / 4]; /**< TSL index read-ahead buffer */
+    uint32_t ra_addr;                            /**< the buffer data address, FDB_DATA_UNUSED: empty */
+    uint32_t ra_len;                             /**< the buffer data length */
+#endif /* FDB_TSDB_USING_READ_AHEAD */
+
+#ifdef FDB_TSDB_USING_APPEND_BUF
+    /* the staged TSL indexes, a page and the index over the page end */
+    uint32_t ab_idx[(FDB_TSDB_APPEND_BUF_SIZE + 32) / 4];
+    uint32_t ab_data[FDB_TSDB_APPEND_BUF_SIZE / 4]; /**< the staged TSL data page */
+    uint32_t ab_idx_addr;                        /**< the first staged index address */
+    uint32_t ab_idx_len;                         /**< the staged indexes length, 0: none */
+    uint32_t ab_data_addr;                       /**< the lowest staged data address */
+    uint32_t ab_data_len;                        /**< the staged data length, 0: none */
+    fdb_time_t ab_time;                          /**< the first staged TSL timestamp */
+    fdb_time_t flush_deadline;                   /**< the staged TSLs are flushed after it, 0: when the page is full */
+#endif /* FDB_TSDB_USING_APPEND_BUF */
+
     void *user_data;
 };
 typedef struct fdb_tsdb *fdb_tsdb_t;
 
+#ifdef FDB_TSDB_USING_SERIES
+/* compressed numeric series, the samples are encoded by timestamp delta of delta and value XOR */
+struct fdb_series {
+    fdb_tsdb_t db;                               /**< the TSDB which saves the blocks */
+    fdb_time_t last_time;                        /**< the last sample's timestamp */
+    int32_t last_delta;                          /**< the last timestamp delta */
+    uint32_t last_value;                         /**< the last sample's value bits */
+    uint8_t leading;                             /**< leading zeros of the last XOR value, UINT8_MAX: none */
+    uint8_t trailing;                            /**< trailing zeros of the last XOR value */
+    uint16_t count;                              /**< sample count in the block */
+    uint32_t bit_pos;                            /**< the encoded bits after the block header */
+    uint32_t block[FDB_TSDB_SERIES_BLOCK_SIZE / 4]; /**< the block which is encoding */
+};
+typedef struct fdb_series *fdb_series_t;
+typedef bool (*fdb_series_cb)(fdb_time_t time, float value, void *arg);
+#endif /* FDB_TSDB_USING_SERIES */
+
 /* blob structure */
 struct fdb_blob {
     void *buf;                                   /**< blob data buffer */
@@ -65,5 +65,14 @@ size_t _fdb_read_status(fdb_db_t db, uint32_t addr, uint8_t status_table[], size
 fdb_err_t _fdb_flash_read(fdb_db_t db, uint32_t addr, void *buf, size_t size);
 fdb_err_t _fdb_flash_erase(fdb_db_t db, uint32_t addr, size_t size);
 fdb_err_t _fdb_flash_write(fdb_db_t db, uint32_t addr, const void *buf, size_t size, bool sync);
+#if defined(FDB_USING_KVDB) && defined(FDB_KV_USING_SNAPSHOT)
+void _fdb_kv_snapshot_touch(fdb_kvdb_t db, uint32_t addr, size_t size);
+#endif
+#ifdef FDB_USING_ERASE_COUNT
+uint32_t _fdb_next_erase_count(fdb_db_t db, bool hdr_ok, uint32_t count);
+#endif
+#ifdef FDB_USING_POWER_CUT_TEST
+size_t _fdb_power_cut_after(size_t num);
+#endif
 
 #endif /* _FDB_LOW_LVL_H_ */
@@ -40,6 +40,10 @@ fdb_err_t fdb_tsdb_init   (fdb_tsdb_t db, const char *name, const char *path, fd
         void *user_data);
 void      fdb_tsdb_control(fdb_tsdb_t db, int cmd, void *arg);
 fdb_err_t fdb_tsdb_deinit(fdb_tsdb_t db);
+#ifdef FDB_USING_ERASE_COUNT
+fdb_err_t fdb_kvdb_erase_stat(fdb_kvdb_t db, fdb_erase_stat_t stat);
+fdb_err_t fdb_tsdb_erase_stat(fdb_tsdb_t db, fdb_erase_stat_t stat);
+#endif
 
 /* blob API */
 fdb_blob_t fdb_blob_make     (fdb_blob_t blob, const void *value_buf, size_t buf_len);
@@ -57,10 +61,19 @@ fdb_err_t         fdb_kv_set_default  (fdb_kvdb_t db);
 void              fdb_kv_print        (fdb_kvdb_t db);
 fdb_kv_iterator_t fdb_kv_iterator_init(fdb_kvdb_t db, fdb_kv_iterator_t itr);
 bool              fdb_kv_iterate      (fdb_kvdb_t db, fdb_kv_iterator_t itr);
+fdb_kv_batch_t    fdb_kv_batch_begin  (fdb_kvdb_t db, fdb_kv_batch_t batch, fdb_kv_batch_node_t nodes, size_t max_num);
+fdb_err_t         fdb_kv_batch_set    (fdb_kv_batch_t batch, const char *key, const char *value);
+fdb_err_t         fdb_kv_batch_set_blob(fdb_kv_batch_t batch, const char *key, fdb_blob_t blob);
+fdb_err_t         fdb_kv_batch_del    (fdb_kv_batch_t batch, const char *key);
+fdb_err_t         fdb_kv_batch_commit (fdb_kv_batch_t batch);
+bool              fdb_kv_gc_step      (fdb_kvdb_t db);
+fdb_err_t         fdb_kv_snapshot     (fdb_kvdb_t db);
 
 /* Time series log API like a TSDB */
 fdb_err_t  fdb_tsl_append      (fdb_tsdb_t db, fdb_blob_t blob);
 fdb_err_t  fdb_tsl_append_with_ts(fdb_tsdb_t db, fdb_blob_t blob, fdb_time_t timestamp);
+fdb_err_t  fdb_tsl_flush       (fdb_tsdb_t db);
+fdb_err_t  fdb_tsl_flush_expired(fdb_tsdb_t db);
 void       fdb_tsl_iter        (fdb_tsdb_t db, fdb_tsl_cb cb, void *cb_arg);
 void       fdb_tsl_iter_reverse(fdb_tsdb_t db, fdb_tsl_cb cb, void *cb_arg);
 void       fdb_tsl_iter_by_time(fdb_tsdb_t db, fdb_time_t from, fdb_time_t to, fdb_tsl_cb cb, void *cb_arg);
@@ -68,9 +81,23 @@ size_t     fdb_tsl_query_count (fdb_tsdb_t db, fdb_time_t from, fdb_time_t to, f
 fdb_err_t  fdb_tsl_set_status  (fdb_tsdb_t db, fdb_tsl_t tsl, fdb_tsl_status_t status);
 void       fdb_tsl_clean       (fdb_tsdb_t db);
 fdb_blob_t fdb_tsl_to_blob     (fdb_tsl_t tsl, fdb_blob_t blob);
+#ifdef FDB_TSDB_USING_SUMMARY
+fdb_err_t  fdb_tsl_query_agg   (fdb_tsdb_t db, fdb_time_t from, fdb_time_t to, fdb_tsl_agg_t agg);
+#endif
+
+#ifdef FDB_TSDB_USING_SERIES
+/* compressed numeric series API on a TSDB */
+fdb_err_t fdb_series_init        (fdb_series_t series, fdb_tsdb_t db);
+fdb_err_t fdb_series_append      (fdb_series_t series, fdb_time_t time, float value);
+fdb_err_t fdb_series_flush       (fdb_series_t series);
+void      fdb_series_iter_by_time(fdb_series_t series, fdb_time_t from, fdb_time_t to, fdb_series_cb cb, void *cb_arg);
+#endif
 
 /* fdb_utils.c */
 uint32_t   fdb_calc_crc32(uint32_t crc, const void *buf, size_t size);
+#ifdef FDB_USING_ERASE_COUNT
+uint32_t   fdb_erase_lifetime(fdb_erase_stat_t stat, uint32_t seconds);
+#endif
 
 #ifdef __cplusplus
 }
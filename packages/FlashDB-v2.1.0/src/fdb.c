@@ -41,6 +41,10 @@ fdb_err_t _fdb_init_ex(fdb_db_t db, const char *name, const char *path, fdb_db_t
     db->name = name;
     db->type = type;
     db->user_data = user_data;
+#ifdef FDB_USING_ERASE_COUNT
+    db->erase_max = 0;
+    db->erase_num = 0;
+#endif
 
     if (db->file_mode) {
 #ifdef FDB_USING_FILE_MODE
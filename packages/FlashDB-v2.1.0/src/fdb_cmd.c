@@ -60,6 +60,31 @@ static void kvdb_cmd_bench(fdb_kvdb_t db)
             (end_tick - start_tick) / TEST_COUNT);
 }
 
+#ifdef FDB_USING_ERASE_COUNT
+static void kvdb_cmd_wear(fdb_kvdb_t db, rt_tick_t probe_tick)
+{
+    struct fdb_erase_stat stat;
+    uint32_t hours;
+
+    if (fdb_kvdb_erase_stat(db, &stat) != FDB_NO_ERR || stat.sec_num == 0)
+    {
+        rt_kprintf("get the erase counts failed!\n");
+        return;
+    }
+    rt_kprintf("%d sectors erased min %d, avg %d, max %d, total %d times, %d times since probed.\n", stat.sec_num,
+            stat.min, stat.total / stat.sec_num, stat.max, stat.total, stat.session);
+    hours = fdb_erase_lifetime(&stat, (rt_tick_get() - probe_tick) / RT_TICK_PER_SECOND);
+    if (hours == 0xFFFFFFFF)
+    {
+        rt_kprintf("No sector is erased since probed, the lifetime isn't projected.\n");
+    }
+    else
+    {
+        rt_kprintf("%d hours left at this rate until the sectors are erased %d times.\n", hours, FDB_ERASE_ENDURANCE);
+    }
+}
+#endif /* FDB_USING_ERASE_COUNT */
+
 static void kvdb(uint8_t argc, char **argv)
 {
 #define KVDB_CMD_PROBE_INDEX0           0
@@ -70,6 +95,7 @@ static void kvdb(uint8_t argc, char **argv)
 #define KVDB_CMD_RESET_INDEX            5
 #define KVDB_CMD_CLOSE_INDEX            6
 #define KVDB_CMD_BENCH_INDEX            7
+#define KVDB_CMD_WEAR_INDEX             8
     
     int result;
     size_t i = 0;
@@ -77,6 +103,9 @@ static void kvdb(uint8_t argc, char **argv)
     static struct fdb_kvdb static_kvdb = { 0 };
     static char dev_name[FDB_KV_NAME_MAX] = { 0 };
     static char part_name[FDB_KV_NAME_MAX] = { 0 };
+#ifdef FDB_USING_ERASE_COUNT
+    static rt_tick_t probe_tick = 0;
+#endif
 
     const char* help_info[] =
     {
@@ -88,6 +117,9 @@ static void kvdb(uint8_t argc, char **argv)
             [KVDB_CMD_RESET_INDEX]      = "kvdb reset                           - recovery all KV to default.",
             [KVDB_CMD_CLOSE_INDEX]      = "kvdb deinit                          - deinit the KVDB",
             [KVDB_CMD_BENCH_INDEX]      = "kvdb bench                           - benchmark test",
+#ifdef FDB_USING_ERASE_COUNT
+            [KVDB_CMD_WEAR_INDEX]       = "kvdb wear                            - show the sector erase counts and lifetime.",
+#endif
     };
 
     if (argc < 2)
@@ -176,6 +208,9 @@ static void kvdb(uint8_t argc, char **argv)
                 {
                     rt_kprintf("Probed a KVDB | %s | part_name: %s | sec_size: %d | max_size: %d |.\n", static_kvdb.parent.name, 
                         part_name, static_kvdb.parent.sec_size, static_kvdb.parent.max_size);
+#ifdef FDB_USING_ERASE_COUNT
+                    probe_tick = rt_tick_get();
+#endif
                 }
             }
             else
@@ -259,6 +294,12 @@ static void kvdb(uint8_t argc, char **argv)
             {
                 kvdb_cmd_bench(&static_kvdb);
             }
+#ifdef FDB_USING_ERASE_COUNT
+            else if (!rt_strcmp(operator, "wear"))
+            {
+                kvdb_cmd_wear(&static_kvdb, probe_tick);
+            }
+#endif
             else
             {
                 rt_kprintf("Usage:\n");
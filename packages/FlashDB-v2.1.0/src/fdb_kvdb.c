@@ -46,6 +46,11 @@
 #define FDB_GC_EMPTY_SEC_THRESHOLD                1
 #endif
 
+/* the empty sectors erased within this count of each other are opened in the ring order */
+#ifndef FDB_ERASE_COUNT_TOLERANCE
+#define FDB_ERASE_COUNT_TOLERANCE                 1
+#endif
+
 /* the string KV value buffer size for legacy fdb_get_kv(db, ) function */
 #ifndef FDB_STR_KV_VALUE_MAX_SIZE
 #define FDB_STR_KV_VALUE_MAX_SIZE                128
@@ -55,6 +60,12 @@
 #error "The KV cache table size must less than 0xFFFF"
 #endif
 
+#ifdef FDB_KV_USING_SNAPSHOT
+#if !defined(FDB_USING_FAL_MODE) || FDB_WRITE_GRAN != 1
+#error "The KV snapshot needs FDB_USING_FAL_MODE and the write granularity 1"
+#endif
+#endif /* FDB_KV_USING_SNAPSHOT */
+
 /* the sector is not combined value */
 #if (FDB_BYTE_ERASED  == 0xFF)
 #define SECTOR_NOT_COMBINED                      0xFFFFFFFF
@@ -79,23 +90,72 @@
 #define KV_LEN_OFFSET                            ((unsigned long)(&((struct kv_hdr_data *)0)->len))
 #define KV_NAME_LEN_OFFSET                       ((unsigned long)(&((struct kv_hdr_data *)0)->name_len))
 
+#ifdef FDB_KV_USING_SNAPSHOT
+/* magic word(`K`, `V`, `S`, `0`) */
+#define SNAP_MAGIC_WORD                          0x3053564B
+#define SNAP_HDR_DATA_SIZE                       (sizeof(struct kv_snap_hdr_data))
+#define SNAP_GEN_OFFSET                          ((unsigned long)(&((struct kv_snap_hdr_data *)0)->gen))
+#define SNAP_CRC_OFFSET                          ((unsigned long)(&((struct kv_snap_hdr_data *)0)->crc32))
+/* the touched sector bitmap is behind the snapshot header, a bit is cleared before the sector is written */
+#define SNAP_MAP_SIZE                            FDB_ALIGN((SECTOR_NUM + 7) / 8, 4)
+/* the snapshot payload: sector status, sector cache, KV cache and KV index */
+#define SNAP_SEC_STATUS_SIZE                     FDB_ALIGN(SECTOR_NUM, 4)
+#define SNAP_SEC_IS_TOUCHED(db, addr)            ((db)->snap_touched[(addr) / db_sec_size(db) / 8] & (1 << ((addr) / db_sec_size(db) % 8)))
+#endif /* FDB_KV_USING_SNAPSHOT */
+
 #define db_name(db)                              (((fdb_db_t)db)->name)
 #define db_init_ok(db)                           (((fdb_db_t)db)->init_ok)
 #define db_sec_size(db)                          (((fdb_db_t)db)->sec_size)
 #define db_max_size(db)                          (((fdb_db_t)db)->max_size)
 #define db_oldest_addr(db)                       (((fdb_db_t)db)->oldest_addr)
 
+#ifdef FDB_USING_RW_LOCK
+#define db_lock(db)                                                            \
+    do {                                                                       \
+        if (((fdb_db_t)db)->lock) ((fdb_db_t)db)->lock((fdb_db_t)db);          \
+        ((fdb_db_t)db)->rd_locked = false;                                     \
+    } while(0);
+
+/* the readers share the database when the read lock is set, the file mode has a shared file cache so it's locked */
+#define db_rdlock(db)                                                          \
+    do {                                                                       \
+        if (((fdb_db_t)db)->rdlock && !((fdb_db_t)db)->file_mode) {            \
+            ((fdb_db_t)db)->rdlock((fdb_db_t)db);                              \
+            ((fdb_db_t)db)->rd_locked = true;                                  \
+        } else {                                                               \
+            db_lock(db);                                                       \
+        }                                                                      \
+    } while(0);
+
+#define db_rdunlock(db)                                                        \
+    do {                                                                       \
+        if (((fdb_db_t)db)->rdlock && !((fdb_db_t)db)->file_mode) {            \
+            ((fdb_db_t)db)->rdunlock((fdb_db_t)db);                            \
+        } else {                                                               \
+            db_unlock(db);                                                     \
+        }                                                                      \
+    } while(0);
+
+#define db_rd_locked(db)                         (((fdb_db_t)db)->rd_locked)
+#else
 #define db_lock(db)                                                            \
     do {                                                                       \
         if (((fdb_db_t)db)->lock) ((fdb_db_t)db)->lock((fdb_db_t)db);          \
     } while(0);
 
+#define db_rdlock(db)                            db_lock(db)
+#define db_rdunlock(db)                          db_unlock(db)
+#define db_rd_locked(db)                         false
+#endif /* FDB_USING_RW_LOCK */
+
 #define db_unlock(db)                                                          \
     do {                                                                       \
         if (((fdb_db_t)db)->unlock) ((fdb_db_t)db)->unlock((fdb_db_t)db);      \
     } while(0);
 
 #define VER_NUM_KV_NAME                         "__ver_num__"
+/* the commit KV of batch, its value is the new and old address of every KV in batch */
+#define BATCH_KV_NAME                           "__kv_batch__"
 
 struct sector_hdr_data {
     struct {
@@ -127,12 +187,34 @@ struct kv_hdr_data {
 };
 typedef struct kv_hdr_data *kv_hdr_data_t;
 
+#ifdef FDB_KV_USING_SNAPSHOT
+struct kv_snap_hdr_data {
+    uint32_t magic;                              /**< magic word(`K`, `V`, `S`, `0`), it's written last */
+    uint32_t gen;                                /**< generation, the newest valid snapshot is loaded */
+    uint32_t sec_size;                           /**< KVDB sector size */
+    uint32_t max_size;                           /**< KVDB max size */
+    uint32_t oldest_addr;                        /**< the oldest sector start address */
+    uint16_t kv_cache_size;                      /**< KV cache table size, 0: no cache */
+    uint16_t sec_cache_size;                     /**< sector cache table size, 0: no cache */
+    uint16_t kv_index_size;                      /**< KV index table size, 0: no index */
+    uint16_t kv_index_num;                       /**< used slots of KV index table */
+    uint32_t kv_index_full;                      /**< the index is dropped */
+    uint32_t len;                                /**< payload length */
+    uint32_t crc32;                              /**< snapshot crc32(header from gen to len + payload) */
+};
+#endif /* FDB_KV_USING_SNAPSHOT */
+
 struct alloc_kv_cb_args {
     fdb_kvdb_t db;
     size_t kv_size;
     uint32_t *empty_kv;
 };
 
+struct recovery_kv_cb_args {
+    uint32_t batch_addr;                         /**< the committed batch KV address, FAILED_ADDR: not found */
+    bool pre_write_found;                        /**< found the KV which status is FDB_KV_PRE_WRITE */
+};
+
 struct gc_cb_args {
     fdb_kvdb_t db;
     size_t cur_free_size;
@@ -142,6 +224,28 @@ struct gc_cb_args {
 
 static void gc_collect(fdb_kvdb_t db);
 static void gc_collect_by_free_size(fdb_kvdb_t db, size_t free_size);
+static fdb_err_t read_kv(fdb_kvdb_t db, fdb_kv_t kv);
+
+#ifdef FDB_USING_RW_LOCK
+/*
+ * The KV cache and index are changed by the writer only, the sequence is odd while they are changing. A lock-free
+ * reader retries on the read lock when the sequence is odd or changed after it read them.
+ */
+static void lookup_write_begin(fdb_kvdb_t db)
+{
+    db->lookup_seq++;
+    FDB_MEM_BARRIER();
+}
+
+static void lookup_write_end(fdb_kvdb_t db)
+{
+    FDB_MEM_BARRIER();
+    db->lookup_seq++;
+}
+#else
+#define lookup_write_begin(db)
+#define lookup_write_end(db)
+#endif /* FDB_USING_RW_LOCK */
 
 #ifdef FDB_KV_USING_CACHE
 static void update_sector_cache(fdb_kvdb_t db, kv_sec_info_t sector)
@@ -205,12 +309,13 @@ static void update_kv_cache(fdb_kvdb_t db, const char *name, size_t name_len, ui
     size_t i, empty_index = FDB_KV_CACHE_TABLE_SIZE, min_activity_index = FDB_KV_CACHE_TABLE_SIZE;
     uint16_t name_crc = (uint16_t) (fdb_calc_crc32(0, name, name_len) >> 16), min_activity = 0xFFFF;
 
+    lookup_write_begin(db);
     for (i = 0; i < FDB_KV_CACHE_TABLE_SIZE; i++) {
         if (addr != FDB_DATA_UNUSED) {
             /* update the KV address in cache */
             if (db->kv_cache_table[i].name_crc == name_crc) {
                 db->kv_cache_table[i].addr = addr;
-                return;
+                goto __exit;
             } else if ((db->kv_cache_table[i].addr == FDB_DATA_UNUSED) && (empty_index == FDB_KV_CACHE_TABLE_SIZE)) {
                 empty_index = i;
             } else if (db->kv_cache_table[i].addr != FDB_DATA_UNUSED) {
@@ -226,7 +331,7 @@ static void update_kv_cache(fdb_kvdb_t db, const char *name, size_t name_len, ui
             /* delete the KV */
             db->kv_cache_table[i].addr = FDB_DATA_UNUSED;
             db->kv_cache_table[i].active = 0;
-            return;
+            goto __exit;
         }
     }
     /* add the KV to cache, using LRU (Least Recently Used) like algorithm */
@@ -239,6 +344,9 @@ static void update_kv_cache(fdb_kvdb_t db, const char *name, size_t name_len, ui
         db->kv_cache_table[min_activity_index].name_crc = name_crc;
         db->kv_cache_table[min_activity_index].active = FDB_KV_CACHE_TABLE_SIZE;
     }
+
+__exit:
+    lookup_write_end(db);
 }
 
 /*
@@ -256,7 +364,9 @@ static bool get_kv_from_cache(fdb_kvdb_t db, const char *name, size_t name_len,
             _fdb_flash_read((fdb_db_t)db, db->kv_cache_table[i].addr + KV_HDR_DATA_SIZE, (uint32_t *) saved_name, FDB_KV_NAME_MAX);
             if (!strncmp(name, saved_name, name_len)) {
                 *addr = db->kv_cache_table[i].addr;
-                if (db->kv_cache_table[i].active >= 0xFFFF - FDB_KV_CACHE_TABLE_SIZE) {
+                if (db_rd_locked(db)) {
+                    /* the shared readers don't change the cache */
+                } else if (db->kv_cache_table[i].active >= 0xFFFF - FDB_KV_CACHE_TABLE_SIZE) {
                     db->kv_cache_table[i].active = 0xFFFF;
                 } else {
                     db->kv_cache_table[i].active += FDB_KV_CACHE_TABLE_SIZE;
@@ -268,8 +378,198 @@ static bool get_kv_from_cache(fdb_kvdb_t db, const char *name, size_t name_len,
 
     return false;
 }
+
+static void reset_kv_cache(fdb_kvdb_t db)
+{
+    size_t i;
+
+    for (i = 0; i < FDB_SECTOR_CACHE_TABLE_SIZE; i++) {
+        db->sector_cache_table[i].check_ok = false;
+        db->sector_cache_table[i].empty_kv = FAILED_ADDR;
+        db->sector_cache_table[i].addr = FDB_DATA_UNUSED;
+    }
+    lookup_write_begin(db);
+    for (i = 0; i < FDB_KV_CACHE_TABLE_SIZE; i++) {
+        db->kv_cache_table[i].addr = FDB_DATA_UNUSED;
+    }
+    lookup_write_end(db);
+}
 #endif /* FDB_KV_USING_CACHE */
 
+#ifdef FDB_KV_USING_INDEX
+#define KV_INDEX_MASK                            (FDB_KV_INDEX_SIZE - 1)
+/* linear probing is kept short by leaving 1/4 of the slots empty */
+#define KV_INDEX_MAX_NUM                         (FDB_KV_INDEX_SIZE - FDB_KV_INDEX_SIZE / 4)
+
+/*
+ * FNV-1a 32bit hash
+ */
+static uint32_t calc_kv_index_hash(const char *name, size_t name_len)
+{
+    uint32_t hash = 2166136261UL;
+
+    while (name_len--) {
+        hash ^= (uint8_t) *name++;
+        hash *= 16777619UL;
+    }
+
+    return hash;
+}
+
+static bool kv_index_name_is_equal(fdb_kvdb_t db, kv_index_node_t node, const char *name, size_t name_len)
+{
+    char saved_name[FDB_WG_ALIGN(FDB_KV_NAME_MAX)];
+
+    /* the name is behind aligned KV header */
+    _fdb_flash_read((fdb_db_t)db, node->addr + KV_HDR_DATA_SIZE, (uint32_t *) saved_name, FDB_WG_ALIGN(name_len));
+
+    return !strncmp(name, saved_name, name_len);
+}
+
+static void reset_kv_index(fdb_kvdb_t db)
+{
+    size_t i;
+
+    lookup_write_begin(db);
+    for (i = 0; i < FDB_KV_INDEX_SIZE; i++) {
+        db->kv_index_table[i].addr = FDB_DATA_UNUSED;
+    }
+    db->kv_index_num = 0;
+    db->kv_index_full = false;
+    lookup_write_end(db);
+}
+
+/*
+ * Add the KV to index or update its address. The index is dropped when it's full.
+ */
+static void update_kv_index(fdb_kvdb_t db, const char *name, size_t name_len, size_t value_len, uint32_t addr)
+{
+    uint32_t hash, i;
+    kv_index_node_t node;
+
+    if (db->kv_index_full) {
+        return;
+    }
+
+    hash = calc_kv_index_hash(name, name_len);
+    lookup_write_begin(db);
+    for (i = hash & KV_INDEX_MASK; (node = &db->kv_index_table[i])->addr != FDB_DATA_UNUSED; i = (i + 1) & KV_INDEX_MASK) {
+        /* the old KV is still on flash when it's updated or moved */
+        if (node->hash == hash && node->name_len == name_len && kv_index_name_is_equal(db, node, name, name_len)) {
+            break;
+        }
+    }
+
+    if (node->addr == FDB_DATA_UNUSED) {
+        if (db->kv_index_num >= KV_INDEX_MAX_NUM) {
+            FDB_INFO("Warning: The KV index is full (%d KVs). Now will search the KV on flash.\n", KV_INDEX_MAX_NUM);
+            db->kv_index_full = true;
+            db->kv_index_ok = false;
+            goto __exit;
+        }
+        db->kv_index_num++;
+        node->hash = hash;
+        node->name_len = name_len;
+    }
+    node->addr = addr;
+    if (value_len > UINT16_MAX) {
+        /* the long KV will be read on flash when it's found */
+        node->value_len = UINT16_MAX;
+        node->long_value = true;
+    } else {
+        node->value_len = value_len;
+        node->long_value = false;
+    }
+
+__exit:
+    lookup_write_end(db);
+}
+
+/*
+ * Remove the index node in the slot.
+ */
+static void del_kv_index_node(fdb_kvdb_t db, uint32_t i)
+{
+    uint32_t j, home;
+
+    lookup_write_begin(db);
+    /* shift the following nodes back to the hole, so no tombstone is left for searching */
+    for (j = (i + 1) & KV_INDEX_MASK; db->kv_index_table[j].addr != FDB_DATA_UNUSED; j = (j + 1) & KV_INDEX_MASK) {
+        home = db->kv_index_table[j].hash & KV_INDEX_MASK;
+        /* the node can be moved when the hole is between its home slot and it */
+        if (((j - home) & KV_INDEX_MASK) >= ((j - i) & KV_INDEX_MASK)) {
+            db->kv_index_table[i] = db->kv_index_table[j];
+            i = j;
+        }
+    }
+    db->kv_index_table[i].addr = FDB_DATA_UNUSED;
+    db->kv_index_num--;
+    lookup_write_end(db);
+}
+
+/*
+ * Remove the KV from index, only when it's still indexed at this address.
+ */
+static void del_kv_index(fdb_kvdb_t db, const char *name, size_t name_len, uint32_t addr)
+{
+    uint32_t i;
+
+    if (db->kv_index_full) {
+        return;
+    }
+
+    for (i = calc_kv_index_hash(name, name_len) & KV_INDEX_MASK; db->kv_index_table[i].addr != addr;
+            i = (i + 1) & KV_INDEX_MASK) {
+        if (db->kv_index_table[i].addr == FDB_DATA_UNUSED) {
+            return;
+        }
+    }
+    del_kv_index_node(db, i);
+}
+
+/*
+ * Get KV info from index. The name of each node with same hash and length is compared on flash, so a hash collision
+ * never returns another KV. The KV info is made by the index node, the KV header is read only for a long value.
+ * It's return true when the KV is found.
+ */
+static bool get_kv_from_index(fdb_kvdb_t db, const char *name, fdb_kv_t kv)
+{
+    size_t name_len = strlen(name);
+    uint32_t hash, i;
+    kv_index_node_t node;
+
+    if (name_len > FDB_KV_NAME_MAX) {
+        return false;
+    }
+
+    hash = calc_kv_index_hash(name, name_len);
+    for (i = hash & KV_INDEX_MASK; (node = &db->kv_index_table[i])->addr != FDB_DATA_UNUSED; i = (i + 1) & KV_INDEX_MASK) {
+        if (node->hash != hash || node->name_len != name_len || !kv_index_name_is_equal(db, node, name, name_len)) {
+            continue;
+        }
+        kv->addr.start = node->addr;
+        if (node->long_value) {
+            read_kv(db, kv);
+        } else {
+            kv->status = FDB_KV_WRITE;
+            kv->crc_is_ok = true;
+            kv->name_len = name_len;
+            kv->value_len = node->value_len;
+            kv->len = KV_HDR_DATA_SIZE + FDB_WG_ALIGN(name_len) + FDB_WG_ALIGN(node->value_len);
+            kv->addr.value = node->addr + KV_HDR_DATA_SIZE + FDB_WG_ALIGN(name_len);
+            if (name_len >= sizeof(kv->name) / sizeof(kv->name[0])) {
+                name_len = sizeof(kv->name) / sizeof(kv->name[0]) - 1;
+            }
+            memcpy(kv->name, name, name_len);
+            kv->name[name_len] = '\0';
+        }
+        return true;
+    }
+
+    return false;
+}
+#endif /* FDB_KV_USING_INDEX */
+
 /*
  * find the next KV address by magic word on the flash
  */
@@ -358,8 +658,11 @@ static fdb_err_t read_kv(fdb_kvdb_t db, fdb_kv_t kv)
         kv->len = KV_HDR_DATA_SIZE;
         if (kv->status != FDB_KV_ERR_HDR) {
             kv->status = FDB_KV_ERR_HDR;
-            FDB_INFO("Error: The KV @0x%08" PRIX32 " length has an error.\n", kv->addr.start);
-            _fdb_write_status((fdb_db_t)db, kv->addr.start, kv_hdr.status_table, FDB_KV_STATUS_NUM, FDB_KV_ERR_HDR, true);
+            /* the shared readers leave it to the writer */
+            if (!db_rd_locked(db)) {
+                FDB_INFO("Error: The KV @0x%08" PRIX32 " length has an error.\n", kv->addr.start);
+                _fdb_write_status((fdb_db_t)db, kv->addr.start, kv_hdr.status_table, FDB_KV_STATUS_NUM, FDB_KV_ERR_HDR, true);
+            }
         }
         kv->crc_is_ok = false;
         return FDB_READ_ERR;
@@ -442,6 +745,12 @@ static fdb_err_t read_sector_info(fdb_kvdb_t db, uint32_t addr, kv_sec_info_t se
     sector->check_ok = true;
     /* get other sector info */
     sector->combined = sec_hdr.combined;
+#ifdef FDB_USING_ERASE_COUNT
+    sector->erase_count = sec_hdr.reserved == FDB_DATA_UNUSED ? 0 : sec_hdr.reserved;
+    if (sector->erase_count > db->parent.erase_max && !db_rd_locked(db)) {
+        db->parent.erase_max = sector->erase_count;
+    }
+#endif
     sector->status.store = (fdb_sector_store_status_t) _fdb_get_status(sec_hdr.status_table.store, FDB_SECTOR_STORE_STATUS_NUM);
     sector->status.dirty = (fdb_sector_dirty_status_t) _fdb_get_status(sec_hdr.status_table.dirty, FDB_SECTOR_DIRTY_STATUS_NUM);
     /* traversal all KV and calculate the remain space size */
@@ -483,13 +792,17 @@ static fdb_err_t read_sector_info(fdb_kvdb_t db, uint32_t addr, kv_sec_info_t se
 
         }
 #ifdef FDB_KV_USING_CACHE
-        update_sector_cache(db, sector);
+        if (!db_rd_locked(db)) {
+            update_sector_cache(db, sector);
+        }
     } else {
         kv_sec_info_t sec_cache = get_sector_from_cache(db, sector->addr);
         if (!sec_cache) {
             sector->empty_kv = FAILED_ADDR;
             sector->remain = 0;
-            update_sector_cache(db, sector);
+            if (!db_rd_locked(db)) {
+                update_sector_cache(db, sector);
+            }
         }
 #endif
     }
@@ -521,8 +834,11 @@ static uint32_t get_next_sector_addr(fdb_kvdb_t db, kv_sec_info_t pre_sec, uint3
     }
 }
 
-static void kv_iterator(fdb_kvdb_t db, fdb_kv_t kv, void *arg1, void *arg2,
-        bool (*callback)(fdb_kv_t kv, void *arg1, void *arg2))
+/*
+ * Iterate the KVs, only in the sectors which are written since the snapshot when touched_only is true.
+ */
+static void kv_iterator_ex(fdb_kvdb_t db, fdb_kv_t kv, void *arg1, void *arg2,
+        bool (*callback)(fdb_kv_t kv, void *arg1, void *arg2), bool touched_only)
 {
     struct kvdb_sec_info sector;
     uint32_t sec_addr, traversed_len = 0;
@@ -537,6 +853,13 @@ static void kv_iterator(fdb_kvdb_t db, fdb_kv_t kv, void *arg1, void *arg2,
         if (callback == NULL) {
             continue;
         }
+#ifdef FDB_KV_USING_SNAPSHOT
+        if (touched_only && !SNAP_SEC_IS_TOUCHED(db, sec_addr)) {
+            continue;
+        }
+#else
+        (void) touched_only;
+#endif /* FDB_KV_USING_SNAPSHOT */
         /* sector has KV */
         if (sector.status.store == FDB_SECTOR_STORE_USING || sector.status.store == FDB_SECTOR_STORE_FULL) {
             kv->addr.start = sector.addr + SECTOR_HDR_DATA_SIZE;
@@ -552,6 +875,12 @@ static void kv_iterator(fdb_kvdb_t db, fdb_kv_t kv, void *arg1, void *arg2,
     } while ((sec_addr = get_next_sector_addr(db, &sector, traversed_len)) != FAILED_ADDR);
 }
 
+static void kv_iterator(fdb_kvdb_t db, fdb_kv_t kv, void *arg1, void *arg2,
+        bool (*callback)(fdb_kv_t kv, void *arg1, void *arg2))
+{
+    kv_iterator_ex(db, kv, arg1, arg2, callback, false);
+}
+
 static bool find_kv_cb(fdb_kv_t kv, void *arg1, void *arg2)
 {
     const char *key = arg1;
@@ -582,6 +911,12 @@ static bool find_kv(fdb_kvdb_t db, const char *key, fdb_kv_t kv)
 {
     bool find_ok = false;
 
+#ifdef FDB_KV_USING_INDEX
+    if (db->kv_index_ok) {
+        return get_kv_from_index(db, key, kv);
+    }
+#endif /* FDB_KV_USING_INDEX */
+
 #ifdef FDB_KV_USING_CACHE
     size_t key_len = strlen(key);
 
@@ -594,7 +929,7 @@ static bool find_kv(fdb_kvdb_t db, const char *key, fdb_kv_t kv)
     find_ok = find_kv_no_cache(db, key, kv);
 
 #ifdef FDB_KV_USING_CACHE
-    if (find_ok) {
+    if (find_ok && !db_rd_locked(db)) {
         update_kv_cache(db, key, key_len, kv->addr.start);
     }
 #endif /* FDB_KV_USING_CACHE */
@@ -639,6 +974,122 @@ static size_t get_kv(fdb_kvdb_t db, const char *key, void *value_buf, size_t buf
     return read_len;
 }
 
+#ifdef FDB_USING_RW_LOCK
+/*
+ * Look up the KV in the KV index or cache without lock. It's return false when the KV should be searched on the
+ * lock, the value address is FAILED_ADDR when the KV is absent.
+ */
+static bool lookup_kv_lockless(fdb_kvdb_t db, const char *key, size_t key_len, uint32_t *value_addr,
+        size_t *value_len)
+{
+    size_t i;
+
+    *value_addr = FAILED_ADDR;
+
+#ifdef FDB_KV_USING_INDEX
+    if (db->kv_index_ok) {
+        uint32_t hash = calc_kv_index_hash(key, key_len), slot = hash & KV_INDEX_MASK;
+        char saved_name[FDB_WG_ALIGN(FDB_KV_NAME_MAX)];
+        kv_index_node_t node;
+
+        /* the probing is bounded, the table may be changing */
+        for (i = 0; i < FDB_KV_INDEX_SIZE && (node = &db->kv_index_table[slot])->addr != FDB_DATA_UNUSED;
+                i++, slot = (slot + 1) & KV_INDEX_MASK) {
+            if (node->hash == hash && node->name_len == key_len) {
+                if (node->long_value) {
+                    /* the length is read on flash by the locked search */
+                    return false;
+                }
+                /* the name read is checked by the lookup sequence as the value */
+                if (_fdb_flash_read((fdb_db_t)db, node->addr + KV_HDR_DATA_SIZE, (uint32_t *) saved_name,
+                        FDB_WG_ALIGN(key_len)) != FDB_NO_ERR) {
+                    return false;
+                }
+                if (memcmp(key, saved_name, key_len)) {
+                    continue;
+                }
+                *value_addr = node->addr + KV_HDR_DATA_SIZE + FDB_WG_ALIGN(key_len);
+                *value_len = node->value_len;
+                break;
+            }
+        }
+        return true;
+    }
+#endif /* FDB_KV_USING_INDEX */
+
+#ifdef FDB_KV_USING_CACHE
+    {
+        uint16_t name_crc = (uint16_t) (fdb_calc_crc32(0, key, key_len) >> 16);
+        char saved_name[FDB_WG_ALIGN(FDB_KV_NAME_MAX)];
+        struct kv_hdr_data kv_hdr;
+        uint32_t addr;
+
+        for (i = 0; i < FDB_KV_CACHE_TABLE_SIZE; i++) {
+            addr = db->kv_cache_table[i].addr;
+            if (addr == FDB_DATA_UNUSED || db->kv_cache_table[i].name_crc != name_crc) {
+                continue;
+            }
+            /* the header is checked instead of the CRC32, read_kv() may change the KV status */
+            if (_fdb_flash_read((fdb_db_t)db, addr, (uint32_t *)&kv_hdr, sizeof(struct kv_hdr_data)) != FDB_NO_ERR
+                    || _fdb_get_status(kv_hdr.status_table, FDB_KV_STATUS_NUM) != FDB_KV_WRITE
+                    || kv_hdr.magic != KV_MAGIC_WORD || kv_hdr.name_len != key_len
+                    || kv_hdr.len != KV_HDR_DATA_SIZE + FDB_WG_ALIGN(key_len) + FDB_WG_ALIGN(kv_hdr.value_len)) {
+                continue;
+            }
+            _fdb_flash_read((fdb_db_t)db, addr + KV_HDR_DATA_SIZE, (uint32_t *) saved_name, FDB_WG_ALIGN(key_len));
+            if (!memcmp(key, saved_name, key_len)) {
+                *value_addr = addr + KV_HDR_DATA_SIZE + FDB_WG_ALIGN(key_len);
+                *value_len = kv_hdr.value_len;
+                return true;
+            }
+        }
+    }
+#endif /* FDB_KV_USING_CACHE */
+
+    /* search it on flash */
+    return false;
+}
+
+/*
+ * Get the KV value without lock. The KV found in the cache or index is not moved or erased until the lookup sequence
+ * is changed, so the value is trusted when the sequence is same after it's read.
+ */
+static bool get_kv_lockless(fdb_kvdb_t db, const char *key, void *value_buf, size_t buf_len, size_t *value_len,
+        size_t *read_len)
+{
+    uint32_t seq = db->lookup_seq, value_addr;
+    size_t key_len = strlen(key), len = 0;
+
+    if (db->parent.file_mode || (seq & 1) || key_len > FDB_KV_NAME_MAX) {
+        return false;
+    }
+    FDB_MEM_BARRIER();
+
+    if (!lookup_kv_lockless(db, key, key_len, &value_addr, &len)) {
+        return false;
+    }
+    if (value_addr == FAILED_ADDR) {
+        len = 0;
+        *read_len = 0;
+    } else {
+        *read_len = buf_len > len ? len : buf_len;
+        if (value_buf && _fdb_flash_read((fdb_db_t)db, value_addr, (uint32_t *) value_buf, *read_len) != FDB_NO_ERR) {
+            return false;
+        }
+    }
+
+    FDB_MEM_BARRIER();
+    if (db->lookup_seq != seq) {
+        return false;
+    }
+    if (value_len) {
+        *value_len = len;
+    }
+
+    return true;
+}
+#endif /* FDB_USING_RW_LOCK */
+
 /**
  * Get a KV object by key name
  *
@@ -658,12 +1109,12 @@ fdb_kv_t fdb_kv_get_obj(fdb_kvdb_t db, const char *key, fdb_kv_t kv)
     }
 
     /* lock the KV cache */
-    db_lock(db);
+    db_rdlock(db);
 
     find_ok = find_kv(db, key, kv);
 
     /* unlock the KV cache */
-    db_unlock(db);
+    db_rdunlock(db);
 
     return find_ok ? kv : NULL;
 }
@@ -703,13 +1154,20 @@ size_t fdb_kv_get_blob(fdb_kvdb_t db, const char *key, fdb_blob_t blob)
         return 0;
     }
 
+#ifdef FDB_USING_RW_LOCK
+    /* the KV in cache or index is read without lock */
+    if (get_kv_lockless(db, key, blob->buf, blob->size, &blob->saved.len, &read_len)) {
+        return read_len;
+    }
+#endif
+
     /* lock the KV cache */
-    db_lock(db);
+    db_rdlock(db);
 
     read_len = get_kv(db, key, blob->buf, blob->size, &blob->saved.len);
 
     /* unlock the KV cache */
-    db_unlock(db);
+    db_rdunlock(db);
 
     return read_len;
 }
@@ -766,9 +1224,18 @@ static fdb_err_t format_sector(fdb_kvdb_t db, uint32_t addr, uint32_t combined_v
 {
     fdb_err_t result = FDB_NO_ERR;
     struct sector_hdr_data sec_hdr = { 0 };
+#ifdef FDB_USING_ERASE_COUNT
+    uint32_t erase_count;
+#endif
 
     FDB_ASSERT(addr % db_sec_size(db) == 0);
 
+#ifdef FDB_USING_ERASE_COUNT
+    /* the erase count is carried over from the old header */
+    _fdb_flash_read((fdb_db_t)db, addr, (uint32_t *)&sec_hdr, sizeof(struct sector_hdr_data));
+    erase_count = _fdb_next_erase_count((fdb_db_t)db, sec_hdr.magic == SECTOR_MAGIC_WORD, sec_hdr.reserved);
+#endif
+
     result = _fdb_flash_erase((fdb_db_t)db, addr, db_sec_size(db));
     if (result == FDB_NO_ERR) {
         /* initialize the header data */
@@ -778,7 +1245,11 @@ static fdb_err_t format_sector(fdb_kvdb_t db, uint32_t addr, uint32_t combined_v
         _fdb_set_status(sec_hdr.status_table.dirty, FDB_SECTOR_DIRTY_STATUS_NUM, FDB_SECTOR_DIRTY_FALSE);
         sec_hdr.magic = SECTOR_MAGIC_WORD;
         sec_hdr.combined = combined_value;
+#ifdef FDB_USING_ERASE_COUNT
+        sec_hdr.reserved = erase_count;
+#else
         sec_hdr.reserved = FDB_DATA_UNUSED;
+#endif
         /* save the header */
         result = _fdb_flash_write((fdb_db_t)db, addr, (uint32_t *)&sec_hdr, SECTOR_HDR_DATA_SIZE, true);
 #else   // seperate the whole "sec_hdr" program to serval sinle program operation to prevent re-program issue on STM32L4xx or
@@ -802,7 +1273,11 @@ static fdb_err_t format_sector(fdb_kvdb_t db, uint32_t addr, uint32_t combined_v
         /* write the magic word and combined next sector number */
         sec_hdr.magic = SECTOR_MAGIC_WORD;
         sec_hdr.combined = combined_value;
+#ifdef FDB_USING_ERASE_COUNT
+        sec_hdr.reserved = erase_count;
+#else
         sec_hdr.reserved = FDB_DATA_UNUSED;
+#endif
         result = _fdb_flash_write((fdb_db_t)db,
                                   addr + SECTOR_MAGIC_OFFSET,
                                   (void *)(&(sec_hdr.magic)),
@@ -908,6 +1383,26 @@ static bool alloc_kv_cb(kv_sec_info_t sector, void *arg1, void *arg2)
     return false;
 }
 
+#ifdef FDB_USING_ERASE_COUNT
+static bool alloc_least_worn_cb(kv_sec_info_t sector, void *arg1, void *arg2)
+{
+    kv_sec_info_t least = arg1, first = arg2;
+
+    if (!sector->check_ok) {
+        return false;
+    }
+    if (first->addr == FAILED_ADDR) {
+        memcpy(first, sector, sizeof(struct kvdb_sec_info));
+    }
+    /* the first one in the ring order when the counts are equal */
+    if (least->addr == FAILED_ADDR || sector->erase_count < least->erase_count) {
+        memcpy(least, sector, sizeof(struct kvdb_sec_info));
+    }
+
+    return false;
+}
+#endif /* FDB_USING_ERASE_COUNT */
+
 static uint32_t alloc_kv(fdb_kvdb_t db, kv_sec_info_t sector, size_t kv_size)
 {
     uint32_t empty_kv = FAILED_ADDR;
@@ -922,7 +1417,21 @@ static uint32_t alloc_kv(fdb_kvdb_t db, kv_sec_info_t sector, size_t kv_size)
     }
     if (empty_sector > 0 && empty_kv == FAILED_ADDR) {
         if (empty_sector > FDB_GC_EMPTY_SEC_THRESHOLD || db->gc_request) {
+#ifdef FDB_USING_ERASE_COUNT
+            /* start the least erased empty sector, or the next one in the ring order when it's erased about as often */
+            struct kvdb_sec_info least = { .addr = FAILED_ADDR }, first = { .addr = FAILED_ADDR };
+
+            sector_iterator(db, sector, FDB_SECTOR_STORE_EMPTY, &least, &first, alloc_least_worn_cb, false);
+            if (least.addr != FAILED_ADDR) {
+                if (least.erase_count + FDB_ERASE_COUNT_TOLERANCE >= first.erase_count) {
+                    least.addr = first.addr;
+                }
+                read_sector_info(db, least.addr, sector, true);
+                alloc_kv_cb(sector, &arg, NULL);
+            }
+#else
             sector_iterator(db, sector, FDB_SECTOR_STORE_EMPTY, &arg, NULL, alloc_kv_cb, true);
+#endif
         } else {
             /* no space for new KV now will GC and retry */
             FDB_DEBUG("Trigger a GC check after alloc KV failed.\n");
@@ -974,6 +1483,16 @@ static fdb_err_t del_kv(fdb_kvdb_t db, const char *key, fdb_kv_t old_kv, bool co
             }
 #endif /* FDB_KV_USING_CACHE */
         }
+#ifdef FDB_KV_USING_INDEX
+        if (result == FDB_NO_ERR) {
+            /* the index is already updated to the new KV when it's changed or moved */
+            if (key != NULL) {
+                del_kv_index(db, key, strlen(key), old_kv->addr.start);
+            } else {
+                del_kv_index(db, old_kv->name, old_kv->name_len, old_kv->addr.start);
+            }
+        }
+#endif /* FDB_KV_USING_INDEX */
 
         db->last_is_complete_del = false;
     }
@@ -1047,6 +1566,9 @@ static fdb_err_t move_kv(fdb_kvdb_t db, fdb_kv_t kv)
         }
         _fdb_write_status((fdb_db_t)db, kv_addr, status_table, FDB_KV_STATUS_NUM, FDB_KV_WRITE, true);
 
+#ifdef FDB_KV_USING_INDEX
+        update_kv_index(db, kv->name, kv->name_len, kv->value_len, kv_addr);
+#endif /* FDB_KV_USING_INDEX */
 #ifdef FDB_KV_USING_CACHE
         update_sector_empty_addr_cache(db, FDB_ALIGN_DOWN(kv_addr, db_sec_size(db)),
                 kv_addr + KV_HDR_DATA_SIZE + FDB_WG_ALIGN(kv->name_len) + FDB_WG_ALIGN(kv->value_len));
@@ -1164,26 +1686,209 @@ static void gc_collect(fdb_kvdb_t db)
     gc_collect_by_free_size(db, db_max_size(db));
 }
 
-static fdb_err_t align_write(fdb_kvdb_t db, uint32_t addr, const uint32_t *buf, size_t size)
+#ifdef FDB_KV_USING_GC_STEP
+#ifdef FDB_USING_ERASE_COUNT
+struct gc_step_find_args {
+    struct kvdb_sec_info dirty;                  /**< the least erased dirty sector */
+#ifdef FDB_KV_USING_WEAR_LEVEL
+    struct kvdb_sec_info cold;                   /**< the least erased sector without dirty KV, its KVs are cold */
+    uint32_t max_count;
+#endif
+};
+
+static bool gc_step_find_cb(kv_sec_info_t sector, void *arg1, void *arg2)
 {
-    fdb_err_t result = FDB_NO_ERR;
-    size_t align_remain;
+    struct gc_step_find_args *args = arg1;
 
-#if (FDB_WRITE_GRAN / 8 > 0)
-    uint8_t align_data[FDB_WRITE_GRAN / 8];
-    size_t align_data_size = sizeof(align_data);
-#else
-    /* For compatibility with C89 */
-    uint8_t align_data_u8, *align_data = &align_data_u8;
-    size_t align_data_size = 1;
+    if (!sector->check_ok) {
+        return false;
+    }
+    /* a sector which GC is interrupted by power off is collected first */
+    if (sector->status.dirty == FDB_SECTOR_DIRTY_GC) {
+        memcpy(&args->dirty, sector, sizeof(struct kvdb_sec_info));
+        return true;
+    } else if (sector->status.dirty == FDB_SECTOR_DIRTY_TRUE
+            && (args->dirty.addr == FAILED_ADDR || sector->erase_count < args->dirty.erase_count)) {
+        memcpy(&args->dirty, sector, sizeof(struct kvdb_sec_info));
+    }
+#ifdef FDB_KV_USING_WEAR_LEVEL
+    if (sector->erase_count > args->max_count) {
+        args->max_count = sector->erase_count;
+    }
+    if (sector->status.store != FDB_SECTOR_STORE_EMPTY && sector->status.dirty == FDB_SECTOR_DIRTY_FALSE
+            && (args->cold.addr == FAILED_ADDR || sector->erase_count < args->cold.erase_count)) {
+        memcpy(&args->cold, sector, sizeof(struct kvdb_sec_info));
+    }
 #endif
 
-    memset(align_data, FDB_BYTE_ERASED, align_data_size);
-    result = _fdb_flash_write((fdb_db_t) db, addr, buf, FDB_WG_ALIGN_DOWN(size), false);
+    return false;
+}
 
-    align_remain = size - FDB_WG_ALIGN_DOWN(size);
-    if (result == FDB_NO_ERR && align_remain) {
-        memcpy(align_data, (uint8_t *) buf + FDB_WG_ALIGN_DOWN(size), align_remain);
+/*
+ * Find the next sector for the GC by steps. The least erased dirty sector is collected. When the erase counts spread
+ * more than FDB_KV_WEAR_LEVEL_DELTA, every other sector is the least erased sector without dirty KV, its cold KVs are
+ * moved so the sector gets in the rotation again.
+ */
+static uint32_t gc_step_find(fdb_kvdb_t db)
+{
+    struct kvdb_sec_info sector;
+    struct gc_step_find_args args;
+
+    args.dirty.addr = FAILED_ADDR;
+#ifdef FDB_KV_USING_WEAR_LEVEL
+    args.cold.addr = FAILED_ADDR;
+    args.max_count = 0;
+#endif
+    sector_iterator(db, &sector, FDB_SECTOR_STORE_UNUSED, &args, NULL, gc_step_find_cb, false);
+#ifdef FDB_KV_USING_WEAR_LEVEL
+    if (args.dirty.addr == FAILED_ADDR || args.dirty.status.dirty != FDB_SECTOR_DIRTY_GC) {
+        if (!db->gc_step_cold && args.cold.addr != FAILED_ADDR
+                && args.max_count - args.cold.erase_count > FDB_KV_WEAR_LEVEL_DELTA) {
+            FDB_DEBUG("GC step moves the cold sector @0x%08" PRIX32 ", erased %" PRIu32 " of %" PRIu32 " times.\n",
+                    args.cold.addr, args.cold.erase_count, args.max_count);
+            db->gc_step_cold = true;
+            return args.cold.addr;
+        }
+        db->gc_step_cold = false;
+    }
+#endif
+
+    return args.dirty.addr;
+}
+#else
+static bool gc_step_find_cb(kv_sec_info_t sector, void *arg1, void *arg2)
+{
+    uint32_t *sec_addr = arg1;
+
+    /* the oldest dirty sector, a sector which GC is interrupted by power off is collected first */
+    if (sector->check_ok && sector->status.dirty == FDB_SECTOR_DIRTY_GC) {
+        *sec_addr = sector->addr;
+        return true;
+    } else if (sector->check_ok && sector->status.dirty == FDB_SECTOR_DIRTY_TRUE && *sec_addr == FAILED_ADDR) {
+        *sec_addr = sector->addr;
+    }
+
+    return false;
+}
+
+static uint32_t gc_step_find(fdb_kvdb_t db)
+{
+    struct kvdb_sec_info sector;
+    uint32_t sec_addr = FAILED_ADDR;
+
+    sector_iterator(db, &sector, FDB_SECTOR_STORE_UNUSED, &sec_addr, NULL, gc_step_find_cb, false);
+
+    return sec_addr;
+}
+#endif /* FDB_USING_ERASE_COUNT */
+
+/*
+ * Collect the dirty sectors by steps, one step changes a sector status, moves a KV or erases a sector. It returns
+ * false when nothing is left to do until more KVs are changed.
+ */
+static bool gc_step(fdb_kvdb_t db)
+{
+    struct kvdb_sec_info sector;
+    struct fdb_kv kv;
+    size_t empty_sec = 0;
+    uint8_t status_table[FDB_DIRTY_STATUS_TABLE_SIZE];
+
+    /* a small database is only collected when saving a KV */
+    if (FDB_KV_GC_HIGH_WATERMARK >= SECTOR_NUM) {
+        return false;
+    }
+
+    sector_iterator(db, &sector, FDB_SECTOR_STORE_EMPTY, &empty_sec, NULL, gc_check_cb, false);
+
+    if (db->gc_step_sec == FAILED_ADDR) {
+        if (empty_sec < FDB_KV_GC_LOW_WATERMARK) {
+            db->gc_step_on = true;
+        } else if (empty_sec >= FDB_KV_GC_HIGH_WATERMARK) {
+            db->gc_step_on = false;
+        }
+        if (!db->gc_step_on) {
+            return false;
+        }
+        db->gc_step_sec = gc_step_find(db);
+        if (db->gc_step_sec == FAILED_ADDR) {
+            /* no dirty sector */
+            db->gc_step_on = false;
+            return false;
+        }
+        /* change the sector status to GC, no new KV is allocated in it from now on */
+        _fdb_write_status((fdb_db_t)db, db->gc_step_sec + SECTOR_DIRTY_OFFSET, status_table, FDB_SECTOR_DIRTY_STATUS_NUM,
+                FDB_SECTOR_DIRTY_GC, true);
+#ifdef FDB_KV_USING_CACHE
+        {
+            kv_sec_info_t sector_cache = get_sector_from_cache(db, db->gc_step_sec);
+            if (sector_cache) {
+                sector_cache->status.dirty = FDB_SECTOR_DIRTY_GC;
+            }
+        }
+#endif /* FDB_KV_USING_CACHE */
+        db->gc_step_kv = db->gc_step_sec + SECTOR_HDR_DATA_SIZE;
+        FDB_DEBUG("GC step starts on the sector @0x%08" PRIX32 ", %" PRIu32 " empty sectors.\n", db->gc_step_sec,
+                (uint32_t)empty_sec);
+        return true;
+    }
+
+    read_sector_info(db, db->gc_step_sec, &sector, false);
+    if (!sector.check_ok || sector.status.dirty != FDB_SECTOR_DIRTY_GC) {
+        /* already collected by the GC when saving a KV */
+        db->gc_step_sec = FAILED_ADDR;
+        return true;
+    }
+
+    /* move the next KV in the sector */
+    for (kv.addr.start = db->gc_step_kv; kv.addr.start != FAILED_ADDR; kv.addr.start = db->gc_step_kv) {
+        read_kv(db, &kv);
+        db->gc_step_kv = get_next_kv_addr(db, &sector, &kv);
+        if (kv.crc_is_ok && (kv.status == FDB_KV_WRITE || kv.status == FDB_KV_PRE_DELETE)) {
+            if (empty_sec <= FDB_GC_EMPTY_SEC_THRESHOLD) {
+                /* the reserved empty sector is only used by the GC when saving a KV, it collects this sector too */
+                db->gc_step_kv = kv.addr.start;
+                return false;
+            }
+            if (move_kv(db, &kv) != FDB_NO_ERR) {
+                FDB_INFO("Error: Moved the KV (%.*s) for GC failed.\n", kv.name_len, kv.name);
+                /* retry it on next step */
+                db->gc_step_kv = kv.addr.start;
+                return false;
+            }
+            return true;
+        }
+    }
+
+    format_sector(db, sector.addr, SECTOR_NOT_COMBINED);
+    FDB_DEBUG("GC step collected a sector @0x%08" PRIX32 "\n", sector.addr);
+    /* update oldest_addr for next GC sector format */
+    db_oldest_addr(db) = get_next_sector_addr(db, &sector, 0);
+    db->gc_step_sec = FAILED_ADDR;
+
+    return true;
+}
+#endif /* FDB_KV_USING_GC_STEP */
+
+static fdb_err_t align_write(fdb_kvdb_t db, uint32_t addr, const uint32_t *buf, size_t size)
+{
+    fdb_err_t result = FDB_NO_ERR;
+    size_t align_remain;
+
+#if (FDB_WRITE_GRAN / 8 > 0)
+    uint8_t align_data[FDB_WRITE_GRAN / 8];
+    size_t align_data_size = sizeof(align_data);
+#else
+    /* For compatibility with C89 */
+    uint8_t align_data_u8, *align_data = &align_data_u8;
+    size_t align_data_size = 1;
+#endif
+
+    memset(align_data, FDB_BYTE_ERASED, align_data_size);
+    result = _fdb_flash_write((fdb_db_t) db, addr, buf, FDB_WG_ALIGN_DOWN(size), false);
+
+    align_remain = size - FDB_WG_ALIGN_DOWN(size);
+    if (result == FDB_NO_ERR && align_remain) {
+        memcpy(align_data, (uint8_t *) buf + FDB_WG_ALIGN_DOWN(size), align_remain);
         result = _fdb_flash_write((fdb_db_t) db, addr + FDB_WG_ALIGN_DOWN(size), (uint32_t *) align_data,
                 align_data_size, false);
     }
@@ -1191,6 +1896,48 @@ static fdb_err_t align_write(fdb_kvdb_t db, uint32_t addr, const uint32_t *buf,
     return result;
 }
 
+/*
+ * Make the KV header and start calculate CRC32(header.name_len + header.value_len + name + value).
+ */
+static void make_kv_hdr(kv_hdr_data_t kv_hdr, const char *key, size_t value_len)
+{
+    uint8_t ff = FDB_BYTE_ERASED;
+    size_t align_remain;
+
+    memset(kv_hdr, FDB_BYTE_ERASED, sizeof(struct kv_hdr_data));
+    kv_hdr->magic = KV_MAGIC_WORD;
+    kv_hdr->name_len = strlen(key);
+    kv_hdr->value_len = value_len;
+    kv_hdr->len = KV_HDR_DATA_SIZE + FDB_WG_ALIGN(kv_hdr->name_len) + FDB_WG_ALIGN(kv_hdr->value_len);
+
+    kv_hdr->crc32 = 0;
+    /* using sizeof(uint32_t) for compatible V1.x */
+    kv_hdr->crc32 = fdb_calc_crc32(kv_hdr->crc32, &kv_hdr->name_len, sizeof(uint32_t));
+    kv_hdr->crc32 = fdb_calc_crc32(kv_hdr->crc32, &kv_hdr->value_len, sizeof(uint32_t));
+    kv_hdr->crc32 = fdb_calc_crc32(kv_hdr->crc32, key, kv_hdr->name_len);
+    align_remain = FDB_WG_ALIGN(kv_hdr->name_len) - kv_hdr->name_len;
+    while (align_remain--) {
+        kv_hdr->crc32 = fdb_calc_crc32(kv_hdr->crc32, &ff, 1);
+    }
+}
+
+/*
+ * Add the value to KV header CRC32, it can be added by parts. The value align data is added after the last part.
+ */
+static void calc_kv_value_crc32(kv_hdr_data_t kv_hdr, const void *value, size_t len, bool is_last)
+{
+    uint8_t ff = FDB_BYTE_ERASED;
+    size_t align_remain;
+
+    kv_hdr->crc32 = fdb_calc_crc32(kv_hdr->crc32, value, len);
+    if (is_last) {
+        align_remain = FDB_WG_ALIGN(kv_hdr->value_len) - kv_hdr->value_len;
+        while (align_remain--) {
+            kv_hdr->crc32 = fdb_calc_crc32(kv_hdr->crc32, &ff, 1);
+        }
+    }
+}
+
 static fdb_err_t create_kv_blob(fdb_kvdb_t db, kv_sec_info_t sector, const char *key, const void *value, size_t len)
 {
     fdb_err_t result = FDB_NO_ERR;
@@ -1203,11 +1950,7 @@ static fdb_err_t create_kv_blob(fdb_kvdb_t db, kv_sec_info_t sector, const char
         return FDB_KV_NAME_ERR;
     }
 
-    memset(&kv_hdr, FDB_BYTE_ERASED, sizeof(struct kv_hdr_data));
-    kv_hdr.magic = KV_MAGIC_WORD;
-    kv_hdr.name_len = strlen(key);
-    kv_hdr.value_len = len;
-    kv_hdr.len = KV_HDR_DATA_SIZE + FDB_WG_ALIGN(kv_hdr.name_len) + FDB_WG_ALIGN(kv_hdr.value_len);
+    make_kv_hdr(&kv_hdr, key, len);
 
     if (kv_hdr.len > db_sec_size(db) - SECTOR_HDR_DATA_SIZE) {
         FDB_INFO("Error: The KV size is too big\n");
@@ -1215,28 +1958,12 @@ static fdb_err_t create_kv_blob(fdb_kvdb_t db, kv_sec_info_t sector, const char
     }
 
     if (kv_addr != FAILED_ADDR || (kv_addr = new_kv(db, sector, kv_hdr.len)) != FAILED_ADDR) {
-        size_t align_remain;
         /* update the sector status */
         if (result == FDB_NO_ERR) {
             result = update_sec_status(db, sector, kv_hdr.len, &is_full);
         }
         if (result == FDB_NO_ERR) {
-            uint8_t ff = FDB_BYTE_ERASED;
-            /* start calculate CRC32 */
-            kv_hdr.crc32 = 0;
-            /* CRC32(header.name_len + header.value_len + name + value), using sizeof(uint32_t) for compatible V1.x */
-            kv_hdr.crc32 = fdb_calc_crc32(kv_hdr.crc32, &kv_hdr.name_len, sizeof(uint32_t));
-            kv_hdr.crc32 = fdb_calc_crc32(kv_hdr.crc32, &kv_hdr.value_len, sizeof(uint32_t));
-            kv_hdr.crc32 = fdb_calc_crc32(kv_hdr.crc32, key, kv_hdr.name_len);
-            align_remain = FDB_WG_ALIGN(kv_hdr.name_len) - kv_hdr.name_len;
-            while (align_remain--) {
-                kv_hdr.crc32 = fdb_calc_crc32(kv_hdr.crc32, &ff, 1);
-            }
-            kv_hdr.crc32 = fdb_calc_crc32(kv_hdr.crc32, value, kv_hdr.value_len);
-            align_remain = FDB_WG_ALIGN(kv_hdr.value_len) - kv_hdr.value_len;
-            while (align_remain--) {
-                kv_hdr.crc32 = fdb_calc_crc32(kv_hdr.crc32, &ff, 1);
-            }
+            calc_kv_value_crc32(&kv_hdr, value, kv_hdr.value_len, true);
             /* write KV header data */
             result = write_kv_hdr(db, kv_addr, &kv_hdr);
         }
@@ -1262,91 +1989,903 @@ static fdb_err_t create_kv_blob(fdb_kvdb_t db, kv_sec_info_t sector, const char
             result = _fdb_write_status((fdb_db_t) db, kv_addr, kv_hdr.status_table, FDB_KV_STATUS_NUM, FDB_KV_WRITE,
                     true);
         }
-        /* trigger GC collect when current sector is full */
-        if (result == FDB_NO_ERR && is_full) {
-            FDB_DEBUG("Trigger a GC check after created KV.\n");
-            db->gc_request = true;
+#ifdef FDB_KV_USING_INDEX
+        if (result == FDB_NO_ERR) {
+            update_kv_index(db, key, kv_hdr.name_len, kv_hdr.value_len, kv_addr);
+        }
+#endif /* FDB_KV_USING_INDEX */
+        /* trigger GC collect when current sector is full */
+        if (result == FDB_NO_ERR && is_full) {
+            FDB_DEBUG("Trigger a GC check after created KV.\n");
+            db->gc_request = true;
+        }
+    } else {
+        result = FDB_SAVED_FULL;
+    }
+
+    return result;
+}
+
+/**
+ * Delete an KV.
+ *
+ * @param db database object
+ * @param key KV name
+ *
+ * @return result
+ */
+fdb_err_t fdb_kv_del(fdb_kvdb_t db, const char *key)
+{
+    fdb_err_t result = FDB_NO_ERR;
+
+    if (!db_init_ok(db)) {
+        FDB_INFO("Error: KV (%s) isn't initialize OK.\n", db_name(db));
+        return FDB_INIT_FAILED;
+    }
+
+    /* lock the KV cache */
+    db_lock(db);
+
+    result = del_kv(db, key, NULL, true);
+
+    /* unlock the KV cache */
+    db_unlock(db);
+
+    return result;
+}
+
+static fdb_err_t set_kv(fdb_kvdb_t db, const char *key, const void *value_buf, size_t buf_len)
+{
+    fdb_err_t result = FDB_NO_ERR;
+    bool kv_is_found = false;
+
+    if (value_buf == NULL) {
+        result = del_kv(db, key, NULL, true);
+    } else {
+        /* make sure the flash has enough space */
+        if (new_kv_ex(db, &db->cur_sector, strlen(key), buf_len) == FAILED_ADDR) {
+            return FDB_SAVED_FULL;
+        }
+        kv_is_found = find_kv(db, key, &db->cur_kv);
+        /* prepare to delete the old KV */
+        if (kv_is_found) {
+            result = del_kv(db, key, &db->cur_kv, false);
+        }
+        /* create the new KV */
+        if (result == FDB_NO_ERR) {
+            result = create_kv_blob(db, &db->cur_sector, key, value_buf, buf_len);
+        }
+        /* delete the old KV */
+        if (kv_is_found && result == FDB_NO_ERR) {
+            result = del_kv(db, key, &db->cur_kv, true);
+        }
+        /* process the GC after set KV */
+        if (db->gc_request) {
+            gc_collect_by_free_size(db, KV_HDR_DATA_SIZE + FDB_WG_ALIGN(strlen(key)) + FDB_WG_ALIGN(buf_len));
+        }
+    }
+
+    return result;
+}
+
+/**
+ * Set a blob KV. If it blob value is NULL, delete it.
+ * If not find it in flash, then create it.
+ *
+ * @param db database object
+ * @param key KV name
+ * @param blob blob object
+ *
+ * @return result
+ */
+fdb_err_t fdb_kv_set_blob(fdb_kvdb_t db, const char *key, fdb_blob_t blob)
+{
+    fdb_err_t result = FDB_NO_ERR;
+
+    if (!db_init_ok(db)) {
+        FDB_INFO("Error: KV (%s) isn't initialize OK.\n", db_name(db));
+        return FDB_INIT_FAILED;
+    }
+
+    /* lock the KV cache */
+    db_lock(db);
+
+    result = set_kv(db, key, blob->buf, blob->size);
+
+    /* unlock the KV cache */
+    db_unlock(db);
+
+    return result;
+}
+
+/**
+ * Set a string KV. If it value is NULL, delete it.
+ * If not find it in flash, then create it.
+ *
+ * @param db database object
+ * @param key KV name
+ * @param value KV value
+ *
+ * @return result
+ */
+fdb_err_t fdb_kv_set(fdb_kvdb_t db, const char *key, const char *value)
+{
+    struct fdb_blob blob;
+
+    return fdb_kv_set_blob(db, key, fdb_blob_make(&blob, value, strlen(value)));
+}
+
+/**
+ * Begin a KV batch. The KVs which are set or deleted in batch are saved together by fdb_kv_batch_commit.
+ * The batch only holds the KV name and value pointers, so they MUST be valid until the batch is committed.
+ *
+ * @param db database object
+ * @param batch batch object
+ * @param nodes node buffer, each KV in batch uses one node
+ * @param max_num node buffer size
+ *
+ * @return batch object
+ */
+fdb_kv_batch_t fdb_kv_batch_begin(fdb_kvdb_t db, fdb_kv_batch_t batch, fdb_kv_batch_node_t nodes, size_t max_num)
+{
+    batch->db = db;
+    batch->nodes = nodes;
+    batch->max_num = max_num;
+    batch->num = 0;
+
+    return batch;
+}
+
+/**
+ * Set a blob KV in batch. If it blob value is NULL, delete it.
+ * The KV which is already in batch will be replaced.
+ *
+ * @param batch batch object
+ * @param key KV name
+ * @param blob blob object
+ *
+ * @return result, FDB_SAVED_FULL: the node buffer is full or the KV size is too big
+ */
+fdb_err_t fdb_kv_batch_set_blob(fdb_kv_batch_t batch, const char *key, fdb_blob_t blob)
+{
+    fdb_kvdb_t db = batch->db;
+    fdb_kv_batch_node_t node = NULL;
+    size_t i, key_len = strlen(key);
+
+    if (key_len > FDB_KV_NAME_MAX) {
+        FDB_INFO("Error: The KV name length is more than %d\n", FDB_KV_NAME_MAX);
+        return FDB_KV_NAME_ERR;
+    }
+    if (blob->buf && KV_HDR_DATA_SIZE + FDB_WG_ALIGN(key_len) + FDB_WG_ALIGN(blob->size)
+            > db_sec_size(db) - SECTOR_HDR_DATA_SIZE) {
+        FDB_INFO("Error: The KV size is too big\n");
+        return FDB_SAVED_FULL;
+    }
+
+    for (i = 0; i < batch->num; i++) {
+        if (!strcmp(batch->nodes[i].key, key)) {
+            node = &batch->nodes[i];
+            break;
+        }
+    }
+    if (node == NULL) {
+        if (batch->num >= batch->max_num) {
+            FDB_INFO("Error: The KV batch is full (%zu KVs)\n", batch->max_num);
+            return FDB_SAVED_FULL;
+        }
+        node = &batch->nodes[batch->num++];
+        node->key = key;
+    }
+    node->value = blob->buf;
+    node->value_len = blob->buf ? blob->size : 0;
+
+    return FDB_NO_ERR;
+}
+
+/**
+ * Set a string KV in batch.
+ *
+ * @param batch batch object
+ * @param key KV name
+ * @param value KV value
+ *
+ * @return result
+ */
+fdb_err_t fdb_kv_batch_set(fdb_kv_batch_t batch, const char *key, const char *value)
+{
+    struct fdb_blob blob;
+
+    return fdb_kv_batch_set_blob(batch, key, fdb_blob_make(&blob, value, strlen(value)));
+}
+
+/**
+ * Delete an KV in batch.
+ *
+ * @param batch batch object
+ * @param key KV name
+ *
+ * @return result
+ */
+fdb_err_t fdb_kv_batch_del(fdb_kv_batch_t batch, const char *key)
+{
+    struct fdb_blob blob;
+
+    return fdb_kv_batch_set_blob(batch, key, fdb_blob_make(&blob, NULL, 0));
+}
+
+static bool find_batch_kv_cb(fdb_kv_t kv, void *arg1, void *arg2)
+{
+    fdb_kv_batch_t batch = arg1;
+    size_t i, *found_num = arg2;
+
+    if (!kv->crc_is_ok || kv->status != FDB_KV_WRITE) {
+        return false;
+    }
+    for (i = 0; i < batch->num; i++) {
+        if (batch->nodes[i].old_addr == FAILED_ADDR && strlen(batch->nodes[i].key) == kv->name_len
+                && !strncmp(kv->name, batch->nodes[i].key, kv->name_len)) {
+            batch->nodes[i].old_addr = kv->addr.start;
+            /* all KVs in batch are found */
+            return ++(*found_num) == batch->num;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Find the old KVs in batch. They are found by index when it's OK, otherwise all KVs are searched in one traversal.
+ */
+static void find_batch_kv(fdb_kvdb_t db, fdb_kv_batch_t batch)
+{
+    struct fdb_kv kv;
+    size_t i, found_num = 0;
+
+    for (i = 0; i < batch->num; i++) {
+        batch->nodes[i].old_addr = FAILED_ADDR;
+    }
+
+#ifdef FDB_KV_USING_INDEX
+    if (db->kv_index_ok) {
+        for (i = 0; i < batch->num; i++) {
+            if (find_kv(db, batch->nodes[i].key, &kv)) {
+                batch->nodes[i].old_addr = kv.addr.start;
+            }
+        }
+        return;
+    }
+#endif /* FDB_KV_USING_INDEX */
+
+    kv_iterator(db, &kv, batch, &found_num, find_batch_kv_cb);
+}
+
+/*
+ * Write the KV header and name in batch. The KVs are placed one by one in current sector, an other sector is
+ * allocated only when current sector has not enough space. The KV status is kept FDB_KV_PRE_WRITE.
+ */
+static fdb_err_t create_batch_kv_hdr(fdb_kvdb_t db, kv_sec_info_t sector, kv_hdr_data_t kv_hdr, const char *key,
+        uint32_t *kv_addr, bool *need_gc)
+{
+    fdb_err_t result = FDB_NO_ERR;
+    bool is_full = false;
+
+    if (sector->empty_kv == FAILED_ADDR || sector->remain <= kv_hdr->len + FDB_SEC_REMAIN_THRESHOLD) {
+        if (alloc_kv(db, sector, kv_hdr->len) == FAILED_ADDR) {
+            return FDB_SAVED_FULL;
+        }
+    }
+    /* only the first and last KV in sector will change the sector status */
+    result = update_sec_status(db, sector, kv_hdr->len, &is_full);
+    if (result != FDB_NO_ERR) {
+        return result;
+    }
+    *kv_addr = sector->empty_kv;
+    sector->status.store = FDB_SECTOR_STORE_USING;
+    sector->empty_kv += kv_hdr->len;
+    sector->remain -= kv_hdr->len;
+    if (is_full) {
+        sector->empty_kv = FAILED_ADDR;
+        *need_gc = true;
+    }
+#ifdef FDB_KV_USING_CACHE
+    else {
+        update_sector_empty_addr_cache(db, sector->addr, sector->empty_kv);
+    }
+#endif /* FDB_KV_USING_CACHE */
+
+    result = write_kv_hdr(db, *kv_addr, kv_hdr);
+    if (result == FDB_NO_ERR) {
+        result = align_write(db, *kv_addr + KV_HDR_DATA_SIZE, (uint32_t *) key, kv_hdr->name_len);
+    }
+
+    return result;
+}
+
+/*
+ * Write all KVs in batch, then the commit KV which value is the new and old address of every KV.
+ */
+static fdb_err_t write_batch(fdb_kvdb_t db, fdb_kv_batch_t batch, uint32_t *batch_addr, bool *need_gc)
+{
+    fdb_err_t result = FDB_NO_ERR;
+    struct kvdb_sec_info sector;
+    struct kv_hdr_data kv_hdr;
+    fdb_kv_batch_node_t node;
+    uint32_t buf[8], value_addr;
+    size_t i, len;
+
+    sector.empty_kv = FAILED_ADDR;
+    for (i = 0; i < batch->num; i++) {
+        batch->nodes[i].addr = FAILED_ADDR;
+    }
+
+    for (i = 0; i < batch->num && result == FDB_NO_ERR; i++) {
+        node = &batch->nodes[i];
+        if (node->value == NULL) {
+            continue;
+        }
+        make_kv_hdr(&kv_hdr, node->key, node->value_len);
+        calc_kv_value_crc32(&kv_hdr, node->value, node->value_len, true);
+        result = create_batch_kv_hdr(db, &sector, &kv_hdr, node->key, &node->addr, need_gc);
+        if (result == FDB_NO_ERR) {
+            result = align_write(db, node->addr + KV_HDR_DATA_SIZE + FDB_WG_ALIGN(kv_hdr.name_len), node->value,
+                    node->value_len);
+        }
+    }
+    if (result != FDB_NO_ERR) {
+        return result;
+    }
+
+    /* the value is the new and old address of each node */
+    make_kv_hdr(&kv_hdr, BATCH_KV_NAME, batch->num * 2 * sizeof(uint32_t));
+    for (i = 0; i < batch->num; i++) {
+        calc_kv_value_crc32(&kv_hdr, &batch->nodes[i].addr, sizeof(uint32_t), false);
+        calc_kv_value_crc32(&kv_hdr, &batch->nodes[i].old_addr, sizeof(uint32_t), i == batch->num - 1);
+    }
+    result = create_batch_kv_hdr(db, &sector, &kv_hdr, BATCH_KV_NAME, batch_addr, need_gc);
+    value_addr = *batch_addr + KV_HDR_DATA_SIZE + FDB_WG_ALIGN(kv_hdr.name_len);
+    for (i = 0; i < batch->num && result == FDB_NO_ERR; i += len / 2) {
+        for (len = 0; len < sizeof(buf) / sizeof(buf[0]) && i + len / 2 < batch->num; len += 2) {
+            buf[len] = batch->nodes[i + len / 2].addr;
+            buf[len + 1] = batch->nodes[i + len / 2].old_addr;
+        }
+        result = align_write(db, value_addr, buf, len * sizeof(uint32_t));
+        value_addr += len * sizeof(uint32_t);
+    }
+
+    return result;
+}
+
+/*
+ * Delete the KV which is written by an uncommitted batch.
+ */
+static void discard_batch_kv(fdb_kvdb_t db, const char *key, uint32_t addr)
+{
+    struct fdb_kv kv;
+
+    if (addr != FAILED_ADDR) {
+        kv.addr.start = addr;
+        del_kv(db, key, &kv, true);
+    }
+}
+
+static fdb_err_t commit_batch(fdb_kvdb_t db, fdb_kv_batch_t batch)
+{
+    fdb_err_t result = FDB_NO_ERR;
+    uint8_t status_table[KV_STATUS_TABLE_SIZE];
+    uint32_t batch_addr = FAILED_ADDR;
+    bool already_gc = false, need_gc = false;
+    fdb_kv_batch_node_t node;
+    struct fdb_kv kv;
+    size_t i, total_len;
+
+    total_len = KV_HDR_DATA_SIZE + FDB_WG_ALIGN(sizeof(BATCH_KV_NAME) - 1) + FDB_WG_ALIGN(batch->num * 2 * sizeof(uint32_t));
+    if (total_len > db_sec_size(db) - SECTOR_HDR_DATA_SIZE) {
+        FDB_INFO("Error: Too many KVs (%zu) in batch\n", batch->num);
+        return FDB_SAVED_FULL;
+    }
+    for (i = 0; i < batch->num; i++) {
+        if (batch->nodes[i].value) {
+            total_len += KV_HDR_DATA_SIZE + FDB_WG_ALIGN(strlen(batch->nodes[i].key))
+                    + FDB_WG_ALIGN(batch->nodes[i].value_len);
+        }
+    }
+
+__retry:
+
+    find_batch_kv(db, batch);
+    result = write_batch(db, batch, &batch_addr, &need_gc);
+    if (result != FDB_NO_ERR) {
+        /* nothing is changed, the written KVs are deleted then GC and retry once */
+        for (i = 0; i < batch->num; i++) {
+            discard_batch_kv(db, batch->nodes[i].key, batch->nodes[i].addr);
+        }
+        discard_batch_kv(db, BATCH_KV_NAME, batch_addr);
+        batch_addr = FAILED_ADDR;
+        if (result == FDB_SAVED_FULL && db->gc_request && !already_gc) {
+            FDB_INFO("Warning: Alloc the KV batch (size %" PRIu32 ") failed. Now will GC then retry.\n", (uint32_t)total_len);
+            /* the first collected sector is kept empty for next GC */
+            gc_collect_by_free_size(db, total_len + db_sec_size(db));
+            already_gc = true;
+            goto __retry;
+        }
+        FDB_INFO("Error: Write the KV batch (size %" PRIu32 ") failed.\n", (uint32_t)total_len);
+        db->gc_request = false;
+        return result;
+    }
+
+    /* the batch is saved when the commit KV status is changed, the KVs are changed again on next boot if power off */
+    result = _fdb_write_status((fdb_db_t)db, batch_addr, status_table, FDB_KV_STATUS_NUM, FDB_KV_WRITE, true);
+    for (i = 0; i < batch->num && result == FDB_NO_ERR; i++) {
+        node = &batch->nodes[i];
+        if (node->old_addr != FAILED_ADDR) {
+            kv.addr.start = node->old_addr;
+            result = del_kv(db, node->key, &kv, true);
+        }
+        if (result == FDB_NO_ERR && node->addr != FAILED_ADDR) {
+            result = _fdb_write_status((fdb_db_t)db, node->addr, status_table, FDB_KV_STATUS_NUM, FDB_KV_WRITE, true);
+            if (result == FDB_NO_ERR) {
+#ifdef FDB_KV_USING_CACHE
+                update_kv_cache(db, node->key, strlen(node->key), node->addr);
+#endif /* FDB_KV_USING_CACHE */
+#ifdef FDB_KV_USING_INDEX
+                update_kv_index(db, node->key, strlen(node->key), node->value_len, node->addr);
+#endif /* FDB_KV_USING_INDEX */
+            }
+        }
+    }
+    if (result == FDB_NO_ERR) {
+        kv.addr.start = batch_addr;
+        result = del_kv(db, BATCH_KV_NAME, &kv, true);
+    }
+    if (need_gc) {
+        FDB_DEBUG("Trigger a GC check after committed KV batch.\n");
+        db->gc_request = true;
+    }
+    /* process the GC after the batch is finished */
+    if (db->gc_request) {
+        gc_collect_by_free_size(db, total_len);
+    }
+
+    return result;
+}
+
+/**
+ * Commit the KV batch. All KVs in batch are saved, or none of them is changed after power failure.
+ * The flash space for all KVs is allocated in one pass, and the KVs are written one by one.
+ *
+ * @param batch batch object
+ *
+ * @return result
+ */
+fdb_err_t fdb_kv_batch_commit(fdb_kv_batch_t batch)
+{
+    fdb_kvdb_t db = batch->db;
+    fdb_err_t result = FDB_NO_ERR;
+
+    if (!db_init_ok(db)) {
+        FDB_INFO("Error: KV (%s) isn't initialize OK.\n", db_name(db));
+        return FDB_INIT_FAILED;
+    }
+    if (batch->num == 0) {
+        return FDB_NO_ERR;
+    }
+
+    /* lock the KV cache */
+    db_lock(db);
+
+    result = commit_batch(db, batch);
+
+    /* unlock the KV cache */
+    db_unlock(db);
+
+    return result;
+}
+
+#ifdef FDB_KV_USING_GC_STEP
+/**
+ * Collect the dirty sectors by steps, call it in a low priority task. Each step moves a KV or erases a sector,
+ * the database is unlocked between steps. The GC starts when the empty sectors are fewer than
+ * FDB_KV_GC_LOW_WATERMARK and stops when there are FDB_KV_GC_HIGH_WATERMARK, so the GC when saving a KV is rarely
+ * triggered.
+ *
+ * @param db database object
+ *
+ * @return true: call it again after yield, false: nothing to do now
+ */
+bool fdb_kv_gc_step(fdb_kvdb_t db)
+{
+    bool busy;
+
+    if (!db_init_ok(db)) {
+        return false;
+    }
+
+    /* lock the KV cache */
+    db_lock(db);
+
+    busy = gc_step(db);
+
+    /* unlock the KV cache */
+    db_unlock(db);
+
+    return busy;
+}
+#endif /* FDB_KV_USING_GC_STEP */
+
+#ifdef FDB_KV_USING_SNAPSHOT
+/*
+ * Get the sector status on flash for the snapshot, store status in low 4 bits and dirty status in high 4 bits,
+ * 0xFF: the header is incorrect.
+ */
+static uint8_t snap_sec_status(fdb_kvdb_t db, uint32_t addr)
+{
+    struct sector_hdr_data sec_hdr;
+
+    _fdb_flash_read((fdb_db_t)db, addr, (uint32_t *)&sec_hdr, sizeof(struct sector_hdr_data));
+    if (sec_hdr.magic != SECTOR_MAGIC_WORD
+            || (sec_hdr.combined != SECTOR_NOT_COMBINED && sec_hdr.combined != SECTOR_COMBINED)) {
+        return 0xFF;
+    }
+
+    return (uint8_t) (_fdb_get_status(sec_hdr.status_table.store, FDB_SECTOR_STORE_STATUS_NUM)
+            | (_fdb_get_status(sec_hdr.status_table.dirty, FDB_SECTOR_DIRTY_STATUS_NUM) << 4));
+}
+
+/*
+ * Clear the magic word of the snapshot slot, it's never loaded.
+ */
+static void kv_snapshot_invalidate(fdb_kvdb_t db, uint32_t slot)
+{
+    uint32_t magic = FDB_BYTE_WRITTEN;
+
+    if (fal_partition_write(db->snap_part, slot, (uint8_t *)&magic, sizeof(magic)) < 0) {
+        FDB_INFO("Error: Invalidate the snapshot @0x%08" PRIX32 " failed.\n", slot);
+    }
+}
+
+/*
+ * Mark the sectors on the snapshot before they are written or erased. A sector which isn't marked is the same as
+ * it's saved in the snapshot.
+ */
+void _fdb_kv_snapshot_touch(fdb_kvdb_t db, uint32_t addr, size_t size)
+{
+    uint32_t sec, last;
+    uint8_t mark;
+
+    if (db->snap_addr == FAILED_ADDR || size == 0) {
+        return;
+    }
+
+    for (sec = addr / db_sec_size(db), last = (addr + size - 1) / db_sec_size(db); sec <= last; sec++) {
+        if (db->snap_touched[sec / 8] & (1 << (sec % 8))) {
+            continue;
+        }
+        db->snap_touched[sec / 8] |= 1 << (sec % 8);
+        /* the touched bits are cleared, the others are kept erased */
+        mark = ~db->snap_touched[sec / 8];
+        if (fal_partition_write(db->snap_part, db->snap_addr + SNAP_HDR_DATA_SIZE + sec / 8, &mark, 1) < 0) {
+            FDB_INFO("Error: Mark the sector @0x%08" PRIX32 " on snapshot failed.\n", sec * db_sec_size(db));
+            kv_snapshot_invalidate(db, db->snap_addr);
+            db->snap_addr = FAILED_ADDR;
+            return;
+        }
+    }
+}
+
+static fdb_err_t snap_write(fdb_kvdb_t db, uint32_t *addr, uint32_t *crc, const void *buf, size_t size)
+{
+    *crc = fdb_calc_crc32(*crc, buf, size);
+    if (fal_partition_write(db->snap_part, *addr, (const uint8_t *)buf, size) < 0) {
+        return FDB_WRITE_ERR;
+    }
+    *addr += size;
+
+    return FDB_NO_ERR;
+}
+
+static fdb_err_t snap_read(fdb_kvdb_t db, uint32_t *addr, uint32_t *crc, void *buf, size_t size)
+{
+    if (fal_partition_read(db->snap_part, *addr, (uint8_t *)buf, size) < 0) {
+        return FDB_READ_ERR;
+    }
+    *crc = fdb_calc_crc32(*crc, buf, size);
+    *addr += size;
+
+    return FDB_NO_ERR;
+}
+
+static uint32_t snap_payload_len(fdb_kvdb_t db)
+{
+    uint32_t len = SNAP_SEC_STATUS_SIZE;
+
+#ifdef FDB_KV_USING_CACHE
+    len += sizeof(db->sector_cache_table) + sizeof(db->kv_cache_table);
+#endif
+#ifdef FDB_KV_USING_INDEX
+    len += sizeof(db->kv_index_table);
+#endif
+
+    return len;
+}
+
+static void make_snap_hdr(fdb_kvdb_t db, struct kv_snap_hdr_data *hdr)
+{
+    memset(hdr, 0, sizeof(struct kv_snap_hdr_data));
+    hdr->magic = SNAP_MAGIC_WORD;
+    hdr->sec_size = db_sec_size(db);
+    hdr->max_size = db_max_size(db);
+#ifdef FDB_KV_USING_CACHE
+    hdr->kv_cache_size = FDB_KV_CACHE_TABLE_SIZE;
+    hdr->sec_cache_size = FDB_SECTOR_CACHE_TABLE_SIZE;
+#endif
+#ifdef FDB_KV_USING_INDEX
+    hdr->kv_index_size = FDB_KV_INDEX_SIZE;
+#endif
+    hdr->len = snap_payload_len(db);
+}
+
+/*
+ * Save the sector status, caches and index to the next slot, then the old snapshot is invalidated.
+ */
+static fdb_err_t kv_snapshot_save(fdb_kvdb_t db)
+{
+    struct kv_snap_hdr_data hdr;
+    uint8_t buf[32];
+    uint32_t slot, addr, crc, i, j, size;
+    fdb_err_t result;
+
+    if (db->snap_addr != FAILED_ADDR) {
+        for (i = 0; i < sizeof(db->snap_touched) && db->snap_touched[i] == 0; i++);
+        if (i == sizeof(db->snap_touched)) {
+            /* nothing is written since the snapshot */
+            return FDB_NO_ERR;
+        }
+        /* the slots are used in turn */
+        slot = db->snap_addr + db->snap_slot_size;
+        if (slot + db->snap_slot_size > db->snap_part->len) {
+            slot = 0;
+        }
+    } else {
+        slot = 0;
+    }
+
+    if (fal_partition_erase(db->snap_part, slot, db->snap_slot_size) < 0) {
+        return FDB_ERASE_ERR;
+    }
+
+    make_snap_hdr(db, &hdr);
+    hdr.gen = db->snap_gen + 1;
+    hdr.oldest_addr = db_oldest_addr(db);
+#ifdef FDB_KV_USING_INDEX
+    hdr.kv_index_num = db->kv_index_num;
+    hdr.kv_index_full = db->kv_index_full;
+#endif
+    crc = fdb_calc_crc32(0, &hdr.gen, SNAP_CRC_OFFSET - SNAP_GEN_OFFSET);
+    addr = slot + SNAP_HDR_DATA_SIZE + SNAP_MAP_SIZE;
+    /* the sector status on flash, it's checked for the sectors which aren't marked when loading */
+    for (i = 0; i < SNAP_SEC_STATUS_SIZE; i += size) {
+        size = SNAP_SEC_STATUS_SIZE - i < sizeof(buf) ? SNAP_SEC_STATUS_SIZE - i : sizeof(buf);
+        for (j = 0; j < size; j++) {
+            buf[j] = i + j < SECTOR_NUM ? snap_sec_status(db, (i + j) * db_sec_size(db)) : 0xFF;
+        }
+        if ((result = snap_write(db, &addr, &crc, buf, size)) != FDB_NO_ERR) {
+            return result;
+        }
+    }
+#ifdef FDB_KV_USING_CACHE
+    if ((result = snap_write(db, &addr, &crc, db->sector_cache_table, sizeof(db->sector_cache_table))) != FDB_NO_ERR
+            || (result = snap_write(db, &addr, &crc, db->kv_cache_table, sizeof(db->kv_cache_table))) != FDB_NO_ERR) {
+        return result;
+    }
+#endif /* FDB_KV_USING_CACHE */
+#ifdef FDB_KV_USING_INDEX
+    if ((result = snap_write(db, &addr, &crc, db->kv_index_table, sizeof(db->kv_index_table))) != FDB_NO_ERR) {
+        return result;
+    }
+#endif /* FDB_KV_USING_INDEX */
+    hdr.crc32 = crc;
+    /* the magic word is written last, the snapshot is valid after it */
+    if (fal_partition_write(db->snap_part, slot + SNAP_GEN_OFFSET, (uint8_t *)&hdr.gen,
+            SNAP_HDR_DATA_SIZE - SNAP_GEN_OFFSET) < 0
+            || fal_partition_write(db->snap_part, slot, (uint8_t *)&hdr.magic, sizeof(hdr.magic)) < 0) {
+        return FDB_WRITE_ERR;
+    }
+
+    if (db->snap_addr != FAILED_ADDR && db->snap_addr != slot) {
+        kv_snapshot_invalidate(db, db->snap_addr);
+    }
+    db->snap_addr = slot;
+    db->snap_gen = hdr.gen;
+    memset(db->snap_touched, 0, sizeof(db->snap_touched));
+    FDB_DEBUG("Saved the snapshot %" PRIu32 " @0x%08" PRIX32 ".\n", hdr.gen, slot);
+
+    return FDB_NO_ERR;
+}
+
+/*
+ * Drop the caches and index of the sectors which are written since the snapshot, they are loaded by scanning.
+ */
+static void kv_snapshot_drop_touched(fdb_kvdb_t db)
+{
+    size_t i;
+
+#ifdef FDB_KV_USING_CACHE
+    for (i = 0; i < FDB_SECTOR_CACHE_TABLE_SIZE; i++) {
+        if (db->sector_cache_table[i].addr != FDB_DATA_UNUSED && SNAP_SEC_IS_TOUCHED(db, db->sector_cache_table[i].addr)) {
+            db->sector_cache_table[i].addr = FDB_DATA_UNUSED;
+        }
+    }
+    lookup_write_begin(db);
+    for (i = 0; i < FDB_KV_CACHE_TABLE_SIZE; i++) {
+        if (db->kv_cache_table[i].addr != FDB_DATA_UNUSED && SNAP_SEC_IS_TOUCHED(db, db->kv_cache_table[i].addr)) {
+            db->kv_cache_table[i].addr = FDB_DATA_UNUSED;
+        }
+    }
+    lookup_write_end(db);
+#endif /* FDB_KV_USING_CACHE */
+#ifdef FDB_KV_USING_INDEX
+    for (i = 0; i < FDB_KV_INDEX_SIZE; i++) {
+        /* the next node may be shifted to this slot */
+        while (db->kv_index_table[i].addr != FDB_DATA_UNUSED && SNAP_SEC_IS_TOUCHED(db, db->kv_index_table[i].addr)) {
+            del_kv_index_node(db, i);
         }
-    } else {
-        result = FDB_SAVED_FULL;
     }
-
-    return result;
+#endif /* FDB_KV_USING_INDEX */
+    (void) i;
 }
 
-/**
- * Delete an KV.
- *
- * @param db database object
- * @param key KV name
- *
- * @return result
+/*
+ * Load the newest valid snapshot. The caches and index are reset when it's failed, then all KVs are scanned.
  */
-fdb_err_t fdb_kv_del(fdb_kvdb_t db, const char *key)
+static fdb_err_t kv_snapshot_load(fdb_kvdb_t db)
 {
-    fdb_err_t result = FDB_NO_ERR;
+    struct kv_snap_hdr_data hdr, ref;
+    uint8_t buf[32];
+    uint32_t slot, best = FAILED_ADDR, addr, crc, i, j, size;
+    bool touched = false;
+
+    memset(db->snap_touched, 0, sizeof(db->snap_touched));
+    make_snap_hdr(db, &ref);
+    /* find the newest snapshot, the older one is left when the power is lost on saving, it's invalidated */
+    for (slot = 0; slot + db->snap_slot_size <= db->snap_part->len; slot += db->snap_slot_size) {
+        if (fal_partition_read(db->snap_part, slot, (uint8_t *)&hdr, sizeof(hdr)) < 0 || hdr.magic != SNAP_MAGIC_WORD) {
+            continue;
+        }
+        if (best == FAILED_ADDR || (int32_t)(hdr.gen - db->snap_gen) > 0) {
+            if (best != FAILED_ADDR) {
+                kv_snapshot_invalidate(db, best);
+            }
+            best = slot;
+            db->snap_gen = hdr.gen;
+        } else {
+            kv_snapshot_invalidate(db, slot);
+        }
+    }
+    if (best == FAILED_ADDR) {
+        return FDB_READ_ERR;
+    }
 
-    if (!db_init_ok(db)) {
-        FDB_INFO("Error: KV (%s) isn't initialize OK.\n", db_name(db));
+    fal_partition_read(db->snap_part, best, (uint8_t *)&hdr, sizeof(hdr));
+    if (hdr.sec_size != ref.sec_size || hdr.max_size != ref.max_size || hdr.kv_cache_size != ref.kv_cache_size
+            || hdr.sec_cache_size != ref.sec_cache_size || hdr.kv_index_size != ref.kv_index_size || hdr.len != ref.len) {
+        FDB_INFO("The snapshot is saved by other configuration. Now will scan all KVs.\n");
         return FDB_INIT_FAILED;
     }
+    /* the cleared bit is touched */
+    if (fal_partition_read(db->snap_part, best + SNAP_HDR_DATA_SIZE, db->snap_touched, (SECTOR_NUM + 7) / 8) < 0) {
+        goto __failed;
+    }
+    for (i = 0; i < (SECTOR_NUM + 7) / 8; i++) {
+        db->snap_touched[i] = ~db->snap_touched[i];
+        touched |= db->snap_touched[i] != 0;
+    }
+    if (SECTOR_NUM % 8) {
+        db->snap_touched[SECTOR_NUM / 8] &= (1 << (SECTOR_NUM % 8)) - 1;
+    }
 
-    /* lock the KV cache */
-    db_lock(db);
+    crc = fdb_calc_crc32(0, &hdr.gen, SNAP_CRC_OFFSET - SNAP_GEN_OFFSET);
+    addr = best + SNAP_HDR_DATA_SIZE + SNAP_MAP_SIZE;
+    /* the sectors which aren't marked must be the same as saved */
+    for (i = 0; i < SNAP_SEC_STATUS_SIZE; i += size) {
+        size = SNAP_SEC_STATUS_SIZE - i < sizeof(buf) ? SNAP_SEC_STATUS_SIZE - i : sizeof(buf);
+        if (snap_read(db, &addr, &crc, buf, size) != FDB_NO_ERR) {
+            goto __failed;
+        }
+        for (j = 0; j < size && i + j < SECTOR_NUM; j++) {
+            if (!SNAP_SEC_IS_TOUCHED(db, (i + j) * db_sec_size(db))
+                    && buf[j] != snap_sec_status(db, (i + j) * db_sec_size(db))) {
+                FDB_INFO("The sector @0x%08" PRIX32 " is changed since the snapshot. Now will scan all KVs.\n",
+                        (i + j) * db_sec_size(db));
+                goto __failed;
+            }
+        }
+    }
+#ifdef FDB_KV_USING_CACHE
+    if (snap_read(db, &addr, &crc, db->sector_cache_table, sizeof(db->sector_cache_table)) != FDB_NO_ERR
+            || snap_read(db, &addr, &crc, db->kv_cache_table, sizeof(db->kv_cache_table)) != FDB_NO_ERR) {
+        goto __failed;
+    }
+#endif /* FDB_KV_USING_CACHE */
+#ifdef FDB_KV_USING_INDEX
+    if (snap_read(db, &addr, &crc, db->kv_index_table, sizeof(db->kv_index_table)) != FDB_NO_ERR) {
+        goto __failed;
+    }
+#endif /* FDB_KV_USING_INDEX */
+    if (crc != hdr.crc32) {
+        FDB_INFO("The snapshot CRC32 check failed. Now will scan all KVs.\n");
+        goto __failed;
+    }
 
-    result = del_kv(db, key, NULL, true);
+#ifdef FDB_KV_USING_INDEX
+    db->kv_index_num = hdr.kv_index_num;
+    db->kv_index_full = hdr.kv_index_full;
+    if (db->kv_index_full) {
+        reset_kv_index(db);
+        db->kv_index_full = true;
+    }
+#endif /* FDB_KV_USING_INDEX */
+    kv_snapshot_drop_touched(db);
+    if (!touched) {
+        /* keep the oldest sector which is moved by GC */
+        db_oldest_addr(db) = hdr.oldest_addr;
+    }
+    db->snap_addr = best;
+    FDB_DEBUG("Loaded the snapshot %" PRIu32 " @0x%08" PRIX32 ".\n", hdr.gen, best);
 
-    /* unlock the KV cache */
-    db_unlock(db);
+    return FDB_NO_ERR;
 
-    return result;
+__failed:
+    memset(db->snap_touched, 0, sizeof(db->snap_touched));
+#ifdef FDB_KV_USING_CACHE
+    reset_kv_cache(db);
+#endif /* FDB_KV_USING_CACHE */
+#ifdef FDB_KV_USING_INDEX
+    reset_kv_index(db);
+#endif /* FDB_KV_USING_INDEX */
+
+    return FDB_READ_ERR;
 }
 
-static fdb_err_t set_kv(fdb_kvdb_t db, const char *key, const void *value_buf, size_t buf_len)
+/*
+ * Find the snapshot partition and make the slot size, the snapshot is disabled when it's not usable.
+ */
+static void kv_snapshot_init(fdb_kvdb_t db)
 {
-    fdb_err_t result = FDB_NO_ERR;
-    bool kv_is_found = false;
+    const struct fal_partition *part;
+    size_t block_size;
 
-    if (value_buf == NULL) {
-        result = del_kv(db, key, NULL, true);
-    } else {
-        /* make sure the flash has enough space */
-        if (new_kv_ex(db, &db->cur_sector, strlen(key), buf_len) == FAILED_ADDR) {
-            return FDB_SAVED_FULL;
-        }
-        kv_is_found = find_kv(db, key, &db->cur_kv);
-        /* prepare to delete the old KV */
-        if (kv_is_found) {
-            result = del_kv(db, key, &db->cur_kv, false);
-        }
-        /* create the new KV */
-        if (result == FDB_NO_ERR) {
-            result = create_kv_blob(db, &db->cur_sector, key, value_buf, buf_len);
-        }
-        /* delete the old KV */
-        if (kv_is_found && result == FDB_NO_ERR) {
-            result = del_kv(db, key, &db->cur_kv, true);
-        }
-        /* process the GC after set KV */
-        if (db->gc_request) {
-            gc_collect_by_free_size(db, KV_HDR_DATA_SIZE + FDB_WG_ALIGN(strlen(key)) + FDB_WG_ALIGN(buf_len));
-        }
+    if (db->snap_name == NULL || db->parent.file_mode) {
+        return;
     }
-
-    return result;
+    if ((part = fal_partition_find(db->snap_name)) == NULL) {
+        FDB_INFO("Error: Snapshot partition (%s) not found.\n", db->snap_name);
+        return;
+    }
+    if (SECTOR_NUM > FDB_KV_SNAPSHOT_SEC_NUM) {
+        FDB_INFO("Error: The KVDB has more than %d sectors, no snapshot.\n", FDB_KV_SNAPSHOT_SEC_NUM);
+        return;
+    }
+    block_size = fal_flash_device_find(part->flash_name)->blk_size;
+    db->snap_slot_size = FDB_ALIGN(SNAP_HDR_DATA_SIZE + SNAP_MAP_SIZE + snap_payload_len(db), block_size);
+    if (part->len < 2 * db->snap_slot_size) {
+        FDB_INFO("Error: Snapshot partition (%s) MUST have 2 slots of %" PRIu32 " bytes.\n", db->snap_name,
+                db->snap_slot_size);
+        return;
+    }
+    db->snap_part = part;
+    db->snap_gen = 0;
 }
 
 /**
- * Set a blob KV. If it blob value is NULL, delete it.
- * If not find it in flash, then create it.
+ * Save the caches and index to the snapshot partition, then only the sectors written since it are scanned when the
+ * database is loaded. Call it when idle, e.g. in the GC task, a snapshot slot is erased when any KV is changed since
+ * the last snapshot. It does nothing when no snapshot partition is set.
  *
  * @param db database object
- * @param key KV name
- * @param blob blob object
  *
  * @return result
  */
-fdb_err_t fdb_kv_set_blob(fdb_kvdb_t db, const char *key, fdb_blob_t blob)
+fdb_err_t fdb_kv_snapshot(fdb_kvdb_t db)
 {
     fdb_err_t result = FDB_NO_ERR;
 
@@ -1358,30 +2897,16 @@ fdb_err_t fdb_kv_set_blob(fdb_kvdb_t db, const char *key, fdb_blob_t blob)
     /* lock the KV cache */
     db_lock(db);
 
-    result = set_kv(db, key, blob->buf, blob->size);
+    if (db->snap_part) {
+        result = kv_snapshot_save(db);
+    }
 
     /* unlock the KV cache */
     db_unlock(db);
 
     return result;
 }
-
-/**
- * Set a string KV. If it value is NULL, delete it.
- * If not find it in flash, then create it.
- *
- * @param db database object
- * @param key KV name
- * @param value KV value
- *
- * @return result
- */
-fdb_err_t fdb_kv_set(fdb_kvdb_t db, const char *key, const char *value)
-{
-    struct fdb_blob blob;
-
-    return fdb_kv_set_blob(db, key, fdb_blob_make(&blob, value, strlen(value)));
-}
+#endif /* FDB_KV_USING_SNAPSHOT */
 
 /**
  * recovery all KV to default.
@@ -1399,10 +2924,15 @@ fdb_err_t fdb_kv_set_default(fdb_kvdb_t db)
     db_lock(db);
 
 #ifdef FDB_KV_USING_CACHE
+    lookup_write_begin(db);
     for (i = 0; i < FDB_KV_CACHE_TABLE_SIZE; i++) {
         db->kv_cache_table[i].addr = FDB_DATA_UNUSED;
     }
+    lookup_write_end(db);
 #endif /* FDB_KV_USING_CACHE */
+#ifdef FDB_KV_USING_INDEX
+    reset_kv_index(db);
+#endif /* FDB_KV_USING_INDEX */
 
     /* format all sectors */
     for (addr = 0; addr < db_max_size(db); addr += db_sec_size(db)) {
@@ -1429,6 +2959,10 @@ fdb_err_t fdb_kv_set_default(fdb_kvdb_t db)
 
 __exit:
     db_oldest_addr(db) = 0;
+#ifdef FDB_KV_USING_INDEX
+    /* the index has all default KVs now, it's completed by _fdb_kv_load when loading */
+    db->kv_index_ok = !db->in_recovery_check && !db->kv_index_full;
+#endif /* FDB_KV_USING_INDEX */
     /* unlock the KV cache */
     db_unlock(db);
 
@@ -1500,7 +3034,7 @@ void fdb_kv_print(fdb_kvdb_t db)
     }
 
     /* lock the KV cache */
-    db_lock(db);
+    db_rdlock(db);
 
     kv_iterator(db, &kv, &using_size, db, print_kv_cb);
 
@@ -1509,7 +3043,7 @@ void fdb_kv_print(fdb_kvdb_t db)
             db_max_size(db) - db_sec_size(db) * FDB_GC_EMPTY_SEC_THRESHOLD);
 
     /* unlock the KV cache */
-    db_unlock(db);
+    db_rdunlock(db);
 }
 
 #ifdef FDB_KV_AUTO_UPDATE
@@ -1601,6 +3135,7 @@ static bool check_and_recovery_gc_cb(kv_sec_info_t sector, void *arg1, void *arg
 static bool check_and_recovery_kv_cb(fdb_kv_t kv, void *arg1, void *arg2)
 {
     fdb_kvdb_t db = arg1;
+    struct recovery_kv_cb_args *arg = arg2;
 
     /* recovery the prepare deleted KV */
     if (kv->crc_is_ok && kv->status == FDB_KV_PRE_DELETE) {
@@ -1609,25 +3144,91 @@ static bool check_and_recovery_kv_cb(fdb_kv_t kv, void *arg1, void *arg2)
         if (move_kv(db, kv) == FDB_NO_ERR) {
             FDB_DEBUG("Recovery the KV successful.\n");
         } else {
+            /* keep going, the committed batch MUST be found before GC */
             FDB_DEBUG("Warning: Moved an KV (size %" PRIu32 ") failed when recovery. Now will GC then retry.\n", kv->len);
-            return true;
+            db->gc_request = true;
         }
     } else if (kv->status == FDB_KV_PRE_WRITE) {
-        uint8_t status_table[KV_STATUS_TABLE_SIZE];
-        /* the KV has not write finish, change the status to error */
-        //TODO Draw the state replacement diagram of exception handling
-        _fdb_write_status((fdb_db_t)db, kv->addr.start, status_table, FDB_KV_STATUS_NUM, FDB_KV_ERR_HDR, true);
-        return true;
+        /* the KV has not write finish, or it's in a committed batch which is not found yet */
+        arg->pre_write_found = true;
+    } else if (kv->crc_is_ok && kv->status == FDB_KV_WRITE && kv->name_len == sizeof(BATCH_KV_NAME) - 1
+            && !strncmp(kv->name, BATCH_KV_NAME, kv->name_len)) {
+        arg->batch_addr = kv->addr.start;
     } else if (kv->crc_is_ok && kv->status == FDB_KV_WRITE) {
 #ifdef FDB_KV_USING_CACHE
         /* update the cache when first load. If caching is disabled, this step is not performed */
         update_kv_cache(db, kv->name, kv->name_len, kv->addr.start);
 #endif
+#ifdef FDB_KV_USING_INDEX
+        /* build the index when first load */
+        update_kv_index(db, kv->name, kv->name_len, kv->value_len, kv->addr.start);
+#endif /* FDB_KV_USING_INDEX */
+    }
+
+    return false;
+}
+
+static bool check_pre_write_kv_cb(fdb_kv_t kv, void *arg1, void *arg2)
+{
+    fdb_kvdb_t db = arg1;
+
+    if (kv->status == FDB_KV_PRE_WRITE) {
+        uint8_t status_table[KV_STATUS_TABLE_SIZE];
+        /* the KV has not write finish, change the status to error */
+        //TODO Draw the state replacement diagram of exception handling
+        _fdb_write_status((fdb_db_t)db, kv->addr.start, status_table, FDB_KV_STATUS_NUM, FDB_KV_ERR_HDR, true);
     }
 
     return false;
 }
 
+/*
+ * Finish the committed batch which is interrupted by power failure. It can be done again when interrupted.
+ */
+static void recovery_batch(fdb_kvdb_t db, uint32_t batch_addr)
+{
+    uint8_t status_table[KV_STATUS_TABLE_SIZE];
+    struct fdb_kv batch_kv, kv;
+    uint32_t buf[8];
+    size_t i, len, size;
+
+    FDB_INFO("Found an KV batch which has committed. Now will finish it.\n");
+    batch_kv.addr.start = batch_addr;
+    read_kv(db, &batch_kv);
+    for (len = 0; len < batch_kv.value_len; len += size) {
+        size = batch_kv.value_len - len < sizeof(buf) ? batch_kv.value_len - len : sizeof(buf);
+        _fdb_flash_read((fdb_db_t)db, batch_kv.addr.value + len, buf, size);
+        for (i = 0; i + 1 < size / sizeof(uint32_t); i += 2) {
+            /* delete the old KV */
+            if (buf[i + 1] != FAILED_ADDR) {
+                kv.addr.start = buf[i + 1];
+                read_kv(db, &kv);
+                if (kv.crc_is_ok && (kv.status == FDB_KV_WRITE || kv.status == FDB_KV_PRE_DELETE)) {
+                    del_kv(db, NULL, &kv, true);
+                }
+            }
+            /* change the new KV status to write */
+            if (buf[i] != FAILED_ADDR) {
+                kv.addr.start = buf[i];
+                read_kv(db, &kv);
+                if (kv.crc_is_ok && kv.status == FDB_KV_PRE_WRITE) {
+                    _fdb_write_status((fdb_db_t)db, kv.addr.start, status_table, FDB_KV_STATUS_NUM, FDB_KV_WRITE, true);
+                    kv.status = FDB_KV_WRITE;
+                }
+                if (kv.crc_is_ok && kv.status == FDB_KV_WRITE) {
+#ifdef FDB_KV_USING_CACHE
+                    update_kv_cache(db, kv.name, kv.name_len, kv.addr.start);
+#endif
+#ifdef FDB_KV_USING_INDEX
+                    update_kv_index(db, kv.name, kv.name_len, kv.value_len, kv.addr.start);
+#endif /* FDB_KV_USING_INDEX */
+                }
+            }
+        }
+    }
+    del_kv(db, NULL, &batch_kv, true);
+}
+
 /**
  * Check and load the flash KV.
  *
@@ -1638,7 +3239,14 @@ static fdb_err_t _fdb_kv_load(fdb_kvdb_t db)
     fdb_err_t result = FDB_NO_ERR;
     struct fdb_kv kv;
     struct kvdb_sec_info sector;
+    struct recovery_kv_cb_args arg;
     size_t check_failed_count = 0;
+    bool touched_only = false;
+
+#ifdef FDB_KV_USING_SNAPSHOT
+    /* the KVs in the sectors which are not written since the snapshot are loaded from it */
+    touched_only = db->snap_addr != FAILED_ADDR;
+#endif /* FDB_KV_USING_SNAPSHOT */
 
     db->in_recovery_check = true;
     /* check all sector header */
@@ -1657,13 +3265,25 @@ static fdb_err_t _fdb_kv_load(fdb_kvdb_t db)
 
 __retry:
     /* check all KV for recovery */
-    kv_iterator(db, &kv, db, NULL, check_and_recovery_kv_cb);
+    arg.batch_addr = FAILED_ADDR;
+    arg.pre_write_found = false;
+    kv_iterator_ex(db, &kv, db, &arg, check_and_recovery_kv_cb, touched_only);
+    /* the committed batch KVs are not written finish, they are finished before GC */
+    if (arg.batch_addr != FAILED_ADDR) {
+        recovery_batch(db, arg.batch_addr);
+    }
+    if (arg.pre_write_found) {
+        kv_iterator_ex(db, &kv, db, NULL, check_pre_write_kv_cb, touched_only);
+    }
     if (db->gc_request) {
         gc_collect(db);
         goto __retry;
     }
 
     db->in_recovery_check = false;
+#ifdef FDB_KV_USING_INDEX
+    db->kv_index_ok = !db->kv_index_full;
+#endif /* FDB_KV_USING_INDEX */
 
     return result;
 }
@@ -1729,6 +3349,43 @@ void fdb_kvdb_control(fdb_kvdb_t db, int cmd, void *arg)
         FDB_ASSERT(db->parent.init_ok == false);
         db->parent.not_formatable = *(bool *)arg;
         break;
+    case FDB_KVDB_CTRL_SET_SNAPSHOT:
+#ifdef FDB_KV_USING_SNAPSHOT
+        /* this change MUST before database initialization */
+        FDB_ASSERT(db->parent.init_ok == false);
+        db->snap_name = (const char *) arg;
+#else
+        FDB_INFO("Error: set snapshot Failed. Please set the FDB_KV_SNAPSHOT_SEC_NUM macro.");
+#endif
+        break;
+    case FDB_KVDB_CTRL_SET_RDLOCK:
+#ifdef FDB_USING_RW_LOCK
+#if !defined(__ARMCC_VERSION) && defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#endif
+        db->parent.rdlock = (void (*)(fdb_db_t db)) arg;
+#if !defined(__ARMCC_VERSION) && defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+#else
+        FDB_INFO("Error: set read lock Failed. Please defined the FDB_USING_RW_LOCK macro.");
+#endif
+        break;
+    case FDB_KVDB_CTRL_SET_RDUNLOCK:
+#ifdef FDB_USING_RW_LOCK
+#if !defined(__ARMCC_VERSION) && defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#endif
+        db->parent.rdunlock = (void (*)(fdb_db_t db)) arg;
+#if !defined(__ARMCC_VERSION) && defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+#else
+        FDB_INFO("Error: set read unlock Failed. Please defined the FDB_USING_RW_LOCK macro.");
+#endif
+        break;
     }
 }
 
@@ -1749,13 +3406,15 @@ fdb_err_t fdb_kvdb_init(fdb_kvdb_t db, const char *name, const char *path, struc
     fdb_err_t result = FDB_NO_ERR;
     struct kvdb_sec_info sector;
 
-#ifdef FDB_KV_USING_CACHE
-    size_t i;
-#endif
-
     /* must be aligned with write granularity */
     FDB_ASSERT((FDB_STR_KV_VALUE_MAX_SIZE * 8) % FDB_WRITE_GRAN == 0);
 
+#ifdef FDB_KV_USING_SNAPSHOT
+    /* nothing is marked on the snapshot until it's loaded */
+    db->snap_part = NULL;
+    db->snap_addr = FAILED_ADDR;
+#endif /* FDB_KV_USING_SNAPSHOT */
+
     result = _fdb_init_ex((fdb_db_t) db, name, path, FDB_DB_TYPE_KV, user_data);
     if (result != FDB_NO_ERR) {
         goto __exit;
@@ -1764,8 +3423,20 @@ fdb_err_t fdb_kvdb_init(fdb_kvdb_t db, const char *name, const char *path, struc
     /* lock the KVDB */
     db_lock(db);
 
+#ifdef FDB_KV_USING_SNAPSHOT
+    kv_snapshot_init(db);
+#endif /* FDB_KV_USING_SNAPSHOT */
+
     db->gc_request = false;
     db->in_recovery_check = false;
+#ifdef FDB_KV_USING_GC_STEP
+    db->gc_step_sec = FAILED_ADDR;
+    db->gc_step_kv = FAILED_ADDR;
+    db->gc_step_on = false;
+#ifdef FDB_KV_USING_WEAR_LEVEL
+    db->gc_step_cold = false;
+#endif
+#endif /* FDB_KV_USING_GC_STEP */
     if (default_kv) {
         db->default_kvs = *default_kv;
     } else {
@@ -1785,17 +3456,27 @@ fdb_err_t fdb_kvdb_init(fdb_kvdb_t db, const char *name, const char *path, struc
     }
     /* there is at least one empty sector for GC. */
     FDB_ASSERT((FDB_GC_EMPTY_SEC_THRESHOLD > 0 && FDB_GC_EMPTY_SEC_THRESHOLD < SECTOR_NUM))
+#ifdef FDB_KV_USING_GC_STEP
+    /* the GC by steps starts before the GC when saving a KV */
+    FDB_ASSERT((FDB_KV_GC_LOW_WATERMARK > FDB_GC_EMPTY_SEC_THRESHOLD + 1))
+    if (FDB_KV_GC_HIGH_WATERMARK >= SECTOR_NUM) {
+        FDB_INFO("Warning: KV (%s) has no more sectors than the GC high watermark, the GC by steps is disabled.\n",
+                db_name(db));
+    }
+#endif
 
 #ifdef FDB_KV_USING_CACHE
-    for (i = 0; i < FDB_SECTOR_CACHE_TABLE_SIZE; i++) {
-        db->sector_cache_table[i].check_ok = false;
-        db->sector_cache_table[i].empty_kv = FAILED_ADDR;
-        db->sector_cache_table[i].addr = FDB_DATA_UNUSED;
-    }
-    for (i = 0; i < FDB_KV_CACHE_TABLE_SIZE; i++) {
-        db->kv_cache_table[i].addr = FDB_DATA_UNUSED;
-    }
+    reset_kv_cache(db);
 #endif /* FDB_KV_USING_CACHE */
+#ifdef FDB_KV_USING_INDEX
+    db->kv_index_ok = false;
+    reset_kv_index(db);
+#endif /* FDB_KV_USING_INDEX */
+#ifdef FDB_KV_USING_SNAPSHOT
+    if (db->snap_part) {
+        kv_snapshot_load(db);
+    }
+#endif /* FDB_KV_USING_SNAPSHOT */
 
     FDB_DEBUG("KVDB size is %" PRIu32 " bytes.\n", db_max_size(db));
     db_unlock(db);
@@ -1826,8 +3507,62 @@ __exit:
  *
  * @return result
  */
+#ifdef FDB_USING_ERASE_COUNT
+static bool erase_stat_cb(kv_sec_info_t sector, void *arg1, void *arg2)
+{
+    fdb_erase_stat_t stat = arg1;
+    uint32_t count = sector->check_ok ? sector->erase_count : 0;
+
+    if (stat->sec_num == 0 || count < stat->min) {
+        stat->min = count;
+    }
+    if (count > stat->max) {
+        stat->max = count;
+    }
+    stat->total += count;
+    stat->sec_num++;
+
+    return false;
+}
+
+/**
+ * Get the erase count statistics of the KVDB sectors.
+ *
+ * @param db database object
+ * @param stat the statistics
+ *
+ * @return result
+ */
+fdb_err_t fdb_kvdb_erase_stat(fdb_kvdb_t db, fdb_erase_stat_t stat)
+{
+    struct kvdb_sec_info sector;
+
+    if (!db_init_ok(db)) {
+        FDB_INFO("Error: KV (%s) isn't initialize OK.\n", db_name(db));
+        return FDB_INIT_FAILED;
+    }
+
+    db_rdlock(db);
+
+    memset(stat, 0, sizeof(struct fdb_erase_stat));
+    sector_iterator(db, &sector, FDB_SECTOR_STORE_UNUSED, stat, NULL, erase_stat_cb, false);
+    stat->session = db->parent.erase_num;
+
+    db_rdunlock(db);
+
+    return FDB_NO_ERR;
+}
+#endif /* FDB_USING_ERASE_COUNT */
+
 fdb_err_t fdb_kvdb_deinit(fdb_kvdb_t db)
 {
+#ifdef FDB_KV_USING_SNAPSHOT
+    /* the next load only scans the sectors written since now */
+    if (db_init_ok(db)) {
+        fdb_kv_snapshot(db);
+    }
+#endif /* FDB_KV_USING_SNAPSHOT */
+
     _fdb_deinit((fdb_db_t) db);
 
     return FDB_NO_ERR;
@@ -1855,15 +3590,7 @@ fdb_kv_iterator_t fdb_kv_iterator_init(fdb_kvdb_t db, fdb_kv_iterator_t itr)
     return itr;
 }
 
-/**
- * The KV database iterator.
- *
- * @param db database object
- * @param itr the iterator structure
- *
- * @return false if iteration is ended, true if iteration is not ended.
- */
-bool fdb_kv_iterate(fdb_kvdb_t db, fdb_kv_iterator_t itr)
+static bool kv_iterate(fdb_kvdb_t db, fdb_kv_iterator_t itr)
 {
     struct kvdb_sec_info sector;
     fdb_kv_t kv = &(itr->curr_kv);
@@ -1901,6 +3628,30 @@ bool fdb_kv_iterate(fdb_kvdb_t db, fdb_kv_iterator_t itr)
     return false;
 }
 
+/**
+ * The KV database iterator.
+ *
+ * @param db database object
+ * @param itr the iterator structure
+ *
+ * @return false if iteration is ended, true if iteration is not ended.
+ */
+bool fdb_kv_iterate(fdb_kvdb_t db, fdb_kv_iterator_t itr)
+{
+#ifdef FDB_USING_RW_LOCK
+    bool result;
+
+    /* the readers iterate together, the writers can go between the steps */
+    db_rdlock(db);
+    result = kv_iterate(db, itr);
+    db_rdunlock(db);
+
+    return result;
+#else
+    return kv_iterate(db, itr);
+#endif
+}
+
 /**
  * The database inergrity check
  *
@@ -45,6 +45,7 @@
 #define SECTOR_END1_TIME_OFFSET                  ((unsigned long)(&((struct sector_hdr_data *)0)->end_info[1].time))
 #define SECTOR_END1_IDX_OFFSET                   ((unsigned long)(&((struct sector_hdr_data *)0)->end_info[1].index))
 #define SECTOR_END1_STATUS_OFFSET                ((unsigned long)(&((struct sector_hdr_data *)0)->end_info[1].status))
+#define SECTOR_RESERVED_OFFSET                   ((unsigned long)(&((struct sector_hdr_data *)0)->reserved))
 
 /* the next address is get failed */
 #define FAILED_ADDR                              0xFFFFFFFF
@@ -55,11 +56,34 @@
 #define db_max_size(db)                          (((fdb_db_t)db)->max_size)
 #define db_oldest_addr(db)                       (((fdb_db_t)db)->oldest_addr)
 
+#ifdef FDB_USING_RW_LOCK
 #define db_lock(db)                                                            \
     do {                                                                       \
         if (((fdb_db_t)db)->lock) ((fdb_db_t)db)->lock((fdb_db_t)db);          \
+        ((fdb_db_t)db)->rd_locked = false;                                     \
     } while(0);
 
+#define db_rdlock(db)                                                          \
+    do {                                                                       \
+        ((fdb_db_t)db)->rdlock((fdb_db_t)db);                                  \
+        ((fdb_db_t)db)->rd_locked = true;                                      \
+    } while(0);
+
+#define db_rdunlock(db)                                                        \
+    do {                                                                       \
+        ((fdb_db_t)db)->rdunlock((fdb_db_t)db);                                \
+    } while(0);
+
+#define db_rd_locked(db)                         (((fdb_db_t)db)->rd_locked)
+#else
+#define db_lock(db)                                                            \
+    do {                                                                       \
+        if (((fdb_db_t)db)->lock) ((fdb_db_t)db)->lock((fdb_db_t)db);          \
+    } while(0);
+
+#define db_rd_locked(db)                         false
+#endif /* FDB_USING_RW_LOCK */
+
 #define db_unlock(db)                                                          \
     do {                                                                       \
         if (((fdb_db_t)db)->unlock) ((fdb_db_t)db)->unlock((fdb_db_t)db);      \
@@ -104,6 +128,13 @@ struct query_count_args {
     size_t count;
 };
 
+#ifdef FDB_TSDB_USING_SUMMARY
+struct query_agg_args {
+    fdb_tsdb_t db;
+    fdb_tsl_agg_t agg;
+};
+#endif
+
 struct check_sec_hdr_cb_args {
     fdb_tsdb_t db;
     bool check_failed;
@@ -111,11 +142,192 @@ struct check_sec_hdr_cb_args {
     uint32_t empty_addr;
 };
 
-static fdb_err_t read_tsl(fdb_tsdb_t db, fdb_tsl_t tsl)
+#ifdef FDB_TSDB_USING_READ_AHEAD
+static void reset_read_ahead(fdb_tsdb_t db)
+{
+    db->ra_addr = FDB_DATA_UNUSED;
+    db->ra_len = 0;
+}
+
+static bool read_ahead_hit(fdb_tsdb_t db, uint32_t addr)
+{
+    return db->ra_addr != FDB_DATA_UNUSED && addr >= db->ra_addr
+            && addr + sizeof(struct log_idx_data) <= db->ra_addr + db->ra_len;
+}
+
+/*
+ * Fill the read-ahead buffer with the TSL indexes from the address, or before it when iterating backward. The
+ * buffer is kept inside the sector of the address.
+ */
+static void fill_read_ahead(fdb_tsdb_t db, uint32_t addr, bool backward)
+{
+    uint32_t sec_addr = addr - addr % db_sec_size(db), len = sizeof(db->ra_buf);
+    uint32_t top = sec_addr + SECTOR_HDR_DATA_SIZE, bottom = sec_addr + db_sec_size(db);
+
+    if (backward) {
+        addr = addr + LOG_IDX_DATA_SIZE >= top + len ? addr + LOG_IDX_DATA_SIZE - len : top;
+    }
+    if (addr + len > bottom) {
+        len = bottom - addr;
+    }
+    _fdb_flash_read((fdb_db_t)db, addr, db->ra_buf, len);
+    db->ra_addr = addr;
+    db->ra_len = len;
+}
+#endif /* FDB_TSDB_USING_READ_AHEAD */
+
+#ifdef FDB_TSDB_USING_APPEND_BUF
+#if (FDB_WRITE_GRAN != 1)
+#error "The TSL append buffer only supports the flash which write granularity is 1 bit"
+#endif
+#if FDB_TSDB_APPEND_BUF_SIZE % 4 != 0
+#error "FDB_TSDB_APPEND_BUF_SIZE must be a multiple of 4"
+#endif
+
+#define APPEND_PAGE_ADDR(addr)                   ((addr) - (addr) % FDB_TSDB_APPEND_BUF_SIZE)
+
+static void reset_append_buf(fdb_tsdb_t db)
+{
+    db->ab_idx_len = 0;
+    db->ab_data_len = 0;
+}
+
+static fdb_err_t flush_append_data(fdb_tsdb_t db)
+{
+    fdb_err_t result = FDB_NO_ERR;
+
+    if (db->ab_data_len > 0) {
+        result = _fdb_flash_write((fdb_db_t)db, db->ab_data_addr,
+                (uint8_t *)db->ab_data + db->ab_data_addr % FDB_TSDB_APPEND_BUF_SIZE, db->ab_data_len, false);
+        db->ab_data_len = 0;
+    }
+
+    return result;
+}
+
+static fdb_err_t write_append_idx(fdb_tsdb_t db, fdb_tsl_status_t status)
+{
+    uint32_t i;
+
+    for (i = 0; i < db->ab_idx_len; i += LOG_IDX_DATA_SIZE) {
+        _fdb_set_status((uint8_t *)db->ab_idx + i, FDB_TSL_STATUS_NUM, status);
+    }
+
+    return _fdb_flash_write((fdb_db_t)db, db->ab_idx_addr, db->ab_idx, db->ab_idx_len, status == FDB_TSL_WRITE);
+}
+
+/*
+ * Flush the staged TSLs. The data is programmed first, then the indexes as pre-write and at last as write, the
+ * same two steps as a single TSL, so a power down never leaves a written index to a partial TSL.
+ */
+static fdb_err_t flush_append_buf(fdb_tsdb_t db)
+{
+    fdb_err_t result = flush_append_data(db);
+
+    if (result == FDB_NO_ERR && db->ab_idx_len > 0) {
+#ifdef FDB_TSDB_USING_READ_AHEAD
+        /* the buffer may hold these unused indexes */
+        reset_read_ahead(db);
+#endif
+        result = write_append_idx(db, FDB_TSL_PRE_WRITE);
+        if (result == FDB_NO_ERR) {
+            result = write_append_idx(db, FDB_TSL_WRITE);
+        }
+    }
+    db->ab_idx_len = 0;
+
+    return result;
+}
+
+/*
+ * Stage the TSL data. It's saved downward, so it's staged from the top page to the bottom page, the data page is
+ * programmed when the next data is out of it.
+ */
+static fdb_err_t stage_append_data(fdb_tsdb_t db, uint32_t addr, const uint8_t *buf, size_t size)
+{
+    fdb_err_t result = FDB_NO_ERR;
+    uint32_t end = addr + size, page, start;
+
+    while (end > addr) {
+        page = APPEND_PAGE_ADDR(end - 1);
+        start = page > addr ? page : addr;
+        if (db->ab_data_len > 0 && (end != db->ab_data_addr || page != APPEND_PAGE_ADDR(db->ab_data_addr))) {
+            result = flush_append_data(db);
+            if (result != FDB_NO_ERR) {
+                return result;
+            }
+        }
+        memcpy((uint8_t *)db->ab_data + start % FDB_TSDB_APPEND_BUF_SIZE, buf + (start - addr), end - start);
+        db->ab_data_addr = start;
+        db->ab_data_len += end - start;
+        /* the next data is in the page below */
+        if (start == page) {
+            result = flush_append_data(db);
+            if (result != FDB_NO_ERR) {
+                return result;
+            }
+        }
+        end = start;
+    }
+
+    return result;
+}
+
+/*
+ * Stage the TSL index, the staged TSLs are flushed when the index reaches the page end.
+ */
+static fdb_err_t stage_append_idx(fdb_tsdb_t db, uint32_t addr, log_idx_data_t idx)
+{
+    fdb_err_t result = FDB_NO_ERR;
+
+    if (db->ab_idx_len > 0 && (addr != db->ab_idx_addr + db->ab_idx_len
+            || db->ab_idx_len + LOG_IDX_DATA_SIZE > sizeof(db->ab_idx))) {
+        result = flush_append_buf(db);
+        if (result != FDB_NO_ERR) {
+            return result;
+        }
+    }
+    if (db->ab_idx_len == 0) {
+        db->ab_idx_addr = addr;
+        db->ab_time = idx->time;
+    }
+    memcpy((uint8_t *)db->ab_idx + db->ab_idx_len, idx, LOG_IDX_DATA_SIZE);
+    db->ab_idx_len += LOG_IDX_DATA_SIZE;
+    if (addr % FDB_TSDB_APPEND_BUF_SIZE + LOG_IDX_DATA_SIZE >= FDB_TSDB_APPEND_BUF_SIZE) {
+        result = flush_append_buf(db);
+    }
+
+    return result;
+}
+
+/*
+ * The staged TSLs are expired when the first one is older than the flush deadline.
+ */
+static bool append_buf_expired(fdb_tsdb_t db, fdb_time_t cur_time)
+{
+    return db->ab_idx_len > 0 && db->flush_deadline > 0 && cur_time - db->ab_time >= db->flush_deadline;
+}
+#endif /* FDB_TSDB_USING_APPEND_BUF */
+
+/*
+ * Read the TSL index, the read-ahead buffer is filled when it's missed and read_ahead is true.
+ */
+static fdb_err_t read_tsl_ex(fdb_tsdb_t db, fdb_tsl_t tsl, bool read_ahead)
 {
     struct log_idx_data idx;
-    /* read TSL index raw data */
-    _fdb_flash_read((fdb_db_t)db, tsl->addr.index, (uint32_t *) &idx, sizeof(struct log_idx_data));
+
+#ifdef FDB_TSDB_USING_READ_AHEAD
+    if (read_ahead && !db_rd_locked(db) && !read_ahead_hit(db, tsl->addr.index)) {
+        fill_read_ahead(db, tsl->addr.index, db->ra_addr != FDB_DATA_UNUSED && tsl->addr.index < db->ra_addr);
+    }
+    if (read_ahead_hit(db, tsl->addr.index)) {
+        memcpy(&idx, (uint8_t *)db->ra_buf + (tsl->addr.index - db->ra_addr), sizeof(struct log_idx_data));
+    } else
+#endif /* FDB_TSDB_USING_READ_AHEAD */
+    {
+        /* read TSL index raw data */
+        _fdb_flash_read((fdb_db_t)db, tsl->addr.index, (uint32_t *) &idx, sizeof(struct log_idx_data));
+    }
     tsl->status = (fdb_tsl_status_t) _fdb_get_status(idx.status_table, FDB_TSL_STATUS_NUM);
     if ((tsl->status == FDB_TSL_PRE_WRITE) || (tsl->status == FDB_TSL_UNUSED)) {
         tsl->log_len = db->max_len;
@@ -130,6 +342,11 @@ static fdb_err_t read_tsl(fdb_tsdb_t db, fdb_tsl_t tsl)
     return FDB_NO_ERR;
 }
 
+static fdb_err_t read_tsl(fdb_tsdb_t db, fdb_tsl_t tsl)
+{
+    return read_tsl_ex(db, tsl, true);
+}
+
 static uint32_t get_next_sector_addr(fdb_tsdb_t db, tsdb_sec_info_t pre_sec, uint32_t traversed_len)
 {
     if (traversed_len + db_sec_size(db) <= db_max_size(db)) {
@@ -214,6 +431,12 @@ static fdb_err_t read_sector_info(fdb_tsdb_t db, uint32_t addr, tsdb_sec_info_t
         return FDB_INIT_FAILED;
     }
     sector->check_ok = true;
+#ifdef FDB_USING_ERASE_COUNT
+    sector->erase_count = sec_hdr.reserved == FDB_DATA_UNUSED ? 0 : sec_hdr.reserved;
+    if (sector->erase_count > db->parent.erase_max && !db_rd_locked(db)) {
+        db->parent.erase_max = sector->erase_count;
+    }
+#endif
     sector->status = (fdb_sector_store_status_t) _fdb_get_status(sec_hdr.status, FDB_SECTOR_STORE_STATUS_NUM);
     sector->start_time = sec_hdr.start_time;
     sector->end_info_stat[0] = (fdb_tsl_status_t) _fdb_get_status(sec_hdr.end_info[0].status, FDB_TSL_STATUS_NUM);
@@ -260,6 +483,191 @@ static fdb_err_t read_sector_info(fdb_tsdb_t db, uint32_t addr, tsdb_sec_info_t
     return result;
 }
 
+#ifdef FDB_TSDB_USING_SEC_INDEX
+static void update_sec_index(fdb_tsdb_t db, tsdb_sec_info_t sector)
+{
+    tsdb_sec_index_node_t node;
+
+    if (!db->sec_index_ok || sector->addr >= db_max_size(db)) {
+        return;
+    }
+
+    node = &db->sec_index_table[sector->addr / db_sec_size(db)];
+    node->status = sector->status;
+    node->start_time = sector->start_time;
+    node->end_time = sector->end_time;
+    if (sector->status == FDB_SECTOR_STORE_USING) {
+        node->count = (sector->empty_idx - sector->addr - SECTOR_HDR_DATA_SIZE) / LOG_IDX_DATA_SIZE;
+    } else if (sector->status == FDB_SECTOR_STORE_FULL) {
+        node->count = (sector->end_idx - sector->addr - SECTOR_HDR_DATA_SIZE) / LOG_IDX_DATA_SIZE + 1;
+    } else {
+        node->count = 0;
+    }
+}
+
+/*
+ * Search the first sector to iterate by time in the sector index. The sectors from the oldest to the current are
+ * sorted by time, so it's the first one which ends at or after the starting timestamp, or the last one which starts
+ * at or before it for a reverse iterator.
+ *
+ * @return false when the index can't be used, otherwise the sector address and the traversed length before it are
+ *         returned, the address is FAILED_ADDR when no sector is matched.
+ */
+static bool search_start_sector(fdb_tsdb_t db, fdb_time_t from, fdb_time_t to, uint32_t *sec_addr,
+        uint32_t *traversed_len)
+{
+    uint32_t sec_num = db_max_size(db) / db_sec_size(db), oldest, cur, num, low, high, mid;
+    tsdb_sec_index_node_t node;
+
+    if (!db->sec_index_ok || db->cur_sec.addr >= db_max_size(db) || db_oldest_addr(db) >= db_max_size(db)) {
+        return false;
+    }
+    oldest = db_oldest_addr(db) / db_sec_size(db);
+    cur = db->cur_sec.addr / db_sec_size(db);
+    if (db->sec_index_table[cur].count == 0) {
+        /* the current sector has no TSL yet, iterate as before */
+        return false;
+    }
+    num = (cur + sec_num - oldest) % sec_num + 1;
+
+    /* search in [low, high), the result is low */
+    low = 0;
+    high = num;
+    while (low < high) {
+        mid = low + (high - low) / 2;
+        node = &db->sec_index_table[(oldest + mid) % sec_num];
+        if (node->count == 0) {
+            /* the sector is out of order */
+            return false;
+        }
+        if ((from <= to && node->end_time < from) || (from > to && node->start_time <= from)) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+
+    if (from <= to) {
+        if (low == num) {
+            *sec_addr = FAILED_ADDR;
+        } else {
+            *sec_addr = (oldest + low) % sec_num * db_sec_size(db);
+            *traversed_len = low * db_sec_size(db);
+        }
+    } else {
+        if (low == 0) {
+            *sec_addr = FAILED_ADDR;
+        } else {
+            /* the reverse iterator starts at the current sector */
+            *sec_addr = (oldest + low - 1) % sec_num * db_sec_size(db);
+            *traversed_len = (num - low) * db_sec_size(db);
+        }
+    }
+
+    return true;
+}
+#endif /* FDB_TSDB_USING_SEC_INDEX */
+
+#ifdef FDB_TSDB_USING_SUMMARY
+static double tsl_value(fdb_tsdb_t db, fdb_tsl_value_t value)
+{
+    return db->value_type == FDB_TSL_VALUE_FLOAT ? (double)value.f32 : (double)value.i32;
+}
+
+/* the value is aggregated unless it's a NaN */
+static bool tsl_value_ok(fdb_tsdb_t db, fdb_tsl_value_t value)
+{
+    return db->value_type != FDB_TSL_VALUE_FLOAT || value.f32 == value.f32;
+}
+
+/*
+ * Read the value of a TSL. The TSLs which status is FDB_TSL_DELETED or later aren't aggregated.
+ */
+static bool read_tsl_value(fdb_tsdb_t db, fdb_tsl_t tsl, fdb_tsl_value_t *value)
+{
+    if (tsl->status < FDB_TSL_WRITE || tsl->status >= FDB_TSL_DELETED || tsl->log_len < sizeof(fdb_tsl_value_t)) {
+        return false;
+    }
+    _fdb_flash_read((fdb_db_t)db, tsl->addr.log, (uint32_t *)value, sizeof(fdb_tsl_value_t));
+
+    return tsl_value_ok(db, *value);
+}
+
+static void agg_add(fdb_tsl_agg_t agg, double value)
+{
+    if (agg->count == 0 || value < agg->min) {
+        agg->min = value;
+    }
+    if (agg->count == 0 || value > agg->max) {
+        agg->max = value;
+    }
+    agg->sum += value;
+    agg->count++;
+}
+
+static void agg_merge_sec(fdb_tsdb_t db, fdb_tsl_agg_t agg, tsdb_sec_index_node_t node)
+{
+    if (node->val_num == 0) {
+        return;
+    }
+    if (agg->count == 0 || tsl_value(db, node->val_min) < agg->min) {
+        agg->min = tsl_value(db, node->val_min);
+    }
+    if (agg->count == 0 || tsl_value(db, node->val_max) > agg->max) {
+        agg->max = tsl_value(db, node->val_max);
+    }
+    agg->sum += node->val_sum;
+    agg->count += node->val_num;
+}
+
+static void sec_summary_add(fdb_tsdb_t db, tsdb_sec_index_node_t node, fdb_tsl_value_t value)
+{
+    double val = tsl_value(db, value);
+
+    if (node->val_num == 0 || val < tsl_value(db, node->val_min)) {
+        node->val_min = value;
+    }
+    if (node->val_num == 0 || val > tsl_value(db, node->val_max)) {
+        node->val_max = value;
+    }
+    node->val_sum += val;
+    node->val_num++;
+}
+
+/*
+ * Reset the sector summary, it's up to date for an empty sector, otherwise it's built by the next aggregate query.
+ */
+static void reset_sec_summary(fdb_tsdb_t db, uint32_t addr, bool ok)
+{
+    tsdb_sec_index_node_t node;
+
+    if (!db->sec_index_ok || addr >= db_max_size(db)) {
+        return;
+    }
+
+    node = &db->sec_index_table[addr / db_sec_size(db)];
+    node->val_ok = ok;
+    node->val_num = 0;
+    node->val_sum = 0;
+}
+
+static void update_sec_summary(fdb_tsdb_t db, tsdb_sec_info_t sector, fdb_blob_t blob)
+{
+    tsdb_sec_index_node_t node;
+    fdb_tsl_value_t value;
+
+    if (db->value_type == FDB_TSL_VALUE_NONE || !db->sec_index_ok || sector->addr >= db_max_size(db)) {
+        return;
+    }
+
+    node = &db->sec_index_table[sector->addr / db_sec_size(db)];
+    memcpy(&value, blob->buf, sizeof(fdb_tsl_value_t));
+    if (node->val_ok && tsl_value_ok(db, value)) {
+        sec_summary_add(db, node, value);
+    }
+}
+#endif /* FDB_TSDB_USING_SUMMARY */
+
 static fdb_err_t format_sector(fdb_tsdb_t db, uint32_t addr)
 {
     fdb_err_t result = FDB_NO_ERR;
@@ -267,12 +675,34 @@ static fdb_err_t format_sector(fdb_tsdb_t db, uint32_t addr)
 
     FDB_ASSERT(addr % db_sec_size(db) == 0);
 
+#ifdef FDB_TSDB_USING_READ_AHEAD
+    reset_read_ahead(db);
+#endif
+#ifdef FDB_USING_ERASE_COUNT
+    /* the erase count is carried over from the old header */
+    _fdb_flash_read((fdb_db_t)db, addr, (uint32_t *)&sec_hdr, sizeof(struct sector_hdr_data));
+    sec_hdr.reserved = _fdb_next_erase_count((fdb_db_t)db, sec_hdr.magic == SECTOR_MAGIC_WORD, sec_hdr.reserved);
+#endif
+
     result = _fdb_flash_erase((fdb_db_t)db, addr, db_sec_size(db));
     if (result == FDB_NO_ERR) {
         _FDB_WRITE_STATUS(db, addr, sec_hdr.status, FDB_SECTOR_STORE_STATUS_NUM, FDB_SECTOR_STORE_EMPTY, true);
+#ifdef FDB_USING_ERASE_COUNT
+        /* the count is written before the magic, a sector is never valid without it */
+        FLASH_WRITE(db, addr + SECTOR_RESERVED_OFFSET, &sec_hdr.reserved, sizeof(sec_hdr.reserved), true);
+#endif
         /* set the magic */
         sec_hdr.magic = SECTOR_MAGIC_WORD;
         FLASH_WRITE(db, addr + SECTOR_MAGIC_OFFSET, &sec_hdr.magic, sizeof(sec_hdr.magic), true);
+#ifdef FDB_TSDB_USING_SEC_INDEX
+        if (db->sec_index_ok) {
+            db->sec_index_table[addr / db_sec_size(db)].status = FDB_SECTOR_STORE_EMPTY;
+            db->sec_index_table[addr / db_sec_size(db)].count = 0;
+        }
+#endif
+#ifdef FDB_TSDB_USING_SUMMARY
+        reset_sec_summary(db, addr, true);
+#endif
     }
 
     return result;
@@ -305,9 +735,25 @@ static fdb_err_t write_tsl(fdb_tsdb_t db, fdb_blob_t blob, fdb_time_t time)
     struct log_idx_data idx;
     uint32_t idx_addr = db->cur_sec.empty_idx;
 
+#ifdef FDB_TSDB_USING_APPEND_BUF
+    memset(&idx, FDB_BYTE_ERASED, sizeof(idx));
+#endif
     idx.log_len = blob->size;
     idx.time = time;
     idx.log_addr = db->cur_sec.empty_data - FDB_WG_ALIGN(idx.log_len);
+#ifdef FDB_TSDB_USING_APPEND_BUF
+    /* the TSL is staged, then flushed with the others in the page */
+    result = stage_append_data(db, idx.log_addr, blob->buf, blob->size);
+    if (result == FDB_NO_ERR) {
+        result = stage_append_idx(db, idx_addr, &idx);
+    }
+    return result;
+#else
+
+#ifdef FDB_TSDB_USING_READ_AHEAD
+    /* the buffer may hold this unused index */
+    reset_read_ahead(db);
+#endif
     /* write the status will by write granularity */
     _FDB_WRITE_STATUS(db, idx_addr, idx.status_table, FDB_TSL_STATUS_NUM, FDB_TSL_PRE_WRITE, false);
     /* write other index info */
@@ -318,6 +764,7 @@ static fdb_err_t write_tsl(fdb_tsdb_t db, fdb_blob_t blob, fdb_time_t time)
     _FDB_WRITE_STATUS(db, idx_addr, idx.status_table, FDB_TSL_STATUS_NUM, FDB_TSL_WRITE, true);
 
     return result;
+#endif /* FDB_TSDB_USING_APPEND_BUF */
 }
 
 static fdb_err_t update_sec_status(fdb_tsdb_t db, tsdb_sec_info_t sector, fdb_blob_t blob, fdb_time_t cur_time)
@@ -328,6 +775,13 @@ static fdb_err_t update_sec_status(fdb_tsdb_t db, tsdb_sec_info_t sector, fdb_bl
     if (sector->status == FDB_SECTOR_STORE_USING && sector->remain < LOG_IDX_DATA_SIZE + FDB_WG_ALIGN(blob->size)) {
         uint8_t end_status[TSL_STATUS_TABLE_SIZE];
         uint32_t end_index = sector->empty_idx - LOG_IDX_DATA_SIZE, new_sec_addr, cur_sec_addr = sector->addr;
+#ifdef FDB_TSDB_USING_APPEND_BUF
+        /* the end node is saved after the staged TSLs */
+        result = flush_append_buf(db);
+        if (result != FDB_NO_ERR) {
+            return result;
+        }
+#endif
         /* save the end node index and timestamp */
         if (sector->end_info_stat[0] == FDB_TSL_UNUSED) {
             _FDB_WRITE_STATUS(db, cur_sec_addr + SECTOR_END0_STATUS_OFFSET, end_status, FDB_TSL_STATUS_NUM, FDB_TSL_PRE_WRITE, false);
@@ -343,6 +797,9 @@ static fdb_err_t update_sec_status(fdb_tsdb_t db, tsdb_sec_info_t sector, fdb_bl
         /* change current sector to full */
         _FDB_WRITE_STATUS(db, cur_sec_addr, status, FDB_SECTOR_STORE_STATUS_NUM, FDB_SECTOR_STORE_FULL, true);
         sector->status = FDB_SECTOR_STORE_FULL;
+#ifdef FDB_TSDB_USING_SEC_INDEX
+        update_sec_index(db, sector);
+#endif
         /* calculate next sector address */
         if (sector->addr + db_sec_size(db) < db_max_size(db)) {
             new_sec_addr = sector->addr + db_sec_size(db);
@@ -394,6 +851,14 @@ static fdb_err_t tsl_append(fdb_tsdb_t db, fdb_blob_t blob, fdb_time_t *timestam
         return FDB_WRITE_ERR;
     }
 
+#ifdef FDB_TSDB_USING_SUMMARY
+    if (db->value_type != FDB_TSL_VALUE_NONE && blob->size < sizeof(fdb_tsl_value_t)) {
+        FDB_INFO("Warning: append length (%" PRIdMAX ") is less than the TSL value. This tsl will be dropped.\n",
+                (intmax_t)blob->size);
+        return FDB_WRITE_ERR;
+    }
+#endif
+
     /* check the current timestamp, MUST more than the last save timestamp */
     if (cur_time <= db->last_time) {
         FDB_INFO("Warning: current timestamp (%" PRIdMAX ") is less than or equal to the last save timestamp (%" PRIdMAX "). This tsl will be dropped.\n",
@@ -420,6 +885,17 @@ static fdb_err_t tsl_append(fdb_tsdb_t db, fdb_blob_t blob, fdb_time_t *timestam
     db->cur_sec.empty_data -= FDB_WG_ALIGN(blob->size);
     db->cur_sec.remain -= LOG_IDX_DATA_SIZE + FDB_WG_ALIGN(blob->size);
     db->last_time = cur_time;
+#ifdef FDB_TSDB_USING_SEC_INDEX
+    update_sec_index(db, &db->cur_sec);
+#endif
+#ifdef FDB_TSDB_USING_SUMMARY
+    update_sec_summary(db, &db->cur_sec, blob);
+#endif
+#ifdef FDB_TSDB_USING_APPEND_BUF
+    if (append_buf_expired(db, cur_time)) {
+        result = flush_append_buf(db);
+    }
+#endif
 
     return result;
 }
@@ -473,57 +949,161 @@ fdb_err_t fdb_tsl_append_with_ts(fdb_tsdb_t db, fdb_blob_t blob, fdb_time_t time
 }
 
 /**
- * The TSDB iterator for each TSL.
+ * Flush the TSLs staged in the append buffer to flash. Call it on power fail or before power down, the staged TSLs
+ * are lost otherwise. It does nothing when the append buffer is disabled.
  *
  * @param db database object
- * @param cb callback
- * @param arg callback argument
+ *
+ * @return result
  */
-void fdb_tsl_iter(fdb_tsdb_t db, fdb_tsl_cb cb, void *arg)
+fdb_err_t fdb_tsl_flush(fdb_tsdb_t db)
 {
-    struct tsdb_sec_info sector;
-    uint32_t sec_addr, traversed_len = 0;
-    struct fdb_tsl tsl;
+    fdb_err_t result = FDB_NO_ERR;
 
     if (!db_init_ok(db)) {
         FDB_INFO("Error: TSL (%s) isn't initialize OK.\n", db_name(db));
+        return FDB_INIT_FAILED;
     }
 
-    if (cb == NULL) {
-        return;
-    }
-
-    sec_addr = db_oldest_addr(db);
-	db_lock(db);
-    /* search all sectors */
-    do {
-        traversed_len += db_sec_size(db);
-        if (read_sector_info(db, sec_addr, &sector, false) != FDB_NO_ERR) {
-            continue;
-        }
-        /* sector has TSL */
-        if (sector.status == FDB_SECTOR_STORE_USING || sector.status == FDB_SECTOR_STORE_FULL) {
-            if (sector.status == FDB_SECTOR_STORE_USING) {
-                /* copy the current using sector status  */
-                sector = db->cur_sec;
-            }
-            tsl.addr.index = sector.addr + SECTOR_HDR_DATA_SIZE;
-            /* search all TSL */
-            do {
-                read_tsl(db, &tsl);
-                /* iterator is interrupted when callback return true */
-                if (cb(&tsl, arg)) {
-                    db_unlock(db);
-                    return;
-                }
-            } while ((tsl.addr.index = get_next_tsl_addr(&sector, &tsl)) != FAILED_ADDR);
-        }
-    } while ((sec_addr = get_next_sector_addr(db, &sector, traversed_len)) != FAILED_ADDR);
+#ifdef FDB_TSDB_USING_APPEND_BUF
+    db_lock(db);
+    result = flush_append_buf(db);
     db_unlock(db);
+#endif
+
+    return result;
 }
 
 /**
- * The TSDB iterator for each TSL.
+ * Flush the staged TSLs when the first one is older than the flush deadline by the current time, see
+ * FDB_TSDB_CTRL_SET_FLUSH_DEADLINE. Call it periodically, e.g. by a timer, when the TSLs are appended seldom.
+ *
+ * @param db database object
+ *
+ * @return result
+ */
+fdb_err_t fdb_tsl_flush_expired(fdb_tsdb_t db)
+{
+    fdb_err_t result = FDB_NO_ERR;
+
+    if (!db_init_ok(db)) {
+        FDB_INFO("Error: TSL (%s) isn't initialize OK.\n", db_name(db));
+        return FDB_INIT_FAILED;
+    }
+
+#ifdef FDB_TSDB_USING_APPEND_BUF
+    db_lock(db);
+    if (append_buf_expired(db, db->get_time())) {
+        result = flush_append_buf(db);
+    }
+    db_unlock(db);
+#endif
+
+    return result;
+}
+
+/*
+ * Lock the TSDB for a query. The queries share the database by the read lock when share is true, unless the staged
+ * TSLs are flushed first by the writer. It's return true when the read lock is hold.
+ */
+static bool query_lock_ex(fdb_tsdb_t db, bool share)
+{
+#ifdef FDB_USING_RW_LOCK
+    if (share && db->parent.rdlock && !db->parent.file_mode) {
+        db_rdlock(db);
+#ifdef FDB_TSDB_USING_APPEND_BUF
+        if (db->ab_idx_len == 0 && db->ab_data_len == 0) {
+            return true;
+        }
+        db_rdunlock(db);
+#else
+        return true;
+#endif /* FDB_TSDB_USING_APPEND_BUF */
+    }
+#else
+    (void) share;
+#endif /* FDB_USING_RW_LOCK */
+
+    db_lock(db);
+#ifdef FDB_TSDB_USING_APPEND_BUF
+    flush_append_buf(db);
+#endif
+
+    return false;
+}
+
+static bool query_lock(fdb_tsdb_t db)
+{
+    return query_lock_ex(db, true);
+}
+
+static void query_unlock(fdb_tsdb_t db, bool shared)
+{
+#ifdef FDB_USING_RW_LOCK
+    if (shared) {
+        db_rdunlock(db);
+        return;
+    }
+#else
+    (void) shared;
+#endif /* FDB_USING_RW_LOCK */
+
+    db_unlock(db);
+}
+
+/**
+ * The TSDB iterator for each TSL.
+ *
+ * @param db database object
+ * @param cb callback
+ * @param arg callback argument
+ */
+void fdb_tsl_iter(fdb_tsdb_t db, fdb_tsl_cb cb, void *arg)
+{
+    struct tsdb_sec_info sector;
+    uint32_t sec_addr, traversed_len = 0;
+    struct fdb_tsl tsl;
+    bool shared;
+
+    if (!db_init_ok(db)) {
+        FDB_INFO("Error: TSL (%s) isn't initialize OK.\n", db_name(db));
+    }
+
+    if (cb == NULL) {
+        return;
+    }
+
+    sec_addr = db_oldest_addr(db);
+    shared = query_lock(db);
+    /* search all sectors */
+    do {
+        traversed_len += db_sec_size(db);
+        if (read_sector_info(db, sec_addr, &sector, false) != FDB_NO_ERR) {
+            continue;
+        }
+        /* sector has TSL */
+        if (sector.status == FDB_SECTOR_STORE_USING || sector.status == FDB_SECTOR_STORE_FULL) {
+            if (sector.status == FDB_SECTOR_STORE_USING) {
+                /* copy the current using sector status  */
+                sector = db->cur_sec;
+            }
+            tsl.addr.index = sector.addr + SECTOR_HDR_DATA_SIZE;
+            /* search all TSL */
+            do {
+                read_tsl(db, &tsl);
+                /* iterator is interrupted when callback return true */
+                if (cb(&tsl, arg)) {
+                    query_unlock(db, shared);
+                    return;
+                }
+            } while ((tsl.addr.index = get_next_tsl_addr(&sector, &tsl)) != FAILED_ADDR);
+        }
+    } while ((sec_addr = get_next_sector_addr(db, &sector, traversed_len)) != FAILED_ADDR);
+    query_unlock(db, shared);
+}
+
+/**
+ * The TSDB iterator for each TSL.
  *
  * @param db database object
  * @param cb callback
@@ -534,6 +1114,7 @@ void fdb_tsl_iter_reverse(fdb_tsdb_t db, fdb_tsl_cb cb, void *cb_arg)
     struct tsdb_sec_info sector;
     uint32_t sec_addr, traversed_len = 0;
     struct fdb_tsl tsl;
+    bool shared;
 
     if (!db_init_ok(db)) {
         FDB_INFO("Error: TSL (%s) isn't initialize OK.\n", db_name(db));
@@ -544,7 +1125,7 @@ void fdb_tsl_iter_reverse(fdb_tsdb_t db, fdb_tsl_cb cb, void *cb_arg)
     }
 
     sec_addr = db->cur_sec.addr;
-    db_lock(db);
+    shared = query_lock(db);
     /* search all sectors */
     do {
         traversed_len += db_sec_size(db);
@@ -571,7 +1152,7 @@ void fdb_tsl_iter_reverse(fdb_tsdb_t db, fdb_tsl_cb cb, void *cb_arg)
     } while ((sec_addr = get_last_sector_addr(db, &sector, traversed_len)) != FAILED_ADDR);
 
 __exit:
-    db_unlock(db);
+    query_unlock(db, shared);
 }
 
 /*
@@ -580,9 +1161,20 @@ __exit:
 static int search_start_tsl_addr(fdb_tsdb_t db, int start, int end, fdb_time_t from, fdb_time_t to)
 {
     struct fdb_tsl tsl;
+    bool read_ahead = false;
+
     while (true) {
         tsl.addr.index = start + FDB_ALIGN((end - start) / 2, LOG_IDX_DATA_SIZE);
-        read_tsl(db, &tsl);
+#ifdef FDB_TSDB_USING_READ_AHEAD
+        /* the probes are read one by one until the rest of the range is in one buffer, the shared readers don't fill it */
+        if (!read_ahead && !db_rd_locked(db) && end + LOG_IDX_DATA_SIZE <= start + sizeof(db->ra_buf)) {
+            if (!read_ahead_hit(db, start) || !read_ahead_hit(db, end)) {
+                fill_read_ahead(db, start, false);
+            }
+            read_ahead = true;
+        }
+#endif
+        read_tsl_ex(db, &tsl, read_ahead);
         if (tsl.time < from) {
             start = tsl.addr.index + LOG_IDX_DATA_SIZE;
         } else if (tsl.time > from) {
@@ -619,7 +1211,7 @@ void fdb_tsl_iter_by_time(fdb_tsdb_t db, fdb_time_t from, fdb_time_t to, fdb_tsl
     struct tsdb_sec_info sector;
     uint32_t sec_addr, start_addr, traversed_len = 0;
     struct fdb_tsl tsl;
-    bool found_start_tsl = false;
+    bool found_start_tsl = false, shared;
 
     uint32_t (*get_sector_addr)(fdb_tsdb_t , tsdb_sec_info_t , uint32_t);
     uint32_t (*get_tsl_addr)(tsdb_sec_info_t , fdb_tsl_t);
@@ -646,7 +1238,13 @@ void fdb_tsl_iter_by_time(fdb_tsdb_t db, fdb_time_t from, fdb_time_t to, fdb_tsl
     }
 
     sec_addr = start_addr;
-    db_lock(db);
+    shared = query_lock(db);
+#ifdef FDB_TSDB_USING_SEC_INDEX
+    /* skip the sectors before the starting timestamp */
+    if (search_start_sector(db, from, to, &sec_addr, &traversed_len) && sec_addr == FAILED_ADDR) {
+        goto __exit;
+    }
+#endif
     /* search all sectors */
     do {
         traversed_len += db_sec_size(db);
@@ -691,7 +1289,7 @@ void fdb_tsl_iter_by_time(fdb_tsdb_t db, fdb_time_t from, fdb_time_t to, fdb_tsl
     } while ((sec_addr = get_sector_addr(db, &sector, traversed_len)) != FAILED_ADDR);
 
 __exit:
-    db_unlock(db);
+    query_unlock(db, shared);
 }
 
 static bool query_count_cb(fdb_tsl_t tsl, void *arg)
@@ -730,6 +1328,136 @@ size_t fdb_tsl_query_count(fdb_tsdb_t db, fdb_time_t from, fdb_time_t to, fdb_ts
 
 }
 
+#ifdef FDB_TSDB_USING_SUMMARY
+static bool query_agg_cb(fdb_tsl_t tsl, void *arg)
+{
+    struct query_agg_args *args = arg;
+    fdb_tsl_value_t value;
+
+    if (read_tsl_value(args->db, tsl, &value)) {
+        agg_add(args->agg, tsl_value(args->db, value));
+    }
+
+    return false;
+}
+
+/*
+ * Aggregate the TSL values of a sector in the time range. When build is true, all TSLs of the sector are read and
+ * its summary is built, otherwise the TSLs are read from the starting timestamp only.
+ */
+static void agg_sector(fdb_tsdb_t db, uint32_t addr, fdb_time_t from, fdb_time_t to, fdb_tsl_agg_t agg, bool build)
+{
+    tsdb_sec_index_node_t node = &db->sec_index_table[addr / db_sec_size(db)];
+    struct tsdb_sec_info sector;
+    struct fdb_tsl tsl;
+    fdb_tsl_value_t value;
+
+    if (addr == db->cur_sec.addr) {
+        sector = db->cur_sec;
+    } else if (read_sector_info(db, addr, &sector, false) != FDB_NO_ERR) {
+        return;
+    }
+    if (sector.status != FDB_SECTOR_STORE_USING && sector.status != FDB_SECTOR_STORE_FULL) {
+        return;
+    }
+
+    if (build) {
+        reset_sec_summary(db, addr, false);
+        tsl.addr.index = sector.addr + SECTOR_HDR_DATA_SIZE;
+    } else {
+        tsl.addr.index = search_start_tsl_addr(db, sector.addr + SECTOR_HDR_DATA_SIZE, sector.end_idx, from, to);
+    }
+    do {
+        read_tsl(db, &tsl);
+        if (tsl.status == FDB_TSL_UNUSED || (!build && tsl.time > to)) {
+            break;
+        }
+        if (read_tsl_value(db, &tsl, &value)) {
+            if (build) {
+                sec_summary_add(db, node, value);
+            }
+            if (tsl.time >= from && tsl.time <= to) {
+                agg_add(agg, tsl_value(db, value));
+            }
+        }
+    } while ((tsl.addr.index = get_next_tsl_addr(&sector, &tsl)) != FAILED_ADDR);
+    if (build) {
+        node->val_ok = true;
+    }
+}
+
+/**
+ * Query the aggregate of the TSL values by timestamp. The value type MUST be set by FDB_TSDB_CTRL_SET_VALUE_TYPE.
+ * The sectors in the time range are aggregated by their summaries, only the sectors at the range edges are read.
+ * A summary which isn't up to date, e.g. after reboot, is built by the query.
+ *
+ * @param db database object
+ * @param from starting timestamp
+ * @param to ending timestamp
+ * @param agg the aggregate of the TSLs which status is FDB_TSL_WRITE or FDB_TSL_USER_STATUS1
+ *
+ * @return result
+ */
+fdb_err_t fdb_tsl_query_agg(fdb_tsdb_t db, fdb_time_t from, fdb_time_t to, fdb_tsl_agg_t agg)
+{
+    uint32_t sec_num, oldest, i;
+    tsdb_sec_index_node_t node;
+    fdb_time_t time;
+    bool shared;
+
+    if (!db_init_ok(db)) {
+        FDB_INFO("Error: TSL (%s) isn't initialize OK.\n", db_name(db));
+        return FDB_INIT_FAILED;
+    }
+    if (db->value_type == FDB_TSL_VALUE_NONE) {
+        FDB_INFO("Error: TSL (%s) has no value type.\n", db_name(db));
+        return FDB_READ_ERR;
+    }
+
+    memset(agg, 0, sizeof(struct fdb_tsl_agg));
+    if (from > to) {
+        time = from;
+        from = to;
+        to = time;
+    }
+    if (!db->sec_index_ok || db_oldest_addr(db) >= db_max_size(db)) {
+        /* no summary, all TSLs in the range are read */
+        struct query_agg_args args = { db, agg };
+
+        fdb_tsl_iter_by_time(db, from, to, query_agg_cb, &args);
+        return FDB_NO_ERR;
+    }
+
+    /* the missing summaries are built by the writer */
+    shared = query_lock_ex(db, db->summary_ok);
+    sec_num = db_max_size(db) / db_sec_size(db);
+    oldest = db_oldest_addr(db) / db_sec_size(db);
+    /* the sectors from the oldest to the current are sorted by time */
+    for (i = 0; i < sec_num; i++) {
+        node = &db->sec_index_table[(oldest + i) % sec_num];
+        if (node->count == 0 || node->end_time < from) {
+            continue;
+        }
+        if (node->start_time > to) {
+            break;
+        }
+        if (node->val_ok && from <= node->start_time && node->end_time <= to) {
+            agg_merge_sec(db, agg, node);
+        } else {
+            agg_sector(db, (oldest + i) % sec_num * db_sec_size(db), from, to, agg, !shared && !node->val_ok);
+        }
+    }
+    if (!shared) {
+        for (i = 0, db->summary_ok = true; i < sec_num; i++) {
+            db->summary_ok = db->summary_ok && db->sec_index_table[i].val_ok;
+        }
+    }
+    query_unlock(db, shared);
+
+    return FDB_NO_ERR;
+}
+#endif /* FDB_TSDB_USING_SUMMARY */
+
 /**
  * Set the TSL status.
  *
@@ -744,8 +1472,18 @@ fdb_err_t fdb_tsl_set_status(fdb_tsdb_t db, fdb_tsl_t tsl, fdb_tsl_status_t stat
     fdb_err_t result = FDB_NO_ERR;
     uint8_t status_table[TSL_STATUS_TABLE_SIZE];
 
+#ifdef FDB_TSDB_USING_READ_AHEAD
+    reset_read_ahead(db);
+#endif
     /* write the status will by write granularity */
     _FDB_WRITE_STATUS(db, tsl->addr.index, status_table, FDB_TSL_STATUS_NUM, status, true);
+#ifdef FDB_TSDB_USING_SUMMARY
+    /* the deleted TSL is dropped from the sector summary when it's built again */
+    if (status >= FDB_TSL_DELETED && db->sec_index_ok && tsl->addr.index < db_max_size(db)) {
+        db->sec_index_table[tsl->addr.index / db_sec_size(db)].val_ok = false;
+        db->summary_ok = false;
+    }
+#endif
 
     return result;
 }
@@ -776,7 +1514,14 @@ static bool check_sec_hdr_cb(tsdb_sec_info_t sector, void *arg1, void *arg2)
         FDB_INFO("Sector (0x%08" PRIX32 ") header info is incorrect.\n", sector->addr);
         (arg->check_failed) = true;
         return true;
-    } else if (sector->status == FDB_SECTOR_STORE_USING) {
+    }
+#ifdef FDB_TSDB_USING_SEC_INDEX
+    update_sec_index(db, sector);
+#endif
+#ifdef FDB_TSDB_USING_SUMMARY
+    reset_sec_summary(db, sector->addr, sector->status == FDB_SECTOR_STORE_EMPTY);
+#endif
+    if (sector->status == FDB_SECTOR_STORE_USING) {
         if (db->cur_sec.addr == FDB_DATA_UNUSED) {
             memcpy(&db->cur_sec, sector, sizeof(struct tsdb_sec_info));
         } else {
@@ -807,6 +1552,10 @@ static void tsl_format_all(fdb_tsdb_t db)
 {
     struct tsdb_sec_info sector;
 
+#ifdef FDB_TSDB_USING_APPEND_BUF
+    /* the staged TSLs are dropped */
+    reset_append_buf(db);
+#endif
     sector.addr = 0;
     sector_iterator(db, &sector, FDB_SECTOR_STORE_UNUSED, db, NULL, format_all_cb, false);
     db_oldest_addr(db) = 0;
@@ -870,6 +1619,34 @@ void fdb_tsdb_control(fdb_tsdb_t db, int cmd, void *arg)
         db->parent.unlock = (void (*)(fdb_db_t db))arg;
 #if !defined(__ARMCC_VERSION) && defined(__GNUC__)
 #pragma GCC diagnostic pop
+#endif
+        break;
+    case FDB_TSDB_CTRL_SET_RDLOCK:
+#ifdef FDB_USING_RW_LOCK
+#if !defined(__ARMCC_VERSION) && defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#endif
+        db->parent.rdlock = (void (*)(fdb_db_t db))arg;
+#if !defined(__ARMCC_VERSION) && defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+#else
+        FDB_INFO("Error: set read lock Failed. Please defined the FDB_USING_RW_LOCK macro.");
+#endif
+        break;
+    case FDB_TSDB_CTRL_SET_RDUNLOCK:
+#ifdef FDB_USING_RW_LOCK
+#if !defined(__ARMCC_VERSION) && defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#endif
+        db->parent.rdunlock = (void (*)(fdb_db_t db))arg;
+#if !defined(__ARMCC_VERSION) && defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
+#else
+        FDB_INFO("Error: set read unlock Failed. Please defined the FDB_USING_RW_LOCK macro.");
 #endif
         break;
     case FDB_TSDB_CTRL_SET_ROLLOVER:
@@ -904,6 +1681,38 @@ void fdb_tsdb_control(fdb_tsdb_t db, int cmd, void *arg)
         FDB_ASSERT(db->parent.init_ok == false);
         db->parent.not_formatable = *(bool *)arg;
         break;
+    case FDB_TSDB_CTRL_SET_FLUSH_DEADLINE:
+#ifdef FDB_TSDB_USING_APPEND_BUF
+        /* this change MUST after database initialized */
+        FDB_ASSERT(db->parent.init_ok == true);
+        db->flush_deadline = *(fdb_time_t *)arg;
+#else
+        FDB_INFO("Error: set flush deadline Failed. Please defined the FDB_TSDB_APPEND_BUF_SIZE macro.");
+#endif
+        break;
+    case FDB_TSDB_CTRL_GET_FLUSH_DEADLINE:
+#ifdef FDB_TSDB_USING_APPEND_BUF
+        *(fdb_time_t *)arg = db->flush_deadline;
+#else
+        *(fdb_time_t *)arg = 0;
+#endif
+        break;
+    case FDB_TSDB_CTRL_SET_VALUE_TYPE:
+#ifdef FDB_TSDB_USING_SUMMARY
+        /* this change MUST before database initialization */
+        FDB_ASSERT(db->parent.init_ok == false);
+        db->value_type = *(fdb_tsl_value_type_t *)arg;
+#else
+        FDB_INFO("Error: set value type Failed. Please defined the FDB_TSDB_USING_SUMMARY macro.");
+#endif
+        break;
+    case FDB_TSDB_CTRL_GET_VALUE_TYPE:
+#ifdef FDB_TSDB_USING_SUMMARY
+        *(fdb_tsl_value_type_t *)arg = db->value_type;
+#else
+        *(fdb_tsl_value_type_t *)arg = FDB_TSL_VALUE_NONE;
+#endif
+        break;
     }
 }
 
@@ -943,6 +1752,24 @@ fdb_err_t fdb_tsdb_init(fdb_tsdb_t db, const char *name, const char *path, fdb_g
     db->cur_sec.addr = FDB_DATA_UNUSED;
     /* must less than sector size */
     FDB_ASSERT(max_len < db_sec_size(db));
+#ifdef FDB_TSDB_USING_READ_AHEAD
+    reset_read_ahead(db);
+#endif
+#ifdef FDB_TSDB_USING_APPEND_BUF
+    reset_append_buf(db);
+    /* default is flushed by full page only */
+    db->flush_deadline = 0;
+#endif
+#ifdef FDB_TSDB_USING_SEC_INDEX
+    db->sec_index_ok = db_max_size(db) / db_sec_size(db) <= FDB_TSDB_SEC_INDEX_NUM;
+    if (!db->sec_index_ok) {
+        FDB_INFO("Warning: The TSDB has more sectors than the index (%d). Now will search the sectors on flash.\n",
+                FDB_TSDB_SEC_INDEX_NUM);
+    }
+#endif
+#ifdef FDB_TSDB_USING_SUMMARY
+    db->summary_ok = false;
+#endif
 
     /* check all sector header */
     sector.addr = 0;
@@ -979,6 +1806,9 @@ fdb_err_t fdb_tsdb_init(fdb_tsdb_t db, const char *name, const char *path, fdb_g
             db->cur_sec.addr);
     /* read the current using sector info */
     read_sector_info(db, db->cur_sec.addr, &db->cur_sec, true);
+#ifdef FDB_TSDB_USING_SEC_INDEX
+    update_sec_index(db, &db->cur_sec);
+#endif
     /* get last save time */
     if (db->cur_sec.status == FDB_SECTOR_STORE_USING) {
         db->last_time = db->cur_sec.end_time;
@@ -1012,11 +1842,481 @@ __exit:
  *
  * @return result
  */
+#ifdef FDB_USING_ERASE_COUNT
+/**
+ * Get the erase count statistics of the TSDB sectors.
+ *
+ * @param db database object
+ * @param stat the statistics
+ *
+ * @return result
+ */
+fdb_err_t fdb_tsdb_erase_stat(fdb_tsdb_t db, fdb_erase_stat_t stat)
+{
+    struct tsdb_sec_info sector;
+    uint32_t addr;
+    bool shared;
+
+    if (!db_init_ok(db)) {
+        FDB_INFO("Error: TSL (%s) isn't initialize OK.\n", db_name(db));
+        return FDB_INIT_FAILED;
+    }
+
+    shared = query_lock(db);
+
+    memset(stat, 0, sizeof(struct fdb_erase_stat));
+    for (addr = 0; addr < db_max_size(db); addr += db_sec_size(db)) {
+        sector.erase_count = 0;
+        read_sector_info(db, addr, &sector, false);
+        if (stat->sec_num == 0 || sector.erase_count < stat->min) {
+            stat->min = sector.erase_count;
+        }
+        if (sector.erase_count > stat->max) {
+            stat->max = sector.erase_count;
+        }
+        stat->total += sector.erase_count;
+        stat->sec_num++;
+    }
+    stat->session = db->parent.erase_num;
+
+    query_unlock(db, shared);
+
+    return FDB_NO_ERR;
+}
+#endif /* FDB_USING_ERASE_COUNT */
+
 fdb_err_t fdb_tsdb_deinit(fdb_tsdb_t db)
 {
+#ifdef FDB_TSDB_USING_APPEND_BUF
+    if (db_init_ok(db)) {
+        db_lock(db);
+        flush_append_buf(db);
+        db_unlock(db);
+    }
+#endif
     _fdb_deinit((fdb_db_t) db);
 
     return FDB_NO_ERR;
 }
 
+#ifdef FDB_TSDB_USING_SERIES
+/* the block header: the first sample's timestamp and value bits, and the sample count */
+#define SERIES_HDR_VALUE_OFFSET                  (sizeof(fdb_time_t))
+#define SERIES_HDR_COUNT_OFFSET                  (SERIES_HDR_VALUE_OFFSET + sizeof(uint32_t))
+#define SERIES_HDR_DATA_SIZE                     (SERIES_HDR_COUNT_OFFSET + sizeof(uint16_t))
+#define SERIES_BLOCK_BITS                        ((FDB_TSDB_SERIES_BLOCK_SIZE - SERIES_HDR_DATA_SIZE) * 8)
+/* the longest sample: '1111' with 32 bits delta of delta, '11' with 5 bits leading, 5 bits length and 32 bits */
+#define SERIES_SAMPLE_MAX_BITS                   (4 + 32 + 2 + 5 + 5 + 32)
+
+#if FDB_TSDB_SERIES_BLOCK_SIZE % 4 != 0 || FDB_TSDB_SERIES_BLOCK_SIZE < 32
+#error "FDB_TSDB_SERIES_BLOCK_SIZE must be a multiple of 4 and not less than 32"
+#endif
+
+struct series_iter_args {
+    fdb_series_t series;
+    fdb_time_t from;
+    fdb_time_t to;
+    fdb_series_cb cb;
+    void *cb_arg;
+    bool stop;
+};
+
+/* the decoder state of a block, same as the encoder's in struct fdb_series */
+struct series_decoder {
+    const uint8_t *buf;
+    uint32_t bit_pos;
+    uint32_t bit_num;
+    fdb_time_t time;
+    int32_t delta;
+    uint32_t value;
+    uint8_t leading;
+    uint8_t trailing;
+};
+
+static uint8_t series_clz(uint32_t x)
+{
+    uint8_t n = 0;
+
+    if (!(x & 0xFFFF0000)) { n += 16; x <<= 16; }
+    if (!(x & 0xFF000000)) { n += 8;  x <<= 8;  }
+    if (!(x & 0xF0000000)) { n += 4;  x <<= 4;  }
+    if (!(x & 0xC0000000)) { n += 2;  x <<= 2;  }
+    if (!(x & 0x80000000)) { n += 1; }
+
+    return n;
+}
+
+static uint8_t series_ctz(uint32_t x)
+{
+    uint8_t n = 0;
+
+    if (!(x & 0x0000FFFF)) { n += 16; x >>= 16; }
+    if (!(x & 0x000000FF)) { n += 8;  x >>= 8;  }
+    if (!(x & 0x0000000F)) { n += 4;  x >>= 4;  }
+    if (!(x & 0x00000003)) { n += 2;  x >>= 2;  }
+    if (!(x & 0x00000001)) { n += 1; }
+
+    return n;
+}
+
+/*
+ * Write the low bits of the value to the bit stream from the most significant one. The stream is zeroed.
+ */
+static void series_write_bits(fdb_series_t series, uint32_t value, uint8_t num)
+{
+    uint8_t *buf = (uint8_t *)series->block + SERIES_HDR_DATA_SIZE;
+    uint32_t pos = series->bit_pos;
+
+    series->bit_pos += num;
+    while (num > 0) {
+        uint8_t room = 8 - pos % 8, n = num < room ? num : room;
+
+        num -= n;
+        buf[pos / 8] |= (uint8_t)(((value >> num) & ((1UL << n) - 1)) << (room - n));
+        pos += n;
+    }
+}
+
+static uint32_t series_read_bits(struct series_decoder *dec, uint8_t num)
+{
+    uint32_t value = 0;
+
+    if (dec->bit_pos + num > dec->bit_num) {
+        /* out of the block, it's broken */
+        dec->bit_pos = dec->bit_num + 1;
+        return 0;
+    }
+    while (num > 0) {
+        uint8_t room = 8 - dec->bit_pos % 8, n = num < room ? num : room;
+
+        value = (value << n) | ((dec->buf[dec->bit_pos / 8] >> (room - n)) & ((1UL << n) - 1));
+        dec->bit_pos += n;
+        num -= n;
+    }
+
+    return value;
+}
+
+static void series_start_block(fdb_series_t series, fdb_time_t time, uint32_t value)
+{
+    uint8_t *hdr = (uint8_t *)series->block;
+
+    memset(series->block, 0, sizeof(series->block));
+    memcpy(hdr, &time, sizeof(fdb_time_t));
+    memcpy(hdr + SERIES_HDR_VALUE_OFFSET, &value, sizeof(uint32_t));
+    series->last_time = time;
+    series->last_delta = 0;
+    series->last_value = value;
+    series->leading = UINT8_MAX;
+    series->trailing = 0;
+    series->bit_pos = 0;
+    series->count = 1;
+}
+
+/*
+ * Encode the timestamp delta of delta in 1, 9, 12, 15 or 36 bits, like the Gorilla TSDB.
+ */
+static void series_encode_time(fdb_series_t series, int32_t dod)
+{
+    if (dod == 0) {
+        series_write_bits(series, 0x0, 1);
+    } else if (dod >= -63 && dod <= 64) {
+        series_write_bits(series, 0x2, 2);
+        series_write_bits(series, (uint32_t)dod, 7);
+    } else if (dod >= -255 && dod <= 256) {
+        series_write_bits(series, 0x6, 3);
+        series_write_bits(series, (uint32_t)dod, 9);
+    } else if (dod >= -2047 && dod <= 2048) {
+        series_write_bits(series, 0xE, 4);
+        series_write_bits(series, (uint32_t)dod, 12);
+    } else {
+        series_write_bits(series, 0xF, 4);
+        series_write_bits(series, (uint32_t)dod, 32);
+    }
+}
+
+/*
+ * Encode the value XOR the last value: '0' when same, '10' with the meaningful bits in the last window, or '11'
+ * with 5 bits leading zeros, 5 bits meaningful bits length - 1 and the meaningful bits.
+ */
+static void series_encode_value(fdb_series_t series, uint32_t value)
+{
+    uint32_t xor = value ^ series->last_value;
+    uint8_t leading, trailing;
+
+    if (xor == 0) {
+        series_write_bits(series, 0x0, 1);
+        return;
+    }
+    leading = series_clz(xor);
+    trailing = series_ctz(xor);
+    if (series->leading != UINT8_MAX && leading >= series->leading && trailing >= series->trailing) {
+        series_write_bits(series, 0x2, 2);
+        series_write_bits(series, xor >> series->trailing, 32 - series->leading - series->trailing);
+    } else {
+        series_write_bits(series, 0x3, 2);
+        series_write_bits(series, leading, 5);
+        series_write_bits(series, 32 - leading - trailing - 1, 5);
+        series_write_bits(series, xor >> trailing, 32 - leading - trailing);
+        series->leading = leading;
+        series->trailing = trailing;
+    }
+}
+
+static int32_t series_decode_signed(uint32_t value, uint8_t num)
+{
+    /* the range is [-(2^(num-1) - 1), 2^(num-1)] */
+    if (value > (1UL << (num - 1))) {
+        return (int32_t)(value - (1UL << num));
+    }
+    return (int32_t)value;
+}
+
+/*
+ * Decode the next sample of the block.
+ *
+ * @return false when the block is broken
+ */
+static bool series_decode_next(struct series_decoder *dec)
+{
+    uint32_t xor;
+    int32_t dod;
+    uint8_t len;
+
+    /* timestamp */
+    if (series_read_bits(dec, 1) == 0) {
+        dod = 0;
+    } else if (series_read_bits(dec, 1) == 0) {
+        dod = series_decode_signed(series_read_bits(dec, 7), 7);
+    } else if (series_read_bits(dec, 1) == 0) {
+        dod = series_decode_signed(series_read_bits(dec, 9), 9);
+    } else if (series_read_bits(dec, 1) == 0) {
+        dod = series_decode_signed(series_read_bits(dec, 12), 12);
+    } else {
+        dod = (int32_t)series_read_bits(dec, 32);
+    }
+    dec->delta += dod;
+    dec->time += dec->delta;
+    /* value */
+    if (series_read_bits(dec, 1) == 0) {
+        return dec->bit_pos <= dec->bit_num;
+    }
+    if (series_read_bits(dec, 1) == 1) {
+        dec->leading = series_read_bits(dec, 5);
+        len = series_read_bits(dec, 5) + 1;
+        if (dec->leading + len > 32) {
+            return false;
+        }
+        dec->trailing = 32 - dec->leading - len;
+    } else if (dec->leading == UINT8_MAX) {
+        return false;
+    }
+    len = 32 - dec->leading - dec->trailing;
+    xor = series_read_bits(dec, len) << dec->trailing;
+    dec->value ^= xor;
+
+    return dec->bit_pos <= dec->bit_num;
+}
+
+/*
+ * Decode the samples in the block and call back the samples in range.
+ *
+ * @return true when the iterator is finished
+ */
+static bool series_decode_block(struct series_iter_args *args, const uint8_t *block, size_t size, uint16_t count)
+{
+    fdb_tsdb_t db = args->series->db;
+    struct series_decoder dec;
+    float value;
+    uint16_t i;
+
+    memcpy(&dec.time, block, sizeof(fdb_time_t));
+    memcpy(&dec.value, block + SERIES_HDR_VALUE_OFFSET, sizeof(uint32_t));
+    dec.buf = block + SERIES_HDR_DATA_SIZE;
+    dec.bit_pos = 0;
+    dec.bit_num = (size - SERIES_HDR_DATA_SIZE) * 8;
+    dec.delta = 0;
+    dec.leading = UINT8_MAX;
+    dec.trailing = 0;
+
+    for (i = 0; i < count; i++) {
+        if (i > 0 && !series_decode_next(&dec)) {
+            FDB_INFO("Error: the series block is broken, %d samples are dropped.\n", count - i);
+            return false;
+        }
+        if (dec.time > args->to) {
+            args->stop = true;
+            return true;
+        }
+        if (dec.time >= args->from) {
+            memcpy(&value, &dec.value, sizeof(float));
+            /* iterator is interrupted when callback return true */
+            if (args->cb(dec.time, value, args->cb_arg)) {
+                args->stop = true;
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+static bool series_iter_cb(fdb_tsl_t tsl, void *arg)
+{
+    struct series_iter_args *args = arg;
+    fdb_tsdb_t db = args->series->db;
+    uint32_t block[FDB_TSDB_SERIES_BLOCK_SIZE / 4] = { 0 };
+    struct fdb_blob blob;
+    uint16_t count;
+    size_t size;
+
+    if (tsl->status == FDB_TSL_DELETED || tsl->log_len < SERIES_HDR_DATA_SIZE
+            || tsl->log_len > FDB_TSDB_SERIES_BLOCK_SIZE) {
+        return false;
+    }
+    size = fdb_blob_read((fdb_db_t)db, fdb_tsl_to_blob(tsl, fdb_blob_make(&blob, block, sizeof(block))));
+    if (size < SERIES_HDR_DATA_SIZE) {
+        /* the block header isn't read, skip the block */
+        FDB_INFO("Error: read the series block (@0x%08" PRIX32 ") failed.\n", tsl->addr.log);
+        return false;
+    }
+    memcpy(&count, (uint8_t *)block + SERIES_HDR_COUNT_OFFSET, sizeof(uint16_t));
+
+    return series_decode_block(args, (uint8_t *)block, size, count);
+}
+
+/**
+ * Initialize a compressed numeric series on the TSDB. The TSDB only saves this series.
+ *
+ * @param series series object
+ * @param db initialized database object, its maximum log length MUST be not less than FDB_TSDB_SERIES_BLOCK_SIZE
+ *
+ * @return result
+ */
+fdb_err_t fdb_series_init(fdb_series_t series, fdb_tsdb_t db)
+{
+    FDB_ASSERT(series);
+    FDB_ASSERT(db);
+
+    if (!db_init_ok(db)) {
+        FDB_INFO("Error: TSL (%s) isn't initialize OK.\n", db_name(db));
+        return FDB_INIT_FAILED;
+    }
+    FDB_ASSERT(db->max_len >= FDB_TSDB_SERIES_BLOCK_SIZE);
+#ifdef FDB_TSDB_USING_SUMMARY
+    /* the blocks aren't typed TSLs */
+    FDB_ASSERT(db->value_type == FDB_TSL_VALUE_NONE);
+#endif
+
+    series->db = db;
+    series->count = 0;
+    series->bit_pos = 0;
+    series->last_time = db->last_time;
+
+    return FDB_NO_ERR;
+}
+
+/**
+ * Save the encoding block of the series as a TSL, the TSL timestamp is the last sample's timestamp.
+ *
+ * @param series series object
+ *
+ * @return result
+ */
+fdb_err_t fdb_series_flush(fdb_series_t series)
+{
+    fdb_err_t result = FDB_NO_ERR;
+    struct fdb_blob blob;
+
+    if (series->count == 0) {
+        return result;
+    }
+
+    memcpy((uint8_t *)series->block + SERIES_HDR_COUNT_OFFSET, &series->count, sizeof(uint16_t));
+    result = fdb_tsl_append_with_ts(series->db, fdb_blob_make(&blob, series->block,
+            SERIES_HDR_DATA_SIZE + (series->bit_pos + 7) / 8), series->last_time);
+    if (result == FDB_NO_ERR) {
+        series->count = 0;
+        series->bit_pos = 0;
+    }
+
+    return result;
+}
+
+/**
+ * Append a sample to the series. The sample is encoded in RAM, and the block is saved when it's full.
+ *
+ * @param series series object
+ * @param time sample timestamp, MUST more than the last one
+ * @param value sample value
+ *
+ * @return result
+ */
+fdb_err_t fdb_series_append(fdb_series_t series, fdb_time_t time, float value)
+{
+    fdb_tsdb_t db = series->db;
+    fdb_err_t result = FDB_NO_ERR;
+    uint32_t bits;
+    int64_t delta, dod;
+
+    if (time <= series->last_time) {
+        FDB_INFO("Warning: current timestamp (%" PRIdMAX ") is less than or equal to the last save timestamp (%" PRIdMAX "). This sample will be dropped.\n",
+                (intmax_t)time, (intmax_t)(series->last_time));
+        return FDB_WRITE_ERR;
+    }
+
+    memcpy(&bits, &value, sizeof(uint32_t));
+    delta = (int64_t)time - series->last_time;
+    dod = delta - series->last_delta;
+    if (series->count > 0 && (series->bit_pos + SERIES_SAMPLE_MAX_BITS > SERIES_BLOCK_BITS
+            || series->count == UINT16_MAX || delta > INT32_MAX || dod < INT32_MIN || dod > INT32_MAX)) {
+        /* the block is full or the sample can't be encoded, save it */
+        result = fdb_series_flush(series);
+        if (result != FDB_NO_ERR) {
+            return result;
+        }
+    }
+
+    if (series->count == 0) {
+        series_start_block(series, time, bits);
+    } else {
+        series_encode_time(series, (int32_t)dod);
+        series_encode_value(series, bits);
+        series->last_time = time;
+        series->last_delta = (int32_t)delta;
+        series->last_value = bits;
+        series->count++;
+    }
+
+    return result;
+}
+
+/**
+ * The series iterator for each sample by timestamp, the samples in the encoding block are included.
+ *
+ * @param series series object
+ * @param from starting timestamp
+ * @param to ending timestamp, the reverse iterator isn't supported
+ * @param cb callback
+ * @param cb_arg callback argument
+ */
+void fdb_series_iter_by_time(fdb_series_t series, fdb_time_t from, fdb_time_t to, fdb_series_cb cb, void *cb_arg)
+{
+    struct series_iter_args args = { series, from, to, cb, cb_arg, false };
+
+    if (cb == NULL || from > to) {
+        return;
+    }
+
+    /* a block is saved with its last sample's timestamp, so the blocks after the starting timestamp are read */
+    if (from <= series->db->last_time) {
+        fdb_tsl_iter_by_time(series->db, from, series->db->last_time, series_iter_cb, &args);
+    }
+    if (!args.stop && series->count > 0) {
+        series_decode_block(&args, (uint8_t *)series->block, SERIES_HDR_DATA_SIZE + (series->bit_pos + 7) / 8,
+                series->count);
+    }
+}
+#endif /* FDB_TSDB_USING_SERIES */
+
 #endif /* defined(FDB_USING_TSDB) */
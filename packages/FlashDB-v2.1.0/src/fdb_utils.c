@@ -275,10 +275,50 @@ fdb_err_t _fdb_flash_read(fdb_db_t db, uint32_t addr, void *buf, size_t size)
     return result;
 }
 
+#ifdef FDB_USING_POWER_CUT_TEST
+/* the flash writes and erases left before the power is cut, SIZE_MAX: never cut */
+static size_t power_cut_left = SIZE_MAX;
+static size_t power_cut_count;
+
+/*
+ * For the power failure tests. After num more flash writes or erases of the databases, the power is cut: every write
+ * and erase fails and the flash is not changed. SIZE_MAX restores the power. It returns the number of writes and
+ * erases done since the last call.
+ */
+size_t _fdb_power_cut_after(size_t num)
+{
+    size_t count = power_cut_count;
+
+    power_cut_left = num;
+    power_cut_count = 0;
+
+    return count;
+}
+
+static bool power_is_cut(void)
+{
+    if (power_cut_left == 0) {
+        return true;
+    }
+    if (power_cut_left != SIZE_MAX) {
+        power_cut_left--;
+    }
+    power_cut_count++;
+
+    return false;
+}
+#endif /* FDB_USING_POWER_CUT_TEST */
+
 fdb_err_t _fdb_flash_erase(fdb_db_t db, uint32_t addr, size_t size)
 {
     fdb_err_t result = FDB_NO_ERR;
 
+#ifdef FDB_USING_POWER_CUT_TEST
+    if (power_is_cut()) {
+        return FDB_ERASE_ERR;
+    }
+#endif
+
     if (db->file_mode) {
 #ifdef FDB_USING_FILE_MODE
         return _fdb_file_erase(db, addr, size);
@@ -287,11 +327,19 @@ fdb_err_t _fdb_flash_erase(fdb_db_t db, uint32_t addr, size_t size)
 #endif /* FDB_USING_FILE_MODE */
     } else {
 #ifdef FDB_USING_FAL_MODE
+#if defined(FDB_USING_KVDB) && defined(FDB_KV_USING_SNAPSHOT)
+        if (db->type == FDB_DB_TYPE_KV) {
+            _fdb_kv_snapshot_touch((fdb_kvdb_t)db, addr, size);
+        }
+#endif
         if (fal_partition_erase(db->storage.part, addr, size) < 0) {
             result = FDB_ERASE_ERR;
         }
 #endif
     }
+#ifdef FDB_USING_ERASE_COUNT
+    db->erase_num += size / db->sec_size;
+#endif
 
     return result;
 }
@@ -300,6 +348,12 @@ fdb_err_t _fdb_flash_write(fdb_db_t db, uint32_t addr, const void *buf, size_t s
 {
     fdb_err_t result = FDB_NO_ERR;
 
+#ifdef FDB_USING_POWER_CUT_TEST
+    if (power_is_cut()) {
+        return FDB_WRITE_ERR;
+    }
+#endif
+
     if (db->file_mode) {
 #ifdef FDB_USING_FILE_MODE
         return _fdb_file_write(db, addr, buf, size, sync);
@@ -308,6 +362,12 @@ fdb_err_t _fdb_flash_write(fdb_db_t db, uint32_t addr, const void *buf, size_t s
 #endif /* FDB_USING_FILE_MODE */
     } else {
 #ifdef FDB_USING_FAL_MODE
+#if defined(FDB_USING_KVDB) && defined(FDB_KV_USING_SNAPSHOT)
+        /* the sector is marked on the snapshot before it's changed */
+        if (db->type == FDB_DB_TYPE_KV) {
+            _fdb_kv_snapshot_touch((fdb_kvdb_t)db, addr, size);
+        }
+#endif
         if (fal_partition_write(db->storage.part, addr, (uint8_t *)buf, size) < 0)
         {
             result = FDB_WRITE_ERR;
@@ -318,3 +378,41 @@ fdb_err_t _fdb_flash_write(fdb_db_t db, uint32_t addr, const void *buf, size_t s
     return result;
 
 }
+
+#ifdef FDB_USING_ERASE_COUNT
+/*
+ * The erase count of a sector which is formatted again. The count of a header which is lost on power failure restarts
+ * from the most count read, the sector formatted before the counter is counted from now.
+ */
+uint32_t _fdb_next_erase_count(fdb_db_t db, bool hdr_ok, uint32_t count)
+{
+    if (!hdr_ok) {
+        return db->erase_max + 1;
+    }
+
+    return count == FDB_DATA_UNUSED ? 1 : count + 1;
+}
+
+/**
+ * Project the database lifetime at the erase rate since it's initialized, the sectors are supposed to wear evenly.
+ *
+ * @param stat the erase count statistics
+ * @param seconds the seconds since the database is initialized
+ *
+ * @return the hours until the most erased sector reaches FDB_ERASE_ENDURANCE, 0xFFFFFFFF: nothing is erased yet
+ */
+uint32_t fdb_erase_lifetime(fdb_erase_stat_t stat, uint32_t seconds)
+{
+    uint64_t hours;
+
+    if (stat->session == 0 || seconds == 0) {
+        return 0xFFFFFFFF;
+    } else if (stat->max >= FDB_ERASE_ENDURANCE) {
+        return 0;
+    }
+    /* each sector is erased session / sec_num times in the seconds */
+    hours = (uint64_t)(FDB_ERASE_ENDURANCE - stat->max) * stat->sec_num * seconds / stat->session / 3600;
+
+    return hours < 0xFFFFFFFF ? (uint32_t)hours : 0xFFFFFFFE;
+}
+#endif /* FDB_USING_ERASE_COUNT */
@@ -656,6 +656,198 @@ static void test_fdb_scale_up(void)
     test_check_fdb_by_kvs(old_kv_tbl, FDB_ARRAY_SIZE(old_kv_tbl));
 }
 
+#ifdef FDB_KV_USING_INDEX
+/* the index is rebuilt at reboot, it holds every saved KV */
+static void test_fdb_kv_index(void)
+{
+    struct fdb_kv_iterator iterator;
+    size_t kv_num = 0;
+
+    /* reboot with the 8 sectors of test_fdb_scale_up */
+    test_fdb_kvdb_deinit();
+    test_fdb_kvdb_init_by_8_sectors();
+    uassert_true(test_kvdb.kv_index_ok);
+
+    fdb_kv_iterator_init(&test_kvdb, &iterator);
+    while (fdb_kv_iterate(&test_kvdb, &iterator))
+    {
+        kv_num++;
+    }
+    uassert_int_equal(test_kvdb.kv_index_num, kv_num);
+    uassert_null(fdb_kv_get(&test_kvdb, "kv_absent"));
+
+    /* these names have the same FNV-1a hash and length, a hit must not return the other KV */
+    uassert_true(fdb_kv_set(&test_kvdb, "idx_112789", "a") == FDB_NO_ERR);
+    uassert_null(fdb_kv_get(&test_kvdb, "idx_349192"));
+    uassert_true(fdb_kv_set(&test_kvdb, "idx_349192", "b") == FDB_NO_ERR);
+    uassert_str_equal(fdb_kv_get(&test_kvdb, "idx_112789"), "a");
+    uassert_str_equal(fdb_kv_get(&test_kvdb, "idx_349192"), "b");
+    uassert_true(fdb_kv_del(&test_kvdb, "idx_112789") == FDB_NO_ERR);
+    uassert_null(fdb_kv_get(&test_kvdb, "idx_112789"));
+    uassert_str_equal(fdb_kv_get(&test_kvdb, "idx_349192"), "b");
+    uassert_true(fdb_kv_del(&test_kvdb, "idx_349192") == FDB_NO_ERR);
+}
+#endif /* FDB_KV_USING_INDEX */
+
+/* the KVs in batch are saved together, the commit record is removed after commit */
+static void test_fdb_kv_batch(void)
+{
+    struct fdb_kv_batch batch;
+    struct fdb_kv_batch_node nodes[4];
+    struct fdb_blob blob;
+    static char value[TEST_KV_VALUE_LEN];
+    int i;
+
+    fdb_kv_batch_begin(&test_kvdb, &batch, nodes, FDB_ARRAY_SIZE(nodes));
+    uassert_true(fdb_kv_batch_set(&batch, "kv4", "40") == FDB_NO_ERR);
+    uassert_true(fdb_kv_batch_set(&batch, "kv5", "50") == FDB_NO_ERR);
+    uassert_true(fdb_kv_batch_del(&batch, "kv6") == FDB_NO_ERR);
+    uassert_true(fdb_kv_batch_set(&batch, "kv_batch", "new") == FDB_NO_ERR);
+    /* replace the KV in batch */
+    uassert_true(fdb_kv_batch_set(&batch, "kv4", "41") == FDB_NO_ERR);
+    uassert_int_equal(batch.num, 4);
+    uassert_true(fdb_kv_batch_set(&batch, "kv7", "70") == FDB_SAVED_FULL);
+    /* nothing is changed before commit */
+    uassert_null(fdb_kv_get(&test_kvdb, "kv_batch"));
+    uassert_true(fdb_kv_batch_commit(&batch) == FDB_NO_ERR);
+
+    for (i = 0; i < 2; i++)
+    {
+        uassert_str_equal(fdb_kv_get(&test_kvdb, "kv4"), "41");
+        uassert_str_equal(fdb_kv_get(&test_kvdb, "kv5"), "50");
+        uassert_null(fdb_kv_get(&test_kvdb, "kv6"));
+        /* the KV out of batch is kept */
+        fdb_kv_get_blob(&test_kvdb, "kv7", fdb_blob_make(&blob, value, sizeof(value)));
+        uassert_str_equal(value, "7");
+        uassert_str_equal(fdb_kv_get(&test_kvdb, "kv_batch"), "new");
+        uassert_null(fdb_kv_get(&test_kvdb, "__kv_batch__"));
+        /* reboot with the 8 sectors of test_fdb_scale_up */
+        test_fdb_kvdb_deinit();
+        test_fdb_kvdb_init_by_8_sectors();
+    }
+}
+
+#ifdef FDB_USING_POWER_CUT_TEST
+/* reboot after a power failure, the power is cut again after num flash writes and erases of the boot */
+static size_t batch_power_cut_reboot(size_t num)
+{
+    uint32_t sec_size = TEST_KVDB_SECTOR_SIZE, db_size = sec_size * 8;
+    rt_bool_t file_mode = true;
+
+    /* nothing is written at power failure */
+    _fdb_power_cut_after(0);
+    fdb_kvdb_deinit(&test_kvdb);
+
+    fdb_kvdb_control(&(test_kvdb), FDB_KVDB_CTRL_SET_SEC_SIZE, &sec_size);
+    fdb_kvdb_control(&(test_kvdb), FDB_KVDB_CTRL_SET_FILE_MODE, &file_mode);
+    fdb_kvdb_control(&(test_kvdb), FDB_KVDB_CTRL_SET_MAX_SIZE, &db_size);
+    _fdb_power_cut_after(num);
+    fdb_kvdb_init(&test_kvdb, "test_kv", TEST_TS_PART_NAME, NULL, NULL);
+
+    return _fdb_power_cut_after(SIZE_MAX);
+}
+
+/* the same KVs in an empty KVDB, so the commit does the same flash writes each time */
+static void batch_power_cut_prepare(void)
+{
+    uassert_true(fdb_kv_set_default(&test_kvdb) == FDB_NO_ERR);
+    uassert_true(fdb_kv_set(&test_kvdb, "cut0", "old0") == FDB_NO_ERR);
+    uassert_true(fdb_kv_set(&test_kvdb, "cut1", "old1") == FDB_NO_ERR);
+    fdb_kv_del(&test_kvdb, "cut2");
+}
+
+/* commit the batch until the power is cut after num flash writes and erases, return the count of them */
+static size_t batch_power_cut_commit(size_t num)
+{
+    struct fdb_kv_batch batch;
+    struct fdb_kv_batch_node nodes[3];
+
+    fdb_kv_batch_begin(&test_kvdb, &batch, nodes, FDB_ARRAY_SIZE(nodes));
+    fdb_kv_batch_set(&batch, "cut0", "new0");
+    fdb_kv_batch_del(&batch, "cut1");
+    fdb_kv_batch_set(&batch, "cut2", "new2");
+    _fdb_power_cut_after(num);
+    fdb_kv_batch_commit(&batch);
+
+    return _fdb_power_cut_after(SIZE_MAX);
+}
+
+/* all KVs in batch are changed or none of them, return true when they are changed */
+static bool batch_power_cut_check(void)
+{
+    char *cut0 = fdb_kv_get(&test_kvdb, "cut0");
+    bool committed = cut0 && !strcmp(cut0, "new0");
+
+    uassert_null(fdb_kv_get(&test_kvdb, "__kv_batch__"));
+    if (committed)
+    {
+        uassert_null(fdb_kv_get(&test_kvdb, "cut1"));
+        uassert_str_equal(fdb_kv_get(&test_kvdb, "cut2"), "new2");
+    }
+    else
+    {
+        uassert_str_equal(fdb_kv_get(&test_kvdb, "cut0"), "old0");
+        uassert_str_equal(fdb_kv_get(&test_kvdb, "cut1"), "old1");
+        uassert_null(fdb_kv_get(&test_kvdb, "cut2"));
+    }
+
+    return committed;
+}
+
+/*
+ * The power is cut after each flash write of the commit. The batch is committed by the status change of the batch
+ * KV: it's not changed when the power is cut before that write, and it's finished on next boot when cut after it,
+ * even if the power is cut again while finishing it.
+ */
+static void test_fdb_kv_batch_power_cut(void)
+{
+    size_t writes, flip = 0, recovery_writes, num;
+    bool committed;
+
+    batch_power_cut_prepare();
+    writes = batch_power_cut_commit(SIZE_MAX);
+    uassert_true(batch_power_cut_check());
+
+    for (num = 0; num < writes; num++)
+    {
+        batch_power_cut_prepare();
+        batch_power_cut_commit(num);
+        batch_power_cut_reboot(SIZE_MAX);
+        committed = batch_power_cut_check();
+        if (committed && flip == 0)
+        {
+            /* the first cut which commits the batch is just after the status change */
+            flip = num;
+        }
+        uassert_int_equal(committed, flip != 0);
+    }
+    uassert_true(flip > 0);
+
+    /* just before the status change */
+    batch_power_cut_prepare();
+    batch_power_cut_commit(flip - 1);
+    batch_power_cut_reboot(SIZE_MAX);
+    uassert_false(batch_power_cut_check());
+
+    /* just after the status change, the batch is finished on boot */
+    batch_power_cut_prepare();
+    batch_power_cut_commit(flip);
+    recovery_writes = batch_power_cut_reboot(SIZE_MAX);
+    uassert_true(batch_power_cut_check());
+    uassert_true(recovery_writes > 0);
+
+    /* cut again after each write of finishing it */
+    for (num = 0; num < recovery_writes; num++)
+    {
+        batch_power_cut_prepare();
+        batch_power_cut_commit(flip);
+        batch_power_cut_reboot(num);
+        batch_power_cut_reboot(SIZE_MAX);
+        uassert_true(batch_power_cut_check());
+    }
+}
+#endif /* FDB_USING_POWER_CUT_TEST */
+
 static void test_fdb_kvdb_set_default(void)
 {
     uassert_true(fdb_kv_set_default(&test_kvdb) == FDB_NO_ERR);
@@ -691,6 +883,13 @@ static void testcase(void)
     UTEST_UNIT_RUN(test_fdb_del_kv);
     UTEST_UNIT_RUN(test_fdb_gc);
     UTEST_UNIT_RUN(test_fdb_scale_up);
+#ifdef FDB_KV_USING_INDEX
+    UTEST_UNIT_RUN(test_fdb_kv_index);
+#endif
+    UTEST_UNIT_RUN(test_fdb_kv_batch);
+#ifdef FDB_USING_POWER_CUT_TEST
+    UTEST_UNIT_RUN(test_fdb_kv_batch_power_cut);
+#endif
     UTEST_UNIT_RUN(test_fdb_kvdb_set_default);
     UTEST_UNIT_RUN(test_fdb_kvdb_deinit);
 }
@@ -368,6 +368,127 @@ static void test_fdb_tsdb_deinit(void)
     uassert_true(fdb_tsdb_deinit(&test_tsdb) == FDB_NO_ERR);
 }
 
+#ifdef FDB_TSDB_USING_SEC_INDEX
+/* the sector index is rebuilt at reboot, it matches the sectors found by iterator */
+static void test_fdb_tsl_sec_index(void)
+{
+    size_t count = 0;
+    int i;
+
+    /* reboot with the TSLs of test_fdb_tsl_iter_by_time_1 */
+    test_fdb_tsdb_deinit();
+    test_fdb_tsdb_init_ex();
+    uassert_true(test_tsdb.sec_index_ok);
+
+    for (i = 0; i < sizeof(test_secs_info) / sizeof(test_secs_info[0]); i++) {
+        if (test_secs_info[i].end_time == 0) {
+            break;
+        }
+        uassert_int_equal(test_tsdb.sec_index_table[i].start_time, test_secs_info[i].start_time);
+        uassert_int_equal(test_tsdb.sec_index_table[i].end_time, test_secs_info[i].end_time);
+    }
+    for (i = 0; i < sizeof(test_tsdb.sec_index_table) / sizeof(test_tsdb.sec_index_table[0]); i++) {
+        count += test_tsdb.sec_index_table[i].count;
+    }
+    uassert_int_equal(count, 800);
+
+    test_tsdb_data_by_time(test_db_start_time - 1, test_db_end_time + 1);
+    test_tsdb_data_by_time(test_secs_info[0].end_time + 1, test_secs_info[2].end_time);
+    test_tsdb_data_by_time(test_secs_info[2].end_time - 1, test_secs_info[0].start_time);
+}
+#endif /* FDB_TSDB_USING_SEC_INDEX */
+
+#ifdef FDB_TSDB_USING_APPEND_BUF
+static void test_fdb_tsl_flush(void)
+{
+    struct fdb_blob blob;
+    fdb_time_t deadline = 4 * TEST_TIME_STEP;
+    int i;
+
+    fdb_tsl_clean(&test_tsdb);
+    /* the TSLs are staged until flushed */
+    for (i = 0; i < 3; i++) {
+        rt_snprintf(logbuf, sizeof(logbuf), "%d", i);
+        uassert_true(fdb_tsl_append(&test_tsdb, fdb_blob_make(&blob, logbuf, rt_strnlen(logbuf, sizeof(logbuf)))) == FDB_NO_ERR);
+    }
+    uassert_true(test_tsdb.ab_idx_len > 0);
+    uassert_true(fdb_tsl_flush(&test_tsdb) == FDB_NO_ERR);
+    uassert_int_equal(test_tsdb.ab_idx_len, 0);
+
+    /* the fifth TSL is appended at the deadline of the first */
+    fdb_tsdb_control(&test_tsdb, FDB_TSDB_CTRL_SET_FLUSH_DEADLINE, &deadline);
+    for (i = 0; i < 5; i++) {
+        rt_snprintf(logbuf, sizeof(logbuf), "%d", i);
+        uassert_true(fdb_tsl_append(&test_tsdb, fdb_blob_make(&blob, logbuf, rt_strnlen(logbuf, sizeof(logbuf)))) == FDB_NO_ERR);
+        uassert_true((i < 4) == (test_tsdb.ab_idx_len > 0));
+    }
+
+    /* reboot, all TSLs are kept */
+    test_fdb_tsdb_deinit();
+    test_fdb_tsdb_init_ex();
+    uassert_int_equal(fdb_tsl_query_count(&test_tsdb, 0, cur_times, FDB_TSL_WRITE), 8);
+}
+#endif /* FDB_TSDB_USING_APPEND_BUF */
+
+#ifdef FDB_TSDB_USING_SUMMARY
+static void test_fdb_tsl_agg_check(fdb_time_t from, fdb_time_t to, uint32_t count, double min, double max, double sum)
+{
+    struct fdb_tsl_agg agg;
+
+    uassert_true(fdb_tsl_query_agg(&test_tsdb, from, to, &agg) == FDB_NO_ERR);
+    uassert_int_equal(agg.count, count);
+    uassert_true(agg.min == min && agg.max == max && agg.sum == sum);
+}
+
+static bool test_fdb_tsl_agg_del_cb(fdb_tsl_t tsl, void *arg)
+{
+    if (tsl->time % (2 * TEST_TIME_STEP) != 0) {
+        uassert_true(fdb_tsl_set_status(&test_tsdb, tsl, FDB_TSL_DELETED) == FDB_NO_ERR);
+    }
+
+    return false;
+}
+
+/* the values are aggregated by the sector summaries, they are built again after reboot and deletion */
+static void test_fdb_tsl_query_agg(void)
+{
+    fdb_tsl_value_type_t type = FDB_TSL_VALUE_INT32;
+    struct fdb_blob blob;
+    int32_t value;
+    int i;
+
+    test_fdb_tsdb_deinit();
+    fdb_tsdb_control(&test_tsdb, FDB_TSDB_CTRL_SET_VALUE_TYPE, &type);
+    test_fdb_tsdb_init_ex();
+    fdb_tsl_clean(&test_tsdb);
+    cur_times = 0;
+    /* the value is the timestamp, 2 to 2000 in some sectors */
+    for (i = 0; i < 1000; i++) {
+        value = cur_times + TEST_TIME_STEP;
+        uassert_true(fdb_tsl_append(&test_tsdb, fdb_blob_make(&blob, &value, sizeof(value))) == FDB_NO_ERR);
+    }
+    uassert_true(fdb_tsl_append(&test_tsdb, fdb_blob_make(&blob, &value, 2)) == FDB_WRITE_ERR);
+
+    test_fdb_tsl_agg_check(0, 2000, 1000, 2, 2000, 1001000);
+    test_fdb_tsl_agg_check(501, 1499, 499, 502, 1498, 499000);
+    test_fdb_tsl_agg_check(1499, 501, 499, 502, 1498, 499000);
+    test_fdb_tsl_agg_check(3000, 4000, 0, 0, 0, 0);
+
+    /* reboot, then delete the values which aren't a multiple of 4 */
+    test_fdb_tsdb_deinit();
+    test_fdb_tsdb_init_ex();
+    test_fdb_tsl_agg_check(0, 2000, 1000, 2, 2000, 1001000);
+    fdb_tsl_iter(&test_tsdb, test_fdb_tsl_agg_del_cb, NULL);
+    test_fdb_tsl_agg_check(0, 2000, 500, 4, 2000, 501000);
+    test_fdb_tsl_agg_check(501, 1499, 249, 504, 1496, 249000);
+
+    test_fdb_tsdb_deinit();
+    type = FDB_TSL_VALUE_NONE;
+    fdb_tsdb_control(&test_tsdb, FDB_TSDB_CTRL_SET_VALUE_TYPE, &type);
+    test_fdb_tsdb_init_ex();
+}
+#endif /* FDB_TSDB_USING_SUMMARY */
+
 static void testcase(void)
 {
     UTEST_UNIT_RUN(test_fdb_tsdb_init_ex);
@@ -379,6 +500,15 @@ static void testcase(void)
     UTEST_UNIT_RUN(test_fdb_tsl_set_status);
     UTEST_UNIT_RUN(test_fdb_tsl_clean);
     UTEST_UNIT_RUN(test_fdb_tsl_iter_by_time_1);
+#ifdef FDB_TSDB_USING_SEC_INDEX
+    UTEST_UNIT_RUN(test_fdb_tsl_sec_index);
+#endif
+#ifdef FDB_TSDB_USING_APPEND_BUF
+    UTEST_UNIT_RUN(test_fdb_tsl_flush);
+#endif
+#ifdef FDB_TSDB_USING_SUMMARY
+    UTEST_UNIT_RUN(test_fdb_tsl_query_agg);
+#endif
     UTEST_UNIT_RUN(test_fdb_tsdb_deinit);
 }
 
@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2020, Armink, <armink.ztl@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Host benchmark of the TSDB aggregate queries by the sector summaries against the TSL iterator.
+ *
+ * cc -O2 -Ishim -I../../inc -o fdb_agg_bench fdb_agg_bench.c ../../src/fdb.c ../../src/fdb_kvdb.c ../../src/fdb_tsdb.c ../../src/fdb_utils.c
+ * ./fdb_agg_bench [queries]
+ *
+ * The TSDB is the 512 KB "tsdb" partition of the board, on a RAM NOR flash which read time is simulated with the
+ * W25Q128 timing at 18 MHz SPI. A float sample with 8 bytes of status is logged every second until the partition
+ * wraps, then some samples are deleted.
+ *
+ * The min, max and average of the last hour, the last day and all samples are queried by fdb_tsl_iter_by_time() with
+ * a blob read of each TSL, then by fdb_tsl_query_agg(). The flash time of each query is printed, the first summary
+ * query after reboot builds the summaries. Random ranges are compared with the iterator at last.
+ */
+
+#include <flashdb.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PART_SIZE               (512 * 1024)
+#define SEC_SIZE                4096
+#define TSL_SIZE                12
+
+/* W25Q128 read timing at 18 MHz SPI, in us */
+#define READ_US(size)           (4.0 + (size) * 0.45)
+
+static uint8_t flash[PART_SIZE];
+static double sim_us;
+
+static const struct fal_flash_dev nor = { "nor", 0, PART_SIZE, SEC_SIZE };
+static const struct fal_partition part = { 0, "tsdb", "nor", 0, PART_SIZE, 0 };
+
+int fal_init(void)
+{
+    return 1;
+}
+
+const struct fal_partition *fal_partition_find(const char *name)
+{
+    return &part;
+}
+
+const struct fal_flash_dev *fal_flash_device_find(const char *name)
+{
+    return &nor;
+}
+
+int fal_partition_read(const struct fal_partition *p, uint32_t addr, uint8_t *buf, size_t size)
+{
+    memcpy(buf, flash + addr, size);
+    sim_us += READ_US(size);
+    return size;
+}
+
+int fal_partition_write(const struct fal_partition *p, uint32_t addr, const uint8_t *buf, size_t size)
+{
+    size_t i;
+
+    for (i = 0; i < size; i++) {
+        flash[addr + i] &= buf[i];
+    }
+    return size;
+}
+
+int fal_partition_erase(const struct fal_partition *p, uint32_t addr, size_t size)
+{
+    memset(flash + addr, 0xFF, size);
+    return size;
+}
+
+static struct fdb_tsdb db;
+static fdb_time_t now;
+
+static fdb_time_t get_time(void)
+{
+    return now;
+}
+
+static void db_init(void)
+{
+    fdb_tsl_value_type_t type = FDB_TSL_VALUE_FLOAT;
+
+    memset(&db, 0, sizeof(db));
+    fdb_tsdb_control(&db, FDB_TSDB_CTRL_SET_VALUE_TYPE, &type);
+    if (fdb_tsdb_init(&db, "tsdb", "tsdb", get_time, 128, NULL) != FDB_NO_ERR) {
+        printf("init failed\n");
+        exit(1);
+    }
+}
+
+/* a slow wave with a spike every 1000 samples */
+static float sample(fdb_time_t time)
+{
+    return (float)((time % 3600) - 1800) / 100.0f + (time % 1000 == 0 ? 500.0f : 0.0f);
+}
+
+static bool iter_agg_cb(fdb_tsl_t tsl, void *arg)
+{
+    fdb_tsl_agg_t agg = arg;
+    struct fdb_blob blob;
+    float value = 0;
+
+    if (tsl->status != FDB_TSL_WRITE && tsl->status != FDB_TSL_USER_STATUS1) {
+        return false;
+    }
+    fdb_blob_read((fdb_db_t)&db, fdb_tsl_to_blob(tsl, fdb_blob_make(&blob, &value, sizeof(value))));
+    if (agg->count == 0 || value < agg->min) {
+        agg->min = value;
+    }
+    if (agg->count == 0 || value > agg->max) {
+        agg->max = value;
+    }
+    agg->sum += value;
+    agg->count++;
+
+    return false;
+}
+
+static void iter_agg(fdb_time_t from, fdb_time_t to, fdb_tsl_agg_t agg)
+{
+    memset(agg, 0, sizeof(struct fdb_tsl_agg));
+    fdb_tsl_iter_by_time(&db, from, to, iter_agg_cb, agg);
+}
+
+static bool agg_equal(fdb_tsl_agg_t a, fdb_tsl_agg_t b)
+{
+    double diff = a->sum - b->sum;
+
+    return a->count == b->count && (a->count == 0 || (a->min == b->min && a->max == b->max
+            && diff < 1e-6 * (1 + (b->sum < 0 ? -b->sum : b->sum)) && diff > -1e-6 * (1 + (b->sum < 0 ? -b->sum : b->sum))));
+}
+
+static unsigned long deleted_num;
+
+static bool delete_cb(fdb_tsl_t tsl, void *arg)
+{
+    if (tsl->time % 97 == 0) {
+        fdb_tsl_set_status(&db, tsl, FDB_TSL_DELETED);
+        deleted_num++;
+    }
+
+    return false;
+}
+
+int main(int argc, char **argv)
+{
+    static const struct {
+        const char *name;
+        fdb_time_t span;
+    } ranges[] = { { "1 hour", 3600 }, { "4 hours", 4 * 3600 }, { "all", 0 } };
+    unsigned long queries = argc > 1 ? atol(argv[1]) : 2000, n;
+    struct fdb_tsl_agg ref, agg;
+    struct fdb_blob blob;
+    uint8_t buf[TSL_SIZE] = { 0 };
+    fdb_time_t first, from, to;
+    float value;
+    int errors = 0;
+    size_t i;
+
+    memset(flash, 0xFF, sizeof(flash));
+    db_init();
+    /* log until the partition wraps */
+    for (now = 1; now < 60000; now++) {
+        value = sample(now);
+        memcpy(buf, &value, sizeof(value));
+        if (fdb_tsl_append(&db, fdb_blob_make(&blob, buf, sizeof(buf))) != FDB_NO_ERR) {
+            errors++;
+        }
+    }
+    fdb_tsl_flush(&db);
+    fdb_tsl_iter(&db, delete_cb, NULL);
+    fdb_tsdb_deinit(&db);
+    db_init();
+    iter_agg(0, now, &ref);
+    first = now - ref.count - deleted_num;
+    printf("%lu TSLs of %d B kept, %lu deleted, %d sectors\n", (unsigned long)ref.count, TSL_SIZE, deleted_num,
+            PART_SIZE / SEC_SIZE);
+
+    printf("  %8s %14s %14s %14s %8s\n", "range", "iterator ms", "first agg ms", "agg ms", "TSLs");
+    for (i = 0; i < sizeof(ranges) / sizeof(ranges[0]); i++) {
+        from = ranges[i].span ? now - ranges[i].span : 0;
+        to = now;
+        sim_us = 0;
+        iter_agg(from, to, &ref);
+        printf("  %8s %14.1f", ranges[i].name, sim_us / 1000);
+        /* reboot, the summaries are built by the first query */
+        fdb_tsdb_deinit(&db);
+        db_init();
+        sim_us = 0;
+        fdb_tsl_query_agg(&db, from, to, &agg);
+        errors += !agg_equal(&agg, &ref);
+        printf(" %14.1f", sim_us / 1000);
+        sim_us = 0;
+        fdb_tsl_query_agg(&db, from, to, &agg);
+        errors += !agg_equal(&agg, &ref);
+        printf(" %14.1f %8lu%s\n", sim_us / 1000, (unsigned long)ref.count,
+                agg_equal(&agg, &ref) ? "" : "  FAILED");
+    }
+
+    /* random ranges with appends between them */
+    for (n = 0; n < queries; n++) {
+        from = first + rand() % (now - first + 100) - 50;
+        to = from + rand() % (n % 2 ? 600 : 40000);
+        if (n % 3 == 0) {
+            value = sample(now);
+            memcpy(buf, &value, sizeof(value));
+            fdb_tsl_append(&db, fdb_blob_make(&blob, buf, sizeof(buf)));
+            now++;
+        }
+        iter_agg(from, to, &ref);
+        fdb_tsl_query_agg(&db, n % 2 ? to : from, n % 2 ? from : to, &agg);
+        if (!agg_equal(&agg, &ref)) {
+            errors++;
+        }
+    }
+    printf("%lu random queries%s\n", queries, errors ? "  FAILED" : ", all matched");
+    fdb_tsdb_deinit(&db);
+
+    return errors != 0;
+}
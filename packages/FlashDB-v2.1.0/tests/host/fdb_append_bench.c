@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2020, Armink, <armink.ztl@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Host benchmark of the TSL append rate with and without the append buffer.
+ *
+ * cc -O2 -Ishim -I../../inc -o fdb_append_bench fdb_append_bench.c ../../src/fdb.c ../../src/fdb_kvdb.c ../../src/fdb_tsdb.c ../../src/fdb_utils.c
+ * cc -O2 -Ishim -I../../inc -DFDB_TSDB_APPEND_BUF_SIZE=0 -o fdb_append_bench_direct fdb_append_bench.c ../../src/fdb.c ../../src/fdb_kvdb.c ../../src/fdb_tsdb.c ../../src/fdb_utils.c
+ * ./fdb_append_bench_direct [appends]; ./fdb_append_bench [appends]
+ *
+ * The TSDB is the 512 KB "tsdb" partition of the board, on a RAM NOR flash which time is simulated with the W25Q128
+ * typical timing. A write is split by pages into program commands, as SFUD does. The TSLs of each size are appended
+ * back to back, the oldest sectors are erased when the partition wraps, the erases are counted in the time.
+ *
+ * The appends per second, then the program commands, the program time and the total flash time per append are
+ * printed. The TSDB is initialized again, then the TSLs are read back and compared.
+ */
+
+#include <flashdb.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PART_SIZE               (512 * 1024)
+#define SEC_SIZE                4096
+#define PAGE_SIZE               256
+
+/* W25Q128 typical timing at 18 MHz SPI, in us */
+#define READ_US(size)           (4.0 + (size) * 0.45)
+#define PROGRAM_US(size)        (30.0 + (size) * 2.5)
+#define ERASE_US                45000.0
+
+static uint8_t flash[PART_SIZE];
+static double sim_us, program_us;
+static unsigned long program_num, erase_num;
+
+static const struct fal_flash_dev nor = { "nor", 0, PART_SIZE, SEC_SIZE };
+static const struct fal_partition part = { 0, "tsdb", "nor", 0, PART_SIZE, 0 };
+
+int fal_init(void)
+{
+    return 1;
+}
+
+const struct fal_partition *fal_partition_find(const char *name)
+{
+    return &part;
+}
+
+const struct fal_flash_dev *fal_flash_device_find(const char *name)
+{
+    return &nor;
+}
+
+int fal_partition_read(const struct fal_partition *p, uint32_t addr, uint8_t *buf, size_t size)
+{
+    memcpy(buf, flash + addr, size);
+    sim_us += READ_US(size);
+    return size;
+}
+
+int fal_partition_write(const struct fal_partition *p, uint32_t addr, const uint8_t *buf, size_t size)
+{
+    size_t i, chunk;
+
+    for (i = 0; i < size; i++) {
+        flash[addr + i] &= buf[i];
+    }
+    /* one page program command for each page */
+    for (i = 0; i < size; i += chunk) {
+        chunk = PAGE_SIZE - (addr + i) % PAGE_SIZE;
+        if (chunk > size - i) {
+            chunk = size - i;
+        }
+        sim_us += PROGRAM_US(chunk);
+        program_us += PROGRAM_US(chunk);
+        program_num++;
+    }
+    return size;
+}
+
+int fal_partition_erase(const struct fal_partition *p, uint32_t addr, size_t size)
+{
+    memset(flash + addr, 0xFF, size);
+    sim_us += ERASE_US * (size / SEC_SIZE);
+    erase_num += size / SEC_SIZE;
+    return size;
+}
+
+static struct fdb_tsdb db;
+static fdb_time_t now;
+
+static fdb_time_t get_time(void)
+{
+    return now;
+}
+
+struct check_args {
+    size_t size;
+    unsigned long num;
+    int errors;
+};
+
+static void make_tsl(uint8_t *buf, size_t size, fdb_time_t time)
+{
+    size_t i;
+
+    for (i = 0; i < size; i++) {
+        buf[i] = (uint8_t)(time * 31 + i);
+    }
+}
+
+static bool check_cb(fdb_tsl_t tsl, void *arg)
+{
+    struct check_args *args = arg;
+    uint8_t buf[128] = { 0 }, ref[128];
+    struct fdb_blob blob;
+
+    make_tsl(ref, args->size, tsl->time);
+    if (tsl->status != FDB_TSL_WRITE || tsl->log_len != args->size
+            || fdb_blob_read((fdb_db_t)&db, fdb_tsl_to_blob(tsl, fdb_blob_make(&blob, buf, sizeof(buf)))) != args->size
+            || memcmp(buf, ref, args->size)) {
+        args->errors++;
+    }
+    args->num++;
+
+    return false;
+}
+
+static int bench_run(unsigned long appends, size_t size)
+{
+    struct check_args args = { size, 0, 0 };
+    uint8_t buf[128];
+    struct fdb_blob blob;
+    unsigned long n, kept = 0;
+    double us;
+
+    memset(&db, 0, sizeof(db));
+    memset(flash, 0xFF, sizeof(flash));
+    if (fdb_tsdb_init(&db, "tsdb", "tsdb", get_time, 128, NULL) != FDB_NO_ERR) {
+        printf("init failed\n");
+        exit(1);
+    }
+    sim_us = 0;
+    program_us = 0;
+    program_num = 0;
+    erase_num = 0;
+
+    for (n = 0, now = 0; n < appends; n++) {
+        now++;
+        make_tsl(buf, size, now);
+        if (fdb_tsl_append(&db, fdb_blob_make(&blob, buf, size)) != FDB_NO_ERR) {
+            args.errors++;
+        }
+    }
+    fdb_tsl_flush(&db);
+    us = sim_us;
+
+    printf("  %4zu B %12.0f %11.2f %11.1f %11.1f %8lu", size, appends / (us / 1e6), (double)program_num / appends,
+            program_us / appends, us / appends, erase_num);
+
+    /* the TSLs since the oldest sector are kept */
+    fdb_tsdb_deinit(&db);
+    memset(&db, 0, sizeof(db));
+    fdb_tsdb_init(&db, "tsdb", "tsdb", get_time, 128, NULL);
+    fdb_tsl_iter(&db, check_cb, &args);
+    kept = fdb_tsl_query_count(&db, 0, now, FDB_TSL_WRITE);
+    if (args.num != kept || args.num == 0 || args.num > appends) {
+        args.errors++;
+    }
+    printf("%s\n", args.errors ? "  FAILED" : "");
+    fdb_tsdb_deinit(&db);
+
+    return args.errors;
+}
+
+int main(int argc, char **argv)
+{
+    static const size_t sizes[] = { 8, 32, 100 };
+    unsigned long appends = argc > 1 ? atol(argv[1]) : 100000;
+    int errors = 0;
+    size_t i;
+
+    printf("%lu appends, append buffer %d B\n", appends, FDB_TSDB_APPEND_BUF_SIZE);
+    printf("  %6s %12s %11s %11s %11s %8s\n", "TSL", "appends/s", "programs", "program us", "total us", "erases");
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        errors += bench_run(appends, sizes[i]);
+    }
+
+    return errors != 0;
+}
@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2020, Armink, <armink.ztl@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Host benchmark of the KVDB load time with and without the snapshot.
+ *
+ * cc -O2 -Ishim -I../../inc -o fdb_boot_bench fdb_boot_bench.c ../../src/fdb.c ../../src/fdb_kvdb.c ../../src/fdb_utils.c
+ * ./fdb_boot_bench [sets]
+ *
+ * The KVDB is the 512 KB "kvdb" partition of the board and the snapshot is the 64 KB "kvsnap" partition, on a RAM
+ * NOR flash which time is simulated with the W25Q128 typical timing. The KVs are set until the partition is full of
+ * old KVs, then the KVDB is loaded again in each case:
+ *
+ *   full         no snapshot, all sectors are scanned
+ *   snapshot     nothing is written since the snapshot
+ *   touched      some KVs are set since the snapshot, their sectors are scanned
+ *   gc           the GC erased and moved sectors since the snapshot
+ *   corrupted    the snapshot payload is damaged, all sectors are scanned
+ *
+ * The load time, the bytes read and the sectors marked on the snapshot are printed, then all KVs are compared.
+ */
+
+#include <flashdb.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PART_SIZE               (512 * 1024)
+#define SNAP_SIZE               (64 * 1024)
+#define SEC_SIZE                4096
+
+#define KEY_NUM                 150
+#define VALUE_MAX               64
+
+/* W25Q128 typical timing at 18 MHz SPI, in us */
+#define READ_US(size)           (4.0 + (size) * 0.45)
+#define PROGRAM_US(size)        (30.0 + (size) * 2.5)
+#define ERASE_US                45000.0
+
+static uint8_t flash[PART_SIZE + SNAP_SIZE];
+static double sim_us;
+static unsigned long read_bytes;
+
+static const struct fal_flash_dev nor = { "nor", 0, PART_SIZE + SNAP_SIZE, SEC_SIZE };
+static const struct fal_partition parts[] = {
+    { 0, "kvdb", "nor", 0, PART_SIZE, 0 },
+    { 0, "kvsnap", "nor", PART_SIZE, SNAP_SIZE, 0 },
+};
+
+int fal_init(void)
+{
+    return 1;
+}
+
+const struct fal_partition *fal_partition_find(const char *name)
+{
+    size_t i;
+
+    for (i = 0; i < sizeof(parts) / sizeof(parts[0]); i++) {
+        if (!strcmp(parts[i].name, name)) {
+            return &parts[i];
+        }
+    }
+    return NULL;
+}
+
+const struct fal_flash_dev *fal_flash_device_find(const char *name)
+{
+    return &nor;
+}
+
+int fal_partition_read(const struct fal_partition *p, uint32_t addr, uint8_t *buf, size_t size)
+{
+    memcpy(buf, flash + p->offset + addr, size);
+    sim_us += READ_US(size);
+    read_bytes += size;
+    return size;
+}
+
+int fal_partition_write(const struct fal_partition *p, uint32_t addr, const uint8_t *buf, size_t size)
+{
+    size_t i;
+
+    for (i = 0; i < size; i++) {
+        flash[p->offset + addr + i] &= buf[i];
+    }
+    sim_us += PROGRAM_US(size);
+    return size;
+}
+
+int fal_partition_erase(const struct fal_partition *p, uint32_t addr, size_t size)
+{
+    memset(flash + p->offset + addr, 0xFF, size);
+    sim_us += ERASE_US * (size / SEC_SIZE);
+    return size;
+}
+
+static struct fdb_kvdb db;
+static char ref[KEY_NUM][VALUE_MAX + 1];
+static uint32_t rng_state = 12345;
+
+static uint32_t rng(void)
+{
+    rng_state = rng_state * 1103515245 + 12345;
+    return rng_state >> 4;
+}
+
+static void kvdb_open(bool snapshot)
+{
+    memset(&db, 0, sizeof(db));
+    if (snapshot) {
+        fdb_kvdb_control(&db, FDB_KVDB_CTRL_SET_SNAPSHOT, (void *)"kvsnap");
+    }
+    if (fdb_kvdb_init(&db, "kvdb", "kvdb", NULL, NULL) != FDB_NO_ERR) {
+        printf("init failed\n");
+        exit(1);
+    }
+}
+
+static void set_kvs(unsigned long sets)
+{
+    char key[16], value[VALUE_MAX + 1];
+    unsigned long n;
+    size_t len;
+    int i;
+
+    for (n = 0; n < sets; n++) {
+        i = rng() % KEY_NUM;
+        len = 1 + rng() % VALUE_MAX;
+        snprintf(key, sizeof(key), "cal_%d", i);
+        memset(value, 'a' + n % 26, len);
+        value[len] = '\0';
+        if (fdb_kv_set(&db, key, value) == FDB_NO_ERR) {
+            strcpy(ref[i], value);
+        }
+    }
+}
+
+static int check_kvs(void)
+{
+    char key[16], value[VALUE_MAX + 1];
+    struct fdb_blob blob;
+    int i, errors = 0;
+    size_t len;
+
+    for (i = 0; i < KEY_NUM; i++) {
+        snprintf(key, sizeof(key), "cal_%d", i);
+        memset(value, 0, sizeof(value));
+        len = fdb_kv_get_blob(&db, key, fdb_blob_make(&blob, value, VALUE_MAX));
+        if (len != strlen(ref[i]) || memcmp(value, ref[i], len)) {
+            errors++;
+        }
+    }
+    return errors;
+}
+
+static int count_touched(void)
+{
+    size_t i;
+    int num = 0;
+
+    for (i = 0; i < sizeof(db.snap_touched); i++) {
+        num += __builtin_popcount(db.snap_touched[i]);
+    }
+    return num;
+}
+
+/* reload the KVDB like a reboot, nothing is saved on deinit */
+static int boot_run(const char *name, bool snapshot)
+{
+    int touched, errors;
+    double us;
+    unsigned long bytes;
+
+    sim_us = 0;
+    read_bytes = 0;
+    kvdb_open(snapshot);
+    us = sim_us;
+    bytes = read_bytes;
+    touched = snapshot ? count_touched() : 0;
+    errors = check_kvs();
+    printf("  %-10s %9.1f %11lu %8d%s\n", name, us / 1000, bytes, touched, errors ? "  FAILED" : "");
+    return errors;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long sets = argc > 1 ? atol(argv[1]) : 20000;
+    int errors = 0;
+
+    memset(flash, 0xFF, sizeof(flash));
+    kvdb_open(true);
+    set_kvs(sets);
+    fdb_kv_snapshot(&db);
+
+    printf("%lu sets of %d KVs, the snapshot is saved after them\n", sets, KEY_NUM);
+    printf("  %-10s %9s %11s %8s\n", "load", "ms", "read bytes", "touched");
+    errors += boot_run("full", false);
+    errors += boot_run("snapshot", true);
+
+    /* a few KVs in the using sector */
+    set_kvs(10);
+    errors += boot_run("touched", true);
+
+    /* until the GC by steps collects some sectors */
+    set_kvs(500);
+    while (fdb_kv_gc_step(&db));
+    errors += boot_run("gc", true);
+
+    /* flip a bit in the KV index of the newest snapshot */
+    fdb_kv_snapshot(&db);
+    flash[PART_SIZE + db.snap_addr + 2048] ^= 0x10;
+    errors += boot_run("corrupted", true);
+
+    return errors != 0;
+}
@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2020, Armink, <armink.ztl@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Host benchmark of the SPI read transactions of the KVDB with and without the FAL partition read cache.
+ *
+ * make fdb_cache_bench
+ * ./fdb_cache_bench [ops]
+ *
+ * The FAL of the board (fal.c, fal_flash.c and fal_partition.c) is built with the board read cache configuration in
+ * shim/rtt/rtconfig.h, which is set by -DFAL_CACHE_LINE_SIZE, -DFAL_CACHE_SETS, -DFAL_CACHE_WAYS and
+ * -DFAL_CACHE_FILL_SEQ_NUM. The KVDB is the 512 KB "kvdb" partition of the board, on a RAM NOR flash which time is
+ * simulated with the W25Q128 typical timing. Each flash device read is one SPI transaction.
+ *
+ * The KVs are set until the partition is full of old KVs, then in each case the KVDB is loaded, the KVs are got and
+ * set at random, the KVs are checked at last. The SPI read transactions, the bytes read, the cache hits and the flash
+ * time of each phase are printed.
+ */
+
+#include <flashdb.h>
+#include <fal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FLASH_SIZE              (8 * 1024 * 1024)
+#define SEC_SIZE                4096
+#define PART_SIZE               (512 * 1024)
+
+#define KEY_NUM                 150
+#define VALUE_MAX               64
+
+/* W25Q128 typical timing at 18 MHz SPI, in us */
+#define READ_US(size)           (4.0 + (size) * 0.45)
+#define PROGRAM_US(size)        (30.0 + (size) * 2.5)
+#define ERASE_US                45000.0
+
+static uint8_t flash[FLASH_SIZE];
+static double sim_us;
+static unsigned long read_num, read_bytes;
+
+static int nor_read(long offset, rt_uint8_t *buf, rt_size_t size)
+{
+    memcpy(buf, flash + offset, size);
+    sim_us += READ_US(size);
+    read_num++;
+    read_bytes += size;
+    return size;
+}
+
+static int nor_write(long offset, const rt_uint8_t *buf, rt_size_t size)
+{
+    size_t i;
+
+    for (i = 0; i < size; i++) {
+        flash[offset + i] &= buf[i];
+    }
+    sim_us += PROGRAM_US(size);
+    return size;
+}
+
+static int nor_erase(long offset, rt_size_t size)
+{
+    memset(flash + offset, 0xFF, size);
+    sim_us += ERASE_US * (size / SEC_SIZE);
+    return size;
+}
+
+struct fal_flash_dev nor_flash0 = {
+    .name       = FAL_USING_NOR_FLASH_DEV_NAME,
+    .addr       = 0,
+    .len        = FLASH_SIZE,
+    .blk_size   = SEC_SIZE,
+    .ops        = { NULL, nor_read, nor_write, nor_erase },
+    .write_gran = 1
+};
+
+static struct fdb_kvdb db;
+static char ref[KEY_NUM][VALUE_MAX + 1];
+static uint32_t rng_state;
+
+static uint32_t rng(void)
+{
+    rng_state = rng_state * 1103515245 + 12345;
+    return rng_state >> 4;
+}
+
+static void kvdb_open(void)
+{
+    memset(&db, 0, sizeof(db));
+    if (fdb_kvdb_init(&db, "kvdb", "kvdb", NULL, NULL) != FDB_NO_ERR) {
+        printf("init failed\n");
+        exit(1);
+    }
+}
+
+static void set_kv(void)
+{
+    char key[16], value[VALUE_MAX + 1];
+    size_t len;
+    int i;
+
+    i = rng() % KEY_NUM;
+    len = 1 + rng() % VALUE_MAX;
+    snprintf(key, sizeof(key), "cal_%d", i);
+    memset(value, 'a' + rng() % 26, len);
+    value[len] = '\0';
+    if (fdb_kv_set(&db, key, value) == FDB_NO_ERR) {
+        strcpy(ref[i], value);
+    }
+}
+
+static int get_kv(int i)
+{
+    char key[16], value[VALUE_MAX + 1] = { 0 };
+    struct fdb_blob blob;
+    size_t len;
+
+    snprintf(key, sizeof(key), "cal_%d", i);
+    len = fdb_kv_get_blob(&db, key, fdb_blob_make(&blob, value, VALUE_MAX));
+    return len != strlen(ref[i]) || memcmp(value, ref[i], len);
+}
+
+struct phase_stat {
+    unsigned long reads;
+    unsigned long bytes;
+    unsigned long hits;
+    double us;
+};
+
+static const struct fal_partition *part;
+static rt_uint32_t hit_begin;
+
+static void phase_begin(void)
+{
+    struct fal_cache_stat stat;
+
+    fal_partition_cache_stat(part, &stat);
+    hit_begin = stat.hit;
+    sim_us = 0;
+    read_num = 0;
+    read_bytes = 0;
+}
+
+static void phase_end(struct phase_stat *stat)
+{
+    struct fal_cache_stat cache;
+
+    fal_partition_cache_stat(part, &cache);
+    stat->reads = read_num;
+    stat->bytes = read_bytes;
+    stat->hits = cache.hit - hit_begin;
+    stat->us = sim_us;
+}
+
+/* the load, get and set phases with the same KVs and the same random sequence */
+static int bench_run(unsigned long ops, struct phase_stat *stats)
+{
+    unsigned long n;
+    int errors = 0, i;
+
+    /* the flash is changed without the partition API */
+    memset(flash + part->offset, 0xFF, PART_SIZE);
+    fal_cache_invalidate(&nor_flash0, part->offset, PART_SIZE);
+    memset(ref, 0, sizeof(ref));
+    rng_state = 12345;
+    kvdb_open();
+    for (n = 0; n < PART_SIZE / 64; n++) {
+        set_kv();
+    }
+    fdb_kvdb_deinit(&db);
+
+    phase_begin();
+    kvdb_open();
+    phase_end(&stats[0]);
+
+    phase_begin();
+    for (n = 0; n < ops; n++) {
+        errors += get_kv(rng() % KEY_NUM);
+    }
+    phase_end(&stats[1]);
+
+    phase_begin();
+    for (n = 0; n < ops / 10; n++) {
+        set_kv();
+        errors += get_kv(rng() % KEY_NUM);
+    }
+    phase_end(&stats[2]);
+
+    for (i = 0; i < KEY_NUM; i++) {
+        errors += get_kv(i);
+    }
+    fdb_kvdb_deinit(&db);
+
+    return errors;
+}
+
+int main(int argc, char **argv)
+{
+    static const char *phases[] = { "load", "get", "set+get" };
+    unsigned long ops = argc > 1 ? atol(argv[1]) : 20000;
+    struct phase_stat direct[3], cached[3];
+    int errors = 0, i;
+
+    memset(flash, 0xFF, sizeof(flash));
+    fal_init();
+    part = fal_partition_find("kvdb");
+
+    fal_partition_cache_enable(part, RT_FALSE);
+    errors += bench_run(ops, direct);
+    fal_partition_cache_enable(part, RT_TRUE);
+    errors += bench_run(ops, cached);
+
+    printf("%d KVs, %lu gets, %lu sets, cache %dx%d lines of %d B\n", KEY_NUM, ops, ops / 10, FAL_CACHE_SETS,
+            FAL_CACHE_WAYS, FAL_CACHE_LINE_SIZE);
+    printf("  %-8s %11s %11s %8s %11s %11s %11s %9s %9s\n", "phase", "SPI reads", "cached", "saved", "KB read",
+            "cached", "cache hits", "flash ms", "cached");
+    for (i = 0; i < 3; i++) {
+        printf("  %-8s %11lu %11lu %7.1f%% %11.1f %11.1f %11lu %9.1f %9.1f\n", phases[i], direct[i].reads,
+                cached[i].reads, 100.0 - 100.0 * cached[i].reads / direct[i].reads, direct[i].bytes / 1024.0,
+                cached[i].bytes / 1024.0, cached[i].hits, direct[i].us / 1000, cached[i].us / 1000);
+    }
+    printf("%s\n", errors ? "KV check FAILED" : "all KVs matched");
+
+    return errors != 0;
+}
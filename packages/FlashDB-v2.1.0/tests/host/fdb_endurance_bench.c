@@ -0,0 +1,426 @@
+/*
+ * Copyright (c) 2020, Armink, <armink.ztl@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Host benchmark and endurance run of the KVDB and TSDB, the result is printed as JSON.
+ *
+ * cc -O2 -Ishim -I../../inc -o fdb_endurance_bench fdb_endurance_bench.c ../../src/fdb.c ../../src/fdb_kvdb.c ../../src/fdb_tsdb.c ../../src/fdb_utils.c
+ * ./fdb_endurance_bench [kv_sets] [tsl_appends] > result.json
+ *
+ * The KVDB and TSDB are the 512 KB "kvdb" and "tsdb" partitions of the board with 4 KB sectors, on a RAM NOR flash
+ * which time is simulated with the W25Q128 typical timing. The program only clears bits as the NOR flash does.
+ *
+ *   kv     random KVs are set with the inline GC, then read, the latency of the sets which erase is the GC pause
+ *   tsdb   32 bytes TSLs are appended until the partition wraps many times, then read by random 1 s time ranges
+ *
+ * The default is 100000 KV sets and 1000000 TSL appends, the KV sets take most of the run time.
+ * The ops/s are computed with the simulated flash time, the CPU time on the RAM flash is printed apart. The write
+ * amplification is the bytes programmed per byte of key and value or TSL. The erase count of each sector shows the
+ * wear after the run. The databases are initialized again and compared at the end, the exit code is 1 on errors.
+ */
+
+#include <flashdb.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define PART_SIZE               (512 * 1024)
+#define SEC_SIZE                4096
+#define SEC_NUM                 (PART_SIZE / SEC_SIZE)
+
+#define KEY_NUM                 150
+#define VALUE_MAX               64
+#define TSL_SIZE                32
+#define TSL_PERIOD_MS           100
+#define QUERY_MS                1000
+
+/* W25Q128 typical timing at 18 MHz SPI, in us */
+#define READ_US(size)           (4.0 + (size) * 0.45)
+#define PROGRAM_US(size)        (30.0 + (size) * 2.5)
+#define ERASE_US                45000.0
+
+/* the GC pause histogram upper bounds, in ms */
+static const double gc_bucket_ms[] = { 100, 500, 1000, 2000, 5000 };
+#define GC_BUCKET_NUM           (sizeof(gc_bucket_ms) / sizeof(gc_bucket_ms[0]) + 1)
+
+enum {
+    PART_KV,
+    PART_TS,
+    PART_NUM,
+};
+
+static uint8_t flash[PART_NUM * PART_SIZE];
+static double sim_us;
+static unsigned long long program_bytes[PART_NUM];
+static unsigned long erase_num[PART_NUM];
+static uint32_t erase_count[PART_NUM][SEC_NUM];
+
+static const struct fal_flash_dev nor = { "nor", 0, PART_NUM * PART_SIZE, SEC_SIZE };
+static const struct fal_partition parts[PART_NUM] = {
+    { 0, "kvdb", "nor", 0, PART_SIZE, 0 },
+    { 0, "tsdb", "nor", PART_SIZE, PART_SIZE, 0 },
+};
+
+int fal_init(void)
+{
+    return 1;
+}
+
+const struct fal_partition *fal_partition_find(const char *name)
+{
+    size_t i;
+
+    for (i = 0; i < PART_NUM; i++) {
+        if (!strcmp(parts[i].name, name)) {
+            return &parts[i];
+        }
+    }
+    return NULL;
+}
+
+const struct fal_flash_dev *fal_flash_device_find(const char *name)
+{
+    return &nor;
+}
+
+int fal_partition_read(const struct fal_partition *p, uint32_t addr, uint8_t *buf, size_t size)
+{
+    memcpy(buf, flash + p->offset + addr, size);
+    sim_us += READ_US(size);
+    return size;
+}
+
+int fal_partition_write(const struct fal_partition *p, uint32_t addr, const uint8_t *buf, size_t size)
+{
+    size_t i;
+
+    for (i = 0; i < size; i++) {
+        flash[p->offset + addr + i] &= buf[i];
+    }
+    sim_us += PROGRAM_US(size);
+    program_bytes[p - parts] += size;
+    return size;
+}
+
+int fal_partition_erase(const struct fal_partition *p, uint32_t addr, size_t size)
+{
+    size_t i;
+
+    memset(flash + p->offset + addr, 0xFF, size);
+    for (i = 0; i < size / SEC_SIZE; i++) {
+        erase_count[p - parts][addr / SEC_SIZE + i]++;
+    }
+    erase_num[p - parts] += size / SEC_SIZE;
+    sim_us += ERASE_US * (size / SEC_SIZE);
+    return size;
+}
+
+struct kv_result {
+    unsigned long sets, gets;
+    double set_us, get_us, set_cpu_ns, get_cpu_ns;
+    double *lat_us;                              /* latency of each set */
+    double *gc_us;                               /* latency of the sets which erase */
+    unsigned long gc_sets;
+    unsigned long gc_hist[GC_BUCKET_NUM];
+    unsigned long long logical_bytes;
+    int errors;
+};
+
+struct ts_result {
+    unsigned long appends, queries, query_tsls;
+    double append_us, query_us, append_cpu_ns, query_cpu_ns;
+    unsigned long long logical_bytes;
+    int errors;
+};
+
+static struct fdb_kvdb kvdb;
+static struct fdb_tsdb tsdb;
+static char ref[KEY_NUM][VALUE_MAX + 1];
+static fdb_time_t now;
+static uint32_t rng_state = 12345;
+
+static uint32_t rng(void)
+{
+    rng_state = rng_state * 1103515245 + 12345;
+    return rng_state >> 4;
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static fdb_time_t get_time(void)
+{
+    return now;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    return *(const double *)a < *(const double *)b ? -1 : *(const double *)a > *(const double *)b;
+}
+
+static double percentile(const double *sorted, unsigned long num, unsigned long per_mille)
+{
+    return num ? sorted[(num - 1) * per_mille / 1000] : 0;
+}
+
+static int kv_check(void)
+{
+    char key[16], value[VALUE_MAX + 1];
+    struct fdb_blob blob;
+    int i, errors = 0;
+    size_t len;
+
+    for (i = 0; i < KEY_NUM; i++) {
+        snprintf(key, sizeof(key), "cal_%d", i);
+        memset(value, 0, sizeof(value));
+        len = fdb_kv_get_blob(&kvdb, key, fdb_blob_make(&blob, value, VALUE_MAX));
+        if (len != strlen(ref[i]) || memcmp(value, ref[i], len)) {
+            errors++;
+        }
+    }
+    return errors;
+}
+
+static void kv_run(unsigned long sets, struct kv_result *r)
+{
+    char key[16], value[VALUE_MAX + 1];
+    struct fdb_blob blob;
+    unsigned long n, erase_before;
+    double start_us, start_ns;
+    size_t len, j;
+    int i;
+
+    r->sets = sets;
+    r->lat_us = malloc(sets * sizeof(double));
+    r->gc_us = malloc(sets * sizeof(double));
+    if (fdb_kvdb_init(&kvdb, "kvdb", "kvdb", NULL, NULL) != FDB_NO_ERR) {
+        fprintf(stderr, "KVDB init failed\n");
+        exit(1);
+    }
+
+    start_ns = now_ns();
+    for (n = 0; n < sets; n++) {
+        i = rng() % KEY_NUM;
+        len = 1 + rng() % VALUE_MAX;
+        snprintf(key, sizeof(key), "cal_%d", i);
+        memset(value, 'a' + n % 26, len);
+        value[len] = '\0';
+
+        erase_before = erase_num[PART_KV];
+        start_us = sim_us;
+        if (fdb_kv_set(&kvdb, key, value) != FDB_NO_ERR) {
+            r->errors++;
+        } else {
+            strcpy(ref[i], value);
+        }
+        r->lat_us[n] = sim_us - start_us;
+        r->set_us += r->lat_us[n];
+        r->logical_bytes += strlen(key) + len;
+
+        if (erase_num[PART_KV] != erase_before) {
+            for (j = 0; j < GC_BUCKET_NUM - 1 && r->lat_us[n] >= gc_bucket_ms[j] * 1000; j++);
+            r->gc_hist[j]++;
+            r->gc_us[r->gc_sets++] = r->lat_us[n];
+        }
+    }
+    r->set_cpu_ns = now_ns() - start_ns;
+
+    /* the same number of gets, of random KVs */
+    r->gets = sets;
+    start_us = sim_us;
+    start_ns = now_ns();
+    for (n = 0; n < r->gets; n++) {
+        snprintf(key, sizeof(key), "cal_%d", (int)(rng() % KEY_NUM));
+        fdb_kv_get_blob(&kvdb, key, fdb_blob_make(&blob, value, VALUE_MAX));
+    }
+    r->get_cpu_ns = now_ns() - start_ns;
+    r->get_us = sim_us - start_us;
+
+    qsort(r->lat_us, sets, sizeof(double), cmp_double);
+    qsort(r->gc_us, r->gc_sets, sizeof(double), cmp_double);
+
+    /* like a reboot */
+    r->errors += kv_check();
+    fdb_kvdb_deinit(&kvdb);
+    memset(&kvdb, 0, sizeof(kvdb));
+    fdb_kvdb_init(&kvdb, "kvdb", "kvdb", NULL, NULL);
+    r->errors += kv_check();
+    fdb_kvdb_deinit(&kvdb);
+}
+
+static void make_tsl(uint8_t *buf, fdb_time_t time)
+{
+    size_t i;
+
+    for (i = 0; i < TSL_SIZE; i++) {
+        buf[i] = (uint8_t)(time * 31 + i);
+    }
+}
+
+static bool query_cb(fdb_tsl_t tsl, void *arg)
+{
+    struct ts_result *r = arg;
+    uint8_t buf[TSL_SIZE] = { 0 }, ref_buf[TSL_SIZE];
+    struct fdb_blob blob;
+
+    make_tsl(ref_buf, tsl->time);
+    if (tsl->status != FDB_TSL_WRITE || tsl->log_len != TSL_SIZE
+            || fdb_blob_read((fdb_db_t)&tsdb, fdb_tsl_to_blob(tsl, fdb_blob_make(&blob, buf, TSL_SIZE))) != TSL_SIZE
+            || memcmp(buf, ref_buf, TSL_SIZE)) {
+        r->errors++;
+    }
+    r->query_tsls++;
+
+    return false;
+}
+
+static void ts_run(unsigned long appends, struct ts_result *r)
+{
+    uint8_t buf[TSL_SIZE];
+    struct fdb_blob blob;
+    fdb_time_t oldest, from;
+    unsigned long n, tsls;
+    double start_us, start_ns;
+
+    r->appends = appends;
+    if (fdb_tsdb_init(&tsdb, "tsdb", "tsdb", get_time, 128, NULL) != FDB_NO_ERR) {
+        fprintf(stderr, "TSDB init failed\n");
+        exit(1);
+    }
+
+    start_us = sim_us;
+    start_ns = now_ns();
+    for (n = 0, now = 0; n < appends; n++) {
+        now += TSL_PERIOD_MS;
+        make_tsl(buf, now);
+        if (fdb_tsl_append(&tsdb, fdb_blob_make(&blob, buf, TSL_SIZE)) != FDB_NO_ERR) {
+            r->errors++;
+        }
+        r->logical_bytes += TSL_SIZE;
+    }
+    fdb_tsl_flush(&tsdb);
+    r->append_cpu_ns = now_ns() - start_ns;
+    r->append_us = sim_us - start_us;
+
+    /* random ranges of the TSLs which are kept */
+    tsls = fdb_tsl_query_count(&tsdb, 0, now, FDB_TSL_WRITE);
+    oldest = now - (fdb_time_t)(tsls - 1) * TSL_PERIOD_MS;
+    r->queries = appends / 100 ? appends / 100 : 1;
+    start_us = sim_us;
+    start_ns = now_ns();
+    for (n = 0; n < r->queries; n++) {
+        from = oldest + (fdb_time_t)(rng() % tsls) * TSL_PERIOD_MS;
+        fdb_tsl_iter_by_time(&tsdb, from, from + QUERY_MS - 1, query_cb, r);
+    }
+    r->query_cpu_ns = now_ns() - start_ns;
+    r->query_us = sim_us - start_us;
+
+    /* like a reboot, all kept TSLs are read back */
+    fdb_tsdb_deinit(&tsdb);
+    memset(&tsdb, 0, sizeof(tsdb));
+    fdb_tsdb_init(&tsdb, "tsdb", "tsdb", get_time, 128, NULL);
+    if (fdb_tsl_query_count(&tsdb, 0, now, FDB_TSL_WRITE) != tsls || tsls == 0) {
+        r->errors++;
+    }
+    fdb_tsdb_deinit(&tsdb);
+}
+
+static double ops_per_s(unsigned long ops, double us)
+{
+    return us > 0 ? ops / (us / 1e6) : 0;
+}
+
+static void print_erase_counts(int part, const char *indent)
+{
+    uint32_t min = UINT32_MAX, max = 0;
+    unsigned long long sum = 0;
+    size_t i;
+
+    for (i = 0; i < SEC_NUM; i++) {
+        sum += erase_count[part][i];
+        min = erase_count[part][i] < min ? erase_count[part][i] : min;
+        max = erase_count[part][i] > max ? erase_count[part][i] : max;
+    }
+    printf("%s\"erases\": {\"total\": %llu, \"min\": %u, \"max\": %u, \"mean\": %.1f, \"per_sector\": [", indent, sum,
+            min, max, (double)sum / SEC_NUM);
+    for (i = 0; i < SEC_NUM; i++) {
+        printf("%s%u", i ? ", " : "", erase_count[part][i]);
+    }
+    printf("]}\n");
+}
+
+static void print_json(const struct kv_result *kv, const struct ts_result *ts)
+{
+    size_t i;
+
+    printf("{\n");
+    printf("  \"flash\": {\"sector_size\": %d, \"partition_size\": %d, \"write_gran\": %d},\n", SEC_SIZE, PART_SIZE,
+            FDB_WRITE_GRAN);
+    printf("  \"kvdb\": {\n");
+    printf("    \"sets\": %lu, \"gets\": %lu, \"keys\": %d,\n", kv->sets, kv->gets, KEY_NUM);
+    printf("    \"set_ops_per_s\": %.1f, \"get_ops_per_s\": %.1f,\n", ops_per_s(kv->sets, kv->set_us),
+            ops_per_s(kv->gets, kv->get_us));
+    printf("    \"set_cpu_ns\": %.0f, \"get_cpu_ns\": %.0f,\n", kv->set_cpu_ns / kv->sets, kv->get_cpu_ns / kv->gets);
+    printf("    \"set_ms\": {\"mean\": %.3f, \"p50\": %.3f, \"p99\": %.3f, \"p999\": %.3f, \"max\": %.3f},\n",
+            kv->set_us / kv->sets / 1000, percentile(kv->lat_us, kv->sets, 500) / 1000,
+            percentile(kv->lat_us, kv->sets, 990) / 1000, percentile(kv->lat_us, kv->sets, 999) / 1000,
+            kv->lat_us[kv->sets - 1] / 1000);
+    printf("    \"gc_pause_ms\": {\"count\": %lu, \"p50\": %.1f, \"p99\": %.1f, \"max\": %.1f, \"histogram\": [",
+            kv->gc_sets, percentile(kv->gc_us, kv->gc_sets, 500) / 1000, percentile(kv->gc_us, kv->gc_sets, 990) / 1000,
+            kv->gc_sets ? kv->gc_us[kv->gc_sets - 1] / 1000 : 0);
+    for (i = 0; i < GC_BUCKET_NUM; i++) {
+        if (i < GC_BUCKET_NUM - 1) {
+            printf("%s{\"lt\": %.0f, \"count\": %lu}", i ? ", " : "", gc_bucket_ms[i], kv->gc_hist[i]);
+        } else {
+            printf(", {\"lt\": null, \"count\": %lu}", kv->gc_hist[i]);
+        }
+    }
+    printf("]},\n");
+    printf("    \"write_amplification\": %.2f,\n", (double)program_bytes[PART_KV] / kv->logical_bytes);
+    print_erase_counts(PART_KV, "    ");
+    printf("  },\n");
+    printf("  \"tsdb\": {\n");
+    printf("    \"appends\": %lu, \"tsl_size\": %d, \"queries\": %lu, \"query_tsls\": %lu,\n", ts->appends, TSL_SIZE,
+            ts->queries, ts->query_tsls);
+    printf("    \"append_ops_per_s\": %.1f, \"query_ops_per_s\": %.1f, \"query_tsls_per_s\": %.1f,\n",
+            ops_per_s(ts->appends, ts->append_us), ops_per_s(ts->queries, ts->query_us),
+            ops_per_s(ts->query_tsls, ts->query_us));
+    printf("    \"append_cpu_ns\": %.0f, \"query_cpu_ns\": %.0f,\n", ts->append_cpu_ns / ts->appends,
+            ts->query_cpu_ns / ts->queries);
+    printf("    \"write_amplification\": %.2f,\n", (double)program_bytes[PART_TS] / ts->logical_bytes);
+    print_erase_counts(PART_TS, "    ");
+    printf("  },\n");
+    printf("  \"errors\": %d\n", kv->errors + ts->errors);
+    printf("}\n");
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long sets = argc > 1 ? atol(argv[1]) : 100000;
+    unsigned long appends = argc > 2 ? atol(argv[2]) : 1000000;
+    static struct kv_result kv;
+    static struct ts_result ts;
+
+    if (sets == 0 || appends == 0) {
+        fprintf(stderr, "usage: %s [kv_sets] [tsl_appends]\n", argv[0]);
+        return 1;
+    }
+    memset(flash, 0xFF, sizeof(flash));
+    kv_run(sets, &kv);
+    ts_run(appends, &ts);
+    print_json(&kv, &ts);
+    free(kv.lat_us);
+    free(kv.gc_us);
+
+    return kv.errors + ts.errors != 0;
+}
@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2020, Armink, <armink.ztl@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Host benchmark of the KV set latency with and without the GC by steps.
+ *
+ * cc -O2 -Ishim -I../../inc -o fdb_gc_bench fdb_gc_bench.c ../../src/fdb.c ../../src/fdb_kvdb.c ../../src/fdb_utils.c
+ * ./fdb_gc_bench [sets] [period_ms]
+ *
+ * The KVDB is the 512 KB "kvdb" partition of the board, on a RAM NOR flash which time is simulated with the W25Q128
+ * typical timing. A KV is set every period, the same random sequence twice:
+ *
+ *   inline   the GC runs when saving a KV, as without the GC task
+ *   step     fdb_kv_gc_step() is called while idle until the next set is due, a set waits for the running step
+ *
+ * The latency of each set includes the wait, the KVs are read back and compared at the end.
+ */
+
+#include <flashdb.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PART_SIZE               (512 * 1024)
+#define SEC_SIZE                4096
+
+#define KEY_NUM                 150
+#define VALUE_MAX               64
+
+/* W25Q128 typical timing at 18 MHz SPI, in us */
+#define READ_US(size)           (4.0 + (size) * 0.45)
+#define PROGRAM_US(size)        (30.0 + (size) * 2.5)
+#define ERASE_US                45000.0
+
+static uint8_t flash[PART_SIZE];
+static double sim_us;
+static unsigned long erase_num;
+
+static const struct fal_flash_dev nor = { "nor", 0, PART_SIZE, SEC_SIZE };
+static const struct fal_partition part = { 0, "kvdb", "nor", 0, PART_SIZE, 0 };
+
+int fal_init(void)
+{
+    return 1;
+}
+
+const struct fal_partition *fal_partition_find(const char *name)
+{
+    return &part;
+}
+
+const struct fal_flash_dev *fal_flash_device_find(const char *name)
+{
+    return &nor;
+}
+
+int fal_partition_read(const struct fal_partition *p, uint32_t addr, uint8_t *buf, size_t size)
+{
+    memcpy(buf, flash + addr, size);
+    sim_us += READ_US(size);
+    return size;
+}
+
+int fal_partition_write(const struct fal_partition *p, uint32_t addr, const uint8_t *buf, size_t size)
+{
+    size_t i;
+
+    for (i = 0; i < size; i++) {
+        flash[addr + i] &= buf[i];
+    }
+    sim_us += PROGRAM_US(size);
+    return size;
+}
+
+int fal_partition_erase(const struct fal_partition *p, uint32_t addr, size_t size)
+{
+    memset(flash + addr, 0xFF, size);
+    sim_us += ERASE_US * (size / SEC_SIZE);
+    erase_num += size / SEC_SIZE;
+    return size;
+}
+
+struct bench_result {
+    double *lat_us;                              /* latency of each set */
+    double sum_us, wait_us;
+    unsigned long gc_sets;                       /* sets which GC inline */
+    unsigned long erases;
+    unsigned long steps;
+    int errors;
+};
+
+static uint32_t rng_state;
+
+static uint32_t rng(void)
+{
+    rng_state = rng_state * 1103515245 + 12345;
+    return rng_state >> 4;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    return *(const double *)a < *(const double *)b ? -1 : *(const double *)a > *(const double *)b;
+}
+
+static void bench_run(unsigned long sets, double period_us, int use_step, struct bench_result *r)
+{
+    static char ref[KEY_NUM][VALUE_MAX + 1];
+    static struct fdb_kvdb db;
+    char key[16], value[VALUE_MAX + 1];
+    struct fdb_blob blob;
+    unsigned long n, erase_before;
+    double last_us;
+    size_t len;
+    int i;
+
+    memset(r, 0, sizeof(*r));
+    r->lat_us = malloc(sets * sizeof(double));
+    memset(ref, 0, sizeof(ref));
+    memset(&db, 0, sizeof(db));
+    memset(flash, 0xFF, sizeof(flash));
+    rng_state = 12345;
+    if (fdb_kvdb_init(&db, "kvdb", "kvdb", NULL, NULL) != FDB_NO_ERR) {
+        printf("init failed\n");
+        exit(1);
+    }
+    sim_us = 0;
+    erase_num = 0;
+
+    for (n = 0, last_us = 0; n < sets; n++) {
+        /* a set late for the previous sets isn't counted as waiting */
+        double start = n * period_us > last_us ? n * period_us : last_us;
+
+        /* the GC task runs while idle, a step started before the set is due delays it */
+        while (use_step && sim_us < start && fdb_kv_gc_step(&db)) {
+            r->steps++;
+        }
+        if (sim_us < start) {
+            sim_us = start;
+        }
+        r->wait_us += sim_us - start;
+        erase_before = erase_num;
+
+        i = rng() % KEY_NUM;
+        len = 1 + rng() % VALUE_MAX;
+        snprintf(key, sizeof(key), "cal_%d", i);
+        memset(value, 'a' + n % 26, len);
+        value[len] = '\0';
+        if (fdb_kv_set(&db, key, value) != FDB_NO_ERR) {
+            r->errors++;
+        } else {
+            strcpy(ref[i], value);
+        }
+
+        last_us = sim_us;
+        r->lat_us[n] = sim_us - start;
+        r->sum_us += sim_us - start;
+        if (erase_num != erase_before) {
+            r->gc_sets++;
+        }
+    }
+    r->erases = erase_num;
+    qsort(r->lat_us, sets, sizeof(double), cmp_double);
+
+    for (i = 0; i < KEY_NUM; i++) {
+        snprintf(key, sizeof(key), "cal_%d", i);
+        memset(value, 0, sizeof(value));
+        len = fdb_kv_get_blob(&db, key, fdb_blob_make(&blob, value, VALUE_MAX));
+        if (len != strlen(ref[i]) || memcmp(value, ref[i], len)) {
+            r->errors++;
+        }
+    }
+    fdb_kvdb_deinit(&db);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long sets = argc > 1 ? atol(argv[1]) : 10000;
+    double period_ms = argc > 2 ? atof(argv[2]) : 1000;
+    struct bench_result r[2];
+    int i;
+
+    printf("%lu sets of %d KVs, one every %.0f ms\n", sets, KEY_NUM, period_ms);
+    printf("  %-8s %9s %9s %9s %9s %9s %9s %8s %7s\n", "mode", "mean ms", "p99 ms", "p99.9 ms", "max ms", "wait ms",
+            "GC sets", "erases", "steps");
+    for (i = 0; i < 2; i++) {
+        bench_run(sets, period_ms * 1000, i, &r[i]);
+        printf("  %-8s %9.1f %9.1f %9.1f %9.1f %9.1f %9lu %8lu %7lu%s\n", i ? "step" : "inline",
+                r[i].sum_us / sets / 1000, r[i].lat_us[sets * 99 / 100] / 1000, r[i].lat_us[sets * 999 / 1000] / 1000,
+                r[i].lat_us[sets - 1] / 1000, r[i].wait_us / 1000, r[i].gc_sets, r[i].erases, r[i].steps,
+                r[i].errors ? "  FAILED" : "");
+        free(r[i].lat_us);
+    }
+
+    return r[0].errors || r[1].errors;
+}
@@ -0,0 +1,303 @@
+/*
+ * Copyright (c) 2020, Armink, <armink.ztl@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Host benchmark of the KV read latency under writes, with the exclusive lock and the reader/writer lock.
+ *
+ * cc -O2 -Ishim -I../../inc -DFDB_BENCH_EXCLUSIVE -o fdb_rw_bench_exclusive fdb_rw_bench.c ../../src/fdb.c ../../src/fdb_kvdb.c ../../src/fdb_tsdb.c ../../src/fdb_utils.c -lpthread
+ * cc -O2 -Ishim -I../../inc -o fdb_rw_bench fdb_rw_bench.c ../../src/fdb.c ../../src/fdb_kvdb.c ../../src/fdb_tsdb.c ../../src/fdb_utils.c -lpthread
+ * ./fdb_rw_bench_exclusive [seconds]; ./fdb_rw_bench [seconds]
+ *
+ * The KVDB is the 512 KB "kvdb" partition of the board, on a RAM NOR flash which program and erase sleep the W25Q128
+ * typical time. The flash is locked by each command, as SFUD locks the SPI device. The lock is the same as the board:
+ * a recursive mutex, the readers are counted under it and a writer waits until they leave.
+ *
+ * A writer sets the KVs and runs the GC by steps, as the GC task. The readers get the KVs at the same time. The read
+ * latency percentiles, the reads which took the lock and the wrong values are printed.
+ */
+
+#include <flashdb.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define PART_SIZE               (512 * 1024)
+#define SEC_SIZE                4096
+
+#define KEY_NUM                 150
+#define VALUE_MAX               64
+#define READER_NUM              3
+#define READS_MAX               (1 << 20)
+
+/* W25Q128 typical timing, in us */
+#define PROGRAM_US(size)        (30 + (size) * 5 / 2)
+#define ERASE_US                45000
+
+static uint8_t flash[PART_SIZE];
+static pthread_mutex_t spi_lock = PTHREAD_MUTEX_INITIALIZER;
+/* the flash is timed after the KVDB is filled */
+static int timed;
+
+static const struct fal_flash_dev nor = { "nor", 0, PART_SIZE, SEC_SIZE };
+static const struct fal_partition part = { 0, "kvdb", "nor", 0, PART_SIZE, 0 };
+
+static void sleep_us(long us)
+{
+    struct timespec ts = { us / 1000000, us % 1000000 * 1000 };
+
+    nanosleep(&ts, NULL);
+}
+
+static double now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+int fal_init(void)
+{
+    return 1;
+}
+
+const struct fal_partition *fal_partition_find(const char *name)
+{
+    return &part;
+}
+
+const struct fal_flash_dev *fal_flash_device_find(const char *name)
+{
+    return &nor;
+}
+
+int fal_partition_read(const struct fal_partition *p, uint32_t addr, uint8_t *buf, size_t size)
+{
+    if (addr + size > PART_SIZE) {
+        return -1;
+    }
+    pthread_mutex_lock(&spi_lock);
+    memcpy(buf, flash + addr, size);
+    pthread_mutex_unlock(&spi_lock);
+    return size;
+}
+
+int fal_partition_write(const struct fal_partition *p, uint32_t addr, const uint8_t *buf, size_t size)
+{
+    size_t i;
+
+    pthread_mutex_lock(&spi_lock);
+    for (i = 0; i < size; i++) {
+        flash[addr + i] &= buf[i];
+    }
+    if (timed) {
+        sleep_us(PROGRAM_US(size));
+    }
+    pthread_mutex_unlock(&spi_lock);
+    return size;
+}
+
+int fal_partition_erase(const struct fal_partition *p, uint32_t addr, size_t size)
+{
+    pthread_mutex_lock(&spi_lock);
+    memset(flash + addr, 0xFF, size);
+    if (timed) {
+        sleep_us(ERASE_US * (size / SEC_SIZE));
+    }
+    pthread_mutex_unlock(&spi_lock);
+    return size;
+}
+
+static struct fdb_kvdb db;
+static pthread_mutex_t db_mutex;
+static pthread_mutex_t rd_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t rd_cond = PTHREAD_COND_INITIALIZER;
+static int readers;
+static volatile int running;
+static unsigned long locked_reads;
+
+static void kvdb_lock(fdb_db_t db)
+{
+    pthread_mutex_lock(&db_mutex);
+    pthread_mutex_lock(&rd_mutex);
+    while (readers) {
+        pthread_cond_wait(&rd_cond, &rd_mutex);
+    }
+    pthread_mutex_unlock(&rd_mutex);
+}
+
+static void kvdb_unlock(fdb_db_t db)
+{
+    pthread_mutex_unlock(&db_mutex);
+}
+
+#ifdef FDB_USING_RW_LOCK
+static void kvdb_rdlock(fdb_db_t db)
+{
+    pthread_mutex_lock(&db_mutex);
+    pthread_mutex_lock(&rd_mutex);
+    readers++;
+    locked_reads++;
+    pthread_mutex_unlock(&rd_mutex);
+    pthread_mutex_unlock(&db_mutex);
+}
+
+static void kvdb_rdunlock(fdb_db_t db)
+{
+    pthread_mutex_lock(&rd_mutex);
+    if (--readers == 0) {
+        pthread_cond_broadcast(&rd_cond);
+    }
+    pthread_mutex_unlock(&rd_mutex);
+}
+#endif /* FDB_USING_RW_LOCK */
+
+/* the value is the key number, the generation and a pattern of them, so a torn or wrong value is found */
+static size_t make_value(uint8_t *buf, uint32_t key, uint32_t gen)
+{
+    size_t len = 8 + (key * 7 + gen) % (VALUE_MAX - 7), i;
+
+    memcpy(buf, &key, 4);
+    memcpy(buf + 4, &gen, 4);
+    for (i = 8; i < len; i++) {
+        buf[i] = (uint8_t)(key * 31 + gen * 17 + i);
+    }
+    return len;
+}
+
+struct reader_args {
+    double *lat;
+    unsigned long num;
+    unsigned long errors;
+    uint32_t seed;
+};
+
+static void *reader_entry(void *arg)
+{
+    struct reader_args *args = arg;
+    uint8_t buf[VALUE_MAX], ref[VALUE_MAX];
+    struct fdb_blob blob;
+    char key[16];
+    uint32_t id, gen;
+    size_t len;
+    double start;
+
+    while (running) {
+        args->seed = args->seed * 1103515245 + 12345;
+        id = (args->seed >> 8) % KEY_NUM;
+        snprintf(key, sizeof(key), "cal_%u", id);
+        start = now_us();
+        len = fdb_kv_get_blob(&db, key, fdb_blob_make(&blob, buf, sizeof(buf)));
+        if (args->num < READS_MAX) {
+            args->lat[args->num] = now_us() - start;
+        }
+        args->num++;
+        memcpy(&gen, buf + 4, 4);
+        if (len < 8 || len != blob.saved.len || memcmp(buf, &id, 4) || len != make_value(ref, id, gen)
+                || memcmp(buf, ref, len)) {
+            args->errors++;
+        }
+        sleep_us(200);
+    }
+
+    return NULL;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+int main(int argc, char **argv)
+{
+    int seconds = argc > 1 ? atoi(argv[1]) : 5;
+    struct reader_args args[READER_NUM];
+    pthread_t threads[READER_NUM];
+    pthread_mutexattr_t attr;
+    uint8_t value[VALUE_MAX];
+    struct fdb_blob blob;
+    unsigned long sets = 0, gc_steps = 0, reads = 0, errors = 0, n;
+    uint32_t gen[KEY_NUM], id, rng = 12345;
+    double *lat, end;
+    char key[16];
+    int i;
+
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&db_mutex, &attr);
+
+    memset(flash, 0xFF, sizeof(flash));
+    fdb_kvdb_control(&db, FDB_KVDB_CTRL_SET_LOCK, (void *)kvdb_lock);
+    fdb_kvdb_control(&db, FDB_KVDB_CTRL_SET_UNLOCK, (void *)kvdb_unlock);
+#ifdef FDB_USING_RW_LOCK
+    fdb_kvdb_control(&db, FDB_KVDB_CTRL_SET_RDLOCK, (void *)kvdb_rdlock);
+    fdb_kvdb_control(&db, FDB_KVDB_CTRL_SET_RDUNLOCK, (void *)kvdb_rdunlock);
+#endif
+    if (fdb_kvdb_init(&db, "kvdb", "kvdb", NULL, NULL) != FDB_NO_ERR) {
+        printf("init failed\n");
+        return 1;
+    }
+    /* every KV is set, then the KVs are set until the partition is full of old KVs, so the GC by steps is busy */
+    for (n = 0; n < PART_SIZE / 64; n++) {
+        rng = rng * 1103515245 + 12345;
+        id = n < KEY_NUM ? n : (rng >> 8) % KEY_NUM;
+        gen[id] = n < KEY_NUM ? 0 : gen[id] + 1;
+        snprintf(key, sizeof(key), "cal_%u", id);
+        fdb_kv_set_blob(&db, key, fdb_blob_make(&blob, value, make_value(value, id, gen[id])));
+    }
+    timed = 1;
+
+    running = 1;
+    for (i = 0; i < READER_NUM; i++) {
+        args[i].lat = malloc(READS_MAX * sizeof(double));
+        args[i].num = 0;
+        args[i].errors = 0;
+        args[i].seed = 1 + i;
+        pthread_create(&threads[i], NULL, reader_entry, &args[i]);
+    }
+    for (end = now_us() + seconds * 1e6; now_us() < end;) {
+        rng = rng * 1103515245 + 12345;
+        id = (rng >> 8) % KEY_NUM;
+        gen[id]++;
+        snprintf(key, sizeof(key), "cal_%u", id);
+        if (fdb_kv_set_blob(&db, key, fdb_blob_make(&blob, value, make_value(value, id, gen[id]))) == FDB_NO_ERR) {
+            sets++;
+        }
+        while (fdb_kv_gc_step(&db)) {
+            gc_steps++;
+        }
+        sleep_us(2000);
+    }
+    running = 0;
+
+    lat = malloc(READER_NUM * READS_MAX * sizeof(double));
+    for (i = 0; i < READER_NUM; i++) {
+        pthread_join(threads[i], NULL);
+        n = args[i].num < READS_MAX ? args[i].num : READS_MAX;
+        memcpy(lat + reads, args[i].lat, n * sizeof(double));
+        reads += n;
+        errors += args[i].errors;
+    }
+    qsort(lat, reads, sizeof(double), cmp_double);
+
+#ifdef FDB_USING_RW_LOCK
+    printf("reader/writer lock, %d readers, %d s\n", READER_NUM, seconds);
+#else
+    printf("exclusive lock, %d readers, %d s\n", READER_NUM, seconds);
+    locked_reads = reads;
+#endif
+    printf("  %8s %8s %8s %9s %9s %9s %9s %7s\n", "sets", "gc steps", "reads", "p50 us", "p99 us", "max us",
+            "locked", "errors");
+    printf("  %8lu %8lu %8lu %9.1f %9.1f %9.1f %8.1f%% %7lu%s\n", sets, gc_steps, reads, lat[reads / 2],
+            lat[reads * 99 / 100], lat[reads - 1], 100.0 * locked_reads / reads, errors, errors ? "  FAILED" : "");
+
+    return errors != 0;
+}
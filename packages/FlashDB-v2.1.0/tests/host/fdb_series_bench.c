@@ -0,0 +1,275 @@
+/*
+ * Copyright (c) 2020, Armink, <armink.ztl@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief Host benchmark of the compressed series against one TSL per sample.
+ *
+ * cc -O2 -Ishim -I../../inc -o fdb_series_bench fdb_series_bench.c ../../src/fdb.c ../../src/fdb_kvdb.c ../../src/fdb_tsdb.c ../../src/fdb_utils.c -lm
+ * ./fdb_series_bench
+ *
+ * The TSDB is the 512 KB "tsdb" partition of the board on a RAM NOR flash. A float sample is logged every 100 ms
+ * (1 ms jitter on 1/8 of the samples) until the partition wraps, for two sensors:
+ *
+ *   temp     a slow temperature wave with 0.01 resolution noise
+ *   adc      12 bits ADC counts as float
+ *
+ * The samples per KB of flash and the hours of logging before the oldest sector is erased are printed for each mode,
+ * then the append CPU time on the RAM flash. The series are read back by time ranges and compared with the samples.
+ */
+
+#include <flashdb.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define PART_SIZE               (512 * 1024)
+#define SEC_SIZE                4096
+#define SAMPLE_PERIOD_MS        100
+#define SAMPLE_MAX              (4 * 1000 * 1000)
+
+static uint8_t flash[PART_SIZE];
+static unsigned long erase_num;
+
+static const struct fal_flash_dev nor = { "nor", 0, PART_SIZE, SEC_SIZE };
+static const struct fal_partition part = { 0, "tsdb", "nor", 0, PART_SIZE, 0 };
+
+int fal_init(void)
+{
+    return 1;
+}
+
+const struct fal_partition *fal_partition_find(const char *name)
+{
+    return &part;
+}
+
+const struct fal_flash_dev *fal_flash_device_find(const char *name)
+{
+    return &nor;
+}
+
+int fal_partition_read(const struct fal_partition *p, uint32_t addr, uint8_t *buf, size_t size)
+{
+    memcpy(buf, flash + addr, size);
+    return size;
+}
+
+int fal_partition_write(const struct fal_partition *p, uint32_t addr, const uint8_t *buf, size_t size)
+{
+    size_t i;
+
+    for (i = 0; i < size; i++) {
+        flash[addr + i] &= buf[i];
+    }
+    return size;
+}
+
+int fal_partition_erase(const struct fal_partition *p, uint32_t addr, size_t size)
+{
+    memset(flash + addr, 0xFF, size);
+    erase_num += size / SEC_SIZE;
+    return size;
+}
+
+static fdb_time_t sample_time[SAMPLE_MAX];
+static float sample_value[SAMPLE_MAX];
+static struct fdb_tsdb db;
+static struct fdb_series series;
+static uint32_t rng_state;
+
+static uint32_t rng(void)
+{
+    rng_state = rng_state * 1103515245 + 12345;
+    return rng_state >> 4;
+}
+
+static fdb_time_t get_time(void)
+{
+    return 0;
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void make_samples(int sensor)
+{
+    fdb_time_t time = 1000;
+    long n;
+
+    rng_state = 12345;
+    for (n = 0; n < SAMPLE_MAX; n++) {
+        time += SAMPLE_PERIOD_MS;
+        if (rng() % 8 == 0) {
+            time += rng() % 2 ? 1 : -1;
+        }
+        sample_time[n] = time;
+        if (sensor == 0) {
+            sample_value[n] = roundf((25.0f + 3.0f * sinf(n / 6000.0f) + (rng() % 21 - 10) / 100.0f) * 100) / 100;
+        } else {
+            sample_value[n] = 2048 + (int)(300 * sinf(n / 600.0f)) + (int)(rng() % 9) - 4;
+        }
+    }
+}
+
+static void db_init(void)
+{
+    memset(flash, 0xFF, sizeof(flash));
+    memset(&db, 0, sizeof(db));
+    if (fdb_tsdb_init(&db, "tsdb", "tsdb", get_time, FDB_TSDB_SERIES_BLOCK_SIZE, NULL) != FDB_NO_ERR) {
+        printf("init failed\n");
+        exit(1);
+    }
+    erase_num = 0;
+}
+
+/* append until the oldest sector is erased, return the samples and the time of each */
+static long fill(bool use_series, double *ns)
+{
+    struct fdb_blob blob;
+    double t0;
+    long n;
+
+    db_init();
+    fdb_series_init(&series, &db);
+    t0 = now_ns();
+    for (n = 0; n < SAMPLE_MAX && erase_num == 0; n++) {
+        if (use_series) {
+            fdb_series_append(&series, sample_time[n], sample_value[n]);
+        } else {
+            fdb_tsl_append_with_ts(&db, fdb_blob_make(&blob, &sample_value[n], sizeof(float)), sample_time[n]);
+        }
+    }
+    *ns = (now_ns() - t0) / (n - 1);
+    return n - 1;
+}
+
+struct check_args {
+    long next;
+    long errors;
+};
+
+static bool check_cb(fdb_time_t time, float value, void *arg)
+{
+    struct check_args *args = arg;
+
+    if (time != sample_time[args->next] || memcmp(&value, &sample_value[args->next], sizeof(float))) {
+        args->errors++;
+    }
+    args->next++;
+    return false;
+}
+
+static long find_sample(long num, fdb_time_t time)
+{
+    long low = 0, high = num;
+
+    while (low < high) {
+        long mid = (low + high) / 2;
+        if (sample_time[mid] < time) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+static bool count_cb(fdb_time_t time, float value, void *arg)
+{
+    (*(long *)arg)++;
+    return false;
+}
+
+/* read back the whole series and random ranges of it */
+static long check(long num)
+{
+    struct check_args args = { 0, 0 };
+    long i, first = 0, errors;
+
+    /* the oldest blocks are erased, the series starts at the first kept sample */
+    fdb_series_iter_by_time(&series, 0, sample_time[num - 1], count_cb, &first);
+    first = num - first;
+    args.next = first;
+    fdb_series_iter_by_time(&series, 0, sample_time[num - 1], check_cb, &args);
+    errors = args.errors + (args.next != num);
+
+    for (i = 0; i < 1000; i++) {
+        fdb_time_t from = sample_time[first] - 50 + rng() % (sample_time[num - 1] - sample_time[first] + 100);
+        fdb_time_t to = from + rng() % 100000;
+
+        args.next = find_sample(num, from) > first ? find_sample(num, from) : first;
+        args.errors = 0;
+        fdb_series_iter_by_time(&series, from, to, check_cb, &args);
+        errors += args.errors + (args.next != find_sample(num, to + 1));
+    }
+    return errors;
+}
+
+/* the special values, random bits and timestamp gaps are lossless */
+static long check_special(void)
+{
+    static const float values[] = { 0.0f, -0.0f, INFINITY, -INFINITY, NAN, 1e-45f, 3.4e38f, -1.0f, 1.0f, 1.0f };
+    fdb_time_t time = 0;
+    uint32_t bits;
+    long n;
+
+    db_init();
+    fdb_series_init(&series, &db);
+    for (n = 0; n < 3000; n++) {
+        time += 1 + n * 37 + (n % 7 == 0 ? 1000000 : 0);
+        sample_time[n] = time;
+        if (n % 2) {
+            bits = rng();
+            memcpy(&sample_value[n], &bits, sizeof(float));
+        } else {
+            sample_value[n] = values[n / 2 % 10];
+        }
+        fdb_series_append(&series, sample_time[n], sample_value[n]);
+        if (n % 500 == 0) {
+            fdb_series_flush(&series);
+        }
+    }
+    return check(n);
+}
+
+int main(int argc, char **argv)
+{
+    static const char *sensor_name[] = { "temp", "adc" };
+    long num[2], errors = 0;
+    int sensor, mode;
+    double ns;
+
+    errors += check_special();
+    printf("special values %s\n", errors ? "FAILED" : "ok");
+
+    printf("%-8s %-8s %10s %10s %10s\n", "sensor", "mode", "samples", "per KB", "hours");
+    for (sensor = 0; sensor < 2; sensor++) {
+        make_samples(sensor);
+        for (mode = 0; mode < 2; mode++) {
+            num[mode] = fill(mode, &ns);
+            printf("%-8s %-8s %10ld %10.1f %10.1f\n", sensor_name[sensor], mode ? "series" : "tsl", num[mode],
+                    num[mode] / (PART_SIZE / 1024.0), num[mode] * SAMPLE_PERIOD_MS / 3600000.0);
+        }
+        /* the series of the last fill, with the sample which made the wrap */
+        errors += check(num[1] + 1);
+    }
+
+    printf("append CPU time on RAM flash, %s sensor\n", sensor_name[1]);
+    for (mode = 0; mode < 2; mode++) {
+        printf("  %-8s %8.1f ns/sample\n", mode ? "series" : "tsl", fill(mode, &ns) ? ns : 0);
+    }
+    printf("%s\n", errors ? "read back FAILED" : "read back ok");
+
+    return errors != 0;
+}
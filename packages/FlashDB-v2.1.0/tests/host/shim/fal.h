@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2020, Armink, <armink.ztl@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief the FAL partition API FlashDB uses, implemented by the host bench
+ */
+
+#ifndef _FAL_H_
+#define _FAL_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+struct fal_flash_dev
+{
+    char name[24];
+    uint32_t addr;
+    size_t len;
+    size_t blk_size;
+};
+
+struct fal_partition
+{
+    uint32_t magic_word;
+    char name[24];
+    char flash_name[24];
+    long offset;
+    size_t len;
+    uint32_t reserved;
+};
+
+int fal_init(void);
+const struct fal_partition *fal_partition_find(const char *name);
+const struct fal_flash_dev *fal_flash_device_find(const char *name);
+int fal_partition_read(const struct fal_partition *part, uint32_t addr, uint8_t *buf, size_t size);
+int fal_partition_write(const struct fal_partition *part, uint32_t addr, const uint8_t *buf, size_t size);
+int fal_partition_erase(const struct fal_partition *part, uint32_t addr, size_t size);
+
+#endif /* _FAL_H_ */
@@ -0,0 +1,46 @@
+/*
+ * Copyright (c) 2020, Armink, <armink.ztl@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief host configuration, the same KVDB and TSDB as the board on a RAM NOR flash
+ */
+
+#ifndef _FDB_CFG_H_
+#define _FDB_CFG_H_
+
+#define FDB_USING_KVDB
+#define FDB_USING_TSDB
+#define FDB_USING_FAL_MODE
+#define FDB_WRITE_GRAN 1
+
+#define FDB_KV_INDEX_SIZE 256
+#define FDB_KV_GC_LOW_WATERMARK 4
+#define FDB_KV_GC_HIGH_WATERMARK 8
+#ifndef FDB_KV_SNAPSHOT_SEC_NUM
+#define FDB_KV_SNAPSHOT_SEC_NUM 128
+#endif
+#define FDB_USING_ERASE_COUNT
+#ifndef FDB_KV_WEAR_LEVEL_DELTA
+#define FDB_KV_WEAR_LEVEL_DELTA 100
+#endif
+/* the exclusive lock baseline of the benches is built by -DFDB_BENCH_EXCLUSIVE */
+#ifndef FDB_BENCH_EXCLUSIVE
+#define FDB_USING_RW_LOCK
+#endif
+
+#define FDB_TSDB_SEC_INDEX_NUM 128
+#define FDB_TSDB_USING_SUMMARY
+#define FDB_TSDB_READ_AHEAD_SIZE 256
+#define FDB_TSDB_SERIES_BLOCK_SIZE 256
+#ifndef FDB_TSDB_APPEND_BUF_SIZE
+#define FDB_TSDB_APPEND_BUF_SIZE 256
+#endif
+
+/* the GC warnings of every inline GC would flood the result */
+#define FDB_PRINT(...) do { if (0) printf(__VA_ARGS__); } while (0)
+
+#endif /* _FDB_CFG_H_ */
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2020, Armink, <armink.ztl@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief the NOR flash partitions of the board, on the RAM NOR flash of the bench
+ */
+
+#ifndef _FAL_CFG_H_
+#define _FAL_CFG_H_
+
+#include <rtconfig.h>
+
+#define NOR_FLASH_DEV_NAME                          FAL_USING_NOR_FLASH_DEV_NAME
+
+extern struct fal_flash_dev nor_flash0;
+
+/* flash device table */
+#define FAL_FLASH_DEV_TABLE                                          \
+{                                                                    \
+    &nor_flash0,                                                     \
+}
+
+/* partition table */
+#define FAL_PART_TABLE                                               \
+{                                                                    \
+    {FAL_PART_MAGIC_WORD,   "factory"     , "w25q64"      ,            0,       524288, 0}, \
+    {FAL_PART_MAGIC_WORD,   "ota"         , "w25q64"      ,       524288,       524288, 0}, \
+    {FAL_PART_MAGIC_WORD,   "kvdb"        , "w25q64"      ,      1048576,       524288, 0}, \
+    {FAL_PART_MAGIC_WORD,   "tsdb"        , "w25q64"      ,      1572864,       524288, 0}, \
+    {FAL_PART_MAGIC_WORD,   "lfs"         , "w25q64"      ,      2097152,      2097152, 0}, \
+    {FAL_PART_MAGIC_WORD,   "userdata"    , "w25q64"      ,      4194304,       524288, 0}, \
+    {FAL_PART_MAGIC_WORD,   "log"         , "w25q64"      ,      4718592,      2097152, 0}, \
+    {FAL_PART_MAGIC_WORD,   "reserved"    , "w25q64"      ,      6815744,      1048576, 0}, \
+    {FAL_PART_MAGIC_WORD,   "kvsnap"      , "w25q64"      ,      7864320,        65536, 0}, \
+}
+
+#endif /* _FAL_CFG_H_ */
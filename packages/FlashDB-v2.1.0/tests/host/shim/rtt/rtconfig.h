@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) 2020, Armink, <armink.ztl@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief host configuration of the FAL, the same read cache as the board
+ */
+
+#ifndef _RTCONFIG_H_
+#define _RTCONFIG_H_
+
+#define RT_USING_FAL
+#define FAL_PART_HAS_TABLE_CFG
+#define FAL_USING_NOR_FLASH_DEV_NAME "w25q64"
+#define FAL_USING_CACHE
+#ifndef FAL_CACHE_LINE_SIZE
+#define FAL_CACHE_LINE_SIZE 256
+#endif
+#ifndef FAL_CACHE_SETS
+#define FAL_CACHE_SETS 4
+#endif
+#ifndef FAL_CACHE_WAYS
+#define FAL_CACHE_WAYS 4
+#endif
+#ifndef FAL_CACHE_FILL_SEQ_NUM
+#define FAL_CACHE_FILL_SEQ_NUM 2
+#endif
+
+#endif /* _RTCONFIG_H_ */
@@ -0,0 +1,22 @@
+/*
+ * Copyright (c) 2020, Armink, <armink.ztl@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief the FAL log, only the errors are printed by the benches
+ */
+
+#ifndef _RTDBG_H_
+#define _RTDBG_H_
+
+#include <rtthread.h>
+
+#define LOG_D(...)
+#define LOG_I(...)
+#define LOG_W(...)
+#define LOG_E(...)                      do { printf("[E/" DBG_TAG "] " __VA_ARGS__); printf("\n"); } while (0)
+
+#endif /* _RTDBG_H_ */
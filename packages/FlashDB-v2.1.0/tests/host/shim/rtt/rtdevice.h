@@ -0,0 +1,12 @@
+/*
+ * Copyright (c) 2020, Armink, <armink.ztl@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _RTDEVICE_H_
+#define _RTDEVICE_H_
+
+#include <rtthread.h>
+
+#endif /* _RTDEVICE_H_ */
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2020, Armink, <armink.ztl@gmail.com>
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * @file
+ * @brief the RT-Thread API the FAL uses, on the host with one thread
+ */
+
+#ifndef _RTTHREAD_H_
+#define _RTTHREAD_H_
+
+#include <rtconfig.h>
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef int8_t                          rt_int8_t;
+typedef int16_t                         rt_int16_t;
+typedef int32_t                         rt_int32_t;
+typedef uint8_t                         rt_uint8_t;
+typedef uint16_t                        rt_uint16_t;
+typedef uint32_t                        rt_uint32_t;
+typedef uint64_t                        rt_uint64_t;
+typedef size_t                          rt_size_t;
+typedef int                             rt_bool_t;
+typedef long                            rt_err_t;
+
+#define RT_TRUE                         1
+#define RT_FALSE                        0
+#define RT_NULL                         NULL
+#define RT_EOK                          0
+#define RT_WAITING_FOREVER              -1
+#define RT_IPC_FLAG_PRIO                0x01
+
+#define RT_ASSERT(EX)                   assert(EX)
+
+#define rt_kprintf                      printf
+#define rt_malloc                       malloc
+#define rt_realloc                      realloc
+#define rt_free                         free
+#define rt_strcmp                       strcmp
+
+/* the benches are single threaded, the lock is not taken by others */
+struct rt_mutex
+{
+    int locked;
+};
+
+static inline rt_err_t rt_mutex_init(struct rt_mutex *mutex, const char *name, rt_uint8_t flag)
+{
+    mutex->locked = 0;
+    return RT_EOK;
+}
+
+static inline rt_err_t rt_mutex_take(struct rt_mutex *mutex, rt_int32_t time)
+{
+    RT_ASSERT(!mutex->locked);
+    mutex->locked = 1;
+    return RT_EOK;
+}
+
+static inline rt_err_t rt_mutex_release(struct rt_mutex *mutex)
+{
+    mutex->locked = 0;
+    return RT_EOK;
+}
+
+#endif /* _RTTHREAD_H_ */
@@ -0,0 +1,484 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2025-12-10     RT-Thread    first version
+ */
+
+#include "candisp.h"
+
+#define DBG_TAG "candisp"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+#ifndef RT_CAN_USING_MSG_HOOK
+#error "candisp needs RT_CAN_USING_MSG_HOOK"
+#endif
+
+#if CANDISP_CONSUMER_MAX > 32
+#error "CANDISP_CONSUMER_MAX must not exceed 32"
+#endif
+
+#define CANDISP_STD_NUM         2048
+#define CANDISP_SET_MAX         256
+#define CANDISP_KEY_VALID       0x80000000
+
+struct candisp_route
+{
+    rt_slist_t list;
+    rt_uint32_t id;
+    rt_uint32_t mask;
+    rt_bool_t ext;
+    rt_uint8_t index;
+};
+
+struct candisp_ext_exact
+{
+    rt_uint32_t key;            /* id | CANDISP_KEY_VALID, 0 when empty */
+    rt_uint32_t set;
+};
+
+struct candisp_ext_masked
+{
+    rt_uint32_t id;
+    rt_uint32_t mask;
+    rt_uint32_t set;
+};
+
+/*
+ * Compiled routing table. A "set" is the bitmap of consumers a frame goes
+ * to. Every 11-bit ID is mapped directly to one of at most 256 distinct
+ * sets, so a standard frame costs two loads. Exact extended IDs live in an
+ * open-addressing hash, masked extended routes are scanned linearly.
+ */
+struct candisp_table
+{
+    rt_uint8_t std_map[CANDISP_STD_NUM];
+    rt_uint16_t set_num;
+    rt_uint16_t masked_num;
+    rt_uint8_t hash_shift;
+    rt_uint32_t hash_mask;
+    rt_uint32_t *sets;
+    struct candisp_ext_exact *hash;
+    struct candisp_ext_masked *masked;
+    rt_size_t size;
+};
+
+static rt_slist_t _disp_list = RT_SLIST_OBJECT_INIT(_disp_list);
+
+rt_inline rt_uint32_t candisp_hash(const struct candisp_table *t, rt_uint32_t id)
+{
+    return (id * 2654435769u) >> t->hash_shift;
+}
+
+static rt_uint32_t candisp_ext_lookup(const struct candisp_table *t, rt_uint32_t id)
+{
+    rt_uint32_t set = 0, h, i;
+
+    if (t->hash != RT_NULL)
+    {
+        for (h = candisp_hash(t, id); t->hash[h].key != 0; h = (h + 1) & t->hash_mask)
+        {
+            if (t->hash[h].key == (id | CANDISP_KEY_VALID))
+            {
+                set = t->hash[h].set;
+                break;
+            }
+        }
+    }
+    for (i = 0; i < t->masked_num; i++)
+    {
+        if ((id & t->masked[i].mask) == t->masked[i].id)
+        {
+            set |= t->masked[i].set;
+        }
+    }
+
+    return set;
+}
+
+static void candisp_deliver(struct candisp_consumer *consumer, struct rt_can_msg *msg)
+{
+    if (consumer->callback != RT_NULL)
+    {
+        consumer->callback(consumer, msg);
+    }
+    else if (rt_mq_send(consumer->mq, msg, sizeof(struct rt_can_msg)) != RT_EOK)
+    {
+        consumer->overrun++;
+        return;
+    }
+    consumer->delivered++;
+}
+
+/* runs in the CAN RX ISR: classify once, deliver to every interested consumer */
+static rt_bool_t candisp_hook(struct rt_can_device *can, struct rt_can_msg *msg, rt_uint32_t dir, void *args)
+{
+    struct candisp *disp = (struct candisp *)args;
+    struct candisp_table *t = disp->table;
+    rt_uint32_t set;
+
+    disp->frames++;
+    if (t == RT_NULL)
+    {
+        return RT_FALSE;
+    }
+
+    if (msg->ide == RT_CAN_STDID)
+    {
+        set = t->sets[t->std_map[msg->id & 0x7FF]];
+    }
+    else
+    {
+        set = candisp_ext_lookup(t, msg->id & 0x1FFFFFFF);
+    }
+
+    if (set == 0)
+    {
+        disp->unmatched++;
+        return RT_FALSE;
+    }
+    while (set)
+    {
+        candisp_deliver(disp->consumer[__rt_ffs(set) - 1], msg);
+        set &= set - 1;
+    }
+
+    return (disp->flags & CANDISP_FLAG_CONSUME) ? RT_TRUE : RT_FALSE;
+}
+
+/* return the index of set in sets[], adding it if needed */
+static int candisp_set_index(rt_uint32_t *sets, rt_uint16_t *num, rt_uint32_t set)
+{
+    int i;
+
+    for (i = 0; i < *num; i++)
+    {
+        if (sets[i] == set)
+        {
+            return i;
+        }
+    }
+    if (*num >= CANDISP_SET_MAX)
+    {
+        return -1;
+    }
+    sets[*num] = set;
+
+    return (*num)++;
+}
+
+static struct candisp_table *candisp_build(struct candisp *disp)
+{
+    struct candisp_table *t;
+    struct candisp_route *route;
+    rt_uint32_t *std_set, exact_num = 0, masked_num = 0, hash_num = 0, h;
+    rt_uint8_t shift = 32;
+    rt_size_t size;
+    int i, idx;
+
+    rt_slist_for_each_entry(route, &disp->routes, list)
+    {
+        if (!route->ext)
+            continue;
+        if (route->mask == CANDISP_MASK_EXACT_EXT)
+            exact_num++;
+        else
+            masked_num++;
+    }
+    if (exact_num)
+    {
+        /* keep the load factor at or below 50% */
+        for (hash_num = 1, shift = 32; hash_num < exact_num * 2; hash_num <<= 1, shift--);
+    }
+
+    size = sizeof(*t) + CANDISP_SET_MAX * sizeof(rt_uint32_t)
+         + hash_num * sizeof(struct candisp_ext_exact)
+         + masked_num * sizeof(struct candisp_ext_masked);
+    t = rt_calloc(1, size);
+    std_set = rt_calloc(CANDISP_STD_NUM, sizeof(rt_uint32_t));
+    if (t == RT_NULL || std_set == RT_NULL)
+    {
+        rt_free(t);
+        rt_free(std_set);
+        return RT_NULL;
+    }
+    t->size = size;
+    t->sets = (rt_uint32_t *)(t + 1);
+    t->hash = hash_num ? (struct candisp_ext_exact *)(t->sets + CANDISP_SET_MAX) : RT_NULL;
+    t->masked = (struct candisp_ext_masked *)((rt_uint8_t *)(t->sets + CANDISP_SET_MAX)
+                                             + hash_num * sizeof(struct candisp_ext_exact));
+    t->hash_mask = hash_num ? hash_num - 1 : 0;
+    t->hash_shift = shift;
+
+    rt_slist_for_each_entry(route, &disp->routes, list)
+    {
+        if (!route->ext)
+        {
+            for (i = 0; i < CANDISP_STD_NUM; i++)
+            {
+                if ((i & route->mask) == (route->id & route->mask))
+                {
+                    std_set[i] |= 1UL << route->index;
+                }
+            }
+        }
+        else if (route->mask == CANDISP_MASK_EXACT_EXT)
+        {
+            for (h = candisp_hash(t, route->id); t->hash[h].key != 0; h = (h + 1) & t->hash_mask)
+            {
+                if (t->hash[h].key == (route->id | CANDISP_KEY_VALID))
+                    break;
+            }
+            t->hash[h].key = route->id | CANDISP_KEY_VALID;
+            t->hash[h].set |= 1UL << route->index;
+        }
+        else
+        {
+            t->masked[t->masked_num].id = route->id & route->mask;
+            t->masked[t->masked_num].mask = route->mask;
+            t->masked[t->masked_num].set = 1UL << route->index;
+            t->masked_num++;
+        }
+    }
+
+    /* sets[0] is the empty set, unmatched IDs map to it */
+    t->set_num = 1;
+    for (i = 0; i < CANDISP_STD_NUM; i++)
+    {
+        idx = candisp_set_index(t->sets, &t->set_num, std_set[i]);
+        if (idx < 0)
+        {
+            LOG_E("more than %d distinct consumer sets", CANDISP_SET_MAX);
+            rt_free(std_set);
+            rt_free(t);
+            return RT_NULL;
+        }
+        t->std_map[i] = (rt_uint8_t)idx;
+    }
+    rt_free(std_set);
+
+    return t;
+}
+
+/**
+ * @brief Create a dispatcher on a CAN device.
+ *
+ * Nothing is routed until candisp_commit() installs the first table.
+ */
+struct candisp *candisp_create(const char *can_name, rt_uint8_t flags)
+{
+    struct candisp *disp;
+    rt_device_t dev;
+
+    dev = rt_device_find(can_name);
+    if (dev == RT_NULL || dev->type != RT_Device_Class_CAN)
+    {
+        return RT_NULL;
+    }
+
+    disp = rt_calloc(1, sizeof(struct candisp));
+    if (disp == RT_NULL)
+    {
+        return RT_NULL;
+    }
+    disp->can = dev;
+    disp->flags = flags;
+    rt_slist_init(&disp->routes);
+    rt_mutex_init(&disp->lock, "candisp", RT_IPC_FLAG_PRIO);
+
+    disp->hook.flags = RT_CAN_MSG_HOOK_RX;
+    disp->hook.hook = candisp_hook;
+    disp->hook.args = disp;
+    if (rt_device_control(dev, RT_CAN_CMD_ADD_MSG_HOOK, &disp->hook) != RT_EOK)
+    {
+        rt_mutex_detach(&disp->lock);
+        rt_free(disp);
+        return RT_NULL;
+    }
+    rt_slist_append(&_disp_list, &disp->list);
+
+    return disp;
+}
+
+void candisp_delete(struct candisp *disp)
+{
+    struct candisp_route *route;
+    rt_slist_t *node;
+
+    rt_device_control(disp->can, RT_CAN_CMD_DEL_MSG_HOOK, &disp->hook);
+    rt_slist_remove(&_disp_list, &disp->list);
+
+    while ((node = rt_slist_first(&disp->routes)) != RT_NULL)
+    {
+        route = rt_slist_entry(node, struct candisp_route, list);
+        rt_slist_remove(&disp->routes, node);
+        rt_free(route);
+    }
+    rt_free(disp->table);
+    rt_mutex_detach(&disp->lock);
+    rt_free(disp);
+}
+
+rt_err_t candisp_add_consumer(struct candisp *disp, struct candisp_consumer *consumer)
+{
+    int i;
+
+    if (consumer->callback == RT_NULL && consumer->mq == RT_NULL)
+    {
+        return -RT_EINVAL;
+    }
+
+    rt_mutex_take(&disp->lock, RT_WAITING_FOREVER);
+    for (i = 0; i < CANDISP_CONSUMER_MAX; i++)
+    {
+        if (disp->consumer[i] == RT_NULL)
+        {
+            consumer->index = i;
+            consumer->delivered = 0;
+            consumer->overrun = 0;
+            disp->consumer[i] = consumer;
+            rt_mutex_release(&disp->lock);
+            return RT_EOK;
+        }
+    }
+    rt_mutex_release(&disp->lock);
+
+    return -RT_EFULL;
+}
+
+/**
+ * @brief Remove a consumer and all of its routes, the table is rebuilt.
+ */
+rt_err_t candisp_del_consumer(struct candisp *disp, struct candisp_consumer *consumer)
+{
+    struct candisp_route *route;
+    rt_slist_t *node, *next;
+    rt_err_t ret;
+
+    if (consumer->index >= CANDISP_CONSUMER_MAX || disp->consumer[consumer->index] != consumer)
+    {
+        return -RT_EINVAL;
+    }
+
+    rt_mutex_take(&disp->lock, RT_WAITING_FOREVER);
+    for (node = rt_slist_first(&disp->routes); node != RT_NULL; node = next)
+    {
+        next = rt_slist_next(node);
+        route = rt_slist_entry(node, struct candisp_route, list);
+        if (route->index == consumer->index)
+        {
+            rt_slist_remove(&disp->routes, node);
+            disp->route_num--;
+            rt_free(route);
+        }
+    }
+    rt_mutex_release(&disp->lock);
+
+    /* the ISR may only lose the consumer once no table points to it */
+    ret = candisp_commit(disp);
+    if (ret == RT_EOK)
+    {
+        disp->consumer[consumer->index] = RT_NULL;
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Route frames matching (id & mask) to a consumer.
+ *
+ * Use CANDISP_MASK_EXACT_STD / CANDISP_MASK_EXACT_EXT for a single ID.
+ * Takes effect on the next candisp_commit().
+ */
+rt_err_t candisp_add_route(struct candisp *disp, rt_uint32_t id, rt_uint32_t mask, rt_bool_t ext,
+                           struct candisp_consumer *consumer)
+{
+    struct candisp_route *route;
+
+    if (consumer->index >= CANDISP_CONSUMER_MAX || disp->consumer[consumer->index] != consumer)
+    {
+        return -RT_EINVAL;
+    }
+
+    route = rt_malloc(sizeof(struct candisp_route));
+    if (route == RT_NULL)
+    {
+        return -RT_ENOMEM;
+    }
+    route->id = id & (ext ? CANDISP_MASK_EXACT_EXT : CANDISP_MASK_EXACT_STD);
+    route->mask = mask & (ext ? CANDISP_MASK_EXACT_EXT : CANDISP_MASK_EXACT_STD);
+    route->ext = ext;
+    route->index = consumer->index;
+
+    rt_mutex_take(&disp->lock, RT_WAITING_FOREVER);
+    rt_slist_init(&route->list);
+    rt_slist_append(&disp->routes, &route->list);
+    disp->route_num++;
+    rt_mutex_release(&disp->lock);
+
+    return RT_EOK;
+}
+
+/**
+ * @brief Compile the routes and switch the ISR over to the new table.
+ */
+rt_err_t candisp_commit(struct candisp *disp)
+{
+    struct candisp_table *t, *old;
+    rt_base_t level;
+
+    rt_mutex_take(&disp->lock, RT_WAITING_FOREVER);
+    t = candisp_build(disp);
+    if (t == RT_NULL)
+    {
+        rt_mutex_release(&disp->lock);
+        return -RT_ENOMEM;
+    }
+
+    level = rt_hw_interrupt_disable();
+    old = disp->table;
+    disp->table = t;
+    rt_hw_interrupt_enable(level);
+    rt_mutex_release(&disp->lock);
+
+    rt_free(old);
+    LOG_D("%s: %d routes, %d sets, %d bytes", disp->can->parent.name, disp->route_num, t->set_num, t->size);
+
+    return RT_EOK;
+}
+
+#ifdef RT_USING_FINSH
+static int candisp(int argc, char **argv)
+{
+    struct candisp *disp;
+    int i;
+
+    rt_slist_for_each_entry(disp, &_disp_list, list)
+    {
+        rt_kprintf("%s: frames %u, unmatched %u, routes %u", disp->can->parent.name,
+                   disp->frames, disp->unmatched, disp->route_num);
+        if (disp->table)
+        {
+            rt_kprintf(", sets %u, ext masked %u, table %u bytes", disp->table->set_num,
+                       disp->table->masked_num, disp->table->size);
+        }
+        rt_kprintf("\n");
+        for (i = 0; i < CANDISP_CONSUMER_MAX; i++)
+        {
+            if (disp->consumer[i])
+            {
+                rt_kprintf("  [%2d] %-12s delivered %u, overrun %u\n", i,
+                           disp->consumer[i]->name ? disp->consumer[i]->name : "-",
+                           disp->consumer[i]->delivered, disp->consumer[i]->overrun);
+            }
+        }
+    }
+
+    return 0;
+}
+MSH_CMD_EXPORT(candisp, show CAN dispatcher statistics);
+#endif /* RT_USING_FINSH */
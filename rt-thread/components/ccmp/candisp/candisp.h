@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2025-12-10     RT-Thread    first version
+ */
+
+#ifndef __CANDISP_H__
+#define __CANDISP_H__
+
+#include <rtthread.h>
+#include <rtdevice.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CANDISP_MASK_EXACT_STD      0x7FF
+#define CANDISP_MASK_EXACT_EXT      0x1FFFFFFF
+
+/* candisp_create() flags */
+#define CANDISP_FLAG_CONSUME        0x01    /* routed frames bypass the device RX FIFO */
+
+struct candisp_consumer;
+
+/**
+ * Called in the CAN ISR for every frame routed to the consumer.
+ */
+typedef void (*candisp_cb_t)(struct candisp_consumer *consumer, struct rt_can_msg *msg);
+
+struct candisp_consumer
+{
+    const char *name;
+    candisp_cb_t callback;          /* called in ISR, or RT_NULL to use mq */
+    rt_mq_t mq;                     /* receives struct rt_can_msg when callback is RT_NULL */
+    void *user_data;
+
+    /* statistics, updated in ISR */
+    rt_uint32_t delivered;
+    rt_uint32_t overrun;            /* mq was full */
+
+    /* private */
+    rt_uint8_t index;
+};
+
+struct candisp_table;
+
+struct candisp
+{
+    rt_slist_t list;
+    rt_device_t can;
+    rt_uint8_t flags;
+    struct rt_can_msg_hook hook;
+    struct rt_mutex lock;
+
+    struct candisp_consumer *consumer[CANDISP_CONSUMER_MAX];
+    rt_slist_t routes;
+    rt_uint32_t route_num;
+
+    struct candisp_table *table;    /* compiled routing table used by the ISR */
+
+    rt_uint32_t frames;
+    rt_uint32_t unmatched;
+};
+
+struct candisp *candisp_create(const char *can_name, rt_uint8_t flags);
+void candisp_delete(struct candisp *disp);
+
+rt_err_t candisp_add_consumer(struct candisp *disp, struct candisp_consumer *consumer);
+rt_err_t candisp_del_consumer(struct candisp *disp, struct candisp_consumer *consumer);
+rt_err_t candisp_add_route(struct candisp *disp, rt_uint32_t id, rt_uint32_t mask, rt_bool_t ext,
+                           struct candisp_consumer *consumer);
+
+rt_err_t candisp_commit(struct candisp *disp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CANDISP_H__ */
@@ -0,0 +1,313 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2025-12-12     RT-Thread    first version
+ */
+
+#include "cangw.h"
+
+#define DBG_TAG "cangw"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+#ifndef RT_CAN_USING_MSG_HOOK
+#error "cangw needs RT_CAN_USING_MSG_HOOK"
+#endif
+
+#ifdef CANGW_USING_LATENCY
+#include <board.h>
+#endif
+
+#define CANGW_STD_NUM           2048
+#define CANGW_ROUTE_MAX         255
+
+struct cangw_bus
+{
+    rt_device_t dev;
+    struct rt_can_msg_hook hook;
+    rt_uint8_t std_map[CANGW_STD_NUM];  /* first matching route + 1, 0 = none */
+    rt_uint32_t rx;
+    rt_uint32_t unrouted;
+#ifdef CANGW_USING_LATENCY
+    /* DWT cycles from the RX hook entry to the frame handed to the destination */
+    rt_uint32_t lat_min;
+    rt_uint32_t lat_max;
+    rt_uint32_t lat_num;
+    rt_uint64_t lat_sum;
+#endif
+};
+
+struct cangw
+{
+    struct cangw_route *routes;
+    rt_uint16_t num;
+    rt_bool_t running;
+    struct cangw_bus bus[CANGW_BUS_NUM];
+};
+
+static struct cangw _gw;
+static const char *_bus_name[CANGW_BUS_NUM] = { CANGW_BUS0_NAME, CANGW_BUS1_NAME };
+
+static struct cangw_route *cangw_match(struct cangw_bus *bus, rt_uint8_t src, const struct rt_can_msg *msg)
+{
+    struct cangw_route *route;
+    rt_uint16_t i;
+
+    if (msg->ide == RT_CAN_STDID)
+    {
+        i = bus->std_map[msg->id & 0x7FF];
+        return i ? &_gw.routes[i - 1] : RT_NULL;
+    }
+
+    for (i = 0; i < _gw.num; i++)
+    {
+        route = &_gw.routes[i];
+        if (route->src == src && (route->flags & CANGW_F_EXT)
+            && (msg->id & route->mask) == (route->id & route->mask))
+        {
+            return route;
+        }
+    }
+
+    return RT_NULL;
+}
+
+/* runs in the RX ISR of the source bus and hands the frame straight to the destination mailboxes */
+static rt_bool_t cangw_hook(struct rt_can_device *can, struct rt_can_msg *msg, rt_uint32_t dir, void *args)
+{
+    rt_uint8_t src = (rt_uint8_t)(rt_ubase_t)args;
+    struct cangw_bus *bus = &_gw.bus[src];
+    struct cangw_route *route;
+    struct rt_can_msg out;
+    rt_tick_t now;
+    int i;
+#ifdef CANGW_USING_LATENCY
+    rt_uint32_t start = DWT->CYCCNT, cycles;
+#endif
+
+    bus->rx++;
+    route = cangw_match(bus, src, msg);
+    if (route == RT_NULL)
+    {
+        bus->unrouted++;
+        return RT_FALSE;
+    }
+    route->matched++;
+
+    now = rt_tick_get();
+    if (route->min_interval_ms && route->forwarded
+        && now - route->last_tick < rt_tick_from_millisecond(route->min_interval_ms))
+    {
+        route->limited++;
+        goto _exit;
+    }
+
+    rt_memcpy(&out, msg, sizeof(out));
+    out.id = (msg->id & ~route->remap_mask) | (route->remap_id & route->remap_mask);
+    out.ide = (route->flags & CANGW_F_EXT_OUT) ? RT_CAN_EXTID : RT_CAN_STDID;
+    out.id &= out.ide ? 0x1FFFFFFF : 0x7FF;
+    for (i = 0; i < 8; i++)
+    {
+        out.data[i] = (msg->data[i] & ~route->data_mask[i]) | (route->data_val[i] & route->data_mask[i]);
+    }
+    out.nonblocking = 1;
+
+    if (rt_device_write(_gw.bus[route->dst].dev, 0, &out, sizeof(out)) == sizeof(out))
+    {
+        /* the rate limit counts the frames actually forwarded */
+        route->forwarded++;
+        route->last_tick = now;
+#ifdef CANGW_USING_LATENCY
+        cycles = DWT->CYCCNT - start;
+        if (bus->lat_num == 0 || cycles < bus->lat_min)
+        {
+            bus->lat_min = cycles;
+        }
+        if (cycles > bus->lat_max)
+        {
+            bus->lat_max = cycles;
+        }
+        bus->lat_sum += cycles;
+        bus->lat_num++;
+#endif
+    }
+    else
+    {
+        route->tx_failed++;
+    }
+
+_exit:
+    return (route->flags & CANGW_F_CONSUME) ? RT_TRUE : RT_FALSE;
+}
+
+static void cangw_build_map(struct cangw_bus *bus, rt_uint8_t src)
+{
+    struct cangw_route *route;
+    rt_uint16_t i, id;
+
+    rt_memset(bus->std_map, 0, sizeof(bus->std_map));
+    /* walk backwards so that the first matching rule ends up in the map */
+    for (i = _gw.num; i > 0; i--)
+    {
+        route = &_gw.routes[i - 1];
+        if (route->src != src || (route->flags & CANGW_F_EXT))
+        {
+            continue;
+        }
+        for (id = 0; id < CANGW_STD_NUM; id++)
+        {
+            if ((id & route->mask) == (route->id & route->mask))
+            {
+                bus->std_map[id] = i;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Start forwarding with a routing table.
+ *
+ * The table stays owned by the caller and holds the per-route counters.
+ * Both buses are opened for interrupt RX/TX if nobody did it before.
+ */
+rt_err_t cangw_start(struct cangw_route *routes, rt_uint16_t num)
+{
+    rt_uint16_t i;
+    rt_err_t ret;
+
+    if (_gw.running)
+    {
+        return -RT_EBUSY;
+    }
+    if (num > CANGW_ROUTE_MAX)
+    {
+        return -RT_EINVAL;
+    }
+    for (i = 0; i < num; i++)
+    {
+        if (routes[i].src >= CANGW_BUS_NUM || routes[i].dst >= CANGW_BUS_NUM || routes[i].src == routes[i].dst)
+        {
+            LOG_E("route %d: bad bus %d -> %d", i, routes[i].src, routes[i].dst);
+            return -RT_EINVAL;
+        }
+        routes[i].matched = 0;
+        routes[i].forwarded = 0;
+        routes[i].limited = 0;
+        routes[i].tx_failed = 0;
+    }
+    _gw.routes = routes;
+    _gw.num = num;
+
+    for (i = 0; i < CANGW_BUS_NUM; i++)
+    {
+        _gw.bus[i].dev = rt_device_find(_bus_name[i]);
+        if (_gw.bus[i].dev == RT_NULL || _gw.bus[i].dev->type != RT_Device_Class_CAN)
+        {
+            LOG_E("can device %s not found", _bus_name[i]);
+            return -RT_ENOSYS;
+        }
+        cangw_build_map(&_gw.bus[i], i);
+        _gw.bus[i].rx = 0;
+        _gw.bus[i].unrouted = 0;
+#ifdef CANGW_USING_LATENCY
+        _gw.bus[i].lat_min = 0;
+        _gw.bus[i].lat_max = 0;
+        _gw.bus[i].lat_num = 0;
+        _gw.bus[i].lat_sum = 0;
+#endif
+    }
+
+#ifdef CANGW_USING_LATENCY
+    /* start the cycle counter if the debugger didn't */
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+
+    for (i = 0; i < CANGW_BUS_NUM; i++)
+    {
+        ret = rt_device_open(_gw.bus[i].dev, RT_DEVICE_FLAG_INT_TX | RT_DEVICE_FLAG_INT_RX);
+        if (ret != RT_EOK)
+        {
+            goto _fail;
+        }
+        _gw.bus[i].hook.flags = RT_CAN_MSG_HOOK_RX;
+        _gw.bus[i].hook.hook = cangw_hook;
+        _gw.bus[i].hook.args = (void *)(rt_ubase_t)i;
+        rt_device_control(_gw.bus[i].dev, RT_CAN_CMD_ADD_MSG_HOOK, &_gw.bus[i].hook);
+    }
+    _gw.running = RT_TRUE;
+    LOG_I("%s <-> %s, %d routes", _bus_name[0], _bus_name[1], num);
+
+    return RT_EOK;
+
+_fail:
+    while (i-- > 0)
+    {
+        rt_device_control(_gw.bus[i].dev, RT_CAN_CMD_DEL_MSG_HOOK, &_gw.bus[i].hook);
+        rt_device_close(_gw.bus[i].dev);
+    }
+
+    return ret;
+}
+
+void cangw_stop(void)
+{
+    int i;
+
+    if (!_gw.running)
+    {
+        return;
+    }
+    for (i = 0; i < CANGW_BUS_NUM; i++)
+    {
+        rt_device_control(_gw.bus[i].dev, RT_CAN_CMD_DEL_MSG_HOOK, &_gw.bus[i].hook);
+        rt_device_close(_gw.bus[i].dev);
+    }
+    _gw.running = RT_FALSE;
+}
+
+#ifdef RT_USING_FINSH
+static int cangw(int argc, char **argv)
+{
+    struct cangw_route *route;
+    int i;
+
+    if (argc > 1 && !rt_strcmp(argv[1], "stop"))
+    {
+        cangw_stop();
+        return 0;
+    }
+
+    rt_kprintf("gateway %s\n", _gw.running ? "running" : "stopped");
+    for (i = 0; i < CANGW_BUS_NUM; i++)
+    {
+        rt_kprintf("bus%d %-6s rx %u, unrouted %u\n", i, _bus_name[i], _gw.bus[i].rx, _gw.bus[i].unrouted);
+#ifdef CANGW_USING_LATENCY
+        if (_gw.bus[i].lat_num)
+        {
+            rt_uint32_t mhz = SystemCoreClock / 1000000;
+            rt_uint32_t avg = (rt_uint32_t)(_gw.bus[i].lat_sum / _gw.bus[i].lat_num);
+
+            rt_kprintf("     latency min %u.%02u us, avg %u.%02u us, max %u.%02u us (%u frames)\n",
+                       _gw.bus[i].lat_min / mhz, _gw.bus[i].lat_min % mhz * 100 / mhz,
+                       avg / mhz, avg % mhz * 100 / mhz,
+                       _gw.bus[i].lat_max / mhz, _gw.bus[i].lat_max % mhz * 100 / mhz, _gw.bus[i].lat_num);
+        }
+#endif
+    }
+    for (i = 0; i < _gw.num; i++)
+    {
+        route = &_gw.routes[i];
+        rt_kprintf("[%2d] %d->%d %08x/%08x matched %u, fwd %u, limited %u, tx failed %u\n", i,
+                   route->src, route->dst, route->id, route->mask,
+                   route->matched, route->forwarded, route->limited, route->tx_failed);
+    }
+
+    return 0;
+}
+MSH_CMD_EXPORT(cangw, show CAN gateway counters or stop it);
+#endif /* RT_USING_FINSH */
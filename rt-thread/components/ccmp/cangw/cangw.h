@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2025-12-12     RT-Thread    first version
+ */
+
+#ifndef __CANGW_H__
+#define __CANGW_H__
+
+#include <rtthread.h>
+#include <rtdevice.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CANGW_BUS_NUM           2
+
+/* cangw_route.flags */
+#define CANGW_F_EXT             0x01    /* match extended frames */
+#define CANGW_F_EXT_OUT         0x02    /* forward as extended frame */
+#define CANGW_F_CONSUME         0x04    /* do not deliver the frame locally */
+
+/**
+ * One forwarding rule. Frames on bus `src` whose (id & mask) equals
+ * (id & mask) of the rule are sent on bus `dst`:
+ *     out.id      = (in.id & ~remap_mask) | (remap_id & remap_mask)
+ *     out.data[i] = (in.data[i] & ~data_mask[i]) | (data_val[i] & data_mask[i])
+ * The first matching rule of a source bus wins.
+ */
+struct cangw_route
+{
+    rt_uint8_t src;
+    rt_uint8_t dst;
+    rt_uint8_t flags;
+    rt_uint16_t min_interval_ms;    /* rate limit, 0 = none */
+    rt_uint32_t id;
+    rt_uint32_t mask;
+    rt_uint32_t remap_id;
+    rt_uint32_t remap_mask;
+    rt_uint8_t data_mask[8];
+    rt_uint8_t data_val[8];
+
+    /* counters, updated in ISR */
+    rt_uint32_t matched;
+    rt_uint32_t forwarded;
+    rt_uint32_t limited;            /* dropped by the rate limit */
+    rt_uint32_t tx_failed;          /* destination queue full */
+    rt_tick_t last_tick;
+};
+
+rt_err_t cangw_start(struct cangw_route *routes, rt_uint16_t num);
+void cangw_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CANGW_H__ */
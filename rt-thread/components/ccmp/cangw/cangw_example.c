@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2025-12-12     RT-Thread    first version
+ */
+
+#include "cangw.h"
+
+#ifdef CCMP_USING_EXAMPLE_CANGW
+
+/* bus 0: vehicle side, bus 1: private side */
+static struct cangw_route _example_routes[] =
+{
+    /* functional diagnostic requests go to the private ECUs unchanged */
+    { .src = 0, .dst = 1, .id = 0x7DF, .mask = 0x7FF },
+    /* private status 0x300..0x30F is published on the vehicle bus as 0x400..0x40F, at most every 100 ms */
+    { .src = 1, .dst = 0, .id = 0x300, .mask = 0x7F0, .remap_id = 0x400, .remap_mask = 0x7F0, .min_interval_ms = 100 },
+    /* private alive counter: clear the private flags in byte 1 */
+    { .src = 1, .dst = 0, .id = 0x18FF1000, .mask = 0x1FFFFFFF, .flags = CANGW_F_EXT | CANGW_F_EXT_OUT,
+      .data_mask = { 0x00, 0xF0 }, .data_val = { 0x00, 0x00 } },
+};
+
+static int cangw_example(void)
+{
+    return cangw_start(_example_routes, sizeof(_example_routes) / sizeof(_example_routes[0]));
+}
+MSH_CMD_EXPORT(cangw_example, start the CAN gateway with the example routes);
+
+#endif /* CCMP_USING_EXAMPLE_CANGW */
@@ -0,0 +1,394 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2025-12-15     RT-Thread    first version
+ */
+
+#include "canil.h"
+
+#define DBG_TAG "canil"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+#if (CANIL_WHEEL_SIZE & (CANIL_WHEEL_SIZE - 1)) != 0
+#error "CANIL_WHEEL_SIZE must be a power of two"
+#endif
+
+#define CANIL_WHEEL_MASK        (CANIL_WHEEL_SIZE - 1)
+
+static rt_slist_t _il_list = RT_SLIST_OBJECT_INIT(_il_list);
+static struct rt_mutex _il_lock;
+#ifndef CANIL_USING_EXTERNAL_TICK
+static struct rt_timer _il_timer;
+#endif
+
+static rt_uint16_t canil_gcd(rt_uint16_t a, rt_uint16_t b)
+{
+    rt_uint16_t t;
+
+    while (b)
+    {
+        t = a % b;
+        a = b;
+        b = t;
+    }
+
+    return a;
+}
+
+/*
+ * Two cyclic messages (c1, o1) and (c2, o2) are due on the same tick iff
+ * (o1 - o2) is a multiple of gcd(c1, c2), and then they collide once every
+ * lcm(c1, c2) ticks. Pick the phase with the lowest summed collision rate.
+ */
+static rt_uint16_t canil_auto_offset(struct canil *il, rt_uint16_t cycle)
+{
+    struct canil_msg *m;
+    rt_uint32_t cost, best_cost = 0xFFFFFFFF;
+    rt_uint16_t o, g, best = 0;
+
+    for (o = 0; o < cycle; o++)
+    {
+        cost = 0;
+        rt_slist_for_each_entry(m, &il->msgs, list)
+        {
+            if (!(m->mode & CANIL_TX_CYCLIC))
+                continue;
+            g = canil_gcd(cycle, m->cycle);
+            if ((o + m->cycle - m->offset % m->cycle) % g == 0)
+            {
+                cost += ((rt_uint32_t)g << 16) / m->cycle;
+            }
+        }
+        if (cost < best_cost)
+        {
+            best_cost = cost;
+            best = o;
+            if (cost == 0)
+                break;
+        }
+    }
+
+    return best;
+}
+
+/* called with interrupts disabled */
+static void canil_wheel_insert(struct canil *il, struct canil_msg *msg)
+{
+    struct canil_msg **slot = &il->wheel[msg->expire & CANIL_WHEEL_MASK];
+
+    msg->wheel_next = *slot;
+    *slot = msg;
+}
+
+/* called with interrupts disabled */
+static void canil_wheel_remove(struct canil *il, struct canil_msg *msg)
+{
+    struct canil_msg **pp = &il->wheel[msg->expire & CANIL_WHEEL_MASK];
+
+    for (; *pp != RT_NULL; pp = &(*pp)->wheel_next)
+    {
+        if (*pp == msg)
+        {
+            *pp = msg->wheel_next;
+            break;
+        }
+    }
+}
+
+rt_inline void canil_send(struct canil *il, struct canil_msg *msg)
+{
+    if (rt_device_write(il->can, 0, &msg->buf[msg->front], sizeof(struct rt_can_msg)) == sizeof(struct rt_can_msg))
+    {
+        msg->tx_count++;
+    }
+    else
+    {
+        msg->tx_failed++;
+    }
+}
+
+/*
+ * One wheel step. Only the slot of the current tick is visited, so the work
+ * per tick is the number of frames due plus, for cycles longer than the
+ * wheel, the few messages that wrap around it.
+ */
+static void canil_process(struct canil *il)
+{
+    struct canil_msg *m, *list;
+    rt_uint32_t now, due = 0;
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    now = ++il->now;
+    list = il->evt_head;
+    il->evt_head = RT_NULL;
+    rt_hw_interrupt_enable(level);
+
+    for (; list != RT_NULL; list = m)
+    {
+        m = list->evt_next;
+        list->evt_queued = 0;
+        canil_send(il, list);
+        due++;
+    }
+
+    level = rt_hw_interrupt_disable();
+    list = il->wheel[now & CANIL_WHEEL_MASK];
+    il->wheel[now & CANIL_WHEEL_MASK] = RT_NULL;
+    while (list != RT_NULL)
+    {
+        m = list;
+        list = m->wheel_next;
+        if (m->expire == now)
+        {
+            canil_send(il, m);
+            m->expire += m->cycle;
+            due++;
+        }
+        canil_wheel_insert(il, m);
+    }
+    rt_hw_interrupt_enable(level);
+
+    if (due > il->max_due)
+    {
+        il->max_due = due;
+    }
+}
+
+/**
+ * @brief Advance every interaction layer by one tick.
+ *
+ * Called by the built-in hard timer, or by a hardware timer ISR when
+ * CANIL_USING_EXTERNAL_TICK is set. Must not be preempted by threads that
+ * update messages, i.e. run it in interrupt context.
+ */
+void canil_tick(void)
+{
+    struct canil *il;
+
+    rt_slist_for_each_entry(il, &_il_list, list)
+    {
+        canil_process(il);
+    }
+}
+
+#ifndef CANIL_USING_EXTERNAL_TICK
+static void canil_timeout(void *parameter)
+{
+    canil_tick();
+}
+#endif
+
+rt_err_t canil_init(struct canil *il, const char *can_name)
+{
+    static rt_bool_t inited = RT_FALSE;
+    rt_base_t level;
+    rt_err_t ret;
+
+    if (!inited)
+    {
+        rt_mutex_init(&_il_lock, "canil", RT_IPC_FLAG_PRIO);
+#ifndef CANIL_USING_EXTERNAL_TICK
+        rt_timer_init(&_il_timer, "canil", canil_timeout, RT_NULL, rt_tick_from_millisecond(CANIL_TICK_MS),
+                      RT_TIMER_FLAG_PERIODIC | RT_TIMER_FLAG_HARD_TIMER);
+        rt_timer_start(&_il_timer);
+#endif
+        inited = RT_TRUE;
+    }
+
+    rt_memset(il, 0, sizeof(struct canil));
+    il->can = rt_device_find(can_name);
+    if (il->can == RT_NULL || il->can->type != RT_Device_Class_CAN)
+    {
+        return -RT_ENOSYS;
+    }
+    ret = rt_device_open(il->can, RT_DEVICE_FLAG_INT_TX | RT_DEVICE_FLAG_INT_RX);
+    if (ret != RT_EOK)
+    {
+        return ret;
+    }
+    rt_slist_init(&il->msgs);
+
+    level = rt_hw_interrupt_disable();
+    rt_slist_append(&_il_list, &il->list);
+    rt_hw_interrupt_enable(level);
+
+    return RT_EOK;
+}
+
+rt_err_t canil_add(struct canil *il, struct canil_msg *msg)
+{
+    rt_base_t level;
+    int i;
+
+    if (msg->mode == 0 || msg->len > 8 || ((msg->mode & CANIL_TX_CYCLIC) && msg->cycle == 0))
+    {
+        return -RT_EINVAL;
+    }
+
+    for (i = 0; i < 2; i++)
+    {
+        rt_memset(&msg->buf[i], 0, sizeof(struct rt_can_msg));
+        msg->buf[i].id = msg->id;
+        msg->buf[i].ide = msg->ide;
+        msg->buf[i].len = msg->len;
+        msg->buf[i].nonblocking = 1;
+    }
+    msg->il = il;
+    msg->front = 0;
+    msg->evt_queued = 0;
+    msg->tx_count = 0;
+    msg->tx_failed = 0;
+
+    rt_mutex_take(&_il_lock, RT_WAITING_FOREVER);
+    if (msg->mode & CANIL_TX_CYCLIC)
+    {
+        if (msg->offset == CANIL_OFFSET_AUTO)
+        {
+            msg->offset = canil_auto_offset(il, msg->cycle);
+        }
+        msg->offset %= msg->cycle;
+    }
+
+    level = rt_hw_interrupt_disable();
+    rt_slist_append(&il->msgs, &msg->list);
+    if (msg->mode & CANIL_TX_CYCLIC)
+    {
+        /* first tick after now that is in phase */
+        msg->expire = il->now + 1;
+        msg->expire += (msg->offset + msg->cycle - msg->expire % msg->cycle) % msg->cycle;
+        canil_wheel_insert(il, msg);
+    }
+    rt_hw_interrupt_enable(level);
+    rt_mutex_release(&_il_lock);
+
+    return RT_EOK;
+}
+
+rt_err_t canil_remove(struct canil_msg *msg)
+{
+    struct canil *il = msg->il;
+    struct canil_msg **pp;
+    rt_base_t level;
+
+    if (il == RT_NULL)
+    {
+        return -RT_EINVAL;
+    }
+
+    rt_mutex_take(&_il_lock, RT_WAITING_FOREVER);
+    level = rt_hw_interrupt_disable();
+    if (msg->mode & CANIL_TX_CYCLIC)
+    {
+        canil_wheel_remove(il, msg);
+    }
+    if (msg->evt_queued)
+    {
+        for (pp = &il->evt_head; *pp != RT_NULL; pp = &(*pp)->evt_next)
+        {
+            if (*pp == msg)
+            {
+                *pp = msg->evt_next;
+                break;
+            }
+        }
+        msg->evt_queued = 0;
+    }
+    rt_slist_remove(&il->msgs, &msg->list);
+    msg->il = RT_NULL;
+    rt_hw_interrupt_enable(level);
+    rt_mutex_release(&_il_lock);
+
+    return RT_EOK;
+}
+
+/**
+ * @brief Get the payload buffer to update in place.
+ *
+ * The returned buffer is private to the caller and starts as a copy of the
+ * published payload. Signals written into it are sent together, never
+ * half-updated, once canil_update_end() publishes the buffer. Only one
+ * thread may update a given message at a time.
+ */
+rt_uint8_t *canil_update_begin(struct canil_msg *msg)
+{
+    rt_uint8_t back = msg->front ^ 1;
+
+    rt_memcpy(msg->buf[back].data, msg->buf[msg->front].data, sizeof(msg->buf[back].data));
+
+    return msg->buf[back].data;
+}
+
+void canil_update_end(struct canil_msg *msg)
+{
+    rt_uint8_t back = msg->front ^ 1;
+    rt_bool_t changed;
+
+    changed = rt_memcmp(msg->buf[back].data, msg->buf[msg->front].data, msg->len) != 0;
+    /* a single byte store, the tick sees either the old or the new payload */
+    msg->front = back;
+
+    if ((msg->mode & CANIL_TX_ON_CHANGE) && changed)
+    {
+        canil_trigger(msg);
+    }
+}
+
+void canil_write(struct canil_msg *msg, const void *data)
+{
+    rt_memcpy(canil_update_begin(msg), data, msg->len);
+    canil_update_end(msg);
+}
+
+/**
+ * @brief Send a message on the next tick, in addition to its cycle.
+ */
+void canil_trigger(struct canil_msg *msg)
+{
+    struct canil *il = msg->il;
+    rt_base_t level;
+
+    if (il == RT_NULL)
+    {
+        return;
+    }
+
+    level = rt_hw_interrupt_disable();
+    if (!msg->evt_queued)
+    {
+        msg->evt_queued = 1;
+        msg->evt_next = il->evt_head;
+        il->evt_head = msg;
+    }
+    rt_hw_interrupt_enable(level);
+}
+
+#ifdef RT_USING_FINSH
+static int canil(int argc, char **argv)
+{
+    struct canil *il;
+    struct canil_msg *m;
+
+    rt_slist_for_each_entry(il, &_il_list, list)
+    {
+        rt_kprintf("%s: tick %u, max frames per tick %u\n", il->can->parent.name, il->now, il->max_due);
+        rt_kprintf("  id        mode cycle offset tx         failed\n");
+        rt_slist_for_each_entry(m, &il->msgs, list)
+        {
+            rt_kprintf("  %08x  %c%c%c  %5u %6u %-10u %u\n", m->id,
+                       (m->mode & CANIL_TX_CYCLIC) ? 'C' : '-',
+                       (m->mode & CANIL_TX_EVENT) ? 'E' : '-',
+                       (m->mode & CANIL_TX_ON_CHANGE) ? 'O' : '-',
+                       m->cycle, m->offset, m->tx_count, m->tx_failed);
+        }
+    }
+
+    return 0;
+}
+MSH_CMD_EXPORT(canil, show CAN interaction layer messages);
+#endif /* RT_USING_FINSH */
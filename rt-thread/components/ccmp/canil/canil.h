@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2025-12-15     RT-Thread    first version
+ */
+
+#ifndef __CANIL_H__
+#define __CANIL_H__
+
+#include <rtthread.h>
+#include <rtdevice.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* canil_msg.mode, may be combined */
+#define CANIL_TX_CYCLIC         0x01    /* every `cycle` ticks, phase `offset` */
+#define CANIL_TX_EVENT          0x02    /* on canil_trigger() */
+#define CANIL_TX_ON_CHANGE      0x04    /* when canil_update_end() changed the payload */
+
+#define CANIL_OFFSET_AUTO       0xFFFF  /* let the layer pick the least loaded phase */
+
+/* convert milliseconds to interaction layer ticks */
+#define CANIL_MS(ms)            ((ms) / CANIL_TICK_MS)
+
+struct canil;
+
+struct canil_msg
+{
+    /* configuration, set before canil_add() */
+    rt_uint32_t id;
+    rt_uint8_t ide;
+    rt_uint8_t len;
+    rt_uint8_t mode;
+    rt_uint16_t cycle;              /* ticks */
+    rt_uint16_t offset;             /* ticks, or CANIL_OFFSET_AUTO */
+
+    /* statistics */
+    rt_uint32_t tx_count;
+    rt_uint32_t tx_failed;
+
+    /* private */
+    rt_slist_t list;
+    struct canil *il;
+    struct canil_msg *wheel_next;
+    struct canil_msg *evt_next;
+    rt_uint32_t expire;
+    rt_uint8_t evt_queued;
+    volatile rt_uint8_t front;      /* index of the published buffer */
+    struct rt_can_msg buf[2];
+};
+
+struct canil
+{
+    rt_slist_t list;
+    rt_device_t can;
+    rt_uint32_t now;
+    rt_slist_t msgs;
+    struct canil_msg *evt_head;
+    struct canil_msg *wheel[CANIL_WHEEL_SIZE];
+    rt_uint32_t max_due;            /* most frames sent in one tick */
+};
+
+rt_err_t canil_init(struct canil *il, const char *can_name);
+rt_err_t canil_add(struct canil *il, struct canil_msg *msg);
+rt_err_t canil_remove(struct canil_msg *msg);
+
+rt_uint8_t *canil_update_begin(struct canil_msg *msg);
+void canil_update_end(struct canil_msg *msg);
+void canil_write(struct canil_msg *msg, const void *data);
+void canil_trigger(struct canil_msg *msg);
+
+void canil_tick(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CANIL_H__ */
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2025-12-15     RT-Thread    first version
+ */
+
+#include "canil.h"
+
+#ifdef CCMP_USING_EXAMPLE_CANIL
+
+#define EXAMPLE_MSG_NUM     120
+
+static struct canil _example_il;
+static struct canil_msg _example_msgs[EXAMPLE_MSG_NUM];
+
+/* 120 cyclic frames at 10/20/100/1000 ms with automatic phases, see `canil` for the result */
+static int canil_example(int argc, char **argv)
+{
+    static const rt_uint16_t cycle_ms[] = { 10, 20, 100, 1000 };
+    const char *dev = argc > 1 ? argv[1] : "can1";
+    rt_uint8_t *data;
+    int i;
+
+    if (canil_init(&_example_il, dev) != RT_EOK)
+    {
+        rt_kprintf("%s not available\n", dev);
+        return -RT_ERROR;
+    }
+
+    for (i = 0; i < EXAMPLE_MSG_NUM; i++)
+    {
+        _example_msgs[i].id = 0x100 + i;
+        _example_msgs[i].ide = RT_CAN_STDID;
+        _example_msgs[i].len = 8;
+        _example_msgs[i].mode = CANIL_TX_CYCLIC | CANIL_TX_ON_CHANGE;
+        _example_msgs[i].cycle = CANIL_MS(cycle_ms[i % 4]);
+        _example_msgs[i].offset = CANIL_OFFSET_AUTO;
+        canil_add(&_example_il, &_example_msgs[i]);
+
+        data = canil_update_begin(&_example_msgs[i]);
+        data[0] = (rt_uint8_t)i;
+        canil_update_end(&_example_msgs[i]);
+    }
+
+    return 0;
+}
+MSH_CMD_EXPORT(canil_example, start 120 cyclic frames on a CAN device);
+
+#endif /* CCMP_USING_EXAMPLE_CANIL */
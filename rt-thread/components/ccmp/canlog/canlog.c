@@ -0,0 +1,1040 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2025-12-08     RT-Thread    first version
+ */
+
+#include "canlog.h"
+#include <stdlib.h>
+
+#ifdef RT_USING_CPUTIME
+#include <drivers/cputime.h>
+#endif
+
+#ifdef CANLOG_USING_FAL
+#include <fal.h>
+#else
+#include <dfs.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+#ifdef PKG_USING_CAN_UDS
+#include "rtt_uds_service.h"
+#endif
+
+#define DBG_TAG "canlog"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+#ifndef RT_CAN_USING_MSG_HOOK
+#error "canlog needs RT_CAN_USING_MSG_HOOK"
+#endif
+
+#if (CANLOG_RING_SIZE & (CANLOG_RING_SIZE - 1)) != 0
+#error "CANLOG_RING_SIZE must be a power of two"
+#endif
+
+#define CANLOG_BUS_NUM          2
+#define CANLOG_WAKE_BATCH       64
+#define CANLOG_POLL_MS          50
+
+#define CANLOG_EVT_DATA         (1 << 0)
+#define CANLOG_EVT_TRIGGER      (1 << 1)
+
+/* triggered mode states */
+#define CANLOG_STATE_ARMED      0
+#define CANLOG_STATE_POST       1
+
+/*
+ * Capture ring: bounded lock-free queue with one consumer and any number of
+ * producers (RX/TX interrupts of every attached bus, plus the non-blocking
+ * send fast path in thread context). A producer claims a slot by advancing
+ * `head` with CAS and publishes it through the slot sequence number, so a
+ * frame never waits for a lock and a full ring only costs a drop counter.
+ */
+struct canlog_slot
+{
+    rt_atomic_t seq;
+    struct canlog_record rec;
+};
+
+struct canlog_hist
+{
+    rt_uint64_t us;
+    struct canlog_record rec;
+};
+
+union canlog_block
+{
+    rt_uint8_t raw[CANLOG_BLOCK_SIZE];
+    struct
+    {
+        struct canlog_block_hdr hdr;
+        struct canlog_record rec[CANLOG_BLOCK_RECORDS];
+    } b;
+};
+
+struct canlog_id_trig
+{
+    rt_uint32_t id;
+    rt_uint32_t mask;
+    rt_bool_t ext;
+    rt_bool_t enable;
+};
+
+struct canlog
+{
+    rt_bool_t inited;
+    volatile rt_bool_t running;
+    rt_uint8_t mode;
+    rt_uint8_t state;
+
+    struct rt_thread thread;
+    struct rt_event event;
+    struct rt_mutex lock;
+
+    /* attached buses, the index is the bus number in the record */
+    rt_device_t bus[CANLOG_BUS_NUM];
+    struct rt_can_msg_hook hook[CANLOG_BUS_NUM];
+
+    /* ring, producer side */
+    rt_atomic_t head;
+    rt_atomic_t dropped;
+    /* ring, consumer side */
+    rt_uint32_t tail;
+
+    /* external trigger request */
+    rt_uint32_t trig_pending;
+    rt_uint64_t trig_us;
+    rt_bool_t mark_next;
+    struct canlog_id_trig id_trig[CANLOG_ID_TRIG_NUM];
+
+    /* pre-trigger history */
+    rt_uint16_t hist_head;
+    rt_uint16_t hist_count;
+    rt_uint32_t post_left;
+
+    /* block being filled */
+    rt_uint32_t blk_seq;
+    rt_uint32_t blk_flags;
+    rt_uint64_t blk_last_us;
+    rt_tick_t blk_open_tick;
+
+#ifdef CANLOG_USING_FAL
+    const struct fal_partition *part;
+    rt_uint32_t blk_num;
+    rt_uint32_t blk_index;
+    rt_uint32_t erased_end;
+#else
+    int fd;
+    rt_uint32_t file_index;
+    rt_uint32_t file_blocks;
+#endif
+
+    struct canlog_stat stat;
+};
+
+static struct canlog _log;
+static struct canlog_slot _ring[CANLOG_RING_SIZE];
+static struct canlog_hist _hist[CANLOG_PRETRIGGER_NUM];
+static union canlog_block _blk;
+static rt_uint8_t _thread_stack[CANLOG_THREAD_STACK_SIZE];
+
+static rt_uint64_t canlog_now_us(void)
+{
+#ifdef RT_USING_CPUTIME
+    return clock_cpu_microsecond(clock_cpu_gettime());
+#else
+    return (rt_uint64_t)rt_tick_get() * (1000000 / RT_TICK_PER_SECOND);
+#endif
+}
+
+static rt_uint32_t canlog_crc32(rt_uint32_t crc, const void *buf, rt_size_t len)
+{
+    static const rt_uint32_t table[16] =
+    {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+        0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+        0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+    };
+    const rt_uint8_t *p = buf;
+
+    crc = ~crc;
+    while (len--)
+    {
+        crc ^= *p++;
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+        crc = (crc >> 4) ^ table[crc & 0x0F];
+    }
+
+    return ~crc;
+}
+
+/* runs in the CAN ISR (or the caller of a non-blocking send) */
+static void canlog_ring_put(const struct rt_can_msg *msg, rt_uint32_t bus, rt_bool_t tx)
+{
+    struct canlog_slot *slot;
+    rt_atomic_t pos, seq;
+    rt_uint32_t len;
+
+    pos = rt_atomic_load(&_log.head);
+    for (;;)
+    {
+        slot = &_ring[pos & (CANLOG_RING_SIZE - 1)];
+        seq = rt_atomic_load(&slot->seq);
+        if (seq == pos)
+        {
+            if (rt_atomic_compare_exchange_strong(&_log.head, &pos, pos + 1))
+            {
+                break;
+            }
+        }
+        else if ((rt_int32_t)(seq - pos) < 0)
+        {
+            /* the consumer has not released this slot yet: ring full */
+            rt_atomic_add(&_log.dropped, 1);
+            return;
+        }
+        else
+        {
+            pos = rt_atomic_load(&_log.head);
+        }
+    }
+
+    len = msg->len > 8 ? 8 : msg->len;
+    slot->rec.stamp = ((rt_uint32_t)canlog_now_us() & CANLOG_STAMP_MASK)
+                    | ((rt_uint32_t)(msg->len & 0x0F) << 26)
+                    | (bus << 30)
+                    | (tx ? CANLOG_STAMP_TX : 0);
+    slot->rec.ident = (msg->id & 0x1FFFFFFF)
+                    | (msg->ide ? CANLOG_IDENT_EXT : 0)
+                    | (msg->rtr ? CANLOG_IDENT_RTR : 0);
+    rt_memset(slot->rec.data, 0, sizeof(slot->rec.data));
+    rt_memcpy(slot->rec.data, msg->data, len);
+    rt_atomic_store(&slot->seq, pos + 1);
+
+    if ((pos & (CANLOG_WAKE_BATCH - 1)) == CANLOG_WAKE_BATCH - 1)
+    {
+        rt_event_send(&_log.event, CANLOG_EVT_DATA);
+    }
+}
+
+static rt_bool_t canlog_ring_get(struct canlog_record *rec)
+{
+    struct canlog_slot *slot = &_ring[_log.tail & (CANLOG_RING_SIZE - 1)];
+
+    if (rt_atomic_load(&slot->seq) != (rt_atomic_t)(_log.tail + 1))
+    {
+        return RT_FALSE;
+    }
+    rt_memcpy(rec, &slot->rec, sizeof(*rec));
+    rt_atomic_store(&slot->seq, (rt_atomic_t)(_log.tail + CANLOG_RING_SIZE));
+    _log.tail++;
+
+    return RT_TRUE;
+}
+
+static rt_bool_t canlog_hook(struct rt_can_device *can, struct rt_can_msg *msg, rt_uint32_t dir, void *args)
+{
+    if (_log.running)
+    {
+        canlog_ring_put(msg, (rt_uint32_t)(rt_ubase_t)args, dir == RT_CAN_MSG_HOOK_TX);
+    }
+
+    /* never consume the frame */
+    return RT_FALSE;
+}
+
+/* ---------------------------------------------------------------------------
+ * Backend
+ * -------------------------------------------------------------------------*/
+
+#ifdef CANLOG_USING_FAL
+static rt_err_t canlog_backend_open(void)
+{
+    struct canlog_block_hdr hdr;
+    rt_uint32_t i, last = 0;
+    rt_bool_t found = RT_FALSE;
+
+    _log.part = fal_partition_find(CANLOG_FAL_PART_NAME);
+    if (_log.part == RT_NULL)
+    {
+        LOG_E("partition '%s' not found", CANLOG_FAL_PART_NAME);
+        return -RT_ERROR;
+    }
+    _log.blk_num = _log.part->len / CANLOG_BLOCK_SIZE;
+    if (_log.blk_num == 0)
+    {
+        return -RT_ERROR;
+    }
+
+    /* resume after the newest block left by a previous session */
+    _log.blk_seq = 0;
+    for (i = 0; i < _log.blk_num; i++)
+    {
+        if (fal_partition_read(_log.part, i * CANLOG_BLOCK_SIZE, (rt_uint8_t *)&hdr, sizeof(hdr)) < 0)
+        {
+            return -RT_EIO;
+        }
+        if (hdr.magic == CANLOG_BLOCK_MAGIC && (!found || (rt_int32_t)(hdr.seq - _log.blk_seq) >= 0))
+        {
+            _log.blk_seq = hdr.seq + 1;
+            last = i;
+            found = RT_TRUE;
+        }
+    }
+    _log.blk_index = found ? (last + 1) % _log.blk_num : 0;
+    /* nothing ahead of the write position is known to be erased */
+    _log.erased_end = _log.blk_index * CANLOG_BLOCK_SIZE;
+
+    LOG_I("fal '%s' %d blocks, resume at block %d seq %d", _log.part->name, _log.blk_num, _log.blk_index, _log.blk_seq);
+
+    return RT_EOK;
+}
+
+static rt_err_t canlog_backend_write(const void *buf)
+{
+    rt_uint32_t off = _log.blk_index * CANLOG_BLOCK_SIZE;
+    rt_uint32_t len;
+
+    if (off == 0 || off >= _log.erased_end)
+    {
+        if (off == 0)
+        {
+            _log.erased_end = 0;
+        }
+        /*
+         * Erase ahead in CANLOG_FAL_ERASE_SIZE chunks so the flash can use
+         * its large block erase. A resumed session first erases up to the
+         * next chunk boundary only, keeping the blocks just behind it.
+         */
+        len = CANLOG_FAL_ERASE_SIZE - (off % CANLOG_FAL_ERASE_SIZE);
+        if (off + len > _log.blk_num * CANLOG_BLOCK_SIZE)
+        {
+            len = _log.blk_num * CANLOG_BLOCK_SIZE - off;
+        }
+        if (fal_partition_erase(_log.part, off, len) < 0)
+        {
+            return -RT_EIO;
+        }
+        _log.erased_end = off + len;
+    }
+
+    if (fal_partition_write(_log.part, off, buf, CANLOG_BLOCK_SIZE) < 0)
+    {
+        return -RT_EIO;
+    }
+    _log.blk_index = (_log.blk_index + 1) % _log.blk_num;
+
+    return RT_EOK;
+}
+
+static void canlog_backend_close(void)
+{
+    _log.part = RT_NULL;
+}
+#else
+static void canlog_file_name(char *buf, rt_size_t size, rt_uint32_t index)
+{
+    rt_snprintf(buf, size, "%s/clg%05d.bin", CANLOG_FILE_DIR, index);
+}
+
+static rt_err_t canlog_file_next(void)
+{
+    char path[DFS_PATH_MAX];
+
+    if (_log.fd >= 0)
+    {
+        close(_log.fd);
+    }
+
+    _log.file_index++;
+    if (_log.file_index > CANLOG_FILE_MAX_NUM)
+    {
+        canlog_file_name(path, sizeof(path), _log.file_index - CANLOG_FILE_MAX_NUM);
+        unlink(path);
+    }
+    canlog_file_name(path, sizeof(path), _log.file_index);
+    _log.fd = open(path, O_WRONLY | O_CREAT | O_TRUNC);
+    _log.file_blocks = 0;
+    if (_log.fd < 0)
+    {
+        LOG_E("open %s failed", path);
+        return -RT_EIO;
+    }
+
+    return RT_EOK;
+}
+
+static rt_err_t canlog_backend_open(void)
+{
+    DIR *dir;
+    struct dirent *ent;
+    rt_uint32_t index;
+
+    mkdir(CANLOG_FILE_DIR, 0);
+    dir = opendir(CANLOG_FILE_DIR);
+    if (dir == RT_NULL)
+    {
+        LOG_E("open dir %s failed", CANLOG_FILE_DIR);
+        return -RT_ERROR;
+    }
+
+    /* every session starts a new file after the newest one */
+    _log.file_index = 0;
+    while ((ent = readdir(dir)) != RT_NULL)
+    {
+        if (rt_strncmp(ent->d_name, "clg", 3) == 0)
+        {
+            index = atoi(ent->d_name + 3);
+            if (index > _log.file_index)
+            {
+                _log.file_index = index;
+            }
+        }
+    }
+    closedir(dir);
+
+    _log.fd = -1;
+    _log.blk_seq = 0;
+
+    return canlog_file_next();
+}
+
+static rt_err_t canlog_backend_write(const void *buf)
+{
+    if (_log.fd < 0 || _log.file_blocks >= CANLOG_FILE_MAX_BLOCKS)
+    {
+        if (canlog_file_next() != RT_EOK)
+        {
+            return -RT_EIO;
+        }
+    }
+
+    if (write(_log.fd, buf, CANLOG_BLOCK_SIZE) != CANLOG_BLOCK_SIZE)
+    {
+        return -RT_EIO;
+    }
+    /* commit the block so a power loss costs at most the block being filled */
+    fsync(_log.fd);
+    _log.file_blocks++;
+
+    return RT_EOK;
+}
+
+static void canlog_backend_close(void)
+{
+    if (_log.fd >= 0)
+    {
+        close(_log.fd);
+        _log.fd = -1;
+    }
+}
+#endif /* CANLOG_USING_FAL */
+
+/* ---------------------------------------------------------------------------
+ * Block assembly
+ * -------------------------------------------------------------------------*/
+
+static void canlog_block_reset(void)
+{
+    rt_memset(&_blk, 0xFF, sizeof(_blk));
+    _blk.b.hdr.count = 0;
+    _log.blk_flags = 0;
+}
+
+static void canlog_block_write(rt_uint32_t flags)
+{
+    struct canlog_block_hdr *hdr = &_blk.b.hdr;
+    rt_tick_t tick;
+
+    if (hdr->count == 0)
+    {
+        return;
+    }
+
+    hdr->magic = CANLOG_BLOCK_MAGIC;
+    hdr->version = CANLOG_BLOCK_VERSION;
+    hdr->seq = _log.blk_seq;
+    hdr->dropped = (rt_uint32_t)rt_atomic_load(&_log.dropped);
+    hdr->flags = _log.blk_flags | flags;
+    hdr->crc = 0;
+    hdr->crc = canlog_crc32(0, &_blk, sizeof(*hdr) + hdr->count * sizeof(struct canlog_record));
+
+    tick = rt_tick_get();
+    if (canlog_backend_write(&_blk) == RT_EOK)
+    {
+        _log.blk_seq++;
+        _log.stat.blocks++;
+    }
+    else
+    {
+        _log.stat.write_errors++;
+    }
+    tick = rt_tick_get() - tick;
+    if (tick * 1000 / RT_TICK_PER_SECOND > _log.stat.max_write_ms)
+    {
+        _log.stat.max_write_ms = tick * 1000 / RT_TICK_PER_SECOND;
+    }
+
+    canlog_block_reset();
+}
+
+static void canlog_block_put(const struct canlog_record *rec, rt_uint64_t us, rt_uint32_t flags)
+{
+    struct canlog_block_hdr *hdr = &_blk.b.hdr;
+    rt_int64_t step;
+
+    if (hdr->count > 0)
+    {
+        step = (rt_int64_t)(us - _log.blk_last_us);
+        if (step >= CANLOG_STAMP_HALF || step <= -CANLOG_STAMP_HALF)
+        {
+            canlog_block_write(CANLOG_BLK_PARTIAL);
+        }
+    }
+    if (hdr->count == 0)
+    {
+        hdr->base_us = us;
+        _log.blk_open_tick = rt_tick_get();
+    }
+
+    rt_memcpy(&_blk.b.rec[hdr->count], rec, sizeof(*rec));
+    hdr->count++;
+    _log.blk_flags |= flags;
+    _log.blk_last_us = us;
+
+    if (hdr->count == CANLOG_BLOCK_RECORDS)
+    {
+        canlog_block_write(0);
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * Triggering
+ * -------------------------------------------------------------------------*/
+
+static rt_bool_t canlog_id_match(const struct canlog_record *rec)
+{
+    rt_uint32_t id = CANLOG_IDENT_ID(rec->ident);
+    rt_bool_t ext = (rec->ident & CANLOG_IDENT_EXT) ? RT_TRUE : RT_FALSE;
+    int i;
+
+    for (i = 0; i < CANLOG_ID_TRIG_NUM; i++)
+    {
+        if (_log.id_trig[i].enable && _log.id_trig[i].ext == ext
+            && (id & _log.id_trig[i].mask) == (_log.id_trig[i].id & _log.id_trig[i].mask))
+        {
+            return RT_TRUE;
+        }
+    }
+
+    return RT_FALSE;
+}
+
+static void canlog_hist_put(const struct canlog_record *rec, rt_uint64_t us)
+{
+    struct canlog_hist *h = &_hist[_log.hist_head];
+
+    h->us = us;
+    rt_memcpy(&h->rec, rec, sizeof(*rec));
+    _log.hist_head = (_log.hist_head + 1) % CANLOG_PRETRIGGER_NUM;
+    if (_log.hist_count < CANLOG_PRETRIGGER_NUM)
+    {
+        _log.hist_count++;
+    }
+}
+
+/* enter the post-trigger window, the pre-trigger history goes out first */
+static void canlog_fire(rt_uint32_t source)
+{
+    rt_uint16_t i, idx;
+
+    _log.stat.triggers++;
+    _log.mark_next = RT_TRUE;
+    LOG_I("trigger 0x%02x", source);
+
+    if (_log.mode != CANLOG_MODE_TRIGGERED)
+    {
+        return;
+    }
+
+    idx = (_log.hist_head + CANLOG_PRETRIGGER_NUM - _log.hist_count) % CANLOG_PRETRIGGER_NUM;
+    for (i = 0; i < _log.hist_count; i++)
+    {
+        canlog_block_put(&_hist[idx].rec, _hist[idx].us, CANLOG_BLK_PRETRIGGER);
+        idx = (idx + 1) % CANLOG_PRETRIGGER_NUM;
+    }
+    _log.hist_count = 0;
+    _log.hist_head = 0;
+    _log.post_left = CANLOG_POSTTRIGGER_NUM;
+    _log.state = CANLOG_STATE_POST;
+}
+
+static rt_uint32_t canlog_take_trigger(rt_uint64_t *us)
+{
+    rt_base_t level;
+    rt_uint32_t source;
+
+    level = rt_hw_interrupt_disable();
+    source = _log.trig_pending;
+    *us = _log.trig_us;
+    _log.trig_pending = 0;
+    rt_hw_interrupt_enable(level);
+
+    return source;
+}
+
+static void canlog_record_one(struct canlog_record *rec, rt_uint64_t us)
+{
+    if (_log.mode == CANLOG_MODE_TRIGGERED && _log.state == CANLOG_STATE_ARMED)
+    {
+        if (!canlog_id_match(rec))
+        {
+            canlog_hist_put(rec, us);
+            return;
+        }
+        canlog_fire(CANLOG_TRIG_ID);
+    }
+    else if (canlog_id_match(rec))
+    {
+        /* a bookmark in continuous mode or inside the post window */
+        _log.stat.triggers++;
+        _log.mark_next = RT_TRUE;
+    }
+
+    if (_log.mark_next)
+    {
+        rec->ident |= CANLOG_IDENT_TRIGGER;
+        _log.mark_next = RT_FALSE;
+        canlog_block_put(rec, us, CANLOG_BLK_TRIGGER);
+    }
+    else
+    {
+        canlog_block_put(rec, us, 0);
+    }
+
+    if (_log.state == CANLOG_STATE_POST && --_log.post_left == 0)
+    {
+        canlog_block_write(CANLOG_BLK_PARTIAL);
+        _log.state = CANLOG_STATE_ARMED;
+    }
+}
+
+/* drain the ring, called with the lock held */
+static void canlog_process(void)
+{
+    struct canlog_record rec;
+    rt_uint64_t now, us, trig_us = 0;
+    rt_uint32_t trig, fill;
+
+    trig = canlog_take_trigger(&trig_us);
+
+    fill = (rt_uint32_t)rt_atomic_load(&_log.head) - _log.tail;
+    if (fill > _log.stat.ring_peak)
+    {
+        _log.stat.ring_peak = fill;
+    }
+
+    while (canlog_ring_get(&rec))
+    {
+        /* read the clock after the slot: the record can never be newer */
+        now = canlog_now_us();
+        us = now - ((now - CANLOG_STAMP_US(rec.stamp)) & CANLOG_STAMP_MASK);
+
+        /* frames captured before an external trigger stay pre-trigger history */
+        if (trig && (rt_int64_t)(us - trig_us) >= 0)
+        {
+            canlog_fire(trig);
+            trig = 0;
+        }
+        canlog_record_one(&rec, us);
+        _log.stat.captured++;
+    }
+
+    if (trig)
+    {
+        canlog_fire(trig);
+    }
+
+    /* bound the data lost on power failure when the bus is quiet */
+    if (_blk.b.hdr.count > 0 && rt_tick_get() - _log.blk_open_tick >= rt_tick_from_millisecond(CANLOG_FLUSH_MS))
+    {
+        canlog_block_write(CANLOG_BLK_PARTIAL);
+    }
+}
+
+static void canlog_thread_entry(void *parameter)
+{
+    rt_uint32_t recved;
+
+    while (1)
+    {
+        rt_event_recv(&_log.event, CANLOG_EVT_DATA | CANLOG_EVT_TRIGGER,
+                      RT_EVENT_FLAG_OR | RT_EVENT_FLAG_CLEAR,
+                      _log.running ? rt_tick_from_millisecond(CANLOG_POLL_MS) : RT_WAITING_FOREVER, &recved);
+
+        rt_mutex_take(&_log.lock, RT_WAITING_FOREVER);
+        if (_log.running)
+        {
+            canlog_process();
+        }
+        rt_mutex_release(&_log.lock);
+    }
+}
+
+/* ---------------------------------------------------------------------------
+ * API
+ * -------------------------------------------------------------------------*/
+
+static int canlog_init(void)
+{
+    rt_uint32_t i;
+
+    if (_log.inited)
+    {
+        return RT_EOK;
+    }
+
+    for (i = 0; i < CANLOG_RING_SIZE; i++)
+    {
+        _ring[i].seq = i;
+    }
+#ifndef CANLOG_USING_FAL
+    _log.fd = -1;
+#endif
+    canlog_block_reset();
+
+    rt_event_init(&_log.event, "canlog", RT_IPC_FLAG_PRIO);
+    rt_mutex_init(&_log.lock, "canlog", RT_IPC_FLAG_PRIO);
+    rt_thread_init(&_log.thread, "canlog", canlog_thread_entry, RT_NULL,
+                   _thread_stack, sizeof(_thread_stack), CANLOG_THREAD_PRIORITY, 10);
+    rt_thread_startup(&_log.thread);
+    _log.inited = RT_TRUE;
+
+    return RT_EOK;
+}
+INIT_APP_EXPORT(canlog_init);
+
+/**
+ * @brief Record every frame sent or received on a CAN device.
+ *
+ * Up to two buses can be attached, the first one is bus 0 in the log.
+ */
+rt_err_t canlog_attach(const char *can_name)
+{
+    rt_device_t dev;
+    rt_err_t ret;
+    int i, free = -1;
+
+    dev = rt_device_find(can_name);
+    if (dev == RT_NULL || dev->type != RT_Device_Class_CAN)
+    {
+        return -RT_EINVAL;
+    }
+
+    rt_mutex_take(&_log.lock, RT_WAITING_FOREVER);
+    for (i = CANLOG_BUS_NUM - 1; i >= 0; i--)
+    {
+        if (_log.bus[i] == dev)
+        {
+            rt_mutex_release(&_log.lock);
+            return RT_EOK;
+        }
+        if (_log.bus[i] == RT_NULL)
+        {
+            free = i;
+        }
+    }
+    if (free < 0)
+    {
+        rt_mutex_release(&_log.lock);
+        return -RT_EFULL;
+    }
+
+    _log.hook[free].flags = RT_CAN_MSG_HOOK_RX | RT_CAN_MSG_HOOK_TX;
+    _log.hook[free].hook = canlog_hook;
+    _log.hook[free].args = (void *)(rt_ubase_t)free;
+    ret = rt_device_control(dev, RT_CAN_CMD_ADD_MSG_HOOK, &_log.hook[free]);
+    if (ret == RT_EOK)
+    {
+        _log.bus[free] = dev;
+    }
+    rt_mutex_release(&_log.lock);
+
+    return ret;
+}
+
+rt_err_t canlog_detach(const char *can_name)
+{
+    int i;
+
+    rt_mutex_take(&_log.lock, RT_WAITING_FOREVER);
+    for (i = 0; i < CANLOG_BUS_NUM; i++)
+    {
+        if (_log.bus[i] && rt_strcmp(_log.bus[i]->parent.name, can_name) == 0)
+        {
+            rt_device_control(_log.bus[i], RT_CAN_CMD_DEL_MSG_HOOK, &_log.hook[i]);
+            _log.bus[i] = RT_NULL;
+            rt_mutex_release(&_log.lock);
+            return RT_EOK;
+        }
+    }
+    rt_mutex_release(&_log.lock);
+
+    return -RT_EINVAL;
+}
+
+rt_err_t canlog_start(rt_uint8_t mode)
+{
+    struct canlog_record rec;
+    rt_err_t ret;
+
+    if (mode > CANLOG_MODE_TRIGGERED)
+    {
+        return -RT_EINVAL;
+    }
+
+    rt_mutex_take(&_log.lock, RT_WAITING_FOREVER);
+    if (_log.running)
+    {
+        rt_mutex_release(&_log.lock);
+        return -RT_EBUSY;
+    }
+
+    ret = canlog_backend_open();
+    if (ret == RT_EOK)
+    {
+        /* discard what was left over from the previous session */
+        while (canlog_ring_get(&rec));
+        canlog_block_reset();
+        canlog_take_trigger(&_log.trig_us);
+        _log.mode = mode;
+        _log.state = CANLOG_STATE_ARMED;
+        _log.hist_head = 0;
+        _log.hist_count = 0;
+        _log.post_left = 0;
+        _log.mark_next = RT_FALSE;
+        rt_atomic_store(&_log.dropped, 0);
+        rt_memset(&_log.stat, 0, sizeof(_log.stat));
+        _log.running = RT_TRUE;
+    }
+    rt_mutex_release(&_log.lock);
+
+    /* wake the thread so it starts polling */
+    rt_event_send(&_log.event, CANLOG_EVT_DATA);
+
+    return ret;
+}
+
+rt_err_t canlog_stop(void)
+{
+    rt_mutex_take(&_log.lock, RT_WAITING_FOREVER);
+    if (!_log.running)
+    {
+        rt_mutex_release(&_log.lock);
+        return RT_EOK;
+    }
+    _log.running = RT_FALSE;
+
+    canlog_process();
+    if (_log.mode == CANLOG_MODE_CONTINUOUS || _log.state == CANLOG_STATE_POST)
+    {
+        canlog_block_write(CANLOG_BLK_PARTIAL);
+    }
+    canlog_backend_close();
+    rt_mutex_release(&_log.lock);
+
+    return RT_EOK;
+}
+
+rt_err_t canlog_flush(void)
+{
+    rt_mutex_take(&_log.lock, RT_WAITING_FOREVER);
+    if (_log.running)
+    {
+        canlog_process();
+        canlog_block_write(CANLOG_BLK_PARTIAL);
+    }
+    rt_mutex_release(&_log.lock);
+
+    return RT_EOK;
+}
+
+/**
+ * @brief Request a trigger, e.g. when a DTC is confirmed.
+ *
+ * Safe to call from interrupt context. Frames captured before the call are
+ * kept as pre-trigger history, the first frame after it is marked.
+ */
+rt_err_t canlog_trigger(rt_uint32_t source)
+{
+    rt_base_t level;
+
+    if (!_log.running)
+    {
+        return -RT_ERROR;
+    }
+
+    level = rt_hw_interrupt_disable();
+    if (_log.trig_pending == 0)
+    {
+        _log.trig_us = canlog_now_us();
+    }
+    _log.trig_pending |= source;
+    rt_hw_interrupt_enable(level);
+    rt_event_send(&_log.event, CANLOG_EVT_TRIGGER);
+
+    return RT_EOK;
+}
+
+rt_err_t canlog_set_id_trigger(rt_uint8_t index, rt_uint32_t id, rt_uint32_t mask, rt_bool_t ext)
+{
+    if (index >= CANLOG_ID_TRIG_NUM)
+    {
+        return -RT_EINVAL;
+    }
+
+    rt_mutex_take(&_log.lock, RT_WAITING_FOREVER);
+    _log.id_trig[index].id = id;
+    _log.id_trig[index].mask = mask;
+    _log.id_trig[index].ext = ext;
+    _log.id_trig[index].enable = RT_TRUE;
+    rt_mutex_release(&_log.lock);
+
+    return RT_EOK;
+}
+
+void canlog_clear_id_trigger(rt_uint8_t index)
+{
+    if (index < CANLOG_ID_TRIG_NUM)
+    {
+        rt_mutex_take(&_log.lock, RT_WAITING_FOREVER);
+        _log.id_trig[index].enable = RT_FALSE;
+        rt_mutex_release(&_log.lock);
+    }
+}
+
+void canlog_get_stat(struct canlog_stat *stat)
+{
+    rt_mutex_take(&_log.lock, RT_WAITING_FOREVER);
+    rt_memcpy(stat, &_log.stat, sizeof(*stat));
+    stat->dropped = (rt_uint32_t)rt_atomic_load(&_log.dropped);
+    rt_mutex_release(&_log.lock);
+}
+
+#ifdef PKG_USING_CAN_UDS
+/* RoutineControl start on CANLOG_UDS_RID fires a trigger */
+static UDS_HANDLER(handle_canlog_trigger)
+{
+    UDSRoutineCtrlArgs_t *args = (UDSRoutineCtrlArgs_t *)data;
+
+    if (args->id != CANLOG_UDS_RID)
+        return UDS_NRC_RequestOutOfRange;
+
+    if (args->ctrlType != UDS_LEV_RCTP_STR)
+        return UDS_NRC_SubFunctionNotSupported;
+
+    if (canlog_trigger(CANLOG_TRIG_UDS) != RT_EOK)
+        return UDS_NRC_ConditionsNotCorrect;
+
+    return UDS_PositiveResponse;
+}
+RTT_UDS_SERVICE_DEFINE_OPS(canlog_trigger_node, UDS_EVT_RoutineCtrl, handle_canlog_trigger);
+#endif /* PKG_USING_CAN_UDS */
+
+#ifdef RT_USING_FINSH
+static void canlog_usage(void)
+{
+    rt_kprintf("Usage:\n");
+    rt_kprintf("canlog attach <can>                 - record a CAN device\n");
+    rt_kprintf("canlog detach <can>                 - stop recording a CAN device\n");
+    rt_kprintf("canlog start [cont|trig]            - start recording\n");
+    rt_kprintf("canlog stop                         - stop recording and flush\n");
+    rt_kprintf("canlog flush                        - write the current block\n");
+    rt_kprintf("canlog trigger                      - fire a manual trigger\n");
+    rt_kprintf("canlog idtrig <n> <id> <mask> [ext] - trigger on a frame id\n");
+    rt_kprintf("canlog idclr <n>                    - remove an id trigger\n");
+    rt_kprintf("canlog stat                         - show statistics\n");
+}
+
+static int canlog(int argc, char **argv)
+{
+    struct canlog_stat stat;
+    rt_err_t ret = RT_EOK;
+
+    if (argc < 2)
+    {
+        canlog_usage();
+        return 0;
+    }
+
+    if (!rt_strcmp(argv[1], "attach") && argc > 2)
+    {
+        ret = canlog_attach(argv[2]);
+    }
+    else if (!rt_strcmp(argv[1], "detach") && argc > 2)
+    {
+        ret = canlog_detach(argv[2]);
+    }
+    else if (!rt_strcmp(argv[1], "start"))
+    {
+        ret = canlog_start((argc > 2 && !rt_strcmp(argv[2], "trig")) ? CANLOG_MODE_TRIGGERED : CANLOG_MODE_CONTINUOUS);
+    }
+    else if (!rt_strcmp(argv[1], "stop"))
+    {
+        ret = canlog_stop();
+    }
+    else if (!rt_strcmp(argv[1], "flush"))
+    {
+        ret = canlog_flush();
+    }
+    else if (!rt_strcmp(argv[1], "trigger"))
+    {
+        ret = canlog_trigger(CANLOG_TRIG_USER);
+    }
+    else if (!rt_strcmp(argv[1], "idtrig") && argc > 4)
+    {
+        ret = canlog_set_id_trigger(atoi(argv[2]), strtoul(argv[3], RT_NULL, 0), strtoul(argv[4], RT_NULL, 0),
+                                    argc > 5 && !rt_strcmp(argv[5], "ext"));
+    }
+    else if (!rt_strcmp(argv[1], "idclr") && argc > 2)
+    {
+        canlog_clear_id_trigger(atoi(argv[2]));
+    }
+    else if (!rt_strcmp(argv[1], "stat"))
+    {
+        canlog_get_stat(&stat);
+        rt_kprintf("running      : %s (%s)\n", _log.running ? "yes" : "no",
+                   _log.mode == CANLOG_MODE_TRIGGERED ? "triggered" : "continuous");
+        rt_kprintf("captured     : %u\n", stat.captured);
+        rt_kprintf("dropped      : %u\n", stat.dropped);
+        rt_kprintf("ring peak    : %u/%u\n", stat.ring_peak, CANLOG_RING_SIZE);
+        rt_kprintf("blocks       : %u (next seq %u)\n", stat.blocks, _log.blk_seq);
+        rt_kprintf("write errors : %u\n", stat.write_errors);
+        rt_kprintf("max write    : %u ms\n", stat.max_write_ms);
+        rt_kprintf("triggers     : %u\n", stat.triggers);
+    }
+    else
+    {
+        canlog_usage();
+        return 0;
+    }
+
+    if (ret != RT_EOK)
+    {
+        rt_kprintf("canlog %s failed: %d\n", argv[1], ret);
+    }
+
+    return ret;
+}
+MSH_CMD_EXPORT(canlog, CAN bus trace recorder);
+#endif /* RT_USING_FINSH */
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2025-12-08     RT-Thread    first version
+ */
+
+#ifndef __CANLOG_H__
+#define __CANLOG_H__
+
+#include <rtthread.h>
+#include <rtdevice.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * On-flash format
+ *
+ * The log is a sequence of CANLOG_BLOCK_SIZE blocks. Every block starts with
+ * a struct canlog_block_hdr followed by up to CANLOG_BLOCK_RECORDS fixed-size
+ * records. Unused record slots at the end of a block are left erased.
+ *
+ * Record timestamps only keep the low 26 bits of the microsecond clock
+ * (~67 s). The absolute time of a record is rebuilt from the previous one,
+ * starting with the block base time, as a signed 26-bit step:
+ *     d = (stamp - prev) & CANLOG_STAMP_MASK
+ *     t = prev + (d < CANLOG_STAMP_HALF ? d : d - CANLOG_STAMP_MASK - 1)
+ * A block is closed early whenever two consecutive records are
+ * CANLOG_STAMP_HALF microseconds or more apart, so this is unambiguous and
+ * tolerates the small reordering between nested RX and TX interrupts.
+ */
+#define CANLOG_BLOCK_MAGIC          0x474F4C43  /* "CLOG" */
+#define CANLOG_BLOCK_VERSION        1
+#define CANLOG_BLOCK_SIZE           4096
+#define CANLOG_BLOCK_RECORDS        ((CANLOG_BLOCK_SIZE - sizeof(struct canlog_block_hdr)) / sizeof(struct canlog_record))
+
+#define CANLOG_STAMP_MASK           0x03FFFFFF
+#define CANLOG_STAMP_HALF           0x02000000
+
+/* canlog_record.stamp */
+#define CANLOG_STAMP_US(s)          ((s) & CANLOG_STAMP_MASK)
+#define CANLOG_STAMP_DLC(s)         (((s) >> 26) & 0x0F)
+#define CANLOG_STAMP_BUS(s)         (((s) >> 30) & 0x01)
+#define CANLOG_STAMP_TX             (1UL << 31)
+
+/* canlog_record.ident */
+#define CANLOG_IDENT_ID(i)          ((i) & 0x1FFFFFFF)
+#define CANLOG_IDENT_EXT            (1UL << 29)
+#define CANLOG_IDENT_RTR            (1UL << 30)
+#define CANLOG_IDENT_TRIGGER        (1UL << 31)
+
+/* canlog_block_hdr.flags */
+#define CANLOG_BLK_TRIGGER          0x0001      /* block holds the trigger record */
+#define CANLOG_BLK_PRETRIGGER       0x0002      /* block holds pre-trigger history */
+#define CANLOG_BLK_PARTIAL          0x0004      /* block was flushed before it was full */
+
+struct canlog_record
+{
+    rt_uint32_t stamp;          /* [25:0] us, [29:26] dlc, [30] bus, [31] tx */
+    rt_uint32_t ident;          /* [28:0] id, [29] ext, [30] rtr, [31] trigger */
+    rt_uint8_t data[8];
+};
+
+struct canlog_block_hdr
+{
+    rt_uint32_t magic;
+    rt_uint16_t version;
+    rt_uint16_t count;          /* valid records in this block */
+    rt_uint32_t seq;            /* block sequence number, monotonic */
+    rt_uint32_t dropped;        /* frames lost so far, cumulative */
+    rt_uint64_t base_us;        /* absolute time of the first record */
+    rt_uint32_t flags;
+    rt_uint32_t crc;            /* crc32 of the header (crc = 0) and the records */
+};
+
+/* recording mode */
+#define CANLOG_MODE_CONTINUOUS      0
+#define CANLOG_MODE_TRIGGERED       1
+
+/* trigger sources */
+#define CANLOG_TRIG_ID              0x01
+#define CANLOG_TRIG_DTC             0x02
+#define CANLOG_TRIG_UDS             0x04
+#define CANLOG_TRIG_USER            0x08
+
+struct canlog_stat
+{
+    rt_uint32_t captured;       /* frames taken from the ring */
+    rt_uint32_t dropped;        /* frames lost because the ring was full */
+    rt_uint32_t ring_peak;      /* highest ring fill level seen */
+    rt_uint32_t blocks;         /* blocks written to the backend */
+    rt_uint32_t write_errors;
+    rt_uint32_t triggers;
+    rt_uint32_t max_write_ms;   /* slowest block write, erase included */
+};
+
+rt_err_t canlog_attach(const char *can_name);
+rt_err_t canlog_detach(const char *can_name);
+
+rt_err_t canlog_start(rt_uint8_t mode);
+rt_err_t canlog_stop(void);
+rt_err_t canlog_flush(void);
+
+rt_err_t canlog_trigger(rt_uint32_t source);
+rt_err_t canlog_set_id_trigger(rt_uint8_t index, rt_uint32_t id, rt_uint32_t mask, rt_bool_t ext);
+void canlog_clear_id_trigger(rt_uint8_t index);
+
+void canlog_get_stat(struct canlog_stat *stat);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CANLOG_H__ */
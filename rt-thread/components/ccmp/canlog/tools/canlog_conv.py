@@ -0,0 +1,126 @@
+#!/usr/bin/env python3
+# Convert canlog binary dumps (FAL partition image or clgNNNNN.bin files)
+# into candump log or Vector ASC text.
+#
+# python canlog_conv.py clg00001.bin clg00002.bin -f asc -o trace.asc
+# python canlog_conv.py canlog_part.bin -f candump --epoch 1700000000.0
+
+import argparse
+import datetime
+import struct
+import sys
+import zlib
+
+BLOCK_SIZE = 4096
+BLOCK_MAGIC = 0x474F4C43
+HDR_FMT = '<IHHIIQII'
+HDR_SIZE = struct.calcsize(HDR_FMT)
+REC_FMT = '<II8s'
+REC_SIZE = struct.calcsize(REC_FMT)
+
+STAMP_MASK = 0x03FFFFFF
+STAMP_HALF = 0x02000000
+
+def read_blocks(paths):
+    blocks = []
+    for path in paths:
+        with open(path, 'rb') as f:
+            data = f.read()
+        for off in range(0, len(data) - BLOCK_SIZE + 1, BLOCK_SIZE):
+            raw = data[off:off + BLOCK_SIZE]
+            magic, version, count, seq, dropped, base_us, flags, crc = struct.unpack_from(HDR_FMT, raw)
+            if magic != BLOCK_MAGIC or count == 0 or count > (BLOCK_SIZE - HDR_SIZE) // REC_SIZE:
+                continue
+            body = raw[:HDR_SIZE - 4] + b'\0\0\0\0' + raw[HDR_SIZE:HDR_SIZE + count * REC_SIZE]
+            if zlib.crc32(body) & 0xFFFFFFFF != crc:
+                sys.stderr.write('%s: block at 0x%x seq %d: bad crc, skipped\n' % (path, off, seq))
+                continue
+            blocks.append((seq, dropped, base_us, flags, raw[HDR_SIZE:HDR_SIZE + count * REC_SIZE]))
+    # a FAL partition is circular: order by sequence number
+    blocks.sort(key=lambda b: b[0])
+    return blocks
+
+
+def frames(blocks):
+    last_dropped = 0
+    for seq, dropped, base_us, flags, body in blocks:
+        if dropped != last_dropped:
+            sys.stderr.write('block seq %d: %d frames dropped before it\n' % (seq, dropped - last_dropped))
+            last_dropped = dropped
+        prev = base_us
+        for off in range(0, len(body), REC_SIZE):
+            stamp, ident, data = struct.unpack_from(REC_FMT, body, off)
+            step = (stamp - prev) & STAMP_MASK
+            if step >= STAMP_HALF:
+                step -= STAMP_MASK + 1
+            prev += step
+            if ident & (1 << 31):
+                sys.stderr.write('trigger at %.6f s (block seq %d)\n' % (prev / 1e6, seq))
+            yield {
+                'us': prev,
+                'bus': (stamp >> 30) & 1,
+                'tx': bool(stamp >> 31),
+                'dlc': (stamp >> 26) & 0x0F,
+                'id': ident & 0x1FFFFFFF,
+                'ext': bool(ident & (1 << 29)),
+                'rtr': bool(ident & (1 << 30)),
+                'data': data,
+            }
+
+
+def write_candump(out, items, epoch):
+    for fr in items:
+        t = epoch + fr['us'] / 1e6
+        ident = ('%08X' if fr['ext'] else '%03X') % fr['id']
+        if fr['rtr']:
+            payload = 'R'
+        else:
+            payload = fr['data'][:min(fr['dlc'], 8)].hex().upper()
+        out.write('(%.6f) can%d %s#%s\n' % (t, fr['bus'], ident, payload))
+
+
+def write_asc(out, items, epoch):
+    items = list(items)
+    start = items[0]['us'] if items else 0
+    date = datetime.datetime.fromtimestamp(epoch + start / 1e6)
+    stamp = '%s.%03d%s' % (date.strftime('%a %b %d %I:%M:%S'), date.microsecond // 1000,
+                           date.strftime(' %p %Y').lower())
+    out.write('date %s\n' % stamp)
+    out.write('base hex  timestamps absolute\n')
+    out.write('internal events logged\n')
+    out.write('Begin Triggerblock %s\n' % stamp)
+    out.write('   0.000000 Start of measurement\n')
+    for fr in items:
+        t = (fr['us'] - start) / 1e6
+        ident = ('%Xx' if fr['ext'] else '%X') % fr['id']
+        direction = 'Tx' if fr['tx'] else 'Rx'
+        if fr['rtr']:
+            out.write('%11.6f %d  %-15s %s   r %X\n' % (t, fr['bus'] + 1, ident, direction, fr['dlc']))
+        else:
+            n = min(fr['dlc'], 8)
+            data = ' '.join('%02X' % b for b in fr['data'][:n])
+            out.write('%11.6f %d  %-15s %s   d %X %s\n' % (t, fr['bus'] + 1, ident, direction, fr['dlc'], data))
+    out.write('End TriggerBlock\n')
+
+
+def main():
+    parser = argparse.ArgumentParser(description='convert canlog binary dumps')
+    parser.add_argument('files', nargs='+', help='partition image or clgNNNNN.bin files')
+    parser.add_argument('-f', '--format', choices=['candump', 'asc'], default='candump')
+    parser.add_argument('-o', '--output', help='output file, default stdout')
+    parser.add_argument('--epoch', type=float, default=0.0,
+                        help='wall clock time (s) of the logger time base, i.e. of boot')
+    args = parser.parse_args()
+
+    items = frames(read_blocks(args.files))
+    out = open(args.output, 'w') if args.output else sys.stdout
+    if args.format == 'asc':
+        write_asc(out, items, args.epoch)
+    else:
+        write_candump(out, items, args.epoch)
+    if args.output:
+        out.close()
+
+
+if __name__ == '__main__':
+    main()
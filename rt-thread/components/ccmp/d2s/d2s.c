@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2025-12-18     RT-Thread    first version
+ */
+
+#include <string.h>
+#include "d2s.h"
+
+/* next frame bit towards the LSB of a Motorola signal */
+static uint16_t d2s_motorola_next(uint16_t pos)
+{
+    return (pos % 8 == 0) ? pos + 15 : pos - 1;
+}
+
+const struct d2s_message *d2s_message_find(const struct d2s_db *db, uint32_t id, uint8_t ide)
+{
+    const struct d2s_message *msg;
+    size_t lo = 0, hi = db->message_num;
+    uint64_t key = ((uint64_t)ide << 32) | id, cur;
+
+    while (lo < hi)
+    {
+        msg = &db->messages[lo + (hi - lo) / 2];
+        cur = ((uint64_t)msg->ide << 32) | msg->id;
+        if (cur == key)
+        {
+            return msg;
+        }
+        if (cur < key)
+        {
+            lo = lo + (hi - lo) / 2 + 1;
+        }
+        else
+        {
+            hi = lo + (hi - lo) / 2;
+        }
+    }
+
+    return NULL;
+}
+
+const struct d2s_signal *d2s_signal_find(const struct d2s_message *msg, const char *name)
+{
+    uint16_t i;
+
+    for (i = 0; i < msg->signal_num; i++)
+    {
+        if (strcmp(msg->signals[i].name, name) == 0)
+        {
+            return &msg->signals[i];
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Read the raw value of a signal, one bit at a time.
+ *
+ * Signed signals are returned sign extended to 64 bits.
+ */
+uint64_t d2s_raw_get(const uint8_t *data, const struct d2s_signal *sig)
+{
+    uint64_t raw = 0;
+    uint16_t pos = sig->start;
+    uint8_t i;
+
+    if (sig->flags & D2S_SIG_MOTOROLA)
+    {
+        /* MSB first */
+        for (i = 0; i < sig->length; i++)
+        {
+            raw = (raw << 1) | ((data[pos / 8] >> (pos % 8)) & 1);
+            pos = d2s_motorola_next(pos);
+        }
+    }
+    else
+    {
+        for (i = 0; i < sig->length; i++, pos++)
+        {
+            raw |= (uint64_t)((data[pos / 8] >> (pos % 8)) & 1) << i;
+        }
+    }
+
+    if ((sig->flags & D2S_SIG_SIGNED) && sig->length < 64 && (raw >> (sig->length - 1)) & 1)
+    {
+        raw |= ~0ULL << sig->length;
+    }
+
+    return raw;
+}
+
+void d2s_raw_set(uint8_t *data, const struct d2s_signal *sig, uint64_t raw)
+{
+    uint16_t pos = sig->start;
+    uint8_t i, bit;
+
+    for (i = 0; i < sig->length; i++)
+    {
+        if (sig->flags & D2S_SIG_MOTOROLA)
+        {
+            bit = (raw >> (sig->length - 1 - i)) & 1;
+        }
+        else
+        {
+            bit = (raw >> i) & 1;
+        }
+        data[pos / 8] = (uint8_t)((data[pos / 8] & ~(1U << (pos % 8))) | (bit << (pos % 8)));
+        pos = (sig->flags & D2S_SIG_MOTOROLA) ? d2s_motorola_next(pos) : pos + 1;
+    }
+}
+
+double d2s_phys_get(const uint8_t *data, const struct d2s_signal *sig)
+{
+    uint64_t raw = d2s_raw_get(data, sig);
+
+    if (sig->flags & D2S_SIG_SIGNED)
+    {
+        return (double)(int64_t)raw * sig->factor + sig->offset;
+    }
+
+    return (double)raw * sig->factor + sig->offset;
+}
+
+void d2s_phys_set(uint8_t *data, const struct d2s_signal *sig, double value)
+{
+    d2s_raw_set(data, sig, (uint64_t)d2s_round((value - sig->offset) / sig->factor));
+}
+
+/**
+ * @brief Check whether a signal is carried by a frame.
+ *
+ * Multiplexed signals are only present when the multiplexor holds their
+ * mux_value, all others always are.
+ */
+int d2s_signal_present(const uint8_t *data, const struct d2s_message *msg, const struct d2s_signal *sig)
+{
+    uint16_t i;
+
+    if (!(sig->flags & D2S_SIG_MUXED))
+    {
+        return 1;
+    }
+    for (i = 0; i < msg->signal_num; i++)
+    {
+        if (msg->signals[i].flags & D2S_SIG_MUX)
+        {
+            return d2s_raw_get(data, &msg->signals[i]) == sig->mux_value;
+        }
+    }
+
+    return 0;
+}
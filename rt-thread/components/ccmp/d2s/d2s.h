@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2025-12-18     RT-Thread    first version
+ */
+
+#ifndef __D2S_H__
+#define __D2S_H__
+
+/*
+ * d2s runtime.
+ *
+ * Generated <db>.h files only need the rounding helpers below, everything
+ * else in them is resolved by tools/d2s.py. The table-driven functions
+ * decode any signal from its description at runtime; they are meant for
+ * tooling (msh, gateways, logging) where flexibility beats speed.
+ *
+ * This header is plain C99 so generated code also builds on the host.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* d2s_signal.flags */
+#define D2S_SIG_INTEL       0x00
+#define D2S_SIG_MOTOROLA    0x01
+#define D2S_SIG_SIGNED      0x02
+#define D2S_SIG_MUX         0x04    /* multiplexor */
+#define D2S_SIG_MUXED       0x08    /* only present when the multiplexor equals mux_value */
+
+struct d2s_signal
+{
+    const char *name;
+    uint16_t start;                 /* DBC start bit */
+    uint8_t length;
+    uint8_t flags;
+    uint16_t mux_value;
+    double factor;
+    double offset;
+    const char *unit;
+};
+
+struct d2s_message
+{
+    uint32_t id;
+    uint8_t ide;
+    uint8_t dlc;
+    uint16_t signal_num;
+    const char *name;
+    const struct d2s_signal *signals;
+};
+
+struct d2s_db
+{
+    const char *name;
+    const struct d2s_message *messages; /* sorted by (ide, id) */
+    size_t message_num;
+};
+
+static inline int32_t d2s_roundf(float x)
+{
+    return (int32_t)(x >= 0.0f ? x + 0.5f : x - 0.5f);
+}
+
+static inline int64_t d2s_round(double x)
+{
+    return (int64_t)(x >= 0.0 ? x + 0.5 : x - 0.5);
+}
+
+const struct d2s_message *d2s_message_find(const struct d2s_db *db, uint32_t id, uint8_t ide);
+const struct d2s_signal *d2s_signal_find(const struct d2s_message *msg, const char *name);
+
+uint64_t d2s_raw_get(const uint8_t *data, const struct d2s_signal *sig);
+void d2s_raw_set(uint8_t *data, const struct d2s_signal *sig, uint64_t raw);
+double d2s_phys_get(const uint8_t *data, const struct d2s_signal *sig);
+void d2s_phys_set(uint8_t *data, const struct d2s_signal *sig, double value);
+int d2s_signal_present(const uint8_t *data, const struct d2s_message *msg, const struct d2s_signal *sig);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __D2S_H__ */
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2025-12-18     RT-Thread    first version
+ */
+
+#include <rtthread.h>
+#include <stdlib.h>
+#include "d2s_apl.h"
+
+#ifdef CCMP_USING_EXAMPLE_D2S
+
+/* rt_kprintf has no %f, print physical values with three decimals */
+static void d2s_example_print(const char *name, double value, const char *unit)
+{
+    long milli = (long)d2s_round(value * 1000.0);
+    const char *sign = milli < 0 ? "-" : "";
+
+    milli = milli < 0 ? -milli : milli;
+    rt_kprintf("  %-12s %s%ld.%03ld %s\n", name, sign, milli / 1000, milli % 1000, unit);
+}
+
+/* generated pack/unpack of a known message */
+static void d2s_example_pack(void)
+{
+    struct apl_vcu_cmd cmd = { 0 };
+    union apl_frame frame;
+    struct rt_can_msg msg = { 0 };
+    int i;
+
+    cmd.TorqueReq = -125.5f;
+    cmd.SpeedLimit = 6000;
+    cmd.Gear = APL_VCU_CMD_GEAR_DRIVE;
+    cmd.Enable = 1;
+    cmd.AccelPedal = 42.0f;
+    cmd.KeyOn = 1;
+    cmd.Counter = 7;
+
+    msg.id = APL_VCU_CMD_ID;
+    msg.ide = APL_VCU_CMD_IDE;
+    msg.len = APL_VCU_CMD_DLC;
+    apl_vcu_cmd_pack(msg.data, &cmd);
+
+    rt_kprintf("VcuCmd %03x:", msg.id);
+    for (i = 0; i < msg.len; i++)
+    {
+        rt_kprintf(" %02x", msg.data[i]);
+    }
+    rt_kprintf("\n");
+
+    if (d2s_apl_decode(&msg, &frame) < 0)
+    {
+        rt_kprintf("decode failed\n");
+        return;
+    }
+    d2s_example_print("TorqueReq", frame.vcu_cmd.TorqueReq, "Nm");
+    d2s_example_print("SpeedLimit", frame.vcu_cmd.SpeedLimit, "rpm");
+    d2s_example_print("Gear", frame.vcu_cmd.Gear, "");
+    d2s_example_print("AccelPedal", frame.vcu_cmd.AccelPedal, "%");
+}
+
+/* table-driven decode of any frame of the database */
+static void d2s_example_decode(rt_uint32_t id, rt_uint8_t ide, const rt_uint8_t *data)
+{
+    const struct d2s_message *msg;
+    const struct d2s_signal *sig;
+    rt_uint16_t i;
+
+    msg = d2s_message_find(&apl_db, id, ide);
+    if (msg == RT_NULL)
+    {
+        rt_kprintf("id %x not in %s\n", id, apl_db.name);
+        return;
+    }
+
+    rt_kprintf("%s:\n", msg->name);
+    for (i = 0; i < msg->signal_num; i++)
+    {
+        sig = &msg->signals[i];
+        if (d2s_signal_present(data, msg, sig))
+        {
+            d2s_example_print(sig->name, d2s_phys_get(data, sig), sig->unit);
+        }
+    }
+}
+
+static int d2s_example(int argc, char **argv)
+{
+    rt_uint8_t data[8] = { 0 };
+    rt_uint32_t id;
+    int i;
+
+    if (argc < 2)
+    {
+        d2s_example_pack();
+        return 0;
+    }
+
+    id = strtoul(argv[1], RT_NULL, 16);
+    for (i = 0; i < 8 && i + 2 < argc; i++)
+    {
+        data[i] = (rt_uint8_t)strtoul(argv[i + 2], RT_NULL, 16);
+    }
+    d2s_example_decode(id & 0x1FFFFFFF, id > 0x7FF ? RT_CAN_EXTID : RT_CAN_STDID, data);
+
+    return 0;
+}
+MSH_CMD_EXPORT(d2s_example, d2s demo: no args packs VcuCmd or <id> <bytes...> decodes a frame);
+
+#endif /* CCMP_USING_EXAMPLE_D2S */
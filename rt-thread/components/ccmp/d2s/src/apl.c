@@ -0,0 +1,80 @@
+/* Generated by d2s from apl.dbc, do not edit. */
+
+#include "apl.h"
+
+static const struct d2s_signal apl_vcu_cmd_signals[] =
+{
+    { "TorqueReq", 0, 16, D2S_SIG_INTEL | D2S_SIG_SIGNED, 0, 0.1, 0.0, "Nm" },
+    { "SpeedLimit", 16, 12, D2S_SIG_INTEL, 0, 4.0, 0.0, "rpm" },
+    { "Gear", 28, 3, D2S_SIG_INTEL, 0, 1.0, 0.0, "" },
+    { "Enable", 31, 1, D2S_SIG_INTEL, 0, 1.0, 0.0, "" },
+    { "AccelPedal", 32, 8, D2S_SIG_INTEL, 0, 0.4, 0.0, "%" },
+    { "BrakeSwitch", 40, 1, D2S_SIG_INTEL, 0, 1.0, 0.0, "" },
+    { "KeyOn", 41, 1, D2S_SIG_INTEL, 0, 1.0, 0.0, "" },
+    { "Counter", 52, 4, D2S_SIG_INTEL, 0, 1.0, 0.0, "" },
+    { "Checksum", 56, 8, D2S_SIG_INTEL, 0, 1.0, 0.0, "" },
+};
+
+static const struct d2s_signal apl_apl_status_signals[] =
+{
+    { "MotorSpeed", 7, 16, D2S_SIG_MOTOROLA | D2S_SIG_SIGNED, 0, 1.0, 0.0, "rpm" },
+    { "DcVoltage", 23, 12, D2S_SIG_MOTOROLA, 0, 0.25, 0.0, "V" },
+    { "DcCurrent", 27, 12, D2S_SIG_MOTOROLA | D2S_SIG_SIGNED, 0, 0.5, 0.0, "A" },
+    { "MotorTemp", 47, 8, D2S_SIG_MOTOROLA, 0, 1.0, -40.0, "degC" },
+    { "State", 55, 4, D2S_SIG_MOTOROLA, 0, 1.0, 0.0, "" },
+    { "Fault", 51, 1, D2S_SIG_MOTOROLA, 0, 1.0, 0.0, "" },
+    { "Derating", 50, 1, D2S_SIG_MOTOROLA, 0, 1.0, 0.0, "" },
+    { "Counter", 63, 4, D2S_SIG_MOTOROLA, 0, 1.0, 0.0, "" },
+};
+
+static const struct d2s_signal apl_apl_time_signals[] =
+{
+    { "UptimeMs", 0, 40, D2S_SIG_INTEL, 0, 1.0, 0.0, "ms" },
+    { "Boots", 40, 20, D2S_SIG_INTEL, 0, 1.0, 0.0, "" },
+    { "Rtc", 63, 3, D2S_SIG_MOTOROLA, 0, 1.0, 0.0, "" },
+};
+
+static const struct d2s_signal apl_apl_temp_signals[] =
+{
+    { "Inlet", 0, 12, D2S_SIG_INTEL | D2S_SIG_SIGNED, 0, 0.0625, 0.0, "degC" },
+    { "Outlet", 23, 12, D2S_SIG_MOTOROLA | D2S_SIG_SIGNED, 0, 0.0625, 0.0, "degC" },
+    { "FanDuty", 32, 7, D2S_SIG_INTEL, 0, 1.0, 0.0, "%" },
+    { "Pump", 39, 1, D2S_SIG_INTEL, 0, 1.0, 0.0, "" },
+};
+
+static const struct d2s_signal apl_bms_pack_signals[] =
+{
+    { "PackVoltage", 0, 16, D2S_SIG_INTEL, 0, 0.01, 0.0, "V" },
+    { "PackCurrent", 16, 16, D2S_SIG_INTEL | D2S_SIG_SIGNED, 0, 0.05, -100.0, "A" },
+    { "Soc", 32, 10, D2S_SIG_INTEL, 0, 0.1, 0.0, "%" },
+    { "CellTempMax", 42, 8, D2S_SIG_INTEL, 0, 1.0, -50.0, "degC" },
+    { "Energy", 50, 14, D2S_SIG_INTEL, 0, 0.001, 0.0, "kWh" },
+};
+
+static const struct d2s_signal apl_bms_cell_signals[] =
+{
+    { "Page", 0, 4, D2S_SIG_INTEL | D2S_SIG_MUX, 0, 1.0, 0.0, "" },
+    { "CellMin", 8, 16, D2S_SIG_INTEL | D2S_SIG_MUXED, 0, 0.001, 0.0, "V" },
+    { "CellMax", 24, 16, D2S_SIG_INTEL | D2S_SIG_MUXED, 0, 0.001, 0.0, "V" },
+    { "CellMinIdx", 40, 8, D2S_SIG_INTEL | D2S_SIG_MUXED, 0, 1.0, 0.0, "" },
+    { "CellMaxIdx", 48, 8, D2S_SIG_INTEL | D2S_SIG_MUXED, 0, 1.0, 0.0, "" },
+    { "TempMin", 15, 8, D2S_SIG_MOTOROLA | D2S_SIG_SIGNED | D2S_SIG_MUXED, 1, 1.0, 0.0, "degC" },
+    { "TempMax", 23, 8, D2S_SIG_MOTOROLA | D2S_SIG_SIGNED | D2S_SIG_MUXED, 1, 1.0, 0.0, "degC" },
+    { "Insulation", 31, 24, D2S_SIG_MOTOROLA | D2S_SIG_MUXED, 1, 1.0, 0.0, "Ohm" },
+    { "Balancing", 8, 48, D2S_SIG_INTEL | D2S_SIG_MUXED, 2, 1.0, 0.0, "" },
+};
+
+static const struct d2s_message apl_messages[] =
+{
+    { 0x100U, 0, 8, 9, "VcuCmd", apl_vcu_cmd_signals },
+    { 0x120U, 0, 8, 8, "AplStatus", apl_apl_status_signals },
+    { 0x400U, 0, 8, 3, "AplTime", apl_apl_time_signals },
+    { 0x500U, 0, 5, 4, "AplTemp", apl_apl_temp_signals },
+    { 0xCFFFF04U, 1, 8, 5, "BmsPack", apl_bms_pack_signals },
+    { 0xD000005U, 1, 8, 9, "BmsCell", apl_bms_cell_signals },
+};
+
+const struct d2s_db apl_db =
+{
+    "apl", apl_messages, sizeof(apl_messages) / sizeof(apl_messages[0])
+};
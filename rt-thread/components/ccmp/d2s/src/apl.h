@@ -0,0 +1,382 @@
+/* Generated by d2s from apl.dbc, do not edit. */
+
+#ifndef __APL_H__
+#define __APL_H__
+
+#include "d2s.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* VcuCmd, sent by VCU */
+#define APL_VCU_CMD_ID 0x100U
+#define APL_VCU_CMD_IDE 0
+#define APL_VCU_CMD_DLC 8
+#define APL_VCU_CMD_GEAR_PARK 0
+#define APL_VCU_CMD_GEAR_REVERSE 1
+#define APL_VCU_CMD_GEAR_NEUTRAL 2
+#define APL_VCU_CMD_GEAR_DRIVE 3
+
+struct apl_vcu_cmd
+{
+    float     TorqueReq;    /* [Nm] */
+    int32_t   SpeedLimit;    /* [rpm] */
+    uint8_t   Gear;
+    uint8_t   Enable;
+    float     AccelPedal;    /* [%] */
+    uint8_t   BrakeSwitch;
+    uint8_t   KeyOn;
+    uint8_t   Counter;
+    uint8_t   Checksum;
+};
+
+static inline void apl_vcu_cmd_unpack(struct apl_vcu_cmd *m, const uint8_t *d)
+{
+    const uint8_t b0 = d[0];
+    const uint8_t b1 = d[1];
+    const uint8_t b2 = d[2];
+    const uint8_t b3 = d[3];
+    const uint8_t b4 = d[4];
+    const uint8_t b5 = d[5];
+    const uint8_t b6 = d[6];
+    const uint8_t b7 = d[7];
+    m->TorqueReq = (float)(int32_t)(((uint32_t)((uint16_t)b0 | ((uint16_t)b1 << 8)) ^ 0x8000U) - 0x8000U) * 0.1f;
+    m->SpeedLimit = (int32_t)((int32_t)((uint16_t)b2 | ((uint16_t)(b3 & 0xFU) << 8)) * 4);
+    m->Gear = ((b3 >> 4) & 0x7U);
+    m->Enable = (b3 >> 7);
+    m->AccelPedal = (float)b4 * 0.4f;
+    m->BrakeSwitch = (b5 & 0x1U);
+    m->KeyOn = ((b5 >> 1) & 0x1U);
+    m->Counter = (b6 >> 4);
+    m->Checksum = b7;
+}
+
+static inline void apl_vcu_cmd_pack(uint8_t *d, const struct apl_vcu_cmd *m)
+{
+    const uint16_t r_TorqueReq = (uint16_t)d2s_roundf(m->TorqueReq * 10.0f);
+    const uint16_t r_SpeedLimit = (uint16_t)(m->SpeedLimit / 4);
+    const uint8_t r_Gear = m->Gear;
+    const uint8_t r_Enable = m->Enable;
+    const uint8_t r_AccelPedal = (uint8_t)d2s_roundf(m->AccelPedal * 2.5f);
+    const uint8_t r_BrakeSwitch = m->BrakeSwitch;
+    const uint8_t r_KeyOn = m->KeyOn;
+    const uint8_t r_Counter = m->Counter;
+    const uint8_t r_Checksum = m->Checksum;
+    d[0] = (uint8_t)r_TorqueReq;
+    d[1] = (uint8_t)(r_TorqueReq >> 8);
+    d[2] = (uint8_t)r_SpeedLimit;
+    d[3] = (uint8_t)(((r_SpeedLimit >> 8) & 0xFU) | ((r_Gear & 0x7U) << 4) | ((r_Enable & 0x1U) << 7));
+    d[4] = (uint8_t)r_AccelPedal;
+    d[5] = (uint8_t)((r_BrakeSwitch & 0x1U) | ((r_KeyOn & 0x1U) << 1));
+    d[6] = (uint8_t)((r_Counter & 0xFU) << 4);
+    d[7] = (uint8_t)r_Checksum;
+}
+
+/* AplStatus, sent by APL */
+#define APL_APL_STATUS_ID 0x120U
+#define APL_APL_STATUS_IDE 0
+#define APL_APL_STATUS_DLC 8
+#define APL_APL_STATUS_STATE_INIT 0
+#define APL_APL_STATUS_STATE_STANDBY 1
+#define APL_APL_STATUS_STATE_RUN 2
+#define APL_APL_STATUS_STATE_FAULT 3
+
+struct apl_apl_status
+{
+    int16_t   MotorSpeed;    /* [rpm] */
+    float     DcVoltage;    /* [V] */
+    float     DcCurrent;    /* [A] */
+    int32_t   MotorTemp;    /* [degC] */
+    uint8_t   State;
+    uint8_t   Fault;
+    uint8_t   Derating;
+    uint8_t   Counter;
+};
+
+static inline void apl_apl_status_unpack(struct apl_apl_status *m, const uint8_t *d)
+{
+    const uint8_t b0 = d[0];
+    const uint8_t b1 = d[1];
+    const uint8_t b2 = d[2];
+    const uint8_t b3 = d[3];
+    const uint8_t b4 = d[4];
+    const uint8_t b5 = d[5];
+    const uint8_t b6 = d[6];
+    const uint8_t b7 = d[7];
+    m->MotorSpeed = (int16_t)(int32_t)(((uint32_t)((uint16_t)b1 | ((uint16_t)b0 << 8)) ^ 0x8000U) - 0x8000U);
+    m->DcVoltage = (float)((uint16_t)(b3 >> 4) | ((uint16_t)b2 << 4)) * 0.25f;
+    m->DcCurrent = (float)(int32_t)(((uint32_t)((uint16_t)b4 | ((uint16_t)(b3 & 0xFU) << 8)) ^ 0x800U) - 0x800U) * 0.5f;
+    m->MotorTemp = (int32_t)((int32_t)b5 - 40);
+    m->State = (b6 >> 4);
+    m->Fault = ((b6 >> 3) & 0x1U);
+    m->Derating = ((b6 >> 2) & 0x1U);
+    m->Counter = (b7 >> 4);
+}
+
+static inline void apl_apl_status_pack(uint8_t *d, const struct apl_apl_status *m)
+{
+    const uint16_t r_MotorSpeed = (uint16_t)m->MotorSpeed;
+    const uint16_t r_DcVoltage = (uint16_t)d2s_roundf(m->DcVoltage * 4.0f);
+    const uint16_t r_DcCurrent = (uint16_t)d2s_roundf(m->DcCurrent * 2.0f);
+    const uint8_t r_MotorTemp = (uint8_t)(m->MotorTemp + 40);
+    const uint8_t r_State = m->State;
+    const uint8_t r_Fault = m->Fault;
+    const uint8_t r_Derating = m->Derating;
+    const uint8_t r_Counter = m->Counter;
+    d[0] = (uint8_t)(r_MotorSpeed >> 8);
+    d[1] = (uint8_t)r_MotorSpeed;
+    d[2] = (uint8_t)(r_DcVoltage >> 4);
+    d[3] = (uint8_t)(((r_DcVoltage & 0xFU) << 4) | ((r_DcCurrent >> 8) & 0xFU));
+    d[4] = (uint8_t)r_DcCurrent;
+    d[5] = (uint8_t)r_MotorTemp;
+    d[6] = (uint8_t)(((r_State & 0xFU) << 4) | ((r_Fault & 0x1U) << 3) | ((r_Derating & 0x1U) << 2));
+    d[7] = (uint8_t)((r_Counter & 0xFU) << 4);
+}
+
+/* AplTime, sent by APL */
+#define APL_APL_TIME_ID 0x400U
+#define APL_APL_TIME_IDE 0
+#define APL_APL_TIME_DLC 8
+
+struct apl_apl_time
+{
+    uint64_t  UptimeMs;    /* [ms] */
+    uint32_t  Boots;
+    uint8_t   Rtc;
+};
+
+static inline void apl_apl_time_unpack(struct apl_apl_time *m, const uint8_t *d)
+{
+    const uint8_t b0 = d[0];
+    const uint8_t b1 = d[1];
+    const uint8_t b2 = d[2];
+    const uint8_t b3 = d[3];
+    const uint8_t b4 = d[4];
+    const uint8_t b5 = d[5];
+    const uint8_t b6 = d[6];
+    const uint8_t b7 = d[7];
+    m->UptimeMs = ((uint64_t)b0 | ((uint64_t)b1 << 8) | ((uint64_t)b2 << 16) | ((uint64_t)b3 << 24) | ((uint64_t)b4 << 32));
+    m->Boots = ((uint32_t)b5 | ((uint32_t)b6 << 8) | ((uint32_t)(b7 & 0xFU) << 16));
+    m->Rtc = (b7 >> 5);
+}
+
+static inline void apl_apl_time_pack(uint8_t *d, const struct apl_apl_time *m)
+{
+    const uint64_t r_UptimeMs = m->UptimeMs;
+    const uint32_t r_Boots = m->Boots;
+    const uint8_t r_Rtc = m->Rtc;
+    d[0] = (uint8_t)r_UptimeMs;
+    d[1] = (uint8_t)(r_UptimeMs >> 8);
+    d[2] = (uint8_t)(r_UptimeMs >> 16);
+    d[3] = (uint8_t)(r_UptimeMs >> 24);
+    d[4] = (uint8_t)(r_UptimeMs >> 32);
+    d[5] = (uint8_t)r_Boots;
+    d[6] = (uint8_t)(r_Boots >> 8);
+    d[7] = (uint8_t)(((r_Boots >> 16) & 0xFU) | ((r_Rtc & 0x7U) << 5));
+}
+
+/* AplTemp, sent by APL */
+#define APL_APL_TEMP_ID 0x500U
+#define APL_APL_TEMP_IDE 0
+#define APL_APL_TEMP_DLC 5
+
+struct apl_apl_temp
+{
+    float     Inlet;    /* [degC] */
+    float     Outlet;    /* [degC] */
+    uint8_t   FanDuty;    /* [%] */
+    uint8_t   Pump;
+};
+
+static inline void apl_apl_temp_unpack(struct apl_apl_temp *m, const uint8_t *d)
+{
+    const uint8_t b0 = d[0];
+    const uint8_t b1 = d[1];
+    const uint8_t b2 = d[2];
+    const uint8_t b3 = d[3];
+    const uint8_t b4 = d[4];
+    m->Inlet = (float)(int32_t)(((uint32_t)((uint16_t)b0 | ((uint16_t)(b1 & 0xFU) << 8)) ^ 0x800U) - 0x800U) * 0.0625f;
+    m->Outlet = (float)(int32_t)(((uint32_t)((uint16_t)(b3 >> 4) | ((uint16_t)b2 << 4)) ^ 0x800U) - 0x800U) * 0.0625f;
+    m->FanDuty = (b4 & 0x7FU);
+    m->Pump = (b4 >> 7);
+}
+
+static inline void apl_apl_temp_pack(uint8_t *d, const struct apl_apl_temp *m)
+{
+    const uint16_t r_Inlet = (uint16_t)d2s_roundf(m->Inlet * 16.0f);
+    const uint16_t r_Outlet = (uint16_t)d2s_roundf(m->Outlet * 16.0f);
+    const uint8_t r_FanDuty = m->FanDuty;
+    const uint8_t r_Pump = m->Pump;
+    d[0] = (uint8_t)r_Inlet;
+    d[1] = (uint8_t)((r_Inlet >> 8) & 0xFU);
+    d[2] = (uint8_t)(r_Outlet >> 4);
+    d[3] = (uint8_t)((r_Outlet & 0xFU) << 4);
+    d[4] = (uint8_t)((r_FanDuty & 0x7FU) | ((r_Pump & 0x1U) << 7));
+}
+
+/* BmsPack, sent by BMS */
+#define APL_BMS_PACK_ID 0xCFFFF04U
+#define APL_BMS_PACK_IDE 1
+#define APL_BMS_PACK_DLC 8
+
+struct apl_bms_pack
+{
+    float     PackVoltage;    /* [V] */
+    float     PackCurrent;    /* [A] */
+    float     Soc;    /* [%] */
+    int32_t   CellTempMax;    /* [degC] */
+    float     Energy;    /* [kWh] */
+};
+
+static inline void apl_bms_pack_unpack(struct apl_bms_pack *m, const uint8_t *d)
+{
+    const uint8_t b0 = d[0];
+    const uint8_t b1 = d[1];
+    const uint8_t b2 = d[2];
+    const uint8_t b3 = d[3];
+    const uint8_t b4 = d[4];
+    const uint8_t b5 = d[5];
+    const uint8_t b6 = d[6];
+    const uint8_t b7 = d[7];
+    m->PackVoltage = (float)((uint16_t)b0 | ((uint16_t)b1 << 8)) * 0.01f;
+    m->PackCurrent = (float)(int32_t)(((uint32_t)((uint16_t)b2 | ((uint16_t)b3 << 8)) ^ 0x8000U) - 0x8000U) * 0.05f - 100.0f;
+    m->Soc = (float)((uint16_t)b4 | ((uint16_t)(b5 & 0x3U) << 8)) * 0.1f;
+    m->CellTempMax = (int32_t)((int32_t)((b5 >> 2) | ((uint8_t)(b6 & 0x3U) << 6)) - 50);
+    m->Energy = (float)((uint16_t)(b6 >> 2) | ((uint16_t)b7 << 6)) * 0.001f;
+}
+
+static inline void apl_bms_pack_pack(uint8_t *d, const struct apl_bms_pack *m)
+{
+    const uint16_t r_PackVoltage = (uint16_t)d2s_roundf(m->PackVoltage * 100.0f);
+    const uint16_t r_PackCurrent = (uint16_t)d2s_roundf((m->PackCurrent + 100.0f) * 20.0f);
+    const uint16_t r_Soc = (uint16_t)d2s_roundf(m->Soc * 10.0f);
+    const uint8_t r_CellTempMax = (uint8_t)(m->CellTempMax + 50);
+    const uint16_t r_Energy = (uint16_t)d2s_roundf(m->Energy * 1000.0f);
+    d[0] = (uint8_t)r_PackVoltage;
+    d[1] = (uint8_t)(r_PackVoltage >> 8);
+    d[2] = (uint8_t)r_PackCurrent;
+    d[3] = (uint8_t)(r_PackCurrent >> 8);
+    d[4] = (uint8_t)r_Soc;
+    d[5] = (uint8_t)(((r_Soc >> 8) & 0x3U) | ((r_CellTempMax & 0x3FU) << 2));
+    d[6] = (uint8_t)(((r_CellTempMax >> 6) & 0x3U) | ((r_Energy & 0x3FU) << 2));
+    d[7] = (uint8_t)(r_Energy >> 6);
+}
+
+/* BmsCell, sent by BMS */
+#define APL_BMS_CELL_ID 0xD000005U
+#define APL_BMS_CELL_IDE 1
+#define APL_BMS_CELL_DLC 8
+
+struct apl_bms_cell
+{
+    uint8_t   Page;
+    float     CellMin;    /* [V] (mux 0) */
+    float     CellMax;    /* [V] (mux 0) */
+    uint8_t   CellMinIdx;    /* (mux 0) */
+    uint8_t   CellMaxIdx;    /* (mux 0) */
+    int8_t    TempMin;    /* [degC] (mux 1) */
+    int8_t    TempMax;    /* [degC] (mux 1) */
+    uint32_t  Insulation;    /* [Ohm] (mux 1) */
+    uint64_t  Balancing;    /* (mux 2) */
+};
+
+static inline void apl_bms_cell_unpack(struct apl_bms_cell *m, const uint8_t *d)
+{
+    const uint8_t b0 = d[0];
+    const uint8_t b1 = d[1];
+    const uint8_t b2 = d[2];
+    const uint8_t b3 = d[3];
+    const uint8_t b4 = d[4];
+    const uint8_t b5 = d[5];
+    const uint8_t b6 = d[6];
+    const uint8_t mux = (b0 & 0xFU);
+    m->Page = mux;
+
+    switch (mux)
+    {
+    case 0:
+        m->CellMin = (float)((uint16_t)b1 | ((uint16_t)b2 << 8)) * 0.001f;
+        m->CellMax = (float)((uint16_t)b3 | ((uint16_t)b4 << 8)) * 0.001f;
+        m->CellMinIdx = b5;
+        m->CellMaxIdx = b6;
+        break;
+    case 1:
+        m->TempMin = (int8_t)(int32_t)(((uint32_t)b1 ^ 0x80U) - 0x80U);
+        m->TempMax = (int8_t)(int32_t)(((uint32_t)b2 ^ 0x80U) - 0x80U);
+        m->Insulation = ((uint32_t)b5 | ((uint32_t)b4 << 8) | ((uint32_t)b3 << 16));
+        break;
+    case 2:
+        m->Balancing = ((uint64_t)b1 | ((uint64_t)b2 << 8) | ((uint64_t)b3 << 16) | ((uint64_t)b4 << 24) | ((uint64_t)b5 << 32) | ((uint64_t)b6 << 40));
+        break;
+    default:
+        break;
+    }
+}
+
+static inline void apl_bms_cell_pack(uint8_t *d, const struct apl_bms_cell *m)
+{
+    const uint8_t r_Page = m->Page;
+    const uint16_t r_CellMin = (uint16_t)d2s_roundf(m->CellMin * 1000.0f);
+    const uint16_t r_CellMax = (uint16_t)d2s_roundf(m->CellMax * 1000.0f);
+    const uint8_t r_CellMinIdx = m->CellMinIdx;
+    const uint8_t r_CellMaxIdx = m->CellMaxIdx;
+    const uint8_t r_TempMin = (uint8_t)m->TempMin;
+    const uint8_t r_TempMax = (uint8_t)m->TempMax;
+    const uint32_t r_Insulation = m->Insulation;
+    const uint64_t r_Balancing = m->Balancing;
+    uint8_t b0 = (uint8_t)(r_Page & 0xFU);
+    uint8_t b1 = 0;
+    uint8_t b2 = 0;
+    uint8_t b3 = 0;
+    uint8_t b4 = 0;
+    uint8_t b5 = 0;
+    uint8_t b6 = 0;
+    uint8_t b7 = 0;
+
+    switch (r_Page)
+    {
+    case 0:
+        b1 |= (uint8_t)r_CellMin;
+        b2 |= (uint8_t)(r_CellMin >> 8);
+        b3 |= (uint8_t)r_CellMax;
+        b4 |= (uint8_t)(r_CellMax >> 8);
+        b5 |= (uint8_t)r_CellMinIdx;
+        b6 |= (uint8_t)r_CellMaxIdx;
+        break;
+    case 1:
+        b1 |= (uint8_t)r_TempMin;
+        b2 |= (uint8_t)r_TempMax;
+        b5 |= (uint8_t)r_Insulation;
+        b4 |= (uint8_t)(r_Insulation >> 8);
+        b3 |= (uint8_t)(r_Insulation >> 16);
+        break;
+    case 2:
+        b1 |= (uint8_t)r_Balancing;
+        b2 |= (uint8_t)(r_Balancing >> 8);
+        b3 |= (uint8_t)(r_Balancing >> 16);
+        b4 |= (uint8_t)(r_Balancing >> 24);
+        b5 |= (uint8_t)(r_Balancing >> 32);
+        b6 |= (uint8_t)(r_Balancing >> 40);
+        break;
+    default:
+        break;
+    }
+
+    d[0] = b0;
+    d[1] = b1;
+    d[2] = b2;
+    d[3] = b3;
+    d[4] = b4;
+    d[5] = b5;
+    d[6] = b6;
+    d[7] = b7;
+}
+
+extern const struct d2s_db apl_db;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __APL_H__ */
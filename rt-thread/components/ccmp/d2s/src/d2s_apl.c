@@ -0,0 +1,61 @@
+/* Generated by d2s from apl.dbc, do not edit. */
+
+#include "d2s_apl.h"
+
+/**
+ * @brief Decode a received frame into the matching message struct.
+ *
+ * @return the index of the message in apl_db, or -1 if the id is unknown
+ *         or the frame is shorter than the message.
+ */
+int d2s_apl_decode(const struct rt_can_msg *msg, union apl_frame *out)
+{
+    if (msg->ide == RT_CAN_STDID)
+    {
+        switch (msg->id)
+        {
+        case APL_VCU_CMD_ID:
+            if (msg->len < APL_VCU_CMD_DLC)
+                return -1;
+            apl_vcu_cmd_unpack(&out->vcu_cmd, msg->data);
+            return 0;
+        case APL_APL_STATUS_ID:
+            if (msg->len < APL_APL_STATUS_DLC)
+                return -1;
+            apl_apl_status_unpack(&out->apl_status, msg->data);
+            return 1;
+        case APL_APL_TIME_ID:
+            if (msg->len < APL_APL_TIME_DLC)
+                return -1;
+            apl_apl_time_unpack(&out->apl_time, msg->data);
+            return 2;
+        case APL_APL_TEMP_ID:
+            if (msg->len < APL_APL_TEMP_DLC)
+                return -1;
+            apl_apl_temp_unpack(&out->apl_temp, msg->data);
+            return 3;
+        default:
+            break;
+        }
+    }
+    if (msg->ide == RT_CAN_EXTID)
+    {
+        switch (msg->id)
+        {
+        case APL_BMS_PACK_ID:
+            if (msg->len < APL_BMS_PACK_DLC)
+                return -1;
+            apl_bms_pack_unpack(&out->bms_pack, msg->data);
+            return 4;
+        case APL_BMS_CELL_ID:
+            if (msg->len < APL_BMS_CELL_DLC)
+                return -1;
+            apl_bms_cell_unpack(&out->bms_cell, msg->data);
+            return 5;
+        default:
+            break;
+        }
+    }
+
+    return -1;
+}
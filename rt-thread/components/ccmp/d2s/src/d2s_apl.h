@@ -0,0 +1,22 @@
+/* Generated by d2s from apl.dbc, do not edit. */
+
+#ifndef __D2S_APL_H__
+#define __D2S_APL_H__
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include "apl.h"
+
+union apl_frame
+{
+    struct apl_vcu_cmd vcu_cmd;
+    struct apl_apl_status apl_status;
+    struct apl_apl_time apl_time;
+    struct apl_apl_temp apl_temp;
+    struct apl_bms_pack bms_pack;
+    struct apl_bms_cell bms_cell;
+};
+
+int d2s_apl_decode(const struct rt_can_msg *msg, union apl_frame *out);
+
+#endif /* __D2S_APL_H__ */
@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2025-12-18     RT-Thread    first version
+ */
+
+/*
+ * Host test for generated d2s code, built and run by run.py.
+ *
+ * For random frames of every message:
+ *  - the generated unpack must give the same physical values as the
+ *    table-driven d2s_phys_get(),
+ *  - packing the unpacked struct must give back the raw value of every
+ *    signal present in the frame and leave all other bits zero.
+ * Then both decoders are timed on the same frames.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "d2s.h"
+
+enum
+{
+    FIELD_U8, FIELD_U16, FIELD_U32, FIELD_U64,
+    FIELD_S8, FIELD_S16, FIELD_S32, FIELD_S64,
+    FIELD_F32, FIELD_F64,
+};
+
+struct test_field
+{
+    size_t offset;
+    int kind;
+};
+
+struct test_message
+{
+    size_t size;
+    void (*unpack)(void *m, const uint8_t *d);
+    void (*pack)(uint8_t *d, const void *m);
+    const struct test_field *fields;
+};
+
+#include "test_fields.h"
+
+#define FRAMES          1024
+#define ROUNDS          2000
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static uint8_t rng_byte(void)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (uint8_t)(rng_state >> 24);
+}
+
+static double field_get(const void *m, const struct test_field *f)
+{
+    const uint8_t *p = (const uint8_t *)m + f->offset;
+
+    switch (f->kind)
+    {
+    case FIELD_U8:  return *(const uint8_t *)p;
+    case FIELD_U16: return *(const uint16_t *)p;
+    case FIELD_U32: return *(const uint32_t *)p;
+    case FIELD_U64: return (double)*(const uint64_t *)p;
+    case FIELD_S8:  return *(const int8_t *)p;
+    case FIELD_S16: return *(const int16_t *)p;
+    case FIELD_S32: return *(const int32_t *)p;
+    case FIELD_S64: return (double)*(const int64_t *)p;
+    case FIELD_F32: return *(const float *)p;
+    default:        return *(const double *)p;
+    }
+}
+
+static int test_message(const struct d2s_message *msg, const struct test_message *t)
+{
+    uint8_t d[8], out[8], used[8];
+    uint64_t all = ~0ULL;
+    double expect, got, tol;
+    uint8_t m[256];
+    int i, n, j, errors = 0;
+
+    for (n = 0; n < FRAMES && errors < 10; n++)
+    {
+        memset(d, 0, sizeof(d));
+        for (j = 0; j < msg->dlc; j++)
+        {
+            d[j] = rng_byte();
+        }
+        memset(m, 0, sizeof(m));
+        t->unpack(m, d);
+
+        memset(used, 0, sizeof(used));
+        for (i = 0; i < msg->signal_num; i++)
+        {
+            const struct d2s_signal *sig = &msg->signals[i];
+
+            if (!d2s_signal_present(d, msg, sig))
+            {
+                continue;
+            }
+            d2s_raw_set(used, sig, all);
+            expect = d2s_phys_get(d, sig);
+            got = field_get(m, &t->fields[i]);
+            /* float fields keep 24 bits of mantissa */
+            tol = fabs(expect) * 1e-6 + fabs(sig->factor) * 1e-3;
+            if (fabs(expect - got) > tol)
+            {
+                printf("  %s.%s: unpack %.6f, expected %.6f\n", msg->name, sig->name, got, expect);
+                errors++;
+            }
+        }
+
+        memset(out, 0xA5, sizeof(out));
+        t->pack(out, m);
+        for (i = 0; i < msg->signal_num; i++)
+        {
+            const struct d2s_signal *sig = &msg->signals[i];
+
+            if (d2s_signal_present(d, msg, sig) && d2s_raw_get(out, sig) != d2s_raw_get(d, sig))
+            {
+                printf("  %s.%s: pack 0x%llx, expected 0x%llx\n", msg->name, sig->name,
+                       (unsigned long long)d2s_raw_get(out, sig), (unsigned long long)d2s_raw_get(d, sig));
+                errors++;
+            }
+        }
+        for (j = 0; j < msg->dlc; j++)
+        {
+            if (out[j] & ~used[j])
+            {
+                printf("  %s: pack set unused bits 0x%02x in byte %d\n", msg->name, out[j] & ~used[j], j);
+                errors++;
+            }
+        }
+    }
+
+    return errors;
+}
+
+static void bench_message(const struct d2s_message *msg, const struct test_message *t, int loops)
+{
+    static uint8_t frames[FRAMES][8];
+    volatile double sink = 0;
+    double values[64], generic_ns, generated_ns;
+    uint8_t m[256];
+    clock_t start;
+    int n, i, j;
+
+    for (n = 0; n < FRAMES; n++)
+    {
+        for (j = 0; j < 8; j++)
+        {
+            frames[n][j] = rng_byte();
+        }
+    }
+
+    start = clock();
+    for (n = 0; n < loops; n++)
+    {
+        const uint8_t *d = frames[n % FRAMES];
+
+        for (i = 0; i < msg->signal_num; i++)
+        {
+            values[i] = d2s_signal_present(d, msg, &msg->signals[i]) ? d2s_phys_get(d, &msg->signals[i]) : 0;
+        }
+        sink += values[n % msg->signal_num];
+    }
+    generic_ns = (double)(clock() - start) * 1e9 / CLOCKS_PER_SEC / loops;
+
+    start = clock();
+    for (n = 0; n < loops; n++)
+    {
+        t->unpack(m, frames[n % FRAMES]);
+        sink += m[n % t->size];
+    }
+    generated_ns = (double)(clock() - start) * 1e9 / CLOCKS_PER_SEC / loops;
+
+    printf("  %-12s %2d signals  generic %8.1f ns  generated %6.1f ns  x%.1f\n", msg->name, msg->signal_num,
+           generic_ns, generated_ns, generated_ns > 0 ? generic_ns / generated_ns : 0.0);
+    (void)sink;
+}
+
+int main(int argc, char **argv)
+{
+    int loops = argc > 1 ? atoi(argv[1]) : ROUNDS * FRAMES;
+    int errors = 0;
+    size_t i;
+
+    printf("round trip, %d frames per message\n", FRAMES);
+    for (i = 0; i < TEST_DB.message_num; i++)
+    {
+        const struct d2s_message *msg = &TEST_DB.messages[i];
+        int e = test_message(msg, &test_messages[i]);
+
+        printf("  %-12s %s\n", msg->name, e ? "FAILED" : "ok");
+        errors += e;
+        if (d2s_message_find(&TEST_DB, msg->id, msg->ide) != msg)
+        {
+            printf("  %-12s lookup FAILED\n", msg->name);
+            errors++;
+        }
+    }
+
+    printf("decode time per frame, %d frames\n", loops);
+    for (i = 0; i < TEST_DB.message_num; i++)
+    {
+        if (TEST_DB.messages[i].signal_num)
+        {
+            bench_message(&TEST_DB.messages[i], &test_messages[i], loops);
+        }
+    }
+
+    printf("%s\n", errors ? "FAILED" : "PASSED");
+
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,74 @@
+#!/usr/bin/env python3
+# Host round-trip test and benchmark for the d2s generator.
+#
+# python run.py [dbc] [--cc gcc] [--loops 200000]
+#
+# Generates code for the DBC (default: ../example/apl.dbc) into a temporary
+# directory, adds a field table that maps every signal description to its
+# struct member, then builds d2s_test.c with the host compiler and runs it.
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+ROOT = os.path.dirname(HERE)
+sys.path.insert(0, os.path.join(ROOT, 'tools'))
+import d2s  # noqa: E402
+
+C_KIND = {'float': 'F32', 'double': 'F64'}
+
+
+def gen_fields(db, messages):
+    L = ['/* Generated by run.py, do not edit. */', '', '#include <stddef.h>', '#include "%s.h"' % db, '']
+    for msg in messages:
+        mn = d2s.c_name(msg.name)
+        L.append('static void %s_u(void *m, const uint8_t *d) { %s_%s_unpack(m, d); }' % (mn, db, mn))
+        L.append('static void %s_p(uint8_t *d, const void *m) { %s_%s_pack(d, m); }' % (mn, db, mn))
+        L.append('static const struct test_field %s_fields[] =' % mn)
+        L.append('{')
+        for s in msg.signals:
+            ft = s.field_type()
+            kind = C_KIND.get(ft, ('S' if ft.startswith('int') else 'U') + ft.strip('uint_t'))
+            L.append('    { offsetof(struct %s_%s, %s), FIELD_%s },' % (db, mn, s.name, kind))
+        if not msg.signals:
+            L.append('    { 0, 0 },')
+        L.append('};')
+        L.append('')
+    L.append('static const struct test_message test_messages[] =')
+    L.append('{')
+    for msg in messages:
+        mn = d2s.c_name(msg.name)
+        L.append('    { sizeof(struct %s_%s), %s_u, %s_p, %s_fields },' % (db, mn, mn, mn, mn))
+    L.append('};')
+    L.append('')
+    L.append('#define TEST_DB %s_db' % db)
+    return '\n'.join(L) + '\n'
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument('dbc', nargs='?', default=os.path.join(ROOT, 'example', 'apl.dbc'))
+    parser.add_argument('--cc', default=os.environ.get('CC', 'cc'))
+    parser.add_argument('--loops', type=int, default=200000, help='benchmark iterations per message')
+    args = parser.parse_args()
+
+    db = os.path.splitext(os.path.basename(args.dbc))[0].lower()
+    messages = d2s.parse_dbc(args.dbc)
+    with tempfile.TemporaryDirectory() as out:
+        subprocess.check_call([sys.executable, os.path.join(ROOT, 'tools', 'd2s.py'), args.dbc,
+                               '-o', out, '--no-glue'])
+        with open(os.path.join(out, 'test_fields.h'), 'w') as f:
+            f.write(gen_fields(db, messages))
+        exe = os.path.join(out, 'd2s_test')
+        subprocess.check_call([args.cc, '-std=c99', '-O2', '-Wall', '-Wextra', '-Wno-unused-parameter',
+                               '-I', out, '-I', ROOT, '-o', exe,
+                               os.path.join(HERE, 'd2s_test.c'), os.path.join(ROOT, 'd2s.c'),
+                               os.path.join(out, db + '.c')])
+        return subprocess.call([exe, str(args.loops)])
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,524 @@
+#!/usr/bin/env python3
+# d2s: generate C structs and specialized pack/unpack code from a DBC file.
+#
+# python d2s.py apl.dbc -o ../src
+#
+# For a database <db> (the DBC file name) this writes:
+#   <db>.h      message structs, ids and static inline pack/unpack functions
+#   <db>.c      signal description tables for the generic d2s runtime
+#   d2s_<db>.h  RT-Thread glue declarations
+#   d2s_<db>.c  RT-Thread glue: decode a struct rt_can_msg by id
+#
+# Every bit position, mask, shift, byte order and scale/offset is resolved
+# here, so the generated code has no loops and no per-bit work at runtime.
+
+import argparse
+import os
+import re
+import sys
+
+SG_RE = re.compile(
+    r'^\s*SG_\s+(\w+)\s*(M|m\d+)?\s*:\s*(\d+)\|(\d+)@([01])([+-])\s*'
+    r'\(\s*([-+.\deE]+)\s*,\s*([-+.\deE]+)\s*\)\s*'
+    r'\[\s*([-+.\deE]+)\s*\|\s*([-+.\deE]+)\s*\]\s*"([^"]*)"')
+BO_RE = re.compile(r'^\s*BO_\s+(\d+)\s+(\w+)\s*:\s*(\d+)\s+(\w+)')
+VAL_RE = re.compile(r'^\s*VAL_\s+(\d+)\s+(\w+)\s+(.*);')
+VAL_ITEM_RE = re.compile(r'(-?\d+)\s+"([^"]*)"')
+
+
+class Signal:
+    def __init__(self, m):
+        self.name = m.group(1)
+        mux = m.group(2)
+        self.is_mux = mux == 'M'
+        self.mux_value = int(mux[1:]) if mux and mux != 'M' else None
+        self.start = int(m.group(3))
+        self.length = int(m.group(4))
+        self.intel = m.group(5) == '1'
+        self.signed = m.group(6) == '-'
+        self.factor = float(m.group(7))
+        self.offset = float(m.group(8))
+        self.minimum = float(m.group(9))
+        self.maximum = float(m.group(10))
+        self.unit = m.group(11)
+        self.values = []
+
+    def positions(self):
+        """Frame bit position (byte * 8 + bit) of every raw bit, LSB first."""
+        if self.intel:
+            return [self.start + i for i in range(self.length)]
+        pos, msb_first = self.start, []
+        for _ in range(self.length):
+            msb_first.append(pos)
+            pos = pos + 15 if pos % 8 == 0 else pos - 1
+        return list(reversed(msb_first))
+
+    def segments(self):
+        """Split the signal into (byte, bit in byte, raw bit, width) runs."""
+        segs = []
+        for raw_bit, pos in enumerate(self.positions()):
+            byte, bit = divmod(pos, 8)
+            if segs and segs[-1][0] == byte and segs[-1][1] + segs[-1][3] == bit \
+                    and segs[-1][2] + segs[-1][3] == raw_bit:
+                b, p, r, n = segs[-1]
+                segs[-1] = (b, p, r, n + 1)
+            else:
+                segs.append((byte, bit, raw_bit, 1))
+        return segs
+
+    def width(self):
+        for w in (8, 16, 32, 64):
+            if self.length <= w:
+                return w
+        raise ValueError('%s: signal longer than 64 bits' % self.name)
+
+    def raw_type(self):
+        return 'uint%d_t' % self.width()
+
+    def kind(self):
+        if self.factor == 1.0 and self.offset == 0.0:
+            return 'raw'
+        if self.factor == int(self.factor) and self.offset == int(self.offset):
+            return 'int'
+        return 'float'
+
+    def field_type(self):
+        kind = self.kind()
+        if kind == 'raw':
+            return ('int%d_t' if self.signed else 'uint%d_t') % self.width()
+        if kind == 'int':
+            lo = min(self.phys(self.raw_min()), self.phys(self.raw_max()))
+            hi = max(self.phys(self.raw_min()), self.phys(self.raw_max()))
+            return 'int32_t' if -2 ** 31 <= lo and hi < 2 ** 31 else 'int64_t'
+        # float keeps 24 bits of mantissa
+        return 'float' if self.length <= 24 else 'double'
+
+    def raw_min(self):
+        return -(1 << (self.length - 1)) if self.signed else 0
+
+    def raw_max(self):
+        return (1 << (self.length - 1)) - 1 if self.signed else (1 << self.length) - 1
+
+    def phys(self, raw):
+        return raw * self.factor + self.offset
+
+
+class Message:
+    def __init__(self, m):
+        ident = int(m.group(1))
+        self.ext = bool(ident & 0x80000000)
+        self.id = ident & 0x1FFFFFFF
+        self.name = m.group(2)
+        self.dlc = int(m.group(3))
+        self.sender = m.group(4)
+        self.signals = []
+
+    def mux(self):
+        for s in self.signals:
+            if s.is_mux:
+                return s
+        return None
+
+
+def parse_dbc(path):
+    messages, by_id, msg = [], {}, None
+    with open(path, encoding='utf-8', errors='replace') as f:
+        for line in f:
+            m = BO_RE.match(line)
+            if m:
+                msg = Message(m)
+                # VECTOR__INDEPENDENT_SIG_MSG holds orphan signals
+                if msg.name != 'VECTOR__INDEPENDENT_SIG_MSG':
+                    messages.append(msg)
+                    by_id[int(m.group(1))] = msg
+                continue
+            m = SG_RE.match(line)
+            if m and msg is not None:
+                msg.signals.append(Signal(m))
+                continue
+            if not line.strip():
+                msg = None
+            m = VAL_RE.match(line)
+            if m and int(m.group(1)) in by_id:
+                for s in by_id[int(m.group(1))].signals:
+                    if s.name == m.group(2):
+                        s.values = [(int(v), n) for v, n in VAL_ITEM_RE.findall(m.group(3))]
+    messages.sort(key=lambda x: (x.ext, x.id))
+    return messages
+
+
+def c_name(name):
+    return re.sub(r'(?<=[a-z0-9])([A-Z])', r'_\1', name).lower()
+
+
+def c_float(value, double):
+    text = repr(float(value))
+    if 'e' not in text and '.' not in text:
+        text += '.0'
+    return text if double else text + 'f'
+
+
+def mask_hex(bits):
+    return '0x%XU' % ((1 << bits) - 1)
+
+
+def unpack_expr(sig):
+    """Expression building the unsigned raw value from the byte locals b<n>."""
+    t = sig.raw_type()
+    terms = []
+    for byte, bit, raw_bit, n in sig.segments():
+        e = 'b%d' % byte
+        if bit:
+            e = '(%s >> %d)' % (e, bit)
+        if bit + n < 8:
+            e = '(%s & %s)' % (e, mask_hex(n))
+        if raw_bit or t != 'uint8_t':
+            e = '(%s)%s' % (t, e)
+        if raw_bit:
+            e = '(%s << %d)' % (e, raw_bit)
+        terms.append(e)
+    return ' | '.join(terms)
+
+
+def paren(expr):
+    return '(%s)' % expr if ' | ' in expr else expr
+
+
+def store(terms):
+    if not terms:
+        return '0'
+    return '(uint8_t)%s' % paren(' | '.join(terms) if len(terms) > 1 else terms[0]) \
+        if len(terms) > 1 or terms[0].startswith('(') else '(uint8_t)' + terms[0]
+
+
+def pack_terms(sig, local):
+    """Per byte contributions of the raw value held in `local`."""
+    out = []
+    for byte, bit, raw_bit, n in sig.segments():
+        e = local
+        if raw_bit:
+            e = '(%s >> %d)' % (e, raw_bit)
+        if not (bit == 0 and n == 8):
+            e = '(%s & %s)' % (e, mask_hex(n))
+        if bit:
+            e = '(%s << %d)' % (e, bit)
+        out.append((byte, e))
+    return out
+
+
+def signed_expr(sig, raw):
+    w = 32 if sig.length <= 32 else 64
+    sign = '0x%XU' % (1 << (sig.length - 1)) + ('LL' if w == 64 else '')
+    return '(int%d_t)(((uint%d_t)%s ^ %s) - %s)' % (w, w, raw, sign, sign)
+
+
+def to_phys(sig, raw):
+    value = signed_expr(sig, raw) if sig.signed else raw
+    kind, ft = sig.kind(), sig.field_type()
+    if kind == 'raw':
+        return value if ft == sig.raw_type() else '(%s)%s' % (ft, value)
+    if kind == 'int':
+        e = '(%s)%s' % (ft, value)
+        if sig.factor != 1:
+            e = '%s * %d' % (e, int(sig.factor))
+        if sig.offset:
+            e = '%s %s %d' % (e, '+' if sig.offset > 0 else '-', abs(int(sig.offset)))
+        return '(%s)(%s)' % (ft, e)
+    double = ft == 'double'
+    e = '(%s)%s' % (ft, value)
+    if sig.factor != 1:
+        e = '%s * %s' % (e, c_float(sig.factor, double))
+    if sig.offset:
+        e = '%s %s %s' % (e, '+' if sig.offset > 0 else '-', c_float(abs(sig.offset), double))
+    return e
+
+
+def to_raw(sig, field):
+    kind, t = sig.kind(), sig.raw_type()
+    if kind == 'raw':
+        return field if sig.field_type() == t else '(%s)%s' % (t, field)
+    if kind == 'int':
+        e = field
+        if sig.offset:
+            e = '%s %s %d' % (e, '-' if sig.offset > 0 else '+', abs(int(sig.offset)))
+        if sig.factor != 1:
+            e = '(%s) / %d' % (e, int(sig.factor)) if sig.offset else '%s / %d' % (e, int(sig.factor))
+        return '(%s)(%s)' % (t, e)
+    double = sig.field_type() == 'double' or sig.length > 31
+    e = field
+    if sig.offset:
+        e = '(%s %s %s)' % (e, '-' if sig.offset > 0 else '+', c_float(abs(sig.offset), double))
+    if sig.factor != 1:
+        e = '%s * %s' % (e, c_float(1.0 / sig.factor, double))
+    return '(%s)%s(%s)' % (t, 'd2s_round' if double else 'd2s_roundf', e)
+
+
+def gen_header(db, messages):
+    guard = '__%s_H__' % db.upper()
+    L = []
+    L.append('/* Generated by d2s from %s.dbc, do not edit. */' % db)
+    L.append('')
+    L.append('#ifndef %s' % guard)
+    L.append('#define %s' % guard)
+    L.append('')
+    L.append('#include "d2s.h"')
+    L.append('')
+    L.append('#ifdef __cplusplus')
+    L.append('extern "C" {')
+    L.append('#endif')
+    L.append('')
+    for msg in messages:
+        mn = c_name(msg.name)
+        P = '%s_%s' % (db.upper(), mn.upper())
+        L.append('/* %s, sent by %s */' % (msg.name, msg.sender))
+        L.append('#define %s_ID 0x%XU' % (P, msg.id))
+        L.append('#define %s_IDE %d' % (P, 1 if msg.ext else 0))
+        L.append('#define %s_DLC %d' % (P, msg.dlc))
+        for s in msg.signals:
+            for v, n in s.values:
+                L.append('#define %s_%s_%s %d' % (P, s.name.upper(), re.sub(r'\W', '_', n).upper(), v))
+        L.append('')
+        L.append('struct %s_%s' % (db, mn))
+        L.append('{')
+        for s in msg.signals:
+            note = ' [%s]' % s.unit if s.unit else ''
+            if s.mux_value is not None:
+                note += ' (mux %d)' % s.mux_value
+            L.append('    %-9s %s;%s' % (s.field_type(), s.name, ('    /*%s */' % note) if note else ''))
+        L.append('};')
+        L.append('')
+        L.append(gen_unpack(db, msg))
+        L.append('')
+        L.append(gen_pack(db, msg))
+        L.append('')
+    L.append('extern const struct d2s_db %s_db;' % db)
+    L.append('')
+    L.append('#ifdef __cplusplus')
+    L.append('}')
+    L.append('#endif')
+    L.append('')
+    L.append('#endif /* %s */' % guard)
+    return '\n'.join(L) + '\n'
+
+
+def used_bytes(signals):
+    return sorted({b for s in signals for b, _, _, _ in s.segments()})
+
+
+def gen_unpack(db, msg):
+    mn = c_name(msg.name)
+    mux = msg.mux()
+    L = []
+    L.append('static inline void %s_%s_unpack(struct %s_%s *m, const uint8_t *d)' % (db, mn, db, mn))
+    L.append('{')
+    for b in used_bytes(msg.signals):
+        L.append('    const uint8_t b%d = d[%d];' % (b, b))
+    plain = [s for s in msg.signals if s.mux_value is None]
+    for s in plain:
+        if s is mux:
+            L.append('    const %s mux = %s;' % (s.raw_type(), unpack_expr(s)))
+            L.append('    m->%s = %s;' % (s.name, to_phys(s, 'mux')))
+        else:
+            L.append('    m->%s = %s;' % (s.name, to_phys(s, paren(unpack_expr(s)))))
+    if mux is not None:
+        L.append('')
+        L.append('    switch (mux)')
+        L.append('    {')
+        for value in sorted({s.mux_value for s in msg.signals if s.mux_value is not None}):
+            L.append('    case %d:' % value)
+            for s in msg.signals:
+                if s.mux_value == value:
+                    L.append('        m->%s = %s;' % (s.name, to_phys(s, paren(unpack_expr(s)))))
+            L.append('        break;')
+        L.append('    default:')
+        L.append('        break;')
+        L.append('    }')
+    if not msg.signals:
+        L.append('    (void)m;')
+        L.append('    (void)d;')
+    L.append('}')
+    return '\n'.join(L)
+
+
+def gen_pack(db, msg):
+    mn = c_name(msg.name)
+    mux = msg.mux()
+    L = []
+    L.append('static inline void %s_%s_pack(uint8_t *d, const struct %s_%s *m)' % (db, mn, db, mn))
+    L.append('{')
+    nbytes = msg.dlc
+    plain = [s for s in msg.signals if s.mux_value is None]
+    for s in msg.signals:
+        L.append('    const %s r_%s = %s;' % (s.raw_type(), s.name, to_raw(s, 'm->%s' % s.name)))
+    if mux is None:
+        for b in range(nbytes):
+            terms = [e for s in plain for byte, e in pack_terms(s, 'r_%s' % s.name) if byte == b]
+            L.append('    d[%d] = %s;' % (b, store(terms)))
+    else:
+        for b in range(nbytes):
+            terms = [e for s in plain for byte, e in pack_terms(s, 'r_%s' % s.name) if byte == b]
+            L.append('    uint8_t b%d = %s;' % (b, store(terms)))
+        L.append('')
+        L.append('    switch (r_%s)' % mux.name)
+        L.append('    {')
+        for value in sorted({s.mux_value for s in msg.signals if s.mux_value is not None}):
+            L.append('    case %d:' % value)
+            for s in msg.signals:
+                if s.mux_value == value:
+                    for byte, e in pack_terms(s, 'r_%s' % s.name):
+                        if byte < nbytes:
+                            L.append('        b%d |= (uint8_t)%s;' % (byte, e))
+            L.append('        break;')
+        L.append('    default:')
+        L.append('        break;')
+        L.append('    }')
+        L.append('')
+        for b in range(nbytes):
+            L.append('    d[%d] = b%d;' % (b, b))
+    if not msg.signals:
+        L.append('    (void)m;')
+    L.append('}')
+    return '\n'.join(L)
+
+
+def gen_source(db, messages):
+    L = []
+    L.append('/* Generated by d2s from %s.dbc, do not edit. */' % db)
+    L.append('')
+    L.append('#include "%s.h"' % db)
+    L.append('')
+    for msg in messages:
+        if not msg.signals:
+            continue
+        mn = c_name(msg.name)
+        L.append('static const struct d2s_signal %s_%s_signals[] =' % (db, mn))
+        L.append('{')
+        for s in msg.signals:
+            flags = ['D2S_SIG_INTEL' if s.intel else 'D2S_SIG_MOTOROLA']
+            if s.signed:
+                flags.append('D2S_SIG_SIGNED')
+            if s.is_mux:
+                flags.append('D2S_SIG_MUX')
+            if s.mux_value is not None:
+                flags.append('D2S_SIG_MUXED')
+            L.append('    { "%s", %d, %d, %s, %d, %s, %s, "%s" },' % (
+                s.name, s.start, s.length, ' | '.join(flags), s.mux_value or 0,
+                repr(s.factor), repr(s.offset), s.unit))
+        L.append('};')
+        L.append('')
+    L.append('static const struct d2s_message %s_messages[] =' % db)
+    L.append('{')
+    for msg in messages:
+        mn = c_name(msg.name)
+        sigs = '%s_%s_signals' % (db, mn) if msg.signals else 'NULL'
+        L.append('    { 0x%XU, %d, %d, %d, "%s", %s },' % (
+            msg.id, 1 if msg.ext else 0, msg.dlc, len(msg.signals), msg.name, sigs))
+    L.append('};')
+    L.append('')
+    L.append('const struct d2s_db %s_db =' % db)
+    L.append('{')
+    L.append('    "%s", %s_messages, sizeof(%s_messages) / sizeof(%s_messages[0])' % (db, db, db, db))
+    L.append('};')
+    return '\n'.join(L) + '\n'
+
+
+def gen_glue_header(db, messages):
+    guard = '__D2S_%s_H__' % db.upper()
+    L = []
+    L.append('/* Generated by d2s from %s.dbc, do not edit. */' % db)
+    L.append('')
+    L.append('#ifndef %s' % guard)
+    L.append('#define %s' % guard)
+    L.append('')
+    L.append('#include <rtthread.h>')
+    L.append('#include <rtdevice.h>')
+    L.append('#include "%s.h"' % db)
+    L.append('')
+    L.append('union %s_frame' % db)
+    L.append('{')
+    for msg in messages:
+        mn = c_name(msg.name)
+        L.append('    struct %s_%s %s;' % (db, mn, mn))
+    L.append('};')
+    L.append('')
+    L.append('int d2s_%s_decode(const struct rt_can_msg *msg, union %s_frame *out);' % (db, db))
+    L.append('')
+    L.append('#endif /* %s */' % guard)
+    return '\n'.join(L) + '\n'
+
+
+def gen_glue_source(db, messages):
+    L = []
+    L.append('/* Generated by d2s from %s.dbc, do not edit. */' % db)
+    L.append('')
+    L.append('#include "d2s_%s.h"' % db)
+    L.append('')
+    L.append('/**')
+    L.append(' * @brief Decode a received frame into the matching message struct.')
+    L.append(' *')
+    L.append(' * @return the index of the message in %s_db, or -1 if the id is unknown' % db)
+    L.append(' *         or the frame is shorter than the message.')
+    L.append(' */')
+    L.append('int d2s_%s_decode(const struct rt_can_msg *msg, union %s_frame *out)' % (db, db))
+    L.append('{')
+    for ext in (False, True):
+        group = [(i, m) for i, m in enumerate(messages) if m.ext == ext]
+        if not group:
+            continue
+        L.append('    if (msg->ide == %s)' % ('RT_CAN_EXTID' if ext else 'RT_CAN_STDID'))
+        L.append('    {')
+        L.append('        switch (msg->id)')
+        L.append('        {')
+        for i, m in group:
+            mn = c_name(m.name)
+            L.append('        case %s_%s_ID:' % (db.upper(), mn.upper()))
+            L.append('            if (msg->len < %s_%s_DLC)' % (db.upper(), mn.upper()))
+            L.append('                return -1;')
+            L.append('            %s_%s_unpack(&out->%s, msg->data);' % (db, mn, mn))
+            L.append('            return %d;' % i)
+        L.append('        default:')
+        L.append('            break;')
+        L.append('        }')
+        L.append('    }')
+    L.append('')
+    L.append('    return -1;')
+    L.append('}')
+    return '\n'.join(L) + '\n'
+
+
+def main():
+    parser = argparse.ArgumentParser(description='generate C pack/unpack code from a DBC file')
+    parser.add_argument('dbc')
+    parser.add_argument('-o', '--output', default='.', help='output directory')
+    parser.add_argument('-n', '--name', help='database name, default: DBC file name')
+    parser.add_argument('--no-glue', action='store_true', help='skip the RT-Thread glue files')
+    args = parser.parse_args()
+
+    db = args.name or os.path.splitext(os.path.basename(args.dbc))[0]
+    db = re.sub(r'\W', '_', db).lower()
+    messages = parse_dbc(args.dbc)
+    if not messages:
+        sys.exit('%s: no messages found' % args.dbc)
+    for msg in messages:
+        used = {}
+        for s in msg.signals:
+            if max(s.positions()) >= msg.dlc * 8 or min(s.positions()) < 0:
+                sys.exit('%s.%s: signal outside of the %d byte frame' % (msg.name, s.name, msg.dlc))
+            for pos in s.positions():
+                other = used.setdefault((s.mux_value, pos), s)
+                if other is not s or (s.mux_value is not None and (None, pos) in used):
+                    sys.exit('%s.%s: overlaps %s at bit %d' % (msg.name, s.name, used.get((None, pos), other).name, pos))
+
+    os.makedirs(args.output, exist_ok=True)
+    files = {'%s.h' % db: gen_header(db, messages), '%s.c' % db: gen_source(db, messages)}
+    if not args.no_glue:
+        files['d2s_%s.h' % db] = gen_glue_header(db, messages)
+        files['d2s_%s.c' % db] = gen_glue_source(db, messages)
+    for name, text in files.items():
+        with open(os.path.join(args.output, name), 'w', newline='\n') as f:
+            f.write(text)
+    print('%s: %d messages, %d signals' % (db, len(messages), sum(len(m.signals) for m in messages)))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,349 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2025-12-20     RT-Thread    first version
+ */
+
+#include "ebus.h"
+
+#define DBG_TAG "ebus"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+#if EBUS_MSG_SIZE <= 16
+#error "EBUS_MSG_SIZE is too small for the message header"
+#endif
+
+#define EBUS_BLOCK_SIZE         RT_ALIGN(EBUS_MSG_SIZE, RT_ALIGN_SIZE)
+
+static struct rt_mempool _pool;
+rt_align(RT_ALIGN_SIZE)
+static rt_uint8_t _pool_buf[EBUS_MSG_NUM * (EBUS_BLOCK_SIZE + sizeof(rt_uint8_t *))];
+static struct ebus_sub *_subs[EBUS_SUB_MAX];
+static rt_uint32_t _topic_map[EBUS_TOPIC_NUM];  /* subscriber bitmap per topic */
+
+static rt_uint32_t _published;
+static rt_uint32_t _no_sub;
+static rt_uint32_t _no_mem;
+
+/**
+ * @brief Get an empty message block for a topic.
+ *
+ * Never blocks, so it may be called from interrupts. The caller owns one
+ * reference, fills data[0..len) and hands the reference over with
+ * ebus_publish(), or gives it back with ebus_msg_release().
+ *
+ * @return the message, or RT_NULL if the pool is empty or len is too big.
+ */
+struct ebus_msg *ebus_msg_alloc(rt_uint16_t topic, rt_uint16_t len)
+{
+    struct ebus_msg *msg;
+
+    if (topic >= EBUS_TOPIC_NUM || len > EBUS_DATA_MAX)
+    {
+        return RT_NULL;
+    }
+
+    msg = rt_mp_alloc(&_pool, 0);
+    if (msg == RT_NULL)
+    {
+        _no_mem++;
+        return RT_NULL;
+    }
+    rt_atomic_store(&msg->ref, 1);
+    msg->topic = topic;
+    msg->len = len;
+    msg->tick = rt_tick_get();
+
+    return msg;
+}
+
+void ebus_msg_release(struct ebus_msg *msg)
+{
+    if (rt_atomic_dec_and_test(&msg->ref))
+    {
+        rt_mp_free(msg);
+    }
+}
+
+/* called with interrupts disabled, returns the overwritten message if any */
+rt_inline struct ebus_msg *ebus_sub_push(struct ebus_sub *sub, struct ebus_msg *msg, rt_bool_t *wake)
+{
+    struct ebus_msg *old = RT_NULL;
+
+    *wake = RT_FALSE;
+    if (sub->count == sub->depth)
+    {
+        sub->dropped++;
+        if (sub->policy == EBUS_POLICY_DROP)
+        {
+            return RT_NULL;
+        }
+        /* the count and the semaphore stay the same */
+        old = sub->queue[sub->head];
+        sub->head = (sub->head + 1) % sub->depth;
+        sub->count--;
+    }
+    else
+    {
+        *wake = RT_TRUE;
+    }
+    rt_atomic_add(&msg->ref, 1);
+    sub->queue[(sub->head + sub->count) % sub->depth] = msg;
+    sub->count++;
+    sub->received++;
+
+    return old;
+}
+
+/**
+ * @brief Deliver a message to every subscriber of its topic.
+ *
+ * The message is queued by pointer, N subscribers share one block and the
+ * last ebus_msg_release() frees it. The caller's reference is consumed in
+ * all cases. Safe to call from interrupts.
+ *
+ * @return RT_EOK, or -RT_EEMPTY if nobody subscribes to the topic.
+ */
+rt_err_t ebus_publish(struct ebus_msg *msg)
+{
+    struct ebus_sub *sub;
+    struct ebus_msg *old;
+    rt_uint32_t map;
+    rt_base_t level;
+    rt_bool_t wake;
+    int i;
+
+    _published++;
+    map = _topic_map[msg->topic];
+    if (map == 0)
+    {
+        _no_sub++;
+        ebus_msg_release(msg);
+        return -RT_EEMPTY;
+    }
+
+    /* one short critical section per subscriber keeps the irq latency flat */
+    while (map)
+    {
+        i = __rt_ffs(map) - 1;
+        map &= map - 1;
+
+        level = rt_hw_interrupt_disable();
+        sub = _subs[i];
+        if (sub == RT_NULL)
+        {
+            rt_hw_interrupt_enable(level);
+            continue;
+        }
+        old = ebus_sub_push(sub, msg, &wake);
+        rt_hw_interrupt_enable(level);
+
+        if (wake)
+        {
+            rt_sem_release(&sub->sem);
+        }
+        if (old != RT_NULL)
+        {
+            ebus_msg_release(old);
+        }
+    }
+    ebus_msg_release(msg);
+
+    return RT_EOK;
+}
+
+rt_err_t ebus_publish_copy(rt_uint16_t topic, const void *data, rt_uint16_t len)
+{
+    struct ebus_msg *msg;
+
+    msg = ebus_msg_alloc(topic, len);
+    if (msg == RT_NULL)
+    {
+        return -RT_ENOMEM;
+    }
+    rt_memcpy(msg->data, data, len);
+
+    return ebus_publish(msg);
+}
+
+/**
+ * @brief Wait for the next message of any subscribed topic.
+ *
+ * @return the message, to be released with ebus_msg_release(), or RT_NULL
+ *         on timeout.
+ */
+struct ebus_msg *ebus_recv(struct ebus_sub *sub, rt_int32_t timeout)
+{
+    struct ebus_msg *msg;
+    rt_base_t level;
+
+    if (rt_sem_take(&sub->sem, timeout) != RT_EOK)
+    {
+        return RT_NULL;
+    }
+
+    level = rt_hw_interrupt_disable();
+    msg = sub->queue[sub->head];
+    sub->head = (sub->head + 1) % sub->depth;
+    sub->count--;
+    rt_hw_interrupt_enable(level);
+
+    return msg;
+}
+
+/**
+ * @brief Register a subscriber.
+ *
+ * @param queue storage for depth message pointers, kept by the caller.
+ * @param policy EBUS_POLICY_DROP or EBUS_POLICY_OVERWRITE.
+ */
+rt_err_t ebus_sub_init(struct ebus_sub *sub, const char *name, struct ebus_msg **queue,
+                       rt_uint16_t depth, rt_uint8_t policy)
+{
+    rt_base_t level;
+    int i;
+
+    if (queue == RT_NULL || depth == 0 || policy > EBUS_POLICY_OVERWRITE)
+    {
+        return -RT_EINVAL;
+    }
+
+    rt_memset(sub, 0, sizeof(struct ebus_sub));
+    sub->name = name;
+    sub->queue = queue;
+    sub->depth = depth;
+    sub->policy = policy;
+    rt_sem_init(&sub->sem, name, 0, RT_IPC_FLAG_PRIO);
+
+    level = rt_hw_interrupt_disable();
+    for (i = 0; i < EBUS_SUB_MAX; i++)
+    {
+        if (_subs[i] == RT_NULL)
+        {
+            _subs[i] = sub;
+            sub->id = i;
+            break;
+        }
+    }
+    rt_hw_interrupt_enable(level);
+
+    if (i == EBUS_SUB_MAX)
+    {
+        rt_sem_detach(&sub->sem);
+        return -RT_EFULL;
+    }
+
+    return RT_EOK;
+}
+
+rt_err_t ebus_sub_detach(struct ebus_sub *sub)
+{
+    struct ebus_msg *msg;
+    rt_uint32_t bit = 1UL << sub->id;
+    rt_base_t level;
+    int i;
+
+    level = rt_hw_interrupt_disable();
+    for (i = 0; i < EBUS_TOPIC_NUM; i++)
+    {
+        _topic_map[i] &= ~bit;
+    }
+    _subs[sub->id] = RT_NULL;
+    rt_hw_interrupt_enable(level);
+
+    while (sub->count)
+    {
+        msg = sub->queue[sub->head];
+        sub->head = (sub->head + 1) % sub->depth;
+        sub->count--;
+        ebus_msg_release(msg);
+    }
+    rt_sem_detach(&sub->sem);
+
+    return RT_EOK;
+}
+
+rt_err_t ebus_subscribe(struct ebus_sub *sub, rt_uint16_t topic)
+{
+    rt_base_t level;
+
+    if (topic >= EBUS_TOPIC_NUM || _subs[sub->id] != sub)
+    {
+        return -RT_EINVAL;
+    }
+
+    level = rt_hw_interrupt_disable();
+    _topic_map[topic] |= 1UL << sub->id;
+    rt_hw_interrupt_enable(level);
+
+    return RT_EOK;
+}
+
+rt_err_t ebus_unsubscribe(struct ebus_sub *sub, rt_uint16_t topic)
+{
+    rt_base_t level;
+
+    if (topic >= EBUS_TOPIC_NUM || _subs[sub->id] != sub)
+    {
+        return -RT_EINVAL;
+    }
+
+    level = rt_hw_interrupt_disable();
+    _topic_map[topic] &= ~(1UL << sub->id);
+    rt_hw_interrupt_enable(level);
+
+    return RT_EOK;
+}
+
+static int ebus_init(void)
+{
+    rt_err_t ret;
+
+    ret = rt_mp_init(&_pool, "ebus", _pool_buf, sizeof(_pool_buf), EBUS_BLOCK_SIZE);
+    if (ret != RT_EOK)
+    {
+        LOG_E("pool init failed %d", ret);
+        return ret;
+    }
+    LOG_D("%d topics, %d blocks of %d bytes", EBUS_TOPIC_NUM, EBUS_MSG_NUM, EBUS_BLOCK_SIZE);
+
+    return RT_EOK;
+}
+INIT_COMPONENT_EXPORT(ebus_init);
+
+#ifdef RT_USING_FINSH
+#define EBUS_TOPIC_NAME(name)   #name,
+
+static const char *_topic_name[EBUS_TOPIC_NUM] = { EBUS_TOPIC_TABLE(EBUS_TOPIC_NAME) };
+
+static int ebus(int argc, char **argv)
+{
+    struct ebus_sub *sub;
+    int i;
+
+    rt_kprintf("pool %u/%u free, published %u, no subscriber %u, no memory %u\n",
+               _pool.block_free_count, _pool.block_total_count, _published, _no_sub, _no_mem);
+    for (i = 0; i < EBUS_TOPIC_NUM; i++)
+    {
+        rt_kprintf("  %-28s %08x\n", _topic_name[i], _topic_map[i]);
+    }
+    rt_kprintf("id name         depth queued received dropped\n");
+    for (i = 0; i < EBUS_SUB_MAX; i++)
+    {
+        sub = _subs[i];
+        if (sub != RT_NULL)
+        {
+            rt_kprintf("%2d %-12s %5u %6u %8u %u\n", i, sub->name, sub->depth, sub->count,
+                       sub->received, sub->dropped);
+        }
+    }
+
+    return 0;
+}
+MSH_CMD_EXPORT(ebus, show event bus topics and subscribers);
+#endif /* RT_USING_FINSH */
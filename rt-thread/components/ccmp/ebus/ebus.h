@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2025-12-20     RT-Thread    first version
+ */
+
+#ifndef __EBUS_H__
+#define __EBUS_H__
+
+#include <rtthread.h>
+#include "ebus_topic.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define EBUS_TOPIC_ENUM(name)   name,
+
+enum ebus_topic
+{
+    EBUS_TOPIC_TABLE(EBUS_TOPIC_ENUM)
+    EBUS_TOPIC_NUM
+};
+
+#define EBUS_SUB_MAX            32
+
+/* ebus_sub.policy, what a full subscriber queue does with a new message */
+#define EBUS_POLICY_DROP        0       /* keep the queued messages, drop the new one */
+#define EBUS_POLICY_OVERWRITE   1       /* drop the oldest queued message */
+
+/*
+ * A message lives in one pool block and is shared by all subscribers.
+ * Subscribers must treat data as read only and release the message when
+ * they are done with it.
+ */
+struct ebus_msg
+{
+    rt_atomic_t ref;
+    rt_uint16_t topic;
+    rt_uint16_t len;
+    rt_tick_t tick;                     /* publish time */
+    rt_uint8_t data[];
+};
+
+#define EBUS_DATA_MAX           (EBUS_MSG_SIZE - sizeof(struct ebus_msg))
+
+struct ebus_sub
+{
+    const char *name;
+    rt_uint8_t id;
+    rt_uint8_t policy;
+    rt_uint16_t depth;
+    struct ebus_msg **queue;            /* depth entries, owned by the caller */
+    rt_uint16_t head;
+    rt_uint16_t count;
+    struct rt_semaphore sem;
+
+    /* statistics */
+    rt_uint32_t received;
+    rt_uint32_t dropped;
+};
+
+rt_err_t ebus_sub_init(struct ebus_sub *sub, const char *name, struct ebus_msg **queue,
+                       rt_uint16_t depth, rt_uint8_t policy);
+rt_err_t ebus_sub_detach(struct ebus_sub *sub);
+rt_err_t ebus_subscribe(struct ebus_sub *sub, rt_uint16_t topic);
+rt_err_t ebus_unsubscribe(struct ebus_sub *sub, rt_uint16_t topic);
+
+struct ebus_msg *ebus_msg_alloc(rt_uint16_t topic, rt_uint16_t len);
+void ebus_msg_release(struct ebus_msg *msg);
+rt_err_t ebus_publish(struct ebus_msg *msg);
+rt_err_t ebus_publish_copy(rt_uint16_t topic, const void *data, rt_uint16_t len);
+
+struct ebus_msg *ebus_recv(struct ebus_sub *sub, rt_int32_t timeout);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __EBUS_H__ */
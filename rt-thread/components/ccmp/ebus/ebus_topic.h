@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2025-12-20     RT-Thread    first version
+ */
+
+#ifndef __EBUS_TOPIC_H__
+#define __EBUS_TOPIC_H__
+
+/*
+ * Topic list of the application, one X(name) per topic.
+ *
+ * Topics become the enum ebus_topic, so a topic id is a compile time
+ * constant and the subscriber table is a plain array indexed by it.
+ */
+
+#ifdef CCMP_USING_EXAMPLE_EBUS
+#define EBUS_TOPIC_EXAMPLE(X)           \
+    X(EBUS_TOPIC_EXAMPLE_TICK)          \
+    X(EBUS_TOPIC_EXAMPLE_REQ)           \
+    X(EBUS_TOPIC_EXAMPLE_ACK)
+#else
+#define EBUS_TOPIC_EXAMPLE(X)
+#endif
+
+#define EBUS_TOPIC_TABLE(X)             \
+    X(EBUS_TOPIC_CAN_RX)                \
+    X(EBUS_TOPIC_UDS_SESSION)           \
+    X(EBUS_TOPIC_DTC)                   \
+    X(EBUS_TOPIC_STORAGE)               \
+    X(EBUS_TOPIC_LOG)                   \
+    EBUS_TOPIC_EXAMPLE(X)
+
+#endif /* __EBUS_TOPIC_H__ */
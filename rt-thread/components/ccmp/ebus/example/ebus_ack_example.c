@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2025-12-20     RT-Thread    first version
+ */
+
+#include "ebus.h"
+
+#ifdef CCMP_USING_EXAMPLE_EBUS
+
+#define EXAMPLE_REQ_NUM         10
+
+struct example_req
+{
+    rt_uint32_t seq;
+    rt_int32_t value;
+};
+
+struct example_ack
+{
+    rt_uint32_t seq;
+    rt_int32_t result;
+};
+
+/* answers every request on the ack topic */
+static void example_server_entry(void *parameter)
+{
+    struct ebus_msg *queue[4];
+    const struct example_req *req;
+    struct example_ack *ack;
+    struct ebus_msg *msg, *reply;
+    struct ebus_sub sub;
+    int i;
+
+    ebus_sub_init(&sub, "ex_srv", queue, 4, EBUS_POLICY_DROP);
+    ebus_subscribe(&sub, EBUS_TOPIC_EXAMPLE_REQ);
+
+    for (i = 0; i < EXAMPLE_REQ_NUM; i++)
+    {
+        msg = ebus_recv(&sub, RT_WAITING_FOREVER);
+        req = (const struct example_req *)msg->data;
+
+        reply = ebus_msg_alloc(EBUS_TOPIC_EXAMPLE_ACK, sizeof(struct example_ack));
+        if (reply != RT_NULL)
+        {
+            ack = (struct example_ack *)reply->data;
+            ack->seq = req->seq;
+            ack->result = req->value * 2;
+            ebus_publish(reply);
+        }
+        ebus_msg_release(msg);
+    }
+    ebus_sub_detach(&sub);
+}
+
+/* sends requests and waits for the matching ack, retries once on timeout */
+static void example_client_entry(void *parameter)
+{
+    struct ebus_msg *queue[4];
+    struct example_req req;
+    const struct example_ack *ack;
+    struct ebus_msg *msg;
+    struct ebus_sub sub;
+    rt_tick_t start;
+    int retry;
+
+    ebus_sub_init(&sub, "ex_cli", queue, 4, EBUS_POLICY_DROP);
+    ebus_subscribe(&sub, EBUS_TOPIC_EXAMPLE_ACK);
+
+    for (req.seq = 0; req.seq < EXAMPLE_REQ_NUM; req.seq++)
+    {
+        req.value = (rt_int32_t)req.seq * 10;
+        for (retry = 0; retry < 2; retry++)
+        {
+            start = rt_tick_get();
+            if (ebus_publish_copy(EBUS_TOPIC_EXAMPLE_REQ, &req, sizeof(req)) != RT_EOK)
+            {
+                continue;
+            }
+            msg = ebus_recv(&sub, rt_tick_from_millisecond(100));
+            if (msg == RT_NULL)
+            {
+                continue;
+            }
+            ack = (const struct example_ack *)msg->data;
+            rt_kprintf("req %u -> ack %u result %d in %u ticks\n", req.seq, ack->seq, ack->result,
+                       rt_tick_get() - start);
+            ebus_msg_release(msg);
+            break;
+        }
+    }
+    ebus_sub_detach(&sub);
+}
+
+static int ebus_ack_example(void)
+{
+    rt_thread_t tid;
+
+    tid = rt_thread_create("ex_srv", example_server_entry, RT_NULL, 1024, 19, 10);
+    if (tid != RT_NULL)
+    {
+        rt_thread_startup(tid);
+    }
+    /* let the server subscribe first */
+    rt_thread_mdelay(10);
+    tid = rt_thread_create("ex_cli", example_client_entry, RT_NULL, 1024, 20, 10);
+    if (tid != RT_NULL)
+    {
+        rt_thread_startup(tid);
+    }
+
+    return 0;
+}
+MSH_CMD_EXPORT(ebus_ack_example, request and acknowledge over two topics);
+
+#endif /* CCMP_USING_EXAMPLE_EBUS */
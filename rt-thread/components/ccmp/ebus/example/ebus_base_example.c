@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2025-12-20     RT-Thread    first version
+ */
+
+#include "ebus.h"
+
+#ifdef CCMP_USING_EXAMPLE_EBUS
+
+#define EXAMPLE_QUEUE_DEPTH     4
+
+struct example_tick
+{
+    rt_uint32_t seq;
+};
+
+static struct rt_timer _tick_timer;
+static rt_uint32_t _tick_seq;
+
+/* a hard timer runs in interrupt context: publishing never blocks */
+static void example_tick_timeout(void *parameter)
+{
+    struct ebus_msg *msg;
+
+    msg = ebus_msg_alloc(EBUS_TOPIC_EXAMPLE_TICK, sizeof(struct example_tick));
+    if (msg != RT_NULL)
+    {
+        ((struct example_tick *)msg->data)->seq = _tick_seq++;
+        ebus_publish(msg);
+    }
+}
+
+/* both threads get the same block, the slow one overwrites its oldest entries */
+static void example_sub_entry(void *parameter)
+{
+    rt_uint8_t policy = (rt_uint8_t)(rt_ubase_t)parameter;
+    struct ebus_msg *queue[EXAMPLE_QUEUE_DEPTH];
+    struct ebus_sub sub;
+    struct ebus_msg *msg;
+    int i;
+
+    ebus_sub_init(&sub, policy == EBUS_POLICY_DROP ? "ex_fast" : "ex_slow", queue, EXAMPLE_QUEUE_DEPTH, policy);
+    ebus_subscribe(&sub, EBUS_TOPIC_EXAMPLE_TICK);
+
+    for (i = 0; i < 20; i++)
+    {
+        msg = ebus_recv(&sub, RT_WAITING_FOREVER);
+        rt_kprintf("[%s] tick %u at %u, msg %p\n", sub.name, ((struct example_tick *)msg->data)->seq,
+                   msg->tick, msg);
+        ebus_msg_release(msg);
+        if (policy == EBUS_POLICY_OVERWRITE)
+        {
+            rt_thread_mdelay(250);
+        }
+    }
+    rt_kprintf("[%s] received %u, dropped %u\n", sub.name, sub.received, sub.dropped);
+    ebus_sub_detach(&sub);
+}
+
+static int ebus_base_example(void)
+{
+    static rt_bool_t started = RT_FALSE;
+    rt_thread_t tid;
+
+    if (started)
+    {
+        rt_kprintf("already running\n");
+        return -RT_EBUSY;
+    }
+    started = RT_TRUE;
+
+    tid = rt_thread_create("ex_fast", example_sub_entry, (void *)EBUS_POLICY_DROP, 1024, 20, 10);
+    if (tid != RT_NULL)
+    {
+        rt_thread_startup(tid);
+    }
+    tid = rt_thread_create("ex_slow", example_sub_entry, (void *)EBUS_POLICY_OVERWRITE, 1024, 21, 10);
+    if (tid != RT_NULL)
+    {
+        rt_thread_startup(tid);
+    }
+
+    rt_timer_init(&_tick_timer, "ex_tick", example_tick_timeout, RT_NULL, rt_tick_from_millisecond(100),
+                  RT_TIMER_FLAG_PERIODIC | RT_TIMER_FLAG_HARD_TIMER);
+    rt_timer_start(&_tick_timer);
+
+    return 0;
+}
+MSH_CMD_EXPORT(ebus_base_example, publish a tick from a timer to two subscribers);
+
+#endif /* CCMP_USING_EXAMPLE_EBUS */
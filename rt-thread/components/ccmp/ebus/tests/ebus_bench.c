@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2025-12-20     RT-Thread    first version
+ */
+
+/*
+ * Host throughput and latency benchmark for ebus.
+ *
+ * cc -O2 -pthread -Ishim -I.. -o ebus_bench ebus_bench.c
+ * ./ebus_bench [messages]
+ *
+ * throughput: one publisher, N subscriber threads, 32 byte payloads. The
+ *             publisher spins when the pool is empty, subscribers use the
+ *             drop policy so every message is delivered exactly once.
+ * latency:    publish to return of ebus_recv() in another thread, measured
+ *             with one message in flight at a time.
+ */
+
+#include <stdlib.h>
+#include <sched.h>
+#include "../ebus.c"
+
+#define BENCH_PAYLOAD           32
+#define BENCH_DEPTH             64
+#define BENCH_SUB_MAX           8
+
+pthread_mutex_t shim_irq_lock = PTHREAD_MUTEX_INITIALIZER;
+
+struct bench_sub
+{
+    struct ebus_sub sub;
+    struct ebus_msg *queue[BENCH_DEPTH];
+    pthread_t tid;
+    long expect;
+    long got;
+    long bad;
+    double *lat_ns;
+};
+
+static double now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void *bench_sub_entry(void *parameter)
+{
+    struct bench_sub *b = parameter;
+    struct ebus_msg *msg;
+    double sent;
+
+    while (b->got < b->expect)
+    {
+        msg = ebus_recv(&b->sub, RT_WAITING_FOREVER);
+        if (b->lat_ns != NULL)
+        {
+            memcpy(&sent, msg->data, sizeof(sent));
+            b->lat_ns[b->got] = now_ns() - sent;
+        }
+        else if (msg->data[BENCH_PAYLOAD - 1] != (rt_uint8_t)b->got)
+        {
+            b->bad++;
+        }
+        b->got++;
+        ebus_msg_release(msg);
+    }
+
+    return NULL;
+}
+
+static void bench_start(struct bench_sub *subs, int num, long messages, double *lat_ns)
+{
+    int i;
+
+    for (i = 0; i < num; i++)
+    {
+        ebus_sub_init(&subs[i].sub, "bench", subs[i].queue, BENCH_DEPTH, EBUS_POLICY_DROP);
+        ebus_subscribe(&subs[i].sub, EBUS_TOPIC_LOG);
+        subs[i].expect = messages;
+        subs[i].got = 0;
+        subs[i].bad = 0;
+        subs[i].lat_ns = lat_ns;
+        pthread_create(&subs[i].tid, NULL, bench_sub_entry, &subs[i]);
+    }
+}
+
+static void bench_stop(struct bench_sub *subs, int num)
+{
+    int i;
+
+    for (i = 0; i < num; i++)
+    {
+        pthread_join(subs[i].tid, NULL);
+        ebus_sub_detach(&subs[i].sub);
+    }
+}
+
+/* wait until every subscriber has room, so that the drop policy never triggers */
+static void bench_wait_room(struct bench_sub *subs, int num)
+{
+    int i;
+
+    for (i = 0; i < num; i++)
+    {
+        while (subs[i].sub.count >= BENCH_DEPTH - 1)
+        {
+            sched_yield();
+        }
+    }
+}
+
+static void bench_throughput(int num, long messages)
+{
+    static struct bench_sub subs[BENCH_SUB_MAX];
+    struct ebus_msg *msg;
+    long n, bad = 0;
+    double start, ns;
+    int i;
+
+    bench_start(subs, num, messages, NULL);
+    start = now_ns();
+    for (n = 0; n < messages; n++)
+    {
+        bench_wait_room(subs, num);
+        while ((msg = ebus_msg_alloc(EBUS_TOPIC_LOG, BENCH_PAYLOAD)) == RT_NULL)
+        {
+            sched_yield();
+        }
+        memset(msg->data, 0x5A, BENCH_PAYLOAD - 1);
+        msg->data[BENCH_PAYLOAD - 1] = (rt_uint8_t)n;
+        ebus_publish(msg);
+    }
+    bench_stop(subs, num);
+    ns = now_ns() - start;
+
+    for (i = 0; i < num; i++)
+    {
+        bad += subs[i].bad + subs[i].sub.dropped;
+    }
+    printf("  %d subscriber%s  %8.0f msg/s  %9.0f deliveries/s  %6.0f ns/msg  %s\n", num, num > 1 ? "s" : " ",
+           messages * 1e9 / ns, messages * num * 1e9 / ns, ns / messages, bad ? "LOST" : "ok");
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+
+    return x < y ? -1 : x > y;
+}
+
+static void bench_latency(long messages)
+{
+    static struct bench_sub sub;
+    struct ebus_msg *msg;
+    double *lat, sent;
+    long n;
+
+    lat = calloc(messages, sizeof(double));
+    bench_start(&sub, 1, messages, lat);
+    for (n = 0; n < messages; n++)
+    {
+        while (sub.got < n)
+        {
+            sched_yield();
+        }
+        msg = ebus_msg_alloc(EBUS_TOPIC_LOG, sizeof(double));
+        sent = now_ns();
+        memcpy(msg->data, &sent, sizeof(sent));
+        ebus_publish(msg);
+    }
+    bench_stop(&sub, 1);
+
+    qsort(lat, messages, sizeof(double), cmp_double);
+    printf("  publish -> recv  p50 %.0f ns  p99 %.0f ns  max %.0f ns\n",
+           lat[messages / 2], lat[messages * 99 / 100], lat[messages - 1]);
+    free(lat);
+}
+
+int main(int argc, char **argv)
+{
+    long messages = argc > 1 ? atol(argv[1]) : 200000;
+    static const int subs[] = { 1, 2, 4, 8 };
+    unsigned i;
+
+    ebus_init();
+
+    printf("throughput, %ld messages of %d bytes\n", messages, BENCH_PAYLOAD);
+    for (i = 0; i < sizeof(subs) / sizeof(subs[0]); i++)
+    {
+        bench_throughput(subs[i], messages);
+    }
+
+    printf("latency, %ld messages\n", messages / 10);
+    bench_latency(messages / 10);
+
+    if (_pool.block_free_count != _pool.block_total_count)
+    {
+        printf("pool leak: %zu of %zu blocks free\n", _pool.block_free_count, _pool.block_total_count);
+        return 1;
+    }
+
+    return 0;
+}
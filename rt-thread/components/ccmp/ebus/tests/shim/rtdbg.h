@@ -0,0 +1,10 @@
+/* host shim, see rtthread.h */
+#ifndef __EBUS_SHIM_RTDBG_H__
+#define __EBUS_SHIM_RTDBG_H__
+
+#include <stdio.h>
+
+#define LOG_E(fmt, ...)         printf("E/" DBG_TAG ": " fmt "\n", ##__VA_ARGS__)
+#define LOG_D(fmt, ...)
+
+#endif /* __EBUS_SHIM_RTDBG_H__ */
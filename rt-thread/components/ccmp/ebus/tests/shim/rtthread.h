@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2025-12-20     RT-Thread    first version
+ */
+
+/*
+ * Just enough of the RT-Thread API on top of pthreads to run ebus.c on the
+ * host. The interrupt lock is one global mutex, a tick is a millisecond.
+ */
+
+#ifndef __EBUS_SHIM_RTTHREAD_H__
+#define __EBUS_SHIM_RTTHREAD_H__
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define EBUS_MSG_SIZE           64
+#define EBUS_MSG_NUM            256
+
+typedef int8_t rt_int8_t;
+typedef int16_t rt_int16_t;
+typedef int32_t rt_int32_t;
+typedef uint8_t rt_uint8_t;
+typedef uint16_t rt_uint16_t;
+typedef uint32_t rt_uint32_t;
+typedef long rt_base_t;
+typedef unsigned long rt_ubase_t;
+typedef int rt_err_t;
+typedef rt_base_t rt_bool_t;
+typedef rt_uint32_t rt_tick_t;
+typedef size_t rt_size_t;
+typedef rt_base_t rt_atomic_t;
+
+#define RT_NULL                 NULL
+#define RT_TRUE                 1
+#define RT_FALSE                0
+#define RT_EOK                  0
+#define RT_ERROR                1
+#define RT_ETIMEOUT             2
+#define RT_EFULL                3
+#define RT_EEMPTY               4
+#define RT_ENOMEM               5
+#define RT_EINVAL               10
+#define RT_WAITING_FOREVER      -1
+#define RT_IPC_FLAG_PRIO        1
+#define RT_ALIGN_SIZE           8
+#define RT_ALIGN(size, align)   (((size) + (align) - 1) & ~((align) - 1))
+#define rt_inline               static inline
+#define rt_align(n)             __attribute__((aligned(n)))
+
+#define rt_memcpy               memcpy
+#define rt_memset               memset
+#define rt_kprintf              printf
+
+#define INIT_COMPONENT_EXPORT(fn)
+#define MSH_CMD_EXPORT(cmd, desc)
+
+#define rt_atomic_store(ptr, v) __atomic_store_n(ptr, v, __ATOMIC_SEQ_CST)
+#define rt_atomic_add(ptr, v)   __atomic_fetch_add(ptr, v, __ATOMIC_SEQ_CST)
+
+rt_inline rt_bool_t rt_atomic_dec_and_test(volatile rt_atomic_t *ptr)
+{
+    return __atomic_fetch_sub(ptr, 1, __ATOMIC_SEQ_CST) == 1;
+}
+
+rt_inline int __rt_ffs(int value)
+{
+    return __builtin_ffs(value);
+}
+
+extern pthread_mutex_t shim_irq_lock;
+
+rt_inline rt_base_t rt_hw_interrupt_disable(void)
+{
+    pthread_mutex_lock(&shim_irq_lock);
+    return 0;
+}
+
+rt_inline void rt_hw_interrupt_enable(rt_base_t level)
+{
+    (void)level;
+    pthread_mutex_unlock(&shim_irq_lock);
+}
+
+rt_inline rt_tick_t rt_tick_get(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (rt_tick_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+struct rt_mempool
+{
+    pthread_mutex_t lock;
+    void *block_list;
+    rt_size_t block_size;
+    rt_size_t block_total_count;
+    rt_size_t block_free_count;
+};
+
+rt_inline rt_err_t rt_mp_init(struct rt_mempool *mp, const char *name, void *start, rt_size_t size,
+                              rt_size_t block_size)
+{
+    rt_uint8_t *p = start;
+    rt_size_t i;
+
+    (void)name;
+    pthread_mutex_init(&mp->lock, NULL);
+    mp->block_size = block_size;
+    mp->block_total_count = size / (block_size + sizeof(void *));
+    mp->block_free_count = mp->block_total_count;
+    mp->block_list = NULL;
+    for (i = 0; i < mp->block_total_count; i++, p += block_size + sizeof(void *))
+    {
+        *(void **)p = mp->block_list;
+        mp->block_list = p;
+    }
+    return RT_EOK;
+}
+
+rt_inline void *rt_mp_alloc(struct rt_mempool *mp, rt_int32_t time)
+{
+    rt_uint8_t *p;
+
+    (void)time;
+    pthread_mutex_lock(&mp->lock);
+    p = mp->block_list;
+    if (p != NULL)
+    {
+        mp->block_list = *(void **)p;
+        mp->block_free_count--;
+        /* like RT-Thread, the block header points back to its pool */
+        *(struct rt_mempool **)p = mp;
+        p += sizeof(void *);
+    }
+    pthread_mutex_unlock(&mp->lock);
+    return p;
+}
+
+rt_inline void rt_mp_free(void *block)
+{
+    rt_uint8_t *p = (rt_uint8_t *)block - sizeof(void *);
+    struct rt_mempool *mp = *(struct rt_mempool **)p;
+
+    pthread_mutex_lock(&mp->lock);
+    *(void **)p = mp->block_list;
+    mp->block_list = p;
+    mp->block_free_count++;
+    pthread_mutex_unlock(&mp->lock);
+}
+
+struct rt_semaphore
+{
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    rt_uint32_t value;
+};
+
+rt_inline rt_err_t rt_sem_init(struct rt_semaphore *sem, const char *name, rt_uint32_t value, rt_uint8_t flag)
+{
+    (void)name;
+    (void)flag;
+    pthread_mutex_init(&sem->lock, NULL);
+    pthread_cond_init(&sem->cond, NULL);
+    sem->value = value;
+    return RT_EOK;
+}
+
+rt_inline rt_err_t rt_sem_detach(struct rt_semaphore *sem)
+{
+    pthread_cond_destroy(&sem->cond);
+    pthread_mutex_destroy(&sem->lock);
+    return RT_EOK;
+}
+
+rt_inline rt_err_t rt_sem_take(struct rt_semaphore *sem, rt_int32_t time)
+{
+    struct timespec ts;
+    rt_err_t ret = RT_EOK;
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    if (time > 0)
+    {
+        ts.tv_sec += time / 1000;
+        ts.tv_nsec += (long)(time % 1000) * 1000000;
+        if (ts.tv_nsec >= 1000000000)
+        {
+            ts.tv_sec++;
+            ts.tv_nsec -= 1000000000;
+        }
+    }
+    pthread_mutex_lock(&sem->lock);
+    while (sem->value == 0 && ret == RT_EOK)
+    {
+        if (time == 0)
+            ret = -RT_ETIMEOUT;
+        else if (time < 0)
+            pthread_cond_wait(&sem->cond, &sem->lock);
+        else if (pthread_cond_timedwait(&sem->cond, &sem->lock, &ts) == ETIMEDOUT)
+            ret = -RT_ETIMEOUT;
+    }
+    if (ret == RT_EOK)
+    {
+        sem->value--;
+    }
+    pthread_mutex_unlock(&sem->lock);
+    return ret;
+}
+
+rt_inline rt_err_t rt_sem_release(struct rt_semaphore *sem)
+{
+    pthread_mutex_lock(&sem->lock);
+    sem->value++;
+    pthread_cond_signal(&sem->cond);
+    pthread_mutex_unlock(&sem->lock);
+    return RT_EOK;
+}
+
+#endif /* __EBUS_SHIM_RTTHREAD_H__ */
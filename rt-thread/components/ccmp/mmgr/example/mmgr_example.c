@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2025-12-22     RT-Thread    first version
+ */
+
+#include "mmgr.h"
+
+#ifdef CCMP_USING_EXAMPLE_MMGR
+
+/* boot record kept in a FlashDB blob: bit fields and varints keep it short */
+#define EXAMPLE_BOOT_INFO(F, A, s)                      \
+    F(s, rt_uint32_t, count,        MMGR_VARINT)        \
+    F(s, rt_uint8_t,  reason,       MMGR_BITS(3))       \
+    F(s, rt_uint8_t,  slot,         MMGR_BITS(1))       \
+    F(s, rt_uint8_t,  crashed,      MMGR_BITS(1))       \
+    F(s, rt_int16_t,  temp,         MMGR_VARINT)        \
+    F(s, rt_uint32_t, uptime_s,     MMGR_VARINT)        \
+    A(s, rt_uint8_t,  version,      4)
+
+/* UDS response, big endian; same layout in memory but byte swapped on the wire */
+#define EXAMPLE_UDS_INFO(F, A, s)                       \
+    F(s, rt_uint16_t, did,          MMGR_FIXED)         \
+    F(s, rt_uint16_t, voltage_mv,   MMGR_FIXED)         \
+    F(s, rt_uint32_t, odometer,     MMGR_FIXED)
+
+/* CAN calibration block, native order and no padding: a plain memcpy */
+#define EXAMPLE_CALIB(F, A, s)                          \
+    F(s, rt_uint32_t, magic,        MMGR_FIXED)         \
+    F(s, rt_int16_t,  offset,       MMGR_FIXED)         \
+    F(s, rt_uint16_t, gain,         MMGR_FIXED)         \
+    A(s, rt_uint8_t,  map,          8)
+
+MMGR_STRUCT(example_boot_info, EXAMPLE_BOOT_INFO);
+MMGR_STRUCT(example_uds_info, EXAMPLE_UDS_INFO);
+MMGR_STRUCT(example_calib, EXAMPLE_CALIB);
+
+MMGR_SCHEMA(example_boot_info, EXAMPLE_BOOT_INFO, MMGR_LE);
+MMGR_SCHEMA(example_uds_info, EXAMPLE_UDS_INFO, MMGR_BE);
+MMGR_SCHEMA(example_calib, EXAMPLE_CALIB, MMGR_LE);
+
+static void example_dump(const struct mmgr_schema *schema, const void *obj)
+{
+    rt_uint8_t buf[64], back[64];
+    rt_ssize_t len, i;
+
+    len = mmgr_pack(schema, obj, buf, sizeof(buf));
+    if (len < 0)
+    {
+        rt_kprintf("%s: pack failed %d\n", schema->name, (int)len);
+        return;
+    }
+    rt_kprintf("%-18s struct %2u, wire %2d/%2u%s:", schema->name, schema->struct_size, (int)len, schema->wire_max,
+               (schema->flags & MMGR_SCHEMA_MEMCPY) ? " memcpy" : "");
+    for (i = 0; i < len; i++)
+    {
+        rt_kprintf(" %02x", buf[i]);
+    }
+
+    rt_memset(back, 0, sizeof(back));
+    if (mmgr_unpack(schema, back, buf, len) != len || rt_memcmp(back, obj, schema->struct_size) != 0)
+    {
+        rt_kprintf("  round trip FAILED");
+    }
+    rt_kprintf("\n");
+}
+
+static int mmgr_example(void)
+{
+    /* zero the padding too, the round trip compares whole structs */
+    struct example_boot_info boot;
+    struct example_uds_info uds;
+    struct example_calib calib;
+    int i;
+
+    rt_memset(&boot, 0, sizeof(boot));
+    boot.count = 1234;
+    boot.reason = 5;
+    boot.slot = 1;
+    boot.crashed = 0;
+    boot.temp = -12;
+    boot.uptime_s = 86400;
+    boot.version[0] = 1;
+    boot.version[1] = 2;
+
+    rt_memset(&uds, 0, sizeof(uds));
+    uds.did = 0xF190;
+    uds.voltage_mv = 13800;
+    uds.odometer = 123456;
+
+    rt_memset(&calib, 0, sizeof(calib));
+    calib.magic = 0xCA11B000;
+    calib.offset = -100;
+    calib.gain = 1024;
+    for (i = 0; i < 8; i++)
+    {
+        calib.map[i] = i * 16;
+    }
+
+    example_dump(&example_boot_info_schema, &boot);
+    example_dump(&example_uds_info_schema, &uds);
+    example_dump(&example_calib_schema, &calib);
+
+    return 0;
+}
+MSH_CMD_EXPORT(mmgr_example, pack and unpack sample records);
+
+#endif /* CCMP_USING_EXAMPLE_MMGR */
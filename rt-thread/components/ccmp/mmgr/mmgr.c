@@ -0,0 +1,336 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2025-12-22     RT-Thread    first version
+ */
+
+#include "mmgr.h"
+
+/*
+ * Read an integer of any supported size from the struct, sign extended.
+ * Each case copies a constant size so that it compiles to a single load.
+ */
+rt_inline rt_uint64_t mmgr_load(const void *p, rt_uint8_t size, rt_uint8_t is_signed)
+{
+    rt_uint8_t u8;
+    rt_uint16_t u16;
+    rt_uint32_t u32;
+    rt_uint64_t u64;
+
+    switch (size)
+    {
+    case 1:
+        u8 = *(const rt_uint8_t *)p;
+        return is_signed ? (rt_uint64_t)(rt_int64_t)(rt_int8_t)u8 : u8;
+    case 2:
+        rt_memcpy(&u16, p, 2);
+        return is_signed ? (rt_uint64_t)(rt_int64_t)(rt_int16_t)u16 : u16;
+    case 4:
+        rt_memcpy(&u32, p, 4);
+        return is_signed ? (rt_uint64_t)(rt_int64_t)(rt_int32_t)u32 : u32;
+    default:
+        rt_memcpy(&u64, p, 8);
+        return u64;
+    }
+}
+
+rt_inline void mmgr_store(void *p, rt_uint8_t size, rt_uint64_t value)
+{
+    rt_uint16_t u16;
+    rt_uint32_t u32;
+
+    switch (size)
+    {
+    case 1:
+        *(rt_uint8_t *)p = (rt_uint8_t)value;
+        break;
+    case 2:
+        u16 = (rt_uint16_t)value;
+        rt_memcpy(p, &u16, 2);
+        break;
+    case 4:
+        u32 = (rt_uint32_t)value;
+        rt_memcpy(p, &u32, 4);
+        break;
+    default:
+        rt_memcpy(p, &value, 8);
+        break;
+    }
+}
+
+rt_inline rt_uint64_t mmgr_swap(rt_uint64_t v, rt_uint8_t size)
+{
+    rt_uint64_t r = 0;
+    rt_uint8_t i;
+
+    for (i = 0; i < size; i++, v >>= 8)
+    {
+        r = (r << 8) | (v & 0xFF);
+    }
+
+    return r;
+}
+
+/* copy fixed elements, swapping each one when the wire order is not the CPU order */
+rt_inline void mmgr_copy_fixed(rt_uint8_t *dst, const rt_uint8_t *src, const struct mmgr_field *f, rt_uint8_t order)
+{
+    rt_uint16_t i;
+
+    if (f->count == 1)
+    {
+        /* the common case, constant size copies the compiler can inline */
+        if (order == MMGR_HOST_ORDER)
+        {
+            mmgr_store(dst, f->size, mmgr_load(src, f->size, 0));
+        }
+        else
+        {
+            mmgr_store(dst, f->size, mmgr_swap(mmgr_load(src, f->size, 0), f->size));
+        }
+        return;
+    }
+    if (order == MMGR_HOST_ORDER || f->size == 1)
+    {
+        rt_memcpy(dst, src, (rt_size_t)f->size * f->count);
+        return;
+    }
+    for (i = 0; i < f->count; i++, dst += f->size, src += f->size)
+    {
+        mmgr_store(dst, f->size, mmgr_swap(mmgr_load(src, f->size, 0), f->size));
+    }
+}
+
+/**
+ * @brief Pack a struct into its wire format.
+ *
+ * @return the number of bytes written, or -RT_EFULL if buf is too small.
+ *         A buffer of schema->wire_max bytes is always enough.
+ */
+rt_ssize_t mmgr_pack(const struct mmgr_schema *schema, const void *obj, rt_uint8_t *buf, rt_size_t size)
+{
+    const struct mmgr_field *f = schema->fields;
+    const struct mmgr_field *end = f + schema->field_num;
+    const rt_uint8_t *p;
+    rt_uint64_t v, acc = 0;
+    rt_uint8_t nacc = 0;        /* bits pending in acc, a run of bit fields is open if > 0 */
+    rt_size_t pos = 0, n;
+
+    if (schema->flags & MMGR_SCHEMA_MEMCPY)
+    {
+        if (size < schema->struct_size)
+        {
+            return -RT_EFULL;
+        }
+        rt_memcpy(buf, obj, schema->struct_size);
+        return schema->struct_size;
+    }
+
+    for (; f < end; f++)
+    {
+        p = (const rt_uint8_t *)obj + f->offset;
+
+        if (f->enc == MMGR_ENC_BITS)
+        {
+            v = mmgr_load(p, f->size, 0) & ((1ULL << f->bits) - 1);
+            if (schema->order == MMGR_LE)
+            {
+                /* low bits first, from bit 0 of each byte upwards */
+                acc |= v << nacc;
+                nacc += f->bits;
+                for (; nacc >= 8; nacc -= 8, acc >>= 8)
+                {
+                    if (pos >= size)
+                    {
+                        return -RT_EFULL;
+                    }
+                    buf[pos++] = (rt_uint8_t)acc;
+                }
+            }
+            else
+            {
+                /* high bits first, from bit 7 of each byte downwards */
+                acc = (acc << f->bits) | v;
+                nacc += f->bits;
+                for (; nacc >= 8; nacc -= 8)
+                {
+                    if (pos >= size)
+                    {
+                        return -RT_EFULL;
+                    }
+                    buf[pos++] = (rt_uint8_t)(acc >> (nacc - 8));
+                }
+            }
+            continue;
+        }
+
+        if (nacc)
+        {
+            /* close the run of bit fields, the rest of the byte stays zero */
+            if (pos >= size)
+            {
+                return -RT_EFULL;
+            }
+            buf[pos++] = (rt_uint8_t)(schema->order == MMGR_LE ? acc : acc << (8 - nacc));
+            acc = 0;
+            nacc = 0;
+        }
+
+        if (f->enc == MMGR_ENC_FIXED)
+        {
+            n = (rt_size_t)f->size * f->count;
+            if (pos + n > size)
+            {
+                return -RT_EFULL;
+            }
+            mmgr_copy_fixed(buf + pos, p, f, schema->order);
+            pos += n;
+        }
+        else /* MMGR_ENC_VARINT */
+        {
+            v = mmgr_load(p, f->size, f->is_signed);
+            if (f->is_signed)
+            {
+                /* zigzag: small magnitudes of either sign stay short */
+                v = (v << 1) ^ (rt_uint64_t)((rt_int64_t)v >> 63);
+            }
+            for (; v > 0x7F; v >>= 7)
+            {
+                if (pos >= size)
+                {
+                    return -RT_EFULL;
+                }
+                buf[pos++] = (rt_uint8_t)(v | 0x80);
+            }
+            if (pos >= size)
+            {
+                return -RT_EFULL;
+            }
+            buf[pos++] = (rt_uint8_t)v;
+        }
+    }
+
+    if (nacc)
+    {
+        if (pos >= size)
+        {
+            return -RT_EFULL;
+        }
+        buf[pos++] = (rt_uint8_t)(schema->order == MMGR_LE ? acc : acc << (8 - nacc));
+    }
+
+    return pos;
+}
+
+/**
+ * @brief Unpack a wire format into a struct.
+ *
+ * @return the number of bytes consumed, or -RT_EINVAL if the data is
+ *         truncated or a varint is too long for its field.
+ */
+rt_ssize_t mmgr_unpack(const struct mmgr_schema *schema, void *obj, const rt_uint8_t *buf, rt_size_t len)
+{
+    const struct mmgr_field *f = schema->fields;
+    const struct mmgr_field *end = f + schema->field_num;
+    rt_uint8_t *p, nacc = 0, shift;
+    rt_uint64_t v, b, acc = 0;
+    rt_size_t pos = 0, n;
+
+    if (schema->flags & MMGR_SCHEMA_MEMCPY)
+    {
+        if (len < schema->struct_size)
+        {
+            return -RT_EINVAL;
+        }
+        rt_memcpy(obj, buf, schema->struct_size);
+        return schema->struct_size;
+    }
+
+    for (; f < end; f++)
+    {
+        p = (rt_uint8_t *)obj + f->offset;
+
+        if (f->enc == MMGR_ENC_BITS)
+        {
+            for (; nacc < f->bits; nacc += 8)
+            {
+                if (pos >= len)
+                {
+                    return -RT_EINVAL;
+                }
+                if (schema->order == MMGR_LE)
+                {
+                    acc |= (rt_uint64_t)buf[pos++] << nacc;
+                }
+                else
+                {
+                    acc = (acc << 8) | buf[pos++];
+                }
+            }
+            if (schema->order == MMGR_LE)
+            {
+                v = acc & ((1ULL << f->bits) - 1);
+                acc >>= f->bits;
+            }
+            else
+            {
+                v = (acc >> (nacc - f->bits)) & ((1ULL << f->bits) - 1);
+            }
+            nacc -= f->bits;
+            if (f->is_signed && (v >> (f->bits - 1)) & 1)
+            {
+                v |= ~0ULL << f->bits;
+            }
+            mmgr_store(p, f->size, v);
+            continue;
+        }
+
+        /* whatever is left of the last bit field byte is padding */
+        acc = 0;
+        nacc = 0;
+
+        if (f->enc == MMGR_ENC_FIXED)
+        {
+            n = (rt_size_t)f->size * f->count;
+            if (pos + n > len)
+            {
+                return -RT_EINVAL;
+            }
+            mmgr_copy_fixed(p, buf + pos, f, schema->order);
+            pos += n;
+        }
+        else /* MMGR_ENC_VARINT */
+        {
+            if (pos >= len)
+            {
+                return -RT_EINVAL;
+            }
+            v = buf[pos++];
+            if (v & 0x80)
+            {
+                v &= 0x7F;
+                shift = 7;
+                do
+                {
+                    if (pos >= len || shift >= f->size * 8)
+                    {
+                        return -RT_EINVAL;
+                    }
+                    b = buf[pos++];
+                    v |= (b & 0x7F) << shift;
+                    shift += 7;
+                } while (b & 0x80);
+            }
+            if (f->is_signed)
+            {
+                v = (v >> 1) ^ (0 - (v & 1));
+            }
+            mmgr_store(p, f->size, v);
+        }
+    }
+
+    return pos;
+}
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2025-12-22     RT-Thread    first version
+ */
+
+#ifndef __MMGR_H__
+#define __MMGR_H__
+
+#include <rtthread.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * A record is described once as an X-macro list and both the C struct
+ * and its wire schema are generated from it. The list takes the struct
+ * name so that every entry can resolve its offset:
+ *
+ *   #define BOOT_INFO(F, A, s)                          \
+ *       F(s, rt_uint32_t, count,    MMGR_FIXED)         \
+ *       F(s, rt_uint8_t,  reason,   MMGR_BITS(4))       \
+ *       F(s, rt_uint8_t,  slot,     MMGR_BITS(4))       \
+ *       F(s, rt_uint32_t, uptime_s, MMGR_VARINT)        \
+ *       A(s, rt_uint8_t,  version,  4)
+ *
+ *   MMGR_STRUCT(boot_info, BOOT_INFO);                  in a header
+ *   MMGR_SCHEMA(boot_info, BOOT_INFO, MMGR_LE);         in one source file
+ *
+ * gives `struct boot_info` and `const struct mmgr_schema boot_info_schema`.
+ *
+ * Wire encodings:
+ *   MMGR_FIXED     the full integer in the schema byte order
+ *   MMGR_BITS(n)   the low n bits (n <= 32), packed with neighbouring bit
+ *                  fields, LSB first for MMGR_LE and MSB first for MMGR_BE
+ *   MMGR_VARINT    LEB128, zigzag for signed types
+ *   A(...)         array of fixed elements
+ *
+ * When every field is fixed, the struct has no padding and the schema
+ * order is the CPU order, pack and unpack are a single memcpy.
+ */
+
+/* byte order */
+#define MMGR_LE                 0
+#define MMGR_BE                 1
+
+/* armcc only defines __BIG_ENDIAN for big endian targets, libc headers always do */
+#if defined(__BYTE_ORDER__)
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define MMGR_HOST_ORDER         MMGR_BE
+#endif
+#elif defined(__CC_ARM) && defined(__BIG_ENDIAN)
+#define MMGR_HOST_ORDER         MMGR_BE
+#endif
+#ifndef MMGR_HOST_ORDER
+#define MMGR_HOST_ORDER         MMGR_LE
+#endif
+
+/* mmgr_field.enc */
+#define MMGR_ENC_FIXED          0
+#define MMGR_ENC_BITS           1
+#define MMGR_ENC_VARINT         2
+
+/* encoding arguments of the X-macro list: enc, bits */
+#define MMGR_FIXED              MMGR_ENC_FIXED, 0
+#define MMGR_BITS(n)            MMGR_ENC_BITS, (n)
+#define MMGR_VARINT             MMGR_ENC_VARINT, 0
+
+/* mmgr_schema.flags */
+#define MMGR_SCHEMA_MEMCPY      0x01    /* wire format == memory layout */
+
+struct mmgr_field
+{
+    const char *name;
+    rt_uint16_t offset;         /* in the struct */
+    rt_uint16_t count;          /* array elements, 1 for scalars */
+    rt_uint8_t size;            /* element size in the struct: 1, 2, 4 or 8 */
+    rt_uint8_t is_signed;
+    rt_uint8_t enc;
+    rt_uint8_t bits;
+};
+
+struct mmgr_schema
+{
+    const char *name;
+    const struct mmgr_field *fields;
+    rt_uint16_t field_num;
+    rt_uint16_t struct_size;
+    rt_uint16_t wire_max;       /* worst case packed size */
+    rt_uint8_t order;
+    rt_uint8_t flags;
+};
+
+/* helpers for the generator macros below */
+#define MMGR_ENC_OF_(enc, bits)             (enc)
+#define MMGR_ENC_OF(...)                    MMGR_ENC_OF_(__VA_ARGS__)
+#define MMGR_IS_SIGNED(type)                ((type)-1 < (type)1)
+#define MMGR_VARINT_MAX(type)               ((sizeof(type) * 8 + 6) / 7)
+
+#define MMGR_STRUCT_F_(s, type, name, enc)      type name;
+#define MMGR_STRUCT_A_(s, type, name, n)        type name[n];
+
+#define MMGR_FIELD_F_(s, type, name, enc) \
+    { #name, offsetof(struct s, name), 1, sizeof(type), MMGR_IS_SIGNED(type), enc },
+#define MMGR_FIELD_A_(s, type, name, n) \
+    { #name, offsetof(struct s, name), (n), sizeof(type), MMGR_IS_SIGNED(type), MMGR_FIXED },
+
+#define MMGR_WIRE_F_(s, type, name, enc) \
+    + (MMGR_ENC_OF(enc) == MMGR_ENC_VARINT ? MMGR_VARINT_MAX(type) : sizeof(type))
+#define MMGR_WIRE_A_(s, type, name, n)          + sizeof(type) * (n)
+
+#define MMGR_SIZE_F_(s, type, name, enc)        + sizeof(type)
+#define MMGR_SIZE_A_(s, type, name, n)          + sizeof(type) * (n)
+
+#define MMGR_FIXED_F_(s, type, name, enc)       && MMGR_ENC_OF(enc) == MMGR_ENC_FIXED
+#define MMGR_FIXED_A_(s, type, name, n)
+
+#define MMGR_COUNT_F_(s, type, name, enc)       + 1
+#define MMGR_COUNT_A_(s, type, name, n)         + 1
+
+/**
+ * @brief Declare the struct of a record list and its schema.
+ */
+#define MMGR_STRUCT(s, LIST)                                                            \
+    struct s { LIST(MMGR_STRUCT_F_, MMGR_STRUCT_A_, s) };                               \
+    extern const struct mmgr_schema s##_schema
+
+/**
+ * @brief Define the const schema `<s>_schema` of a record list.
+ */
+#define MMGR_SCHEMA(s, LIST, byte_order)                                                \
+    static const struct mmgr_field s##_fields[] =                                       \
+    {                                                                                   \
+        LIST(MMGR_FIELD_F_, MMGR_FIELD_A_, s)                                           \
+    };                                                                                  \
+    const struct mmgr_schema s##_schema =                                               \
+    {                                                                                   \
+        #s, s##_fields, 0 LIST(MMGR_COUNT_F_, MMGR_COUNT_A_, s), sizeof(struct s),      \
+        0 LIST(MMGR_WIRE_F_, MMGR_WIRE_A_, s), (byte_order),                            \
+        ((byte_order) == MMGR_HOST_ORDER && (1 LIST(MMGR_FIXED_F_, MMGR_FIXED_A_, s))   \
+         && sizeof(struct s) == 0 LIST(MMGR_SIZE_F_, MMGR_SIZE_A_, s))                  \
+            ? MMGR_SCHEMA_MEMCPY : 0                                                    \
+    }
+
+rt_ssize_t mmgr_pack(const struct mmgr_schema *schema, const void *obj, rt_uint8_t *buf, rt_size_t size);
+rt_ssize_t mmgr_unpack(const struct mmgr_schema *schema, void *obj, const rt_uint8_t *buf, rt_size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __MMGR_H__ */
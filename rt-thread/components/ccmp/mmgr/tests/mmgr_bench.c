@@ -0,0 +1,342 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2025-12-22     RT-Thread    first version
+ */
+
+/*
+ * Host check and benchmark for mmgr.
+ *
+ * cc -O2 -Ishim -I.. -o mmgr_bench mmgr_bench.c
+ * ./mmgr_bench [loops]
+ *
+ * Every record is packed and unpacked three ways and the results must be
+ * byte identical:
+ *   engine     mmgr_pack()/mmgr_unpack() with the generated schema
+ *   hand       code written for that one record
+ *   naive      the same descriptors, one byte or one bit per iteration
+ */
+
+#include <stdlib.h>
+#include <time.h>
+
+#define CCMP_USING_EXAMPLE_MMGR
+#include "../mmgr.c"
+#include "../example/mmgr_example.c"
+
+/* mixed record: fixed, bit fields and varints */
+#define BENCH_MIXED(F, A, s)                            \
+    F(s, rt_uint32_t, id,           MMGR_FIXED)         \
+    F(s, rt_uint16_t, voltage,      MMGR_FIXED)         \
+    F(s, rt_uint8_t,  mode,         MMGR_BITS(3))       \
+    F(s, rt_uint8_t,  valid,        MMGR_BITS(1))       \
+    F(s, rt_uint16_t, level,        MMGR_BITS(10))      \
+    F(s, rt_uint32_t, counter,      MMGR_VARINT)        \
+    F(s, rt_int32_t,  delta,        MMGR_VARINT)        \
+    F(s, rt_int16_t,  temp,         MMGR_FIXED)
+
+/* plain record: all fixed, no padding */
+#define BENCH_PLAIN(F, A, s)                            \
+    F(s, rt_uint32_t, id,           MMGR_FIXED)         \
+    F(s, rt_uint32_t, time,         MMGR_FIXED)         \
+    F(s, rt_uint16_t, voltage,      MMGR_FIXED)         \
+    F(s, rt_int16_t,  current,      MMGR_FIXED)         \
+    F(s, rt_uint16_t, soc,          MMGR_FIXED)         \
+    F(s, rt_uint16_t, flags,        MMGR_FIXED)         \
+    A(s, rt_uint8_t,  cells,        8)
+
+MMGR_STRUCT(bench_mixed, BENCH_MIXED);
+MMGR_STRUCT(bench_plain, BENCH_PLAIN);
+MMGR_SCHEMA(bench_mixed, BENCH_MIXED, MMGR_LE);
+MMGR_SCHEMA(bench_plain, BENCH_PLAIN, MMGR_LE);
+
+/* same plain record in big endian, so the fast path does not apply */
+static const struct mmgr_schema bench_plain_be_schema =
+{
+    "bench_plain_be", bench_plain_fields, sizeof(bench_plain_fields) / sizeof(bench_plain_fields[0]),
+    sizeof(struct bench_plain), sizeof(struct bench_plain), MMGR_BE, 0
+};
+
+/* hand written, the way records were serialized before */
+static size_t hand_pack_mixed(const struct bench_mixed *m, rt_uint8_t *b)
+{
+    rt_uint32_t u, z;
+    size_t n = 0;
+
+    b[n++] = m->id; b[n++] = m->id >> 8; b[n++] = m->id >> 16; b[n++] = m->id >> 24;
+    b[n++] = m->voltage; b[n++] = m->voltage >> 8;
+    b[n++] = (m->mode & 7) | (m->valid & 1) << 3 | (m->level & 0xF) << 4;
+    b[n++] = (m->level >> 4) & 0x3F;
+    for (u = m->counter; u > 0x7F; u >>= 7)
+        b[n++] = (u & 0x7F) | 0x80;
+    b[n++] = u;
+    z = ((rt_uint32_t)m->delta << 1) ^ (rt_uint32_t)(m->delta >> 31);
+    for (; z > 0x7F; z >>= 7)
+        b[n++] = (z & 0x7F) | 0x80;
+    b[n++] = z;
+    b[n++] = m->temp; b[n++] = (rt_uint16_t)m->temp >> 8;
+    return n;
+}
+
+static size_t hand_unpack_mixed(struct bench_mixed *m, const rt_uint8_t *b)
+{
+    rt_uint32_t v;
+    size_t n = 8;
+    int s;
+
+    m->id = b[0] | b[1] << 8 | b[2] << 16 | (rt_uint32_t)b[3] << 24;
+    m->voltage = b[4] | b[5] << 8;
+    m->mode = b[6] & 7;
+    m->valid = (b[6] >> 3) & 1;
+    m->level = b[6] >> 4 | (b[7] & 0x3F) << 4;
+    for (v = 0, s = 0; b[n] & 0x80; s += 7)
+        v |= (rt_uint32_t)(b[n++] & 0x7F) << s;
+    m->counter = v | (rt_uint32_t)b[n++] << s;
+    for (v = 0, s = 0; b[n] & 0x80; s += 7)
+        v |= (rt_uint32_t)(b[n++] & 0x7F) << s;
+    v |= (rt_uint32_t)b[n++] << s;
+    m->delta = (rt_int32_t)((v >> 1) ^ (0 - (v & 1)));
+    m->temp = b[n] | b[n + 1] << 8;
+    return n + 2;
+}
+
+static size_t hand_pack_plain(const struct bench_plain *m, rt_uint8_t *b)
+{
+    b[0] = m->id; b[1] = m->id >> 8; b[2] = m->id >> 16; b[3] = m->id >> 24;
+    b[4] = m->time; b[5] = m->time >> 8; b[6] = m->time >> 16; b[7] = m->time >> 24;
+    b[8] = m->voltage; b[9] = m->voltage >> 8;
+    b[10] = m->current; b[11] = (rt_uint16_t)m->current >> 8;
+    b[12] = m->soc; b[13] = m->soc >> 8;
+    b[14] = m->flags; b[15] = m->flags >> 8;
+    memcpy(&b[16], m->cells, 8);
+    return 24;
+}
+
+static size_t hand_unpack_plain(struct bench_plain *m, const rt_uint8_t *b)
+{
+    m->id = b[0] | b[1] << 8 | b[2] << 16 | (rt_uint32_t)b[3] << 24;
+    m->time = b[4] | b[5] << 8 | b[6] << 16 | (rt_uint32_t)b[7] << 24;
+    m->voltage = b[8] | b[9] << 8;
+    m->current = b[10] | b[11] << 8;
+    m->soc = b[12] | b[13] << 8;
+    m->flags = b[14] | b[15] << 8;
+    memcpy(m->cells, &b[16], 8);
+    return 24;
+}
+
+/* naive interpreter: every byte through a 64-bit shift, every bit field bit by bit */
+static size_t naive_pack(const struct mmgr_schema *schema, const void *obj, rt_uint8_t *buf)
+{
+    const struct mmgr_field *f;
+    size_t pos = 0, bitpos = 0;
+    rt_uint64_t v;
+    int i, e, j;
+
+    for (i = 0; i < schema->field_num; i++)
+    {
+        f = &schema->fields[i];
+        if (f->enc != MMGR_ENC_BITS && bitpos)
+        {
+            pos += (bitpos + 7) / 8;
+            bitpos = 0;
+        }
+        for (e = 0; e < f->count; e++)
+        {
+            v = mmgr_load((const rt_uint8_t *)obj + f->offset + e * f->size, f->size, f->is_signed);
+            if (f->enc == MMGR_ENC_FIXED)
+            {
+                for (j = 0; j < f->size; j++)
+                    buf[pos++] = v >> (8 * (schema->order == MMGR_LE ? j : f->size - 1 - j));
+            }
+            else if (f->enc == MMGR_ENC_VARINT)
+            {
+                if (f->is_signed)
+                    v = (v << 1) ^ (rt_uint64_t)((rt_int64_t)v >> 63);
+                do
+                {
+                    buf[pos++] = (v & 0x7F) | (v > 0x7F ? 0x80 : 0);
+                    v >>= 7;
+                } while (v);
+            }
+            else
+            {
+                for (j = 0; j < f->bits; j++, bitpos++)
+                {
+                    if (bitpos % 8 == 0)
+                        buf[pos + bitpos / 8] = 0;
+                    if ((v >> j) & 1)
+                        buf[pos + bitpos / 8] |= 1 << (bitpos % 8);
+                }
+            }
+        }
+    }
+
+    return pos + (bitpos + 7) / 8;
+}
+
+static size_t naive_unpack(const struct mmgr_schema *schema, void *obj, const rt_uint8_t *buf)
+{
+    const struct mmgr_field *f;
+    size_t pos = 0, bitpos = 0;
+    rt_uint64_t v, b;
+    int i, e, j, shift;
+
+    for (i = 0; i < schema->field_num; i++)
+    {
+        f = &schema->fields[i];
+        if (f->enc != MMGR_ENC_BITS && bitpos)
+        {
+            pos += (bitpos + 7) / 8;
+            bitpos = 0;
+        }
+        for (e = 0; e < f->count; e++)
+        {
+            v = 0;
+            if (f->enc == MMGR_ENC_FIXED)
+            {
+                for (j = 0; j < f->size; j++)
+                    v |= (rt_uint64_t)buf[pos++] << (8 * (schema->order == MMGR_LE ? j : f->size - 1 - j));
+            }
+            else if (f->enc == MMGR_ENC_VARINT)
+            {
+                shift = 0;
+                do
+                {
+                    b = buf[pos++];
+                    v |= (b & 0x7F) << shift;
+                    shift += 7;
+                } while (b & 0x80);
+                if (f->is_signed)
+                    v = (v >> 1) ^ (0 - (v & 1));
+            }
+            else
+            {
+                for (j = 0; j < f->bits; j++, bitpos++)
+                    v |= (rt_uint64_t)((buf[pos + bitpos / 8] >> (bitpos % 8)) & 1) << j;
+            }
+            mmgr_store((rt_uint8_t *)obj + f->offset + e * f->size, f->size, v);
+        }
+    }
+
+    return pos + (bitpos + 7) / 8;
+}
+
+#define RECORDS     256
+
+static rt_uint32_t rng_state = 12345;
+
+static rt_uint32_t rng(void)
+{
+    rng_state = rng_state * 1103515245 + 12345;
+    return rng_state >> 4;
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static volatile size_t sink;
+
+#define BENCH(label, expr)                                                  \
+    do                                                                      \
+    {                                                                       \
+        double t0 = now_ns();                                               \
+        for (n = 0; n < loops; n++)                                         \
+        {                                                                   \
+            i = n % RECORDS;                                                \
+            sink += (size_t)(expr);                                         \
+        }                                                                   \
+        printf("  %-24s %6.1f ns\n", label, (now_ns() - t0) / loops);       \
+    } while (0)
+
+int main(int argc, char **argv)
+{
+    static struct bench_mixed mixed[RECORDS], mixed_out[RECORDS];
+    static struct bench_plain plain[RECORDS], plain_out[RECORDS];
+    static rt_uint8_t wire[RECORDS][64], ref[64];
+    long loops = argc > 1 ? atol(argv[1]) : 5000000, n;
+    size_t len, ref_len;
+    int i, errors = 0;
+
+    mmgr_example();
+
+    for (i = 0; i < RECORDS; i++)
+    {
+        memset(&mixed[i], 0, sizeof(mixed[i]));
+        mixed[i].id = rng();
+        mixed[i].voltage = rng();
+        mixed[i].mode = rng() & 7;
+        mixed[i].valid = rng() & 1;
+        mixed[i].level = rng() & 0x3FF;
+        mixed[i].counter = rng() >> (rng() % 28);
+        mixed[i].delta = (rt_int32_t)(rng() >> (rng() % 28)) - 1000;
+        mixed[i].temp = (rt_int16_t)rng();
+        memset(&plain[i], 0, sizeof(plain[i]));
+        plain[i].id = rng();
+        plain[i].time = rng();
+        plain[i].voltage = rng();
+        plain[i].current = rng();
+        plain[i].soc = rng();
+        plain[i].flags = rng();
+        for (n = 0; n < 8; n++)
+            plain[i].cells[n] = rng();
+
+        /* all three ways must agree on the wire and on the way back */
+        ref_len = hand_pack_mixed(&mixed[i], ref);
+        len = mmgr_pack(&bench_mixed_schema, &mixed[i], wire[i], sizeof(wire[i]));
+        errors += len != ref_len || memcmp(ref, wire[i], len) != 0;
+        len = naive_pack(&bench_mixed_schema, &mixed[i], wire[i]);
+        errors += len != ref_len || memcmp(ref, wire[i], len) != 0;
+        memset(&mixed_out[i], 0, sizeof(mixed_out[i]));
+        errors += mmgr_unpack(&bench_mixed_schema, &mixed_out[i], ref, ref_len) != (rt_ssize_t)ref_len;
+        errors += memcmp(&mixed_out[i], &mixed[i], sizeof(mixed[i])) != 0;
+
+        ref_len = hand_pack_plain(&plain[i], ref);
+        len = mmgr_pack(&bench_plain_schema, &plain[i], wire[i], sizeof(wire[i]));
+        errors += len != ref_len || memcmp(ref, wire[i], len) != 0;
+        len = naive_pack(&bench_plain_schema, &plain[i], wire[i]);
+        errors += len != ref_len || memcmp(ref, wire[i], len) != 0;
+        len = mmgr_pack(&bench_plain_be_schema, &plain[i], wire[i], sizeof(wire[i]));
+        errors += mmgr_unpack(&bench_plain_be_schema, &plain_out[i], wire[i], len) != (rt_ssize_t)len;
+        errors += memcmp(&plain_out[i], &plain[i], sizeof(plain[i])) != 0;
+        errors += wire[i][0] != (rt_uint8_t)(plain[i].id >> 24);
+    }
+    printf("mixed record %u bytes, wire max %u; plain record %u bytes, memcpy path %s\n",
+           bench_mixed_schema.struct_size, bench_mixed_schema.wire_max, bench_plain_schema.struct_size,
+           (bench_plain_schema.flags & MMGR_SCHEMA_MEMCPY) ? "on" : "off");
+    printf("cross check %s\n", errors ? "FAILED" : "ok");
+
+    for (i = 0; i < RECORDS; i++)
+        hand_pack_mixed(&mixed[i], wire[i]);
+    printf("mixed pack, %ld loops\n", loops);
+    BENCH("hand", hand_pack_mixed(&mixed[i], ref));
+    BENCH("engine", mmgr_pack(&bench_mixed_schema, &mixed[i], ref, sizeof(ref)));
+    BENCH("naive", naive_pack(&bench_mixed_schema, &mixed[i], ref));
+    printf("mixed unpack\n");
+    BENCH("hand", hand_unpack_mixed(&mixed_out[i], wire[i]));
+    BENCH("engine", mmgr_unpack(&bench_mixed_schema, &mixed_out[i], wire[i], sizeof(wire[i])));
+    BENCH("naive", naive_unpack(&bench_mixed_schema, &mixed_out[i], wire[i]));
+
+    for (i = 0; i < RECORDS; i++)
+        hand_pack_plain(&plain[i], wire[i]);
+    printf("plain pack\n");
+    BENCH("hand", hand_pack_plain(&plain[i], ref));
+    BENCH("engine (memcpy)", mmgr_pack(&bench_plain_schema, &plain[i], ref, sizeof(ref)));
+    BENCH("engine (big endian)", mmgr_pack(&bench_plain_be_schema, &plain[i], ref, sizeof(ref)));
+    BENCH("naive", naive_pack(&bench_plain_schema, &plain[i], ref));
+    printf("plain unpack\n");
+    BENCH("hand", hand_unpack_plain(&plain_out[i], wire[i]));
+    BENCH("engine (memcpy)", mmgr_unpack(&bench_plain_schema, &plain_out[i], wire[i], sizeof(wire[i])));
+    BENCH("engine (big endian)", mmgr_unpack(&bench_plain_be_schema, &plain_out[i], wire[i], sizeof(wire[i])));
+    BENCH("naive", naive_unpack(&bench_plain_schema, &plain_out[i], wire[i]));
+
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2025-12-22     RT-Thread    first version
+ */
+
+/* The few RT-Thread definitions mmgr needs, to build it on the host. */
+
+#ifndef __MMGR_SHIM_RTTHREAD_H__
+#define __MMGR_SHIM_RTTHREAD_H__
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/types.h>
+
+typedef int8_t rt_int8_t;
+typedef int16_t rt_int16_t;
+typedef int32_t rt_int32_t;
+typedef int64_t rt_int64_t;
+typedef uint8_t rt_uint8_t;
+typedef uint16_t rt_uint16_t;
+typedef uint32_t rt_uint32_t;
+typedef uint64_t rt_uint64_t;
+typedef size_t rt_size_t;
+typedef ssize_t rt_ssize_t;
+
+#define RT_NULL                 NULL
+#define RT_EFULL                3
+#define RT_EINVAL               10
+#define rt_inline               static inline
+
+#define rt_memcpy               memcpy
+#define rt_memset               memset
+#define rt_memcmp               memcmp
+#define rt_kprintf              printf
+
+#define MSH_CMD_EXPORT(cmd, desc)
+
+#endif /* __MMGR_SHIM_RTTHREAD_H__ */
@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2025-12-24     RT-Thread    first version
+ */
+
+/*
+ * UDS diagnostic session control as a qsm machine:
+ *
+ *   default
+ *   non_default                 S3 timer runs, tester present restarts it
+ *     extended                  re-entered on every extended request
+ *       locked
+ *       unlocked                after a valid key
+ *     programming               only from extended + unlocked
+ *
+ * Try: qsm post session EXT_REQ / KEY_OK / PROG_REQ / TESTER_PRESENT,
+ *      qsm trace
+ */
+
+#include "qsm.h"
+
+#ifdef CCMP_USING_EXAMPLE_QSM
+
+#define EXAMPLE_S3_MS           5000
+#define EXAMPLE_QUEUE_DEPTH     8
+
+enum
+{
+    SIG_DEFAULT_REQ,
+    SIG_EXT_REQ,
+    SIG_PROG_REQ,
+    SIG_KEY_OK,
+    SIG_TESTER_PRESENT,
+    SIG_S3_TIMEOUT,
+    SIG_NUM
+};
+
+enum
+{
+    ST_DEFAULT,
+    ST_NON_DEFAULT,
+    ST_EXTENDED,
+    ST_LOCKED,
+    ST_UNLOCKED,
+    ST_PROGRAMMING,
+    ST_NUM
+};
+
+/* 1-based transition indexes, as stored in the jump tables */
+enum
+{
+    T_TO_DEFAULT = 1,
+    T_TO_EXTENDED,
+    T_TO_PROGRAMMING,
+    T_TO_UNLOCKED,
+    T_S3_RESTART,
+    T_NUM = T_S3_RESTART
+};
+
+static struct qsm _session;
+static struct qsm_event _queue[EXAMPLE_QUEUE_DEPTH];
+static struct rt_timer _s3_timer;
+
+static void example_s3_timeout(void *parameter)
+{
+    qsm_post(&_session, SIG_S3_TIMEOUT, 0);
+}
+
+static void example_s3_start(struct qsm *sm, const struct qsm_event *e)
+{
+    rt_timer_start(&_s3_timer);
+}
+
+static void example_s3_stop(struct qsm *sm, const struct qsm_event *e)
+{
+    rt_timer_stop(&_s3_timer);
+}
+
+static void example_session_entry(struct qsm *sm, const struct qsm_event *e)
+{
+    rt_kprintf("[session] %s\n", sm->def->states[sm->state].name);
+}
+
+static rt_bool_t example_is_unlocked(struct qsm *sm, const struct qsm_event *e)
+{
+    return qsm_is_in(sm, ST_UNLOCKED);
+}
+
+static const struct qsm_trans _trans[T_NUM] =
+{
+    [T_TO_DEFAULT - 1]      = { RT_NULL,             RT_NULL,          ST_DEFAULT },
+    [T_TO_EXTENDED - 1]     = { RT_NULL,             RT_NULL,          ST_EXTENDED },
+    [T_TO_PROGRAMMING - 1]  = { example_is_unlocked, RT_NULL,          ST_PROGRAMMING },
+    [T_TO_UNLOCKED - 1]     = { RT_NULL,             RT_NULL,          ST_UNLOCKED },
+    [T_S3_RESTART - 1]      = { RT_NULL,             example_s3_start, QSM_NONE },
+};
+
+static const rt_uint8_t _default_jump[SIG_NUM] =
+{
+    [SIG_EXT_REQ]           = T_TO_EXTENDED,
+};
+
+static const rt_uint8_t _non_default_jump[SIG_NUM] =
+{
+    [SIG_DEFAULT_REQ]       = T_TO_DEFAULT,
+    [SIG_S3_TIMEOUT]        = T_TO_DEFAULT,
+    [SIG_TESTER_PRESENT]    = T_S3_RESTART,
+    [SIG_EXT_REQ]           = T_TO_EXTENDED,
+};
+
+static const rt_uint8_t _extended_jump[SIG_NUM] =
+{
+    [SIG_PROG_REQ]          = T_TO_PROGRAMMING,
+};
+
+static const rt_uint8_t _locked_jump[SIG_NUM] =
+{
+    [SIG_KEY_OK]            = T_TO_UNLOCKED,
+};
+
+static const struct qsm_state _states[ST_NUM] =
+{
+    [ST_DEFAULT]     = { "default",     QSM_NONE,       QSM_NONE,    example_session_entry, RT_NULL,         _default_jump },
+    [ST_NON_DEFAULT] = { "non_default", QSM_NONE,       ST_EXTENDED, example_s3_start,      example_s3_stop, _non_default_jump },
+    [ST_EXTENDED]    = { "extended",    ST_NON_DEFAULT, ST_LOCKED,   example_session_entry, RT_NULL,         _extended_jump },
+    [ST_LOCKED]      = { "locked",      ST_EXTENDED,    QSM_NONE,    example_session_entry, RT_NULL,         _locked_jump },
+    [ST_UNLOCKED]    = { "unlocked",    ST_EXTENDED,    QSM_NONE,    example_session_entry, RT_NULL,         RT_NULL },
+    [ST_PROGRAMMING] = { "programming", ST_NON_DEFAULT, QSM_NONE,    example_session_entry, RT_NULL,         RT_NULL },
+};
+
+static const char *const _sig_names[SIG_NUM] =
+{
+    "DEFAULT_REQ", "EXT_REQ", "PROG_REQ", "KEY_OK", "TESTER_PRESENT", "S3_TIMEOUT",
+};
+
+static const struct qsm_def _session_def =
+{
+    "session", _states, _trans, _sig_names, ST_NUM, T_NUM, SIG_NUM, ST_DEFAULT,
+};
+
+static int qsm_demo_init(void)
+{
+    rt_err_t ret;
+
+    rt_timer_init(&_s3_timer, "s3", example_s3_timeout, RT_NULL, rt_tick_from_millisecond(EXAMPLE_S3_MS),
+                  RT_TIMER_FLAG_ONE_SHOT | RT_TIMER_FLAG_HARD_TIMER);
+    ret = qsm_init(&_session, &_session_def, _queue, EXAMPLE_QUEUE_DEPTH, RT_NULL);
+    if (ret != RT_EOK)
+    {
+        return ret;
+    }
+    qsm_start(&_session);
+
+    return qsm_mgr_attach(&_session);
+}
+INIT_APP_EXPORT(qsm_demo_init);
+
+/* a short scripted session, the qsm thread runs it while this one waits */
+static int qsm_demo(int argc, char **argv)
+{
+    static const rt_uint16_t script[] =
+    {
+        SIG_PROG_REQ,           /* unhandled in default */
+        SIG_EXT_REQ,
+        SIG_PROG_REQ,           /* refused, still locked */
+        SIG_KEY_OK,
+        SIG_TESTER_PRESENT,
+        SIG_PROG_REQ,
+        SIG_DEFAULT_REQ,
+    };
+    rt_size_t i;
+
+    for (i = 0; i < sizeof(script) / sizeof(script[0]); i++)
+    {
+        rt_kprintf("post %s\n", _sig_names[script[i]]);
+        qsm_post(&_session, script[i], 0);
+        rt_thread_mdelay(10);
+    }
+    rt_kprintf("session in %s, %u events, %u unhandled\n", _states[_session.state].name,
+               _session.dispatched, _session.unhandled);
+
+    return 0;
+}
+MSH_CMD_EXPORT(qsm_demo, run a scripted UDS session state machine);
+
+#endif /* CCMP_USING_EXAMPLE_QSM */
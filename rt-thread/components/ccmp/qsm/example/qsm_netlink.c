@@ -0,0 +1,269 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2025-12-24     RT-Thread    first version
+ */
+
+/*
+ * CAN network management in the style of AUTOSAR CanNm:
+ *
+ *   bus_sleep
+ *   prepare_bus_sleep           wait bus sleep timer
+ *   network                     NM timer, restarted by every NM PDU
+ *     repeat_message            repeat message timer
+ *     normal_operation          network requested
+ *     ready_sleep               network released
+ *
+ * The repeat message timeout is handled twice: repeat_message takes it to
+ * normal_operation when the network is requested, otherwise the guard fails
+ * and network takes it to ready_sleep. The NM timeout restarts the timer in
+ * network, except in ready_sleep where it goes to prepare_bus_sleep.
+ *
+ * Try: qsm_nm req / rel / rx, qsm list, qsm trace
+ */
+
+#include "qsm.h"
+
+#ifdef CCMP_USING_EXAMPLE_QSM
+
+#define EXAMPLE_NM_TIMEOUT_MS   2000
+#define EXAMPLE_REPEAT_MS       1500
+#define EXAMPLE_WAIT_SLEEP_MS   1500
+#define EXAMPLE_QUEUE_DEPTH     16
+
+enum
+{
+    NM_SIG_NET_REQ,
+    NM_SIG_NET_REL,
+    NM_SIG_RX,
+    NM_SIG_REPEAT_TIMEOUT,
+    NM_SIG_NM_TIMEOUT,
+    NM_SIG_WAIT_SLEEP_TIMEOUT,
+    NM_SIG_NUM
+};
+
+enum
+{
+    NM_ST_BUS_SLEEP,
+    NM_ST_PREPARE,
+    NM_ST_NETWORK,
+    NM_ST_REPEAT,
+    NM_ST_NORMAL,
+    NM_ST_READY,
+    NM_ST_NUM
+};
+
+enum
+{
+    NM_T_REQ_TO_NETWORK = 1,
+    NM_T_RX_TO_NETWORK,
+    NM_T_TO_BUS_SLEEP,
+    NM_T_TO_PREPARE,
+    NM_T_REQ_TO_NORMAL,
+    NM_T_REL_TO_READY,
+    NM_T_REPEAT_TO_NORMAL,
+    NM_T_REPEAT_TO_READY,
+    NM_T_REQ,
+    NM_T_REL,
+    NM_T_NM_RESTART,
+    NM_T_NUM = NM_T_NM_RESTART
+};
+
+struct example_nm
+{
+    rt_bool_t requested;
+    struct rt_timer nm_timer;
+    struct rt_timer repeat_timer;
+    struct rt_timer sleep_timer;
+};
+
+static struct qsm _nm;
+static struct qsm_event _queue[EXAMPLE_QUEUE_DEPTH];
+static struct example_nm _nm_ctx;
+
+static void example_nm_timeout(void *parameter)
+{
+    qsm_post(&_nm, (rt_uint16_t)(rt_ubase_t)parameter, 0);
+}
+
+static void example_nm_log(struct qsm *sm, const struct qsm_event *e)
+{
+    rt_kprintf("[nm] %s\n", sm->def->states[sm->state].name);
+}
+
+static void example_req(struct qsm *sm, const struct qsm_event *e)
+{
+    ((struct example_nm *)sm->user_data)->requested = RT_TRUE;
+}
+
+static void example_rel(struct qsm *sm, const struct qsm_event *e)
+{
+    ((struct example_nm *)sm->user_data)->requested = RT_FALSE;
+}
+
+static rt_bool_t example_is_requested(struct qsm *sm, const struct qsm_event *e)
+{
+    return ((struct example_nm *)sm->user_data)->requested;
+}
+
+static void example_nm_restart(struct qsm *sm, const struct qsm_event *e)
+{
+    rt_timer_start(&((struct example_nm *)sm->user_data)->nm_timer);
+}
+
+static void example_network_entry(struct qsm *sm, const struct qsm_event *e)
+{
+    example_nm_restart(sm, e);
+    example_nm_log(sm, e);
+}
+
+static void example_network_exit(struct qsm *sm, const struct qsm_event *e)
+{
+    rt_timer_stop(&((struct example_nm *)sm->user_data)->nm_timer);
+}
+
+static void example_repeat_entry(struct qsm *sm, const struct qsm_event *e)
+{
+    rt_timer_start(&((struct example_nm *)sm->user_data)->repeat_timer);
+    example_nm_log(sm, e);
+}
+
+static void example_repeat_exit(struct qsm *sm, const struct qsm_event *e)
+{
+    rt_timer_stop(&((struct example_nm *)sm->user_data)->repeat_timer);
+}
+
+static void example_prepare_entry(struct qsm *sm, const struct qsm_event *e)
+{
+    rt_timer_start(&((struct example_nm *)sm->user_data)->sleep_timer);
+    example_nm_log(sm, e);
+}
+
+static void example_prepare_exit(struct qsm *sm, const struct qsm_event *e)
+{
+    rt_timer_stop(&((struct example_nm *)sm->user_data)->sleep_timer);
+}
+
+static const struct qsm_trans _trans[NM_T_NUM] =
+{
+    [NM_T_REQ_TO_NETWORK - 1]   = { RT_NULL,              example_req,        NM_ST_NETWORK },
+    [NM_T_RX_TO_NETWORK - 1]    = { RT_NULL,              RT_NULL,            NM_ST_NETWORK },
+    [NM_T_TO_BUS_SLEEP - 1]     = { RT_NULL,              RT_NULL,            NM_ST_BUS_SLEEP },
+    [NM_T_TO_PREPARE - 1]       = { RT_NULL,              RT_NULL,            NM_ST_PREPARE },
+    [NM_T_REQ_TO_NORMAL - 1]    = { RT_NULL,              example_req,        NM_ST_NORMAL },
+    [NM_T_REL_TO_READY - 1]     = { RT_NULL,              example_rel,        NM_ST_READY },
+    [NM_T_REPEAT_TO_NORMAL - 1] = { example_is_requested, RT_NULL,            NM_ST_NORMAL },
+    [NM_T_REPEAT_TO_READY - 1]  = { RT_NULL,              RT_NULL,            NM_ST_READY },
+    [NM_T_REQ - 1]              = { RT_NULL,              example_req,        QSM_NONE },
+    [NM_T_REL - 1]              = { RT_NULL,              example_rel,        QSM_NONE },
+    [NM_T_NM_RESTART - 1]       = { RT_NULL,              example_nm_restart, QSM_NONE },
+};
+
+static const rt_uint8_t _bus_sleep_jump[NM_SIG_NUM] =
+{
+    [NM_SIG_NET_REQ]            = NM_T_REQ_TO_NETWORK,
+    [NM_SIG_RX]                 = NM_T_RX_TO_NETWORK,
+};
+
+static const rt_uint8_t _prepare_jump[NM_SIG_NUM] =
+{
+    [NM_SIG_NET_REQ]            = NM_T_REQ_TO_NETWORK,
+    [NM_SIG_RX]                 = NM_T_RX_TO_NETWORK,
+    [NM_SIG_WAIT_SLEEP_TIMEOUT] = NM_T_TO_BUS_SLEEP,
+};
+
+static const rt_uint8_t _network_jump[NM_SIG_NUM] =
+{
+    [NM_SIG_NET_REQ]            = NM_T_REQ,
+    [NM_SIG_NET_REL]            = NM_T_REL,
+    [NM_SIG_RX]                 = NM_T_NM_RESTART,
+    [NM_SIG_NM_TIMEOUT]         = NM_T_NM_RESTART,
+    [NM_SIG_REPEAT_TIMEOUT]     = NM_T_REPEAT_TO_READY,
+};
+
+static const rt_uint8_t _repeat_jump[NM_SIG_NUM] =
+{
+    [NM_SIG_REPEAT_TIMEOUT]     = NM_T_REPEAT_TO_NORMAL,
+};
+
+static const rt_uint8_t _normal_jump[NM_SIG_NUM] =
+{
+    [NM_SIG_NET_REL]            = NM_T_REL_TO_READY,
+};
+
+static const rt_uint8_t _ready_jump[NM_SIG_NUM] =
+{
+    [NM_SIG_NET_REQ]            = NM_T_REQ_TO_NORMAL,
+    [NM_SIG_NM_TIMEOUT]         = NM_T_TO_PREPARE,
+};
+
+static const struct qsm_state _states[NM_ST_NUM] =
+{
+    [NM_ST_BUS_SLEEP] = { "bus_sleep",         QSM_NONE,      QSM_NONE,     example_nm_log,        RT_NULL,              _bus_sleep_jump },
+    [NM_ST_PREPARE]   = { "prepare_bus_sleep", QSM_NONE,      QSM_NONE,     example_prepare_entry, example_prepare_exit, _prepare_jump },
+    [NM_ST_NETWORK]   = { "network",           QSM_NONE,      NM_ST_REPEAT, example_network_entry, example_network_exit, _network_jump },
+    [NM_ST_REPEAT]    = { "repeat_message",    NM_ST_NETWORK, QSM_NONE,     example_repeat_entry,  example_repeat_exit,  _repeat_jump },
+    [NM_ST_NORMAL]    = { "normal_operation",  NM_ST_NETWORK, QSM_NONE,     example_nm_log,        RT_NULL,              _normal_jump },
+    [NM_ST_READY]     = { "ready_sleep",       NM_ST_NETWORK, QSM_NONE,     example_nm_log,        RT_NULL,              _ready_jump },
+};
+
+static const char *const _sig_names[NM_SIG_NUM] =
+{
+    "NET_REQ", "NET_REL", "RX", "REPEAT_TIMEOUT", "NM_TIMEOUT", "WAIT_SLEEP_TIMEOUT",
+};
+
+static const struct qsm_def _nm_def =
+{
+    "nm", _states, _trans, _sig_names, NM_ST_NUM, NM_T_NUM, NM_SIG_NUM, NM_ST_BUS_SLEEP,
+};
+
+static int qsm_netlink_init(void)
+{
+    rt_err_t ret;
+
+    rt_timer_init(&_nm_ctx.nm_timer, "nm", example_nm_timeout, (void *)NM_SIG_NM_TIMEOUT,
+                  rt_tick_from_millisecond(EXAMPLE_NM_TIMEOUT_MS), RT_TIMER_FLAG_ONE_SHOT | RT_TIMER_FLAG_HARD_TIMER);
+    rt_timer_init(&_nm_ctx.repeat_timer, "nm_rep", example_nm_timeout, (void *)NM_SIG_REPEAT_TIMEOUT,
+                  rt_tick_from_millisecond(EXAMPLE_REPEAT_MS), RT_TIMER_FLAG_ONE_SHOT | RT_TIMER_FLAG_HARD_TIMER);
+    rt_timer_init(&_nm_ctx.sleep_timer, "nm_wbs", example_nm_timeout, (void *)NM_SIG_WAIT_SLEEP_TIMEOUT,
+                  rt_tick_from_millisecond(EXAMPLE_WAIT_SLEEP_MS), RT_TIMER_FLAG_ONE_SHOT | RT_TIMER_FLAG_HARD_TIMER);
+
+    ret = qsm_init(&_nm, &_nm_def, _queue, EXAMPLE_QUEUE_DEPTH, &_nm_ctx);
+    if (ret != RT_EOK)
+    {
+        return ret;
+    }
+    qsm_start(&_nm);
+
+    return qsm_mgr_attach(&_nm);
+}
+INIT_APP_EXPORT(qsm_netlink_init);
+
+static int qsm_nm(int argc, char **argv)
+{
+    if (argc > 1 && !rt_strcmp(argv[1], "req"))
+    {
+        qsm_post(&_nm, NM_SIG_NET_REQ, 0);
+    }
+    else if (argc > 1 && !rt_strcmp(argv[1], "rel"))
+    {
+        qsm_post(&_nm, NM_SIG_NET_REL, 0);
+    }
+    else if (argc > 1 && !rt_strcmp(argv[1], "rx"))
+    {
+        qsm_post(&_nm, NM_SIG_RX, 0);
+    }
+    else
+    {
+        rt_kprintf("Usage: qsm_nm <req|rel|rx>\n");
+    }
+
+    return 0;
+}
+MSH_CMD_EXPORT(qsm_nm, drive the example network management state machine);
+
+#endif /* CCMP_USING_EXAMPLE_QSM */
@@ -0,0 +1,337 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2025-12-24     RT-Thread    first version
+ */
+
+#include "qsm.h"
+
+#define DBG_TAG "qsm"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+#ifdef QSM_USING_TRACE
+#define QSM_TRACE(sm, type, sig, from, to)  qsm_trace(sm, type, sig, from, to)
+#else
+#define QSM_TRACE(sm, type, sig, from, to)
+#endif
+
+/* levels from the top, 1 for top level states, 0 for QSM_NONE */
+rt_inline rt_uint8_t qsm_depth(const struct qsm_state *states, rt_uint8_t s)
+{
+    rt_uint8_t depth = 0;
+
+    for (; s != QSM_NONE; s = states[s].parent)
+    {
+        depth++;
+    }
+
+    return depth;
+}
+
+/* lowest common ancestor-or-self of a and b, QSM_NONE stands for the root */
+static rt_uint8_t qsm_lca(const struct qsm_state *states, rt_uint8_t a, rt_uint8_t b)
+{
+    rt_uint8_t da = qsm_depth(states, a);
+    rt_uint8_t db = qsm_depth(states, b);
+
+    for (; da > db; da--)
+    {
+        a = states[a].parent;
+    }
+    for (; db > da; db--)
+    {
+        b = states[b].parent;
+    }
+    while (a != b)
+    {
+        a = states[a].parent;
+        b = states[b].parent;
+    }
+
+    return a;
+}
+
+/* exit from the current leaf up to, excluding, top */
+static void qsm_exit_to(struct qsm *sm, rt_uint8_t top)
+{
+    const struct qsm_state *states = sm->def->states;
+    rt_uint8_t s;
+
+    for (s = sm->state; s != top; s = states[s].parent)
+    {
+        if (states[s].exit != RT_NULL)
+        {
+            states[s].exit(sm, RT_NULL);
+        }
+        sm->state = states[s].parent;
+    }
+}
+
+/* enter from below top down to target, then follow the default children */
+static void qsm_enter_from(struct qsm *sm, rt_uint8_t top, rt_uint8_t target)
+{
+    const struct qsm_state *states = sm->def->states;
+    rt_uint8_t path[QSM_DEPTH_MAX];
+    rt_uint8_t s, n = 0;
+
+    for (s = target; s != top; s = states[s].parent)
+    {
+        path[n++] = s;
+    }
+    while (n > 0)
+    {
+        s = path[--n];
+        sm->state = s;
+        if (states[s].entry != RT_NULL)
+        {
+            states[s].entry(sm, RT_NULL);
+        }
+    }
+    for (s = target; states[s].init != QSM_NONE;)
+    {
+        s = states[s].init;
+        sm->state = s;
+        if (states[s].entry != RT_NULL)
+        {
+            states[s].entry(sm, RT_NULL);
+        }
+    }
+}
+
+/**
+ * @brief Bind a machine to its tables and an event ring.
+ *
+ * The tables are checked once here, so that dispatch does not have to:
+ * every parent, default child and target must exist, the nesting must be
+ * at most QSM_DEPTH_MAX levels and jump tables may only hold valid indexes.
+ *
+ * @param queue storage for depth events, kept by the caller. May be RT_NULL
+ *        with depth 0 if events are only dispatched synchronously.
+ */
+rt_err_t qsm_init(struct qsm *sm, const struct qsm_def *def, struct qsm_event *queue, rt_uint16_t depth,
+                  void *user_data)
+{
+    const struct qsm_state *st;
+    rt_uint16_t sig;
+    rt_uint8_t i, s, n;
+
+    if (def->state_num == 0 || def->state_num >= QSM_NONE || def->initial >= def->state_num
+        || (queue == RT_NULL && depth != 0))
+    {
+        return -RT_EINVAL;
+    }
+
+    for (i = 0; i < def->state_num; i++)
+    {
+        st = &def->states[i];
+        if ((st->parent != QSM_NONE && st->parent >= def->state_num)
+            || (st->init != QSM_NONE && (st->init >= def->state_num || def->states[st->init].parent != i)))
+        {
+            LOG_E("%s: bad parent or default child of %s", def->name, st->name);
+            return -RT_EINVAL;
+        }
+        /* bounded walk, catches parent loops as well */
+        for (s = i, n = 0; s != QSM_NONE && n <= QSM_DEPTH_MAX; s = def->states[s].parent)
+        {
+            n++;
+        }
+        if (n > QSM_DEPTH_MAX)
+        {
+            LOG_E("%s: %s is nested too deep", def->name, st->name);
+            return -RT_EINVAL;
+        }
+        for (sig = 0; st->jump != RT_NULL && sig < def->sig_num; sig++)
+        {
+            if (st->jump[sig] > def->trans_num)
+            {
+                LOG_E("%s: %s jumps to transition %d of %d", def->name, st->name, st->jump[sig], def->trans_num);
+                return -RT_EINVAL;
+            }
+        }
+    }
+    for (i = 0; i < def->trans_num; i++)
+    {
+        if (def->trans[i].target != QSM_NONE && def->trans[i].target >= def->state_num)
+        {
+            LOG_E("%s: transition %d has a bad target", def->name, i + 1);
+            return -RT_EINVAL;
+        }
+    }
+
+    rt_memset(sm, 0, sizeof(struct qsm));
+    sm->def = def;
+    sm->user_data = user_data;
+    sm->state = QSM_NONE;
+    sm->id = QSM_NONE;
+    sm->queue = queue;
+    sm->depth = depth;
+    rt_list_init(&sm->list);
+
+    return RT_EOK;
+}
+
+/**
+ * @brief Enter the initial state and its default children.
+ */
+void qsm_start(struct qsm *sm)
+{
+    sm->state = QSM_NONE;
+    qsm_enter_from(sm, QSM_NONE, sm->def->initial);
+    QSM_TRACE(sm, QSM_TRACE_START, 0, QSM_NONE, sm->state);
+}
+
+/**
+ * @brief Process one event to completion in the calling context.
+ *
+ * Not reentrant: actions must use qsm_post() to send events to their own
+ * machine.
+ *
+ * @return RT_EOK, or -RT_ENOENT if no active state handled the event.
+ */
+rt_err_t qsm_dispatch(struct qsm *sm, const struct qsm_event *e)
+{
+    const struct qsm_def *def = sm->def;
+    const struct qsm_state *states = def->states;
+    const struct qsm_trans *t = RT_NULL;
+    rt_uint8_t s, idx, from, top;
+
+    sm->dispatched++;
+    from = sm->state;
+    if (e->sig < def->sig_num)
+    {
+        for (s = from; s != QSM_NONE; s = states[s].parent)
+        {
+            idx = states[s].jump != RT_NULL ? states[s].jump[e->sig] : 0;
+            if (idx != 0)
+            {
+                t = &def->trans[idx - 1];
+                if (t->guard == RT_NULL || t->guard(sm, e))
+                {
+                    break;
+                }
+                t = RT_NULL;
+            }
+        }
+    }
+    if (t == RT_NULL)
+    {
+        sm->unhandled++;
+        QSM_TRACE(sm, QSM_TRACE_UNHANDLED, e->sig, from, from);
+        return -RT_ENOENT;
+    }
+
+    if (t->target == QSM_NONE)
+    {
+        if (t->action != RT_NULL)
+        {
+            t->action(sm, e);
+        }
+        QSM_TRACE(sm, QSM_TRACE_INTERNAL, e->sig, from, s);
+        return RT_EOK;
+    }
+
+    /* a self or up transition leaves and re-enters the target */
+    top = qsm_lca(states, states[s].parent, states[t->target].parent);
+    qsm_exit_to(sm, top);
+    if (t->action != RT_NULL)
+    {
+        t->action(sm, e);
+    }
+    qsm_enter_from(sm, top, t->target);
+    QSM_TRACE(sm, QSM_TRACE_TRAN, e->sig, from, sm->state);
+
+    return RT_EOK;
+}
+
+/**
+ * @brief Queue an event for a later qsm_run(). Safe to call from interrupts.
+ *
+ * @return RT_EOK, or -RT_EFULL if the ring is full and the event is dropped.
+ */
+rt_err_t qsm_post(struct qsm *sm, rt_uint16_t sig, rt_ubase_t param)
+{
+    struct qsm_event *e;
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    if (sm->count == sm->depth)
+    {
+        sm->dropped++;
+        rt_hw_interrupt_enable(level);
+        QSM_TRACE(sm, QSM_TRACE_DROP, sig, sm->state, sm->state);
+        return -RT_EFULL;
+    }
+    e = &sm->queue[(sm->head + sm->count) % sm->depth];
+    e->sig = sig;
+    e->param = param;
+    sm->count++;
+    if (sm->count > sm->peak)
+    {
+        sm->peak = sm->count;
+    }
+    rt_hw_interrupt_enable(level);
+
+    if (sm->notify != RT_NULL)
+    {
+        sm->notify(sm);
+    }
+
+    return RT_EOK;
+}
+
+/**
+ * @brief Dispatch queued events until the ring is empty.
+ *
+ * Events posted by the actions are processed in the same call.
+ *
+ * @return the number of events dispatched.
+ */
+int qsm_run(struct qsm *sm)
+{
+    struct qsm_event e;
+    rt_base_t level;
+    int n = 0;
+
+    for (;;)
+    {
+        level = rt_hw_interrupt_disable();
+        if (sm->count == 0)
+        {
+            rt_hw_interrupt_enable(level);
+            break;
+        }
+        /* copy out, the slot may be reused by a post from an action */
+        e = sm->queue[sm->head];
+        sm->head = (sm->head + 1) % sm->depth;
+        sm->count--;
+        rt_hw_interrupt_enable(level);
+
+        qsm_dispatch(sm, &e);
+        n++;
+    }
+
+    return n;
+}
+
+/**
+ * @brief Check whether a state is the current leaf or one of its ancestors.
+ */
+rt_bool_t qsm_is_in(const struct qsm *sm, rt_uint8_t state)
+{
+    rt_uint8_t s;
+
+    for (s = sm->state; s != QSM_NONE; s = sm->def->states[s].parent)
+    {
+        if (s == state)
+        {
+            return RT_TRUE;
+        }
+    }
+
+    return RT_FALSE;
+}
@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2025-12-24     RT-Thread    first version
+ */
+
+#ifndef __QSM_H__
+#define __QSM_H__
+
+#include <rtthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * A machine is described by const tables that stay in flash:
+ *
+ *   states[]   parent, default child, entry/exit actions and a jump table
+ *   trans[]    guard, action and target of every transition
+ *
+ * The jump table of a state is indexed by the signal and holds the 1-based
+ * index of the transition in trans[], 0 when the state does not handle the
+ * signal. It is usually written with designated initializers:
+ *
+ *   static const rt_uint8_t idle_jump[SIG_NUM] = { [SIG_START] = 1, [SIG_STOP] = 2 };
+ *
+ * An event is looked up in the jump table of the current leaf state, then
+ * in those of its ancestors, one array access per level. A transition whose
+ * guard fails is skipped as if the state did not handle the event.
+ *
+ * Transitions are external: every state from the current leaf up to, but
+ * excluding, the lowest common proper ancestor of the handling state and the
+ * target is exited, the action runs, the states down to the target are
+ * entered and the default children of the target are followed to a leaf. A
+ * transition with target QSM_NONE is internal, only its action runs.
+ *
+ * The hierarchy is walked with loops bounded by QSM_DEPTH_MAX, never by
+ * recursion. Events posted to a machine go to a ring the caller provides.
+ */
+
+#define QSM_NONE                0xFF    /* no state, no parent, internal transition */
+#define QSM_DEPTH_MAX           8       /* nesting levels, including the top level */
+
+/* qsm_trace_rec.type */
+#define QSM_TRACE_START         0       /* machine started, to = initial leaf */
+#define QSM_TRACE_TRAN          1       /* external transition */
+#define QSM_TRACE_INTERNAL      2       /* internal transition, to = handling state */
+#define QSM_TRACE_UNHANDLED     3       /* no state handled the event */
+#define QSM_TRACE_DROP          4       /* event queue full */
+
+struct qsm;
+
+struct qsm_event
+{
+    rt_uint16_t sig;
+    rt_ubase_t param;
+};
+
+typedef void (*qsm_action_t)(struct qsm *sm, const struct qsm_event *e);
+typedef rt_bool_t (*qsm_guard_t)(struct qsm *sm, const struct qsm_event *e);
+
+struct qsm_trans
+{
+    qsm_guard_t guard;          /* RT_NULL: always taken */
+    qsm_action_t action;        /* RT_NULL: none */
+    rt_uint8_t target;          /* QSM_NONE: internal transition */
+};
+
+struct qsm_state
+{
+    const char *name;
+    rt_uint8_t parent;          /* QSM_NONE for top level states */
+    rt_uint8_t init;            /* default child, QSM_NONE for leaves */
+    qsm_action_t entry;         /* called with e == RT_NULL */
+    qsm_action_t exit;          /* called with e == RT_NULL */
+    const rt_uint8_t *jump;     /* [sig_num], RT_NULL if no signal is handled */
+};
+
+struct qsm_def
+{
+    const char *name;
+    const struct qsm_state *states;
+    const struct qsm_trans *trans;
+    const char *const *sig_names;   /* [sig_num] for msh, may be RT_NULL */
+    rt_uint8_t state_num;
+    rt_uint8_t trans_num;
+    rt_uint16_t sig_num;
+    rt_uint8_t initial;
+};
+
+struct qsm
+{
+    const struct qsm_def *def;
+    void *user_data;
+    rt_uint8_t state;           /* current leaf, QSM_NONE before qsm_start() */
+    rt_uint8_t id;              /* trace id given by qsm_mgr, QSM_NONE otherwise */
+
+    /* event ring */
+    struct qsm_event *queue;
+    rt_uint16_t depth;
+    rt_uint16_t head;
+    rt_uint16_t count;
+    rt_uint16_t peak;
+
+    rt_uint32_t dispatched;
+    rt_uint32_t unhandled;
+    rt_uint32_t dropped;
+
+    void (*notify)(struct qsm *sm); /* called after a successful post */
+    rt_list_t list;             /* qsm_mgr */
+};
+
+/* 12 bytes, little endian on the wire */
+struct qsm_trace_rec
+{
+    rt_uint32_t tick;
+    rt_uint16_t seq;
+    rt_uint16_t sig;
+    rt_uint8_t sm;              /* qsm.id */
+    rt_uint8_t type;            /* QSM_TRACE_xxx */
+    rt_uint8_t from;
+    rt_uint8_t to;
+};
+
+rt_err_t qsm_init(struct qsm *sm, const struct qsm_def *def, struct qsm_event *queue, rt_uint16_t depth,
+                  void *user_data);
+void qsm_start(struct qsm *sm);
+rt_err_t qsm_dispatch(struct qsm *sm, const struct qsm_event *e);
+rt_err_t qsm_post(struct qsm *sm, rt_uint16_t sig, rt_ubase_t param);
+int qsm_run(struct qsm *sm);
+rt_bool_t qsm_is_in(const struct qsm *sm, rt_uint8_t state);
+
+/* qsm_mgr.c */
+rt_err_t qsm_mgr_attach(struct qsm *sm);
+rt_err_t qsm_mgr_detach(struct qsm *sm);
+struct qsm *qsm_mgr_find(const char *name);
+
+#ifdef QSM_USING_TRACE
+void qsm_trace(const struct qsm *sm, rt_uint8_t type, rt_uint16_t sig, rt_uint8_t from, rt_uint8_t to);
+rt_size_t qsm_trace_read(rt_uint32_t *cursor, struct qsm_trace_rec *rec, rt_size_t num);
+void qsm_trace_clear(void);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __QSM_H__ */
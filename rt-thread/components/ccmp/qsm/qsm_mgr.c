@@ -0,0 +1,374 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2025-12-24     RT-Thread    first version
+ */
+
+/*
+ * One thread runs every attached machine to completion in turn, woken by
+ * qsm_post() through an event flag. The transition trace ring is shared by
+ * all machines and can be read over msh or, with the UDS package, as a
+ * ReadDataByIdentifier record.
+ */
+
+#include "qsm.h"
+#include <stdlib.h>
+
+#ifdef PKG_USING_CAN_UDS
+#include <rtdevice.h>
+#include "rtt_uds_service.h"
+#endif
+
+#define DBG_TAG "qsm"
+#define DBG_LVL DBG_INFO
+#include <rtdbg.h>
+
+#define QSM_EVT_POST            (1 << 0)
+
+static rt_list_t _sm_list = RT_LIST_OBJECT_INIT(_sm_list);
+static rt_uint32_t _id_map;     /* trace ids in use, at most 32 machines */
+static struct rt_mutex _lock;
+static struct rt_event _event;
+static struct rt_thread _thread;
+static rt_uint8_t _thread_stack[QSM_THREAD_STACK_SIZE];
+
+static void qsm_mgr_notify(struct qsm *sm)
+{
+    rt_event_send(&_event, QSM_EVT_POST);
+}
+
+static void qsm_mgr_thread_entry(void *parameter)
+{
+    struct qsm *sm;
+    rt_uint32_t set;
+
+    while (1)
+    {
+        rt_event_recv(&_event, QSM_EVT_POST, RT_EVENT_FLAG_OR | RT_EVENT_FLAG_CLEAR, RT_WAITING_FOREVER, &set);
+
+        /* posts from the actions set the flag again and get another round */
+        rt_mutex_take(&_lock, RT_WAITING_FOREVER);
+        rt_list_for_each_entry(sm, &_sm_list, list)
+        {
+            qsm_run(sm);
+        }
+        rt_mutex_release(&_lock);
+    }
+}
+
+/**
+ * @brief Let the qsm thread run a started machine whenever it gets events.
+ */
+rt_err_t qsm_mgr_attach(struct qsm *sm)
+{
+    rt_uint8_t id;
+
+    if (sm->state == QSM_NONE || !rt_list_isempty(&sm->list))
+    {
+        return -RT_EINVAL;
+    }
+
+    rt_mutex_take(&_lock, RT_WAITING_FOREVER);
+    if (_id_map == 0xFFFFFFFF)
+    {
+        rt_mutex_release(&_lock);
+        return -RT_EFULL;
+    }
+    id = __rt_ffs(~_id_map) - 1;
+    _id_map |= 1UL << id;
+    sm->id = id;
+    sm->notify = qsm_mgr_notify;
+    rt_list_insert_before(&_sm_list, &sm->list);
+    rt_mutex_release(&_lock);
+
+    /* events queued before the attach */
+    rt_event_send(&_event, QSM_EVT_POST);
+
+    return RT_EOK;
+}
+
+rt_err_t qsm_mgr_detach(struct qsm *sm)
+{
+    if (rt_list_isempty(&sm->list))
+    {
+        return -RT_EINVAL;
+    }
+
+    rt_mutex_take(&_lock, RT_WAITING_FOREVER);
+    rt_list_remove(&sm->list);
+    rt_list_init(&sm->list);
+    _id_map &= ~(1UL << sm->id);
+    sm->notify = RT_NULL;
+    sm->id = QSM_NONE;
+    rt_mutex_release(&_lock);
+
+    return RT_EOK;
+}
+
+struct qsm *qsm_mgr_find(const char *name)
+{
+    struct qsm *sm, *found = RT_NULL;
+
+    rt_mutex_take(&_lock, RT_WAITING_FOREVER);
+    rt_list_for_each_entry(sm, &_sm_list, list)
+    {
+        if (!rt_strcmp(sm->def->name, name))
+        {
+            found = sm;
+            break;
+        }
+    }
+    rt_mutex_release(&_lock);
+
+    return found;
+}
+
+static int qsm_mgr_init(void)
+{
+    rt_mutex_init(&_lock, "qsm", RT_IPC_FLAG_PRIO);
+    rt_event_init(&_event, "qsm", RT_IPC_FLAG_PRIO);
+    rt_thread_init(&_thread, "qsm", qsm_mgr_thread_entry, RT_NULL,
+                   _thread_stack, sizeof(_thread_stack), QSM_THREAD_PRIORITY, 10);
+    rt_thread_startup(&_thread);
+
+    return RT_EOK;
+}
+INIT_COMPONENT_EXPORT(qsm_mgr_init);
+
+#ifdef QSM_USING_TRACE
+#if (QSM_TRACE_NUM & (QSM_TRACE_NUM - 1)) != 0
+#error "QSM_TRACE_NUM must be a power of two"
+#endif
+
+static struct qsm_trace_rec _trace[QSM_TRACE_NUM];
+static rt_uint32_t _trace_seq;  /* records written since the last clear */
+
+/* called by qsm.c, from interrupts too when a post is dropped */
+void qsm_trace(const struct qsm *sm, rt_uint8_t type, rt_uint16_t sig, rt_uint8_t from, rt_uint8_t to)
+{
+    struct qsm_trace_rec *rec;
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    rec = &_trace[_trace_seq & (QSM_TRACE_NUM - 1)];
+    rec->tick = rt_tick_get();
+    rec->seq = (rt_uint16_t)_trace_seq;
+    rec->sig = sig;
+    rec->sm = sm->id;
+    rec->type = type;
+    rec->from = from;
+    rec->to = to;
+    _trace_seq++;
+    rt_hw_interrupt_enable(level);
+}
+
+/**
+ * @brief Copy trace records, oldest first.
+ *
+ * @param cursor sequence number of the first record wanted, 0 for the
+ *        oldest one still in the ring. Advanced past the records copied,
+ *        so repeated calls follow the trace.
+ *
+ * @return the number of records copied.
+ */
+rt_size_t qsm_trace_read(rt_uint32_t *cursor, struct qsm_trace_rec *rec, rt_size_t num)
+{
+    rt_base_t level;
+    rt_size_t n;
+
+    level = rt_hw_interrupt_disable();
+    if (_trace_seq - *cursor > QSM_TRACE_NUM)
+    {
+        /* overwritten, or a cursor from before a clear */
+        *cursor = _trace_seq > QSM_TRACE_NUM ? _trace_seq - QSM_TRACE_NUM : 0;
+    }
+    for (n = 0; n < num && *cursor != _trace_seq; n++, (*cursor)++)
+    {
+        rec[n] = _trace[*cursor & (QSM_TRACE_NUM - 1)];
+    }
+    rt_hw_interrupt_enable(level);
+
+    return n;
+}
+
+void qsm_trace_clear(void)
+{
+    rt_base_t level;
+
+    level = rt_hw_interrupt_disable();
+    _trace_seq = 0;
+    rt_hw_interrupt_enable(level);
+}
+
+#ifdef PKG_USING_CAN_UDS
+#define QSM_UDS_TRACE_MAX       ((UDS_SERVER_SEND_BUF_SIZE - 3) / sizeof(struct qsm_trace_rec))
+
+/* ReadDataByIdentifier QSM_UDS_DID returns the newest records that fit, oldest first */
+static UDS_HANDLER(handle_qsm_trace)
+{
+    UDSRDBIArgs_t *args = (UDSRDBIArgs_t *)data;
+    struct qsm_trace_rec rec[8];
+    rt_uint32_t cursor;
+    rt_size_t n, total = 0;
+    uint8_t ret;
+
+    if (args->dataId != QSM_UDS_DID)
+        return UDS_NRC_RequestOutOfRange;
+
+    cursor = _trace_seq > QSM_UDS_TRACE_MAX ? _trace_seq - QSM_UDS_TRACE_MAX : 0;
+    while (total < QSM_UDS_TRACE_MAX)
+    {
+        n = QSM_UDS_TRACE_MAX - total;
+        n = qsm_trace_read(&cursor, rec, n < sizeof(rec) / sizeof(rec[0]) ? n : sizeof(rec) / sizeof(rec[0]));
+        if (n == 0)
+            break;
+        ret = args->copy(srv, rec, n * sizeof(rec[0]));
+        if (ret != UDS_PositiveResponse)
+            return ret;
+        total += n;
+    }
+
+    return UDS_PositiveResponse;
+}
+RTT_UDS_SERVICE_DEFINE_OPS(qsm_trace_node, UDS_EVT_ReadDataByIdent, handle_qsm_trace);
+#endif /* PKG_USING_CAN_UDS */
+#endif /* QSM_USING_TRACE */
+
+#ifdef RT_USING_FINSH
+static const char *qsm_state_name(const struct qsm *sm, rt_uint8_t s)
+{
+    return (sm == RT_NULL || s >= sm->def->state_num) ? "-" : sm->def->states[s].name;
+}
+
+static void qsm_list(void)
+{
+    struct qsm *sm;
+
+    rt_kprintf("id name         state            queue      dispatched unhandled dropped\n");
+    rt_mutex_take(&_lock, RT_WAITING_FOREVER);
+    rt_list_for_each_entry(sm, &_sm_list, list)
+    {
+        rt_kprintf("%2d %-12s %-16s %3u/%3u/%3u %9u %9u %7u\n", sm->id, sm->def->name,
+                   qsm_state_name(sm, sm->state), sm->count, sm->peak, sm->depth,
+                   sm->dispatched, sm->unhandled, sm->dropped);
+    }
+    rt_mutex_release(&_lock);
+}
+
+#ifdef QSM_USING_TRACE
+static void qsm_trace_dump(void)
+{
+    static const char *const type_name[] = { "start", "tran", "internal", "unhandled", "drop" };
+    struct qsm_trace_rec rec;
+    rt_uint32_t cursor = 0;
+    struct qsm *sm, *it;
+    const char *name;
+    char sig[8];
+
+    while (qsm_trace_read(&cursor, &rec, 1) == 1)
+    {
+        sm = RT_NULL;
+        rt_mutex_take(&_lock, RT_WAITING_FOREVER);
+        rt_list_for_each_entry(it, &_sm_list, list)
+        {
+            if (it->id == rec.sm)
+            {
+                sm = it;
+                break;
+            }
+        }
+        rt_mutex_release(&_lock);
+
+        if (sm != RT_NULL && sm->def->sig_names != RT_NULL && rec.sig < sm->def->sig_num)
+        {
+            name = sm->def->sig_names[rec.sig];
+        }
+        else
+        {
+            rt_snprintf(sig, sizeof(sig), "%u", rec.sig);
+            name = sig;
+        }
+        rt_kprintf("%5u %10u %-12s %-9s %-16s %-16s -> %s\n", rec.seq, rec.tick, sm != RT_NULL ? sm->def->name : "?",
+                   type_name[rec.type], name, qsm_state_name(sm, rec.from), qsm_state_name(sm, rec.to));
+    }
+}
+#endif /* QSM_USING_TRACE */
+
+static int qsm_sig_parse(const struct qsm *sm, const char *str)
+{
+    rt_uint16_t i;
+
+    for (i = 0; sm->def->sig_names != RT_NULL && i < sm->def->sig_num; i++)
+    {
+        if (!rt_strcmp(sm->def->sig_names[i], str))
+        {
+            return i;
+        }
+    }
+
+    return strtoul(str, RT_NULL, 0);
+}
+
+static void qsm_usage(void)
+{
+    rt_kprintf("Usage:\n");
+    rt_kprintf("qsm list                         - show the attached machines\n");
+    rt_kprintf("qsm post <name> <sig> [param]    - post an event, sig by name or number\n");
+#ifdef QSM_USING_TRACE
+    rt_kprintf("qsm trace [clear]                - dump or clear the transition trace\n");
+#endif
+}
+
+static int qsm(int argc, char **argv)
+{
+    struct qsm *sm;
+    rt_err_t ret = RT_EOK;
+
+    if (argc < 2 || !rt_strcmp(argv[1], "list"))
+    {
+        qsm_list();
+        return 0;
+    }
+
+    if (!rt_strcmp(argv[1], "post") && argc > 3)
+    {
+        sm = qsm_mgr_find(argv[2]);
+        if (sm == RT_NULL)
+        {
+            rt_kprintf("no machine %s\n", argv[2]);
+            return -RT_ENOENT;
+        }
+        ret = qsm_post(sm, qsm_sig_parse(sm, argv[3]), argc > 4 ? strtoul(argv[4], RT_NULL, 0) : 0);
+    }
+#ifdef QSM_USING_TRACE
+    else if (!rt_strcmp(argv[1], "trace"))
+    {
+        if (argc > 2 && !rt_strcmp(argv[2], "clear"))
+        {
+            qsm_trace_clear();
+        }
+        else
+        {
+            qsm_trace_dump();
+        }
+    }
+#endif
+    else
+    {
+        qsm_usage();
+        return 0;
+    }
+
+    if (ret != RT_EOK)
+    {
+        rt_kprintf("qsm %s failed: %d\n", argv[1], ret);
+    }
+
+    return ret;
+}
+MSH_CMD_EXPORT(qsm, state machine manager);
+#endif /* RT_USING_FINSH */
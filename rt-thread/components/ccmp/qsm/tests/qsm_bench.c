@@ -0,0 +1,331 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2025-12-24     RT-Thread    first version
+ */
+
+/*
+ * Host check and dispatch benchmark for qsm.
+ *
+ * cc -O2 -Ishim -I.. -o qsm_bench qsm_bench.c
+ * ./qsm_bench [loops]
+ *
+ * The same machine is written twice, as qsm tables and as the nested
+ * switch statements it replaces:
+ *
+ *   a                  b
+ *     a1                 (leaf)
+ *       a11  a12
+ *     a2
+ *
+ * A random event sequence must leave both in the same state with the same
+ * entry, exit and action counts, then every kind of event is timed alone.
+ */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../qsm.c"
+
+enum
+{
+    SIG_LEAF,           /* internal in a11 */
+    SIG_UP,             /* internal in a, two levels above a11 */
+    SIG_GUARD,          /* a11 when armed, otherwise internal in a1 */
+    SIG_SIB,            /* a11 <-> a12 */
+    SIG_FAR,            /* a -> b -> a */
+    SIG_A2,             /* a1 -> a2 */
+    SIG_NONE,           /* never handled */
+    SIG_NUM
+};
+
+enum
+{
+    ST_A,
+    ST_A1,
+    ST_A11,
+    ST_A12,
+    ST_A2,
+    ST_B,
+    ST_NUM
+};
+
+enum
+{
+    T_LEAF = 1,
+    T_UP,
+    T_GUARD,
+    T_GUARD_UP,
+    T_TO_A11,
+    T_TO_A12,
+    T_TO_A2,
+    T_TO_A,
+    T_TO_B,
+    T_NUM = T_TO_B
+};
+
+struct bench_count
+{
+    rt_uint32_t entry[ST_NUM];
+    rt_uint32_t exit[ST_NUM];
+    rt_uint32_t action;
+    rt_bool_t armed;
+};
+
+static struct bench_count qc, sc;
+
+static void q_entry(struct qsm *sm, const struct qsm_event *e)
+{
+    qc.entry[sm->state]++;
+}
+
+static void q_exit(struct qsm *sm, const struct qsm_event *e)
+{
+    qc.exit[sm->state]++;
+}
+
+static void q_action(struct qsm *sm, const struct qsm_event *e)
+{
+    qc.action++;
+}
+
+static rt_bool_t q_armed(struct qsm *sm, const struct qsm_event *e)
+{
+    return qc.armed;
+}
+
+static const struct qsm_trans q_trans[T_NUM] =
+{
+    [T_LEAF - 1]     = { RT_NULL, q_action, QSM_NONE },
+    [T_UP - 1]       = { RT_NULL, q_action, QSM_NONE },
+    [T_GUARD - 1]    = { q_armed, q_action, QSM_NONE },
+    [T_GUARD_UP - 1] = { RT_NULL, q_action, QSM_NONE },
+    [T_TO_A11 - 1]   = { RT_NULL, RT_NULL,  ST_A11 },
+    [T_TO_A12 - 1]   = { RT_NULL, RT_NULL,  ST_A12 },
+    [T_TO_A2 - 1]    = { RT_NULL, RT_NULL,  ST_A2 },
+    [T_TO_A - 1]     = { RT_NULL, RT_NULL,  ST_A },
+    [T_TO_B - 1]     = { RT_NULL, RT_NULL,  ST_B },
+};
+
+static const rt_uint8_t a_jump[SIG_NUM] = { [SIG_UP] = T_UP, [SIG_FAR] = T_TO_B };
+static const rt_uint8_t a1_jump[SIG_NUM] = { [SIG_GUARD] = T_GUARD_UP, [SIG_A2] = T_TO_A2 };
+static const rt_uint8_t a11_jump[SIG_NUM] = { [SIG_LEAF] = T_LEAF, [SIG_GUARD] = T_GUARD, [SIG_SIB] = T_TO_A12 };
+static const rt_uint8_t a12_jump[SIG_NUM] = { [SIG_SIB] = T_TO_A11 };
+static const rt_uint8_t a2_jump[SIG_NUM] = { [SIG_SIB] = T_TO_A11 };
+static const rt_uint8_t b_jump[SIG_NUM] = { [SIG_FAR] = T_TO_A };
+
+static const struct qsm_state q_states[ST_NUM] =
+{
+    [ST_A]   = { "a",   QSM_NONE, ST_A1,    q_entry, q_exit, a_jump },
+    [ST_A1]  = { "a1",  ST_A,     ST_A11,   q_entry, q_exit, a1_jump },
+    [ST_A11] = { "a11", ST_A1,    QSM_NONE, q_entry, q_exit, a11_jump },
+    [ST_A12] = { "a12", ST_A1,    QSM_NONE, q_entry, q_exit, a12_jump },
+    [ST_A2]  = { "a2",  ST_A,     QSM_NONE, q_entry, q_exit, a2_jump },
+    [ST_B]   = { "b",   QSM_NONE, QSM_NONE, q_entry, q_exit, b_jump },
+};
+
+static const struct qsm_def q_def =
+{
+    "bench", q_states, q_trans, RT_NULL, ST_NUM, T_NUM, SIG_NUM, ST_A,
+};
+
+/* the hand-coded switch version, as the UDS session and NM code are written today */
+static rt_uint8_t sw_state;
+
+static void sw_enter(rt_uint8_t s)
+{
+    sw_state = s;
+    sc.entry[s]++;
+}
+
+static void sw_leave(rt_uint8_t s)
+{
+    sc.exit[s]++;
+}
+
+static void sw_enter_a(void)
+{
+    sw_enter(ST_A);
+    sw_enter(ST_A1);
+    sw_enter(ST_A11);
+}
+
+static int sw_dispatch(rt_uint16_t sig)
+{
+    switch (sw_state)
+    {
+    case ST_A11:
+        switch (sig)
+        {
+        case SIG_LEAF:
+            sc.action++;
+            return 0;
+        case SIG_GUARD:
+            sc.action++;                /* same action whether or not armed */
+            return 0;
+        case SIG_SIB:
+            sw_leave(ST_A11);
+            sw_enter(ST_A12);
+            return 0;
+        case SIG_UP:
+            sc.action++;
+            return 0;
+        case SIG_A2:
+            sw_leave(ST_A11);
+            sw_leave(ST_A1);
+            sw_enter(ST_A2);
+            return 0;
+        case SIG_FAR:
+            sw_leave(ST_A11);
+            sw_leave(ST_A1);
+            sw_leave(ST_A);
+            sw_enter(ST_B);
+            return 0;
+        }
+        break;
+    case ST_A12:
+        switch (sig)
+        {
+        case SIG_SIB:
+            sw_leave(ST_A12);
+            sw_enter(ST_A11);
+            return 0;
+        case SIG_GUARD:
+        case SIG_UP:
+            sc.action++;
+            return 0;
+        case SIG_A2:
+            sw_leave(ST_A12);
+            sw_leave(ST_A1);
+            sw_enter(ST_A2);
+            return 0;
+        case SIG_FAR:
+            sw_leave(ST_A12);
+            sw_leave(ST_A1);
+            sw_leave(ST_A);
+            sw_enter(ST_B);
+            return 0;
+        }
+        break;
+    case ST_A2:
+        switch (sig)
+        {
+        case SIG_SIB:
+            sw_leave(ST_A2);
+            sw_enter(ST_A1);
+            sw_enter(ST_A11);
+            return 0;
+        case SIG_UP:
+            sc.action++;
+            return 0;
+        case SIG_FAR:
+            sw_leave(ST_A2);
+            sw_leave(ST_A);
+            sw_enter(ST_B);
+            return 0;
+        }
+        break;
+    case ST_B:
+        if (sig == SIG_FAR)
+        {
+            sw_leave(ST_B);
+            sw_enter_a();
+            return 0;
+        }
+        break;
+    }
+
+    return -1;
+}
+
+static rt_uint32_t rng_state = 12345;
+
+static rt_uint32_t rng(void)
+{
+    rng_state = rng_state * 1103515245 + 12345;
+    return rng_state >> 4;
+}
+
+static double now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static volatile int sink;
+
+#define BENCH(label, expr)                                                  \
+    do                                                                      \
+    {                                                                       \
+        double t0 = now_ns();                                               \
+        for (n = 0; n < loops; n++)                                         \
+        {                                                                   \
+            sink += (expr);                                                 \
+        }                                                                   \
+        printf("  %-24s %6.1f ns\n", label, (now_ns() - t0) / loops);       \
+    } while (0)
+
+/* put both machines back into a11 */
+static void bench_reset(struct qsm *sm)
+{
+    qsm_start(sm);
+    sw_enter_a();
+}
+
+int main(int argc, char **argv)
+{
+    static const struct
+    {
+        const char *name;
+        rt_uint16_t sig;
+    } cases[] =
+    {
+        { "leaf internal",      SIG_LEAF },
+        { "two levels up",      SIG_UP },
+        { "guard fails, up",    SIG_GUARD },
+        { "unhandled",          SIG_NONE },
+        { "sibling transition", SIG_SIB },
+        { "a <-> b, 3 levels",  SIG_FAR },
+    };
+    long loops = argc > 1 ? atol(argv[1]) : 10000000, n;
+    struct qsm_event e = { 0, 0 };
+    struct qsm sm;
+    unsigned i;
+    int errors = 0;
+
+    if (qsm_init(&sm, &q_def, RT_NULL, 0, RT_NULL) != RT_EOK)
+    {
+        return 1;
+    }
+    bench_reset(&sm);
+
+    /* cross check, SIG_NONE included */
+    for (n = 0; n < 1000000; n++)
+    {
+        e.sig = rng() % SIG_NUM;
+        qc.armed = rng() & 1;
+        errors += (qsm_dispatch(&sm, &e) == RT_EOK) != (sw_dispatch(e.sig) == 0);
+        errors += sm.state != sw_state;
+    }
+    errors += memcmp(&qc, &sc, offsetof(struct bench_count, armed)) != 0;
+    printf("%s, %u transitions\n", errors ? "cross check FAILED" : "cross check ok", qc.entry[ST_B]);
+
+    qc.armed = RT_FALSE;
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++)
+    {
+        printf("%s, %ld events\n", cases[i].name, loops);
+        e.sig = cases[i].sig;
+        bench_reset(&sm);
+        BENCH("qsm_dispatch", qsm_dispatch(&sm, &e));
+        bench_reset(&sm);
+        BENCH("switch", sw_dispatch(e.sig));
+    }
+
+    return errors != 0;
+}
@@ -0,0 +1,9 @@
+/* host shim, see rtthread.h */
+#ifndef __QSM_SHIM_RTDBG_H__
+#define __QSM_SHIM_RTDBG_H__
+
+#include <stdio.h>
+
+#define LOG_E(fmt, ...)         printf("E/" DBG_TAG ": " fmt "\n", ##__VA_ARGS__)
+
+#endif /* __QSM_SHIM_RTDBG_H__ */
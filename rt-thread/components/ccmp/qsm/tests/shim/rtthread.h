@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Change Logs:
+ * Date           Author       Notes
+ * 2025-12-24     RT-Thread    first version
+ */
+
+/* The few RT-Thread definitions qsm.c needs, to build it on the host. */
+
+#ifndef __QSM_SHIM_RTTHREAD_H__
+#define __QSM_SHIM_RTTHREAD_H__
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef uint8_t rt_uint8_t;
+typedef uint16_t rt_uint16_t;
+typedef uint32_t rt_uint32_t;
+typedef long rt_base_t;
+typedef unsigned long rt_ubase_t;
+typedef size_t rt_size_t;
+typedef int rt_err_t;
+typedef int rt_bool_t;
+
+struct rt_list_node
+{
+    struct rt_list_node *next;
+    struct rt_list_node *prev;
+};
+typedef struct rt_list_node rt_list_t;
+
+#define RT_NULL                 NULL
+#define RT_TRUE                 1
+#define RT_FALSE                0
+#define RT_EOK                  0
+#define RT_EFULL                3
+#define RT_EINVAL               10
+#define RT_ENOENT               11
+#define rt_inline               static inline
+
+#define rt_memset               memset
+#define rt_kprintf              printf
+
+/* single threaded on the host */
+#define rt_hw_interrupt_disable()       0
+#define rt_hw_interrupt_enable(level)   ((void)(level))
+
+rt_inline void rt_list_init(rt_list_t *l)
+{
+    l->next = l->prev = l;
+}
+
+#define MSH_CMD_EXPORT(cmd, desc)
+
+#endif /* __QSM_SHIM_RTTHREAD_H__ */
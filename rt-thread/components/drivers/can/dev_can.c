@@ -17,6 +17,44 @@
 #define CAN_LOCK(can)   rt_mutex_take(&(can->lock), RT_WAITING_FOREVER)
 #define CAN_UNLOCK(can) rt_mutex_release(&(can->lock))
 
+#ifdef RT_CAN_USING_MSG_HOOK
+/**
+ * @internal
+ * @brief Runs the registered message hooks for one frame.
+ *
+ * The list is walked with interrupts disabled, the same critical section as
+ * RT_CAN_CMD_ADD_MSG_HOOK/DEL_MSG_HOOK, so a hook is never removed while it
+ * runs, whether the frame comes from the ISR or from a sending thread.
+ *
+ * @return RT_TRUE if an RX hook consumed the frame.
+ */
+static rt_bool_t _can_msg_hook_call(struct rt_can_device *can, struct rt_can_msg *msg, rt_uint32_t dir)
+{
+    struct rt_can_msg_hook *hook;
+    rt_bool_t consumed = RT_FALSE;
+    rt_base_t level;
+
+    level = rt_hw_local_irq_disable();
+    rt_slist_for_each_entry(hook, &can->msg_hooks, list)
+    {
+        if ((hook->flags & dir) && hook->hook(can, msg, dir, hook->args) && dir == RT_CAN_MSG_HOOK_RX)
+        {
+            consumed = RT_TRUE;
+            break;
+        }
+    }
+    rt_hw_local_irq_enable(level);
+
+    return consumed;
+}
+#else
+rt_inline rt_bool_t _can_msg_hook_call(struct rt_can_device *can, struct rt_can_msg *msg, rt_uint32_t dir)
+{
+    return RT_FALSE;
+}
+#endif /* RT_CAN_USING_MSG_HOOK */
+#define CAN_MSG_HOOK(can, msg, dir)     _can_msg_hook_call(can, (struct rt_can_msg *)(msg), dir)
+
 static rt_err_t rt_can_init(struct rt_device *dev)
 {
     rt_err_t result = RT_EOK;
@@ -196,6 +234,7 @@ rt_inline int _can_int_tx(struct rt_can_device *can, const struct rt_can_msg *da
             goto err_ret;
         }
 
+        CAN_MSG_HOOK(can, data, RT_CAN_MSG_HOOK_TX);
         can->status.sndchange |= 1<<no;
         if (rt_completion_wait(&(tx_tosnd->completion), RT_CANSND_MSG_TIMEOUT) != RT_EOK)
         {
@@ -290,6 +329,7 @@ rt_inline int _can_int_tx_priv(struct rt_can_device *can, const struct rt_can_ms
         {
             continue;
         }
+        CAN_MSG_HOOK(can, data, RT_CAN_MSG_HOOK_TX);
         can->status.sndchange |= 1<<no;
         if (rt_completion_wait(&(tx_fifo->buffer[no].completion), RT_CANSND_MSG_TIMEOUT) != RT_EOK)
         {
@@ -319,6 +359,213 @@ rt_inline int _can_int_tx_priv(struct rt_can_device *can, const struct rt_can_ms
     return (size - msgs);
 }
 
+#ifdef RT_CAN_USING_TX_PRIO
+/**
+ * @internal
+ * @brief Computes the bus arbitration rank of a frame.
+ *
+ * The rank follows the bit order in which the identifier field is arbitrated
+ * on the bus: the 11-bit base ID, then RTR/SRR, then IDE, then the 18-bit ID
+ * extension and the extended RTR bit. A smaller rank wins arbitration, so a
+ * standard data frame beats a standard remote frame, which beats any extended
+ * frame with the same base ID.
+ */
+rt_inline rt_uint32_t _can_arb_rank(const struct rt_can_msg *msg)
+{
+    if (msg->ide == RT_CAN_STDID)
+    {
+        return ((msg->id & 0x7FFU) << 21) | ((rt_uint32_t)msg->rtr << 20);
+    }
+
+    return (((msg->id >> 18) & 0x7FFU) << 21) | (1U << 20) | (1U << 19) |
+           ((msg->id & 0x3FFFFU) << 1) | msg->rtr;
+}
+
+rt_inline rt_bool_t _can_pq_before(const struct rt_can_tx_prio_node *a,
+                                   const struct rt_can_tx_prio_node *b)
+{
+    if (a->key != b->key)
+    {
+        return a->key < b->key;
+    }
+    /* equal priority: keep submission order, wrap-around safe */
+    return (rt_int32_t)(a->seq - b->seq) < 0;
+}
+
+static void _can_pq_sift_up(struct rt_can_tx_prio_queue *pq, rt_uint16_t pos)
+{
+    struct rt_can_tx_prio_node node = pq->heap[pos];
+
+    while (pos > 0)
+    {
+        rt_uint16_t parent = (pos - 1) >> 1;
+
+        if (!_can_pq_before(&node, &pq->heap[parent]))
+        {
+            break;
+        }
+        pq->heap[pos] = pq->heap[parent];
+        pos = parent;
+    }
+    pq->heap[pos] = node;
+}
+
+static void _can_pq_sift_down(struct rt_can_tx_prio_queue *pq, rt_uint16_t pos)
+{
+    struct rt_can_tx_prio_node node = pq->heap[pos];
+
+    while (RT_TRUE)
+    {
+        rt_uint16_t child = (pos << 1) + 1;
+
+        if (child >= pq->count)
+        {
+            break;
+        }
+        if (child + 1 < pq->count && _can_pq_before(&pq->heap[child + 1], &pq->heap[child]))
+        {
+            child++;
+        }
+        if (!_can_pq_before(&pq->heap[child], &node))
+        {
+            break;
+        }
+        pq->heap[pos] = pq->heap[child];
+        pos = child;
+    }
+    pq->heap[pos] = node;
+}
+
+/**
+ * @internal
+ * @brief Inserts a frame into the priority send queue. Must be called with interrupts disabled.
+ *
+ * @return RT_EOK on success, -RT_EFULL if the queue has no free slot.
+ */
+static rt_err_t _can_pq_push(struct rt_can_tx_prio_queue *pq, const struct rt_can_msg *msg)
+{
+    struct rt_can_tx_prio_node *node;
+
+    if (pq->count >= pq->capacity)
+    {
+        return -RT_EFULL;
+    }
+
+    node = &pq->heap[pq->count];
+    switch (pq->mode)
+    {
+    case RT_CAN_TX_PRIO_ID:
+        node->key = _can_arb_rank(msg);
+        break;
+    case RT_CAN_TX_PRIO_CLASS:
+        node->key = msg->priv;
+        break;
+    default:
+        node->key = 0;
+        break;
+    }
+    node->seq = pq->seq++;
+    rt_memcpy(&node->msg, msg, sizeof(struct rt_can_msg));
+    _can_pq_sift_up(pq, pq->count++);
+
+    pq->enqueued++;
+    if (pq->count > pq->peak)
+    {
+        pq->peak = pq->count;
+    }
+
+    return RT_EOK;
+}
+
+/**
+ * @internal
+ * @brief Removes the highest-priority frame. Must be called with interrupts disabled.
+ */
+static void _can_pq_pop(struct rt_can_tx_prio_queue *pq)
+{
+    RT_ASSERT(pq->count > 0);
+
+    pq->count--;
+    if (pq->count > 0)
+    {
+        pq->heap[0] = pq->heap[pq->count];
+        _can_pq_sift_down(pq, 0);
+    }
+}
+
+/**
+ * @internal
+ * @brief Moves pending frames into free hardware mailboxes, highest priority first.
+ *
+ * The head of the queue is only removed once the hardware has accepted it, and
+ * the whole hand-over runs with interrupts disabled. A thread and the TX-done ISR
+ * can therefore both call this function without ever submitting a lower-priority
+ * frame ahead of a higher-priority one.
+ */
+static void _can_pq_kick(struct rt_can_device *can)
+{
+    rt_base_t level;
+    struct rt_can_tx_prio_queue *pq = &can->nb_tx_pq;
+
+    level = rt_hw_local_irq_disable();
+    while (pq->count > 0)
+    {
+        if (can->ops->sendmsg_nonblocking(can, &pq->heap[0].msg) != RT_EOK)
+        {
+            break;
+        }
+        CAN_MSG_HOOK(can, &pq->heap[0].msg, RT_CAN_MSG_HOOK_TX);
+        _can_pq_pop(pq);
+    }
+    rt_hw_local_irq_enable(level);
+}
+
+/**
+ * @internal
+ * @brief Non-blocking transmission through the priority send queue.
+ *
+ * Every frame is inserted into the heap first and the heap is then drained into
+ * the free mailboxes, so a new frame never overtakes a pending frame of higher
+ * priority, and a pending frame of lower priority never blocks a new critical one.
+ *
+ * @param[in] can   A pointer to the CAN device.
+ * @param[in] pmsg  A pointer to the buffer of `rt_can_msg` structures.
+ * @param[in] size  The total size of the buffer in bytes.
+ *
+ * @return The number of bytes successfully sent or enqueued for later transmission.
+ */
+static rt_ssize_t _can_nonblocking_tx(struct rt_can_device *can, const struct rt_can_msg *pmsg, rt_size_t size)
+{
+    rt_ssize_t sent_size = 0;
+    rt_base_t level;
+
+    if (can->ops->sendmsg_nonblocking == RT_NULL)
+    {
+        return -RT_EINVAL;
+    }
+
+    while (sent_size < size)
+    {
+        level = rt_hw_local_irq_disable();
+        if (_can_pq_push(&can->nb_tx_pq, pmsg) != RT_EOK)
+        {
+            /* Queue is full, cannot process this message or subsequent ones. */
+            can->status.dropedsndpkg += (size - sent_size) / sizeof(struct rt_can_msg);
+            can->nb_tx_pq.dropped += (size - sent_size) / sizeof(struct rt_can_msg);
+            rt_hw_local_irq_enable(level);
+            break;
+        }
+        rt_hw_local_irq_enable(level);
+
+        _can_pq_kick(can);
+
+        pmsg++;
+        sent_size += sizeof(struct rt_can_msg);
+    }
+
+    return sent_size;
+}
+#else
 /**
  * @internal
  * @brief Internal implementation of non-blocking CAN transmission.
@@ -349,6 +596,7 @@ static rt_ssize_t _can_nonblocking_tx(struct rt_can_device *can, const struct rt
     {
         if (can->ops->sendmsg_nonblocking(can, pmsg) == RT_EOK)
         {
+            CAN_MSG_HOOK(can, pmsg, RT_CAN_MSG_HOOK_TX);
             pmsg++;
             sent_size += sizeof(struct rt_can_msg);
             continue;
@@ -375,6 +623,8 @@ static rt_ssize_t _can_nonblocking_tx(struct rt_can_device *can, const struct rt
     return sent_size;
 }
 
+#endif /* RT_CAN_USING_TX_PRIO */
+
 /**
  * @internal
  * @brief Opens the CAN device and initializes its resources.
@@ -455,7 +705,12 @@ static rt_err_t rt_can_open(struct rt_device *dev, rt_uint16_t oflag)
             }
 
             rt_sprintf(tmpname, "%stl", dev->parent.name);
+#ifdef RT_CAN_USING_TX_PRIO
+            /* hand the mailboxes to the most urgent sender first */
+            rt_sem_init(&(tx_fifo->sem), tmpname, can->config.sndboxnumber, RT_IPC_FLAG_PRIO);
+#else
             rt_sem_init(&(tx_fifo->sem), tmpname, can->config.sndboxnumber, RT_IPC_FLAG_FIFO);
+#endif
             can->can_tx = tx_fifo;
 
             dev->open_flag |= RT_DEVICE_FLAG_INT_TX;
@@ -484,11 +739,21 @@ static rt_err_t rt_can_open(struct rt_device *dev, rt_uint16_t oflag)
     }
 #endif
 
+#ifdef RT_CAN_USING_TX_PRIO
+#ifdef RT_CAN_MALLOC_NB_TX_BUFFER
+    can->nb_tx_pq_pool = (struct rt_can_tx_prio_node *)rt_malloc(RT_CAN_TX_PRIO_QUEUE_SZ * sizeof(struct rt_can_tx_prio_node));
+    RT_ASSERT(can->nb_tx_pq_pool != RT_NULL);
+#endif /* RT_CAN_MALLOC_NB_TX_BUFFER  */
+    can->nb_tx_pq.heap = can->nb_tx_pq_pool;
+    can->nb_tx_pq.capacity = RT_CAN_TX_PRIO_QUEUE_SZ;
+    can->nb_tx_pq.count = 0;
+#else
 #ifdef RT_CAN_MALLOC_NB_TX_BUFFER
     can->nb_tx_rb_pool = (rt_uint8_t *)rt_malloc(RT_CAN_NB_TX_FIFO_SIZE);
     RT_ASSERT(can->nb_tx_rb_pool != RT_NULL);
 #endif /* RT_CAN_MALLOC_NB_TX_BUFFER  */
     rt_ringbuffer_init(&can->nb_tx_rb, can->nb_tx_rb_pool, RT_CAN_NB_TX_FIFO_SIZE);
+#endif /* RT_CAN_USING_TX_PRIO */
 
     if (!can->timerinitflag)
     {
@@ -519,11 +784,23 @@ static rt_err_t rt_can_close(struct rt_device *dev)
     }
 
 #ifdef RT_CAN_MALLOC_NB_TX_BUFFER
+#ifdef RT_CAN_USING_TX_PRIO
+    if (can->nb_tx_pq_pool)
+    {
+        rt_base_t level = rt_hw_local_irq_disable();
+        can->nb_tx_pq.heap = RT_NULL;
+        can->nb_tx_pq.count = 0;
+        rt_hw_local_irq_enable(level);
+        rt_free(can->nb_tx_pq_pool);
+        can->nb_tx_pq_pool = RT_NULL;
+    }
+#else
     if (can->nb_tx_rb_pool)
     {
         rt_free(can->nb_tx_rb_pool);
         can->nb_tx_rb_pool = RT_NULL;
     }
+#endif /* RT_CAN_USING_TX_PRIO */
 #endif
 
     if (can->timerinitflag)
@@ -825,6 +1102,70 @@ static rt_err_t rt_can_control(struct rt_device *dev,
         }
         break;
 #endif /*RT_CAN_USING_HDR*/
+#ifdef RT_CAN_USING_TX_PRIO
+    case RT_CAN_CMD_SET_TX_PRIO:
+    {
+        rt_base_t level;
+        rt_uint32_t mode = (rt_uint32_t)(rt_ubase_t)args;
+
+        if (mode > RT_CAN_TX_PRIO_CLASS)
+        {
+            return -RT_EINVAL;
+        }
+
+        level = rt_hw_local_irq_disable();
+        /* the keys of pending frames follow the old policy, only switch on an empty queue */
+        if (can->nb_tx_pq.count != 0)
+        {
+            res = -RT_EBUSY;
+        }
+        else
+        {
+            can->nb_tx_pq.mode = mode;
+        }
+        rt_hw_local_irq_enable(level);
+        break;
+    }
+
+    case RT_CAN_CMD_GET_TX_PRIO_STAT:
+    {
+        rt_base_t level;
+        struct rt_can_tx_prio_stat *stat = (struct rt_can_tx_prio_stat *)args;
+
+        RT_ASSERT(stat != RT_NULL);
+        level = rt_hw_local_irq_disable();
+        stat->mode     = can->nb_tx_pq.mode;
+        stat->pending  = can->nb_tx_pq.count;
+        stat->peak     = can->nb_tx_pq.peak;
+        stat->enqueued = can->nb_tx_pq.enqueued;
+        stat->dropped  = can->nb_tx_pq.dropped;
+        rt_hw_local_irq_enable(level);
+        break;
+    }
+#endif /* RT_CAN_USING_TX_PRIO */
+#ifdef RT_CAN_USING_MSG_HOOK
+    case RT_CAN_CMD_ADD_MSG_HOOK:
+    case RT_CAN_CMD_DEL_MSG_HOOK:
+    {
+        rt_base_t level;
+        struct rt_can_msg_hook *hook = (struct rt_can_msg_hook *)args;
+
+        if (hook == RT_NULL || (cmd == RT_CAN_CMD_ADD_MSG_HOOK && hook->hook == RT_NULL))
+        {
+            return -RT_EINVAL;
+        }
+
+        level = rt_hw_local_irq_disable();
+        rt_slist_remove(&can->msg_hooks, &hook->list);
+        if (cmd == RT_CAN_CMD_ADD_MSG_HOOK)
+        {
+            rt_slist_init(&hook->list);
+            rt_slist_append(&can->msg_hooks, &hook->list);
+        }
+        rt_hw_local_irq_enable(level);
+        break;
+    }
+#endif /* RT_CAN_USING_MSG_HOOK */
 #ifdef RT_CAN_USING_BUS_HOOK
     case RT_CAN_CMD_SET_BUS_HOOK:
         can->bus_hook = (rt_can_bus_hook) args;
@@ -919,8 +1260,17 @@ rt_err_t rt_hw_can_register(struct rt_can_device    *can,
 #ifdef RT_CAN_USING_BUS_HOOK
     can->bus_hook       = RT_NULL;
 #endif /*RT_CAN_USING_BUS_HOOK*/
+#ifdef RT_CAN_USING_MSG_HOOK
+    rt_slist_init(&can->msg_hooks);
+#endif /*RT_CAN_USING_MSG_HOOK*/
 
+#ifdef RT_CAN_USING_TX_PRIO
+    rt_memset(&can->nb_tx_pq, 0, sizeof(can->nb_tx_pq));
+    can->nb_tx_pq.mode = RT_CAN_TX_PRIO_FIFO;
 #ifdef RT_CAN_MALLOC_NB_TX_BUFFER
+    can->nb_tx_pq_pool = RT_NULL;
+#endif
+#elif defined(RT_CAN_MALLOC_NB_TX_BUFFER)
     can->nb_tx_rb_pool = RT_NULL;
 #endif
 
@@ -997,6 +1347,15 @@ void rt_hw_can_isr(struct rt_can_device *can, int event)
         ch = can->ops->recvmsg(can, &tmpmsg, no);
         if (ch == -1) break;
 
+        if (CAN_MSG_HOOK(can, &tmpmsg, RT_CAN_MSG_HOOK_RX))
+        {
+            /* consumed by a hook, bypass the software FIFO */
+            level = rt_hw_local_irq_disable();
+            can->status.rcvpkg++;
+            rt_hw_local_irq_enable(level);
+            break;
+        }
+
         /* disable interrupt */
         level = rt_hw_local_irq_disable();
         can->status.rcvpkg++;
@@ -1113,6 +1472,13 @@ void rt_hw_can_isr(struct rt_can_device *can, int event)
             rt_completion_done(&(tx_fifo->buffer[no].completion));
         }
 
+#ifdef RT_CAN_USING_TX_PRIO
+        if (can->ops->sendmsg_nonblocking != RT_NULL && can->nb_tx_pq.heap != RT_NULL)
+        {
+            /* refill the freed mailbox with the most urgent pending frame */
+            _can_pq_kick(can);
+        }
+#else
         if (can->ops->sendmsg_nonblocking != RT_NULL)
         {
             while (RT_TRUE)
@@ -1141,8 +1507,10 @@ void rt_hw_can_isr(struct rt_can_device *can, int event)
                     rt_hw_local_irq_enable(level);
                     break;
                 }
+                CAN_MSG_HOOK(can, &msg_to_send, RT_CAN_MSG_HOOK_TX);
             }
         }
+#endif /* RT_CAN_USING_TX_PRIO */
         break;
     }
     }
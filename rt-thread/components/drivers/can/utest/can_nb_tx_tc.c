@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Test Case for the CAN non-blocking send path
+ *
+ * The simulated controller of can_sim.h is registered with the
+ * `sendmsg_nonblocking` op, like drv_can.c of the AT32 BSP, and a second one
+ * without it. Frames flagged `nonblocking` go to a free mailbox first, then to
+ * the software queue (the ring buffer, or the priority queue in its default
+ * FIFO mode), and the queue is drained on every TX done event.
+ *
+ * Test Criteria:
+ * - Every frame written while the queue has room is accepted and reaches the
+ *   bus in submission order.
+ * - The frames beyond the queue capacity are refused and counted as dropped.
+ * - A controller without `sendmsg_nonblocking` refuses non-blocking writes
+ *   with -RT_EINVAL.
+ */
+
+#include "utest.h"
+#include "can_sim.h"
+
+#define SIM_ID              0x123
+
+#ifdef RT_CAN_USING_TX_PRIO
+#define SIM_QUEUE_NUM       RT_CAN_TX_PRIO_QUEUE_SZ
+#else
+#define SIM_QUEUE_NUM       (RT_CAN_NB_TX_FIFO_SIZE / sizeof(struct rt_can_msg))
+#endif
+
+static struct can_sim _sim;
+static struct can_sim _sim_no_nb;
+
+static rt_ssize_t sim_send(rt_device_t dev, rt_uint16_t seq)
+{
+    struct rt_can_msg msg = {0};
+
+    msg.id = SIM_ID;
+    msg.ide = RT_CAN_STDID;
+    msg.len = 8;
+    msg.nonblocking = 1;
+    msg.data[0] = seq & 0xFF;
+    msg.data[1] = seq >> 8;
+
+    return rt_device_write(dev, 0, &msg, sizeof(msg));
+}
+
+static void test_can_nb_tx_order(void)
+{
+    struct rt_can_msg sent;
+    rt_uint16_t i, seq = 0;
+
+    /* the mailboxes and the whole queue */
+    for (i = 0; i < CAN_SIM_MAILBOX_NUM + SIM_QUEUE_NUM; i++)
+    {
+        uassert_int_equal(sim_send(&_sim.can.parent, i), sizeof(struct rt_can_msg));
+    }
+
+    while (can_sim_bus_step(&_sim, &sent))
+    {
+        uassert_int_equal(sent.data[0] | sent.data[1] << 8, seq);
+        seq++;
+    }
+    uassert_int_equal(seq, CAN_SIM_MAILBOX_NUM + SIM_QUEUE_NUM);
+    uassert_int_equal(_sim.can.status.dropedsndpkg, 0);
+}
+
+static void test_can_nb_tx_overflow(void)
+{
+    struct rt_can_msg sent;
+    rt_uint16_t i, seq = 0;
+
+    for (i = 0; i < CAN_SIM_MAILBOX_NUM + SIM_QUEUE_NUM; i++)
+    {
+        uassert_int_equal(sim_send(&_sim.can.parent, i), sizeof(struct rt_can_msg));
+    }
+    /* mailboxes and queue are full */
+    uassert_int_equal(sim_send(&_sim.can.parent, i), 0);
+    uassert_int_equal(_sim.can.status.dropedsndpkg, 1);
+
+    /* the accepted frames are still sent in order, the refused one never */
+    while (can_sim_bus_step(&_sim, &sent))
+    {
+        uassert_int_equal(sent.data[0] | sent.data[1] << 8, seq);
+        seq++;
+    }
+    uassert_int_equal(seq, CAN_SIM_MAILBOX_NUM + SIM_QUEUE_NUM);
+}
+
+static void test_can_nb_tx_no_op(void)
+{
+    uassert_int_equal(sim_send(&_sim_no_nb.can.parent, 0), -RT_EINVAL);
+}
+
+static rt_err_t utest_tc_init(void)
+{
+    if (can_sim_register(&_sim, "cansim", RT_TRUE) != RT_EOK)
+    {
+        return -RT_ERROR;
+    }
+
+    return can_sim_register(&_sim_no_nb, "cansim1", RT_FALSE);
+}
+
+static rt_err_t utest_tc_cleanup(void)
+{
+    can_sim_unregister(&_sim);
+    can_sim_unregister(&_sim_no_nb);
+
+    return RT_EOK;
+}
+
+static void testcase(void)
+{
+    UTEST_UNIT_RUN(test_can_nb_tx_order);
+    UTEST_UNIT_RUN(test_can_nb_tx_overflow);
+    UTEST_UNIT_RUN(test_can_nb_tx_no_op);
+}
+UTEST_TC_EXPORT(testcase, "components.drivers.can.nb_tx_tc", utest_tc_init, utest_tc_cleanup, 10);
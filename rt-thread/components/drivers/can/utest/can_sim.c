@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "can_sim.h"
+
+static rt_err_t sim_configure(struct rt_can_device *can, struct can_configure *cfg)
+{
+    return RT_EOK;
+}
+
+static rt_err_t sim_control(struct rt_can_device *can, int cmd, void *arg)
+{
+    return RT_EOK;
+}
+
+static rt_ssize_t sim_sendmsg(struct rt_can_device *can, const void *buf, rt_uint32_t boxno)
+{
+    return -RT_ENOSYS;
+}
+
+static rt_ssize_t sim_recvmsg(struct rt_can_device *can, void *buf, rt_uint32_t fifo)
+{
+    return -RT_ENOSYS;
+}
+
+static rt_ssize_t sim_sendmsg_nonblocking(struct rt_can_device *can, const void *buf)
+{
+    struct can_sim *sim = (struct can_sim *)can;
+    int i;
+
+    for (i = 0; i < CAN_SIM_MAILBOX_NUM; i++)
+    {
+        if (!sim->busy[i])
+        {
+            rt_memcpy(&sim->mailbox[i], buf, sizeof(struct rt_can_msg));
+            sim->order[i] = sim->request++;
+            sim->busy[i] = RT_TRUE;
+            return RT_EOK;
+        }
+    }
+
+    return -RT_EBUSY;
+}
+
+static const struct rt_can_ops _sim_ops =
+{
+    sim_configure,
+    sim_control,
+    sim_sendmsg,
+    sim_recvmsg,
+    sim_sendmsg_nonblocking,
+};
+
+static const struct rt_can_ops _sim_no_nb_ops =
+{
+    sim_configure,
+    sim_control,
+    sim_sendmsg,
+    sim_recvmsg,
+    RT_NULL,
+};
+
+rt_err_t can_sim_register(struct can_sim *sim, const char *name, rt_bool_t nonblocking)
+{
+    struct can_configure config = CANDEFAULTCONFIG;
+
+    rt_memset(sim, 0, sizeof(*sim));
+    config.ticks = RT_TICK_PER_SECOND;
+    sim->can.config = config;
+
+    if (rt_hw_can_register(&sim->can, name, nonblocking ? &_sim_ops : &_sim_no_nb_ops, sim) != RT_EOK)
+    {
+        return -RT_ERROR;
+    }
+
+    return rt_device_open(&sim->can.parent, RT_DEVICE_FLAG_INT_TX);
+}
+
+void can_sim_unregister(struct can_sim *sim)
+{
+    rt_device_close(&sim->can.parent);
+    rt_device_unregister(&sim->can.parent);
+    rt_mutex_detach(&sim->can.lock);
+    rt_timer_detach(&sim->can.timer);
+}
+
+rt_bool_t can_sim_bus_step(struct can_sim *sim, struct rt_can_msg *sent)
+{
+    int i, box = -1;
+
+    for (i = 0; i < CAN_SIM_MAILBOX_NUM; i++)
+    {
+        if (sim->busy[i] && (box < 0 || (rt_int32_t)(sim->order[i] - sim->order[box]) < 0))
+        {
+            box = i;
+        }
+    }
+    if (box < 0)
+    {
+        return RT_FALSE;
+    }
+
+    rt_memcpy(sent, &sim->mailbox[box], sizeof(struct rt_can_msg));
+    sim->busy[box] = RT_FALSE;
+    rt_hw_can_isr(&sim->can, RT_CAN_EVENT_TX_DONE | box << 8);
+
+    return RT_TRUE;
+}
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Simulated CAN controller of the CAN test cases
+ *
+ * It has three transmit mailboxes which are served in request order, like the
+ * AT32 controller configured with CAN_SENDING_BY_REQUEST. The frames are put
+ * on the bus one at a time by can_sim_bus_step(), which raises the TX done
+ * event of the mailbox.
+ */
+
+#ifndef __CAN_SIM_H__
+#define __CAN_SIM_H__
+
+#include <rtthread.h>
+#include <rtdevice.h>
+
+#define CAN_SIM_MAILBOX_NUM     3
+
+struct can_sim
+{
+    struct rt_can_device can;
+    struct rt_can_msg mailbox[CAN_SIM_MAILBOX_NUM];
+    rt_uint32_t order[CAN_SIM_MAILBOX_NUM];     /* request order of each pending mailbox */
+    rt_bool_t busy[CAN_SIM_MAILBOX_NUM];
+    rt_uint32_t request;
+};
+
+/**
+ * Register and open the simulated controller.
+ *
+ * @param sim the controller
+ * @param name the device name
+ * @param nonblocking RT_TRUE: it has the sendmsg_nonblocking op, RT_FALSE: it doesn't
+ *
+ * @return RT_EOK on success
+ */
+rt_err_t can_sim_register(struct can_sim *sim, const char *name, rt_bool_t nonblocking);
+
+/**
+ * Close and unregister the simulated controller.
+ *
+ * @param sim the controller
+ */
+void can_sim_unregister(struct can_sim *sim);
+
+/**
+ * Put the frame of the earliest requested mailbox on the bus.
+ *
+ * @param sim the controller
+ * @param sent the frame put on the bus
+ *
+ * @return RT_FALSE if all mailboxes are empty
+ */
+rt_bool_t can_sim_bus_step(struct can_sim *sim, struct rt_can_msg *sent);
+
+#endif /* __CAN_SIM_H__ */
@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2006-2025, RT-Thread Development Team
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/**
+ * Test Case for the CAN priority send queue (RT_CAN_USING_TX_PRIO)
+ *
+ * The simulated controller of can_sim.h is registered and the bus is stepped
+ * one frame time at a time.
+ *
+ * The scenario fills the queue with an ISO-TP consecutive frame stream on a
+ * low-priority ID, then submits one critical frame and counts how many frame
+ * times it waits before reaching the bus.
+ *
+ * Test Criteria:
+ * - In ID mode the critical frame waits at most one frame time per hardware
+ *   mailbox, independent of the queue depth.
+ * - In FIFO mode the same frame waits behind the whole stream (reference).
+ * - Frames with the same ID always leave in submission order.
+ * - Class mode orders by `priv` and keeps FIFO order within a class.
+ */
+
+#include "utest.h"
+#include "can_sim.h"
+
+#define SIM_BULK_ID         0x7E8
+#define SIM_CRITICAL_ID     0x080
+#define SIM_MAX_STEPS       (RT_CAN_TX_PRIO_QUEUE_SZ * 4)
+
+static struct can_sim _sim;
+
+static void sim_send(rt_uint32_t id, rt_uint8_t seq, rt_uint8_t cls)
+{
+    struct rt_can_msg msg = {0};
+
+    msg.id = id;
+    msg.ide = RT_CAN_STDID;
+    msg.len = 8;
+    msg.priv = cls;
+    msg.nonblocking = 1;
+    msg.data[0] = 0x20 | (seq & 0x0F);
+    msg.data[1] = seq;
+    uassert_int_equal(rt_device_write(&_sim.can.parent, 0, &msg, sizeof(msg)), sizeof(msg));
+}
+
+/* fill the queue with a bulk stream, add one critical frame, return its wait in frame times */
+static int sim_critical_delay(rt_uint32_t mode)
+{
+    struct rt_can_msg sent;
+    int i, step, delay = -1;
+    rt_uint8_t last_seq = 0;
+    rt_bool_t first = RT_TRUE;
+
+    uassert_int_equal(rt_device_control(&_sim.can.parent, RT_CAN_CMD_SET_TX_PRIO, (void *)(rt_ubase_t)mode), RT_EOK);
+
+    /* mailboxes plus the whole queue taken by the stream */
+    for (i = 0; i < CAN_SIM_MAILBOX_NUM + RT_CAN_TX_PRIO_QUEUE_SZ - 1; i++)
+    {
+        sim_send(SIM_BULK_ID, (rt_uint8_t)i, 7);
+    }
+    sim_send(SIM_CRITICAL_ID, 0, 0);
+
+    for (step = 0; step < SIM_MAX_STEPS && can_sim_bus_step(&_sim, &sent); step++)
+    {
+        if (sent.id == SIM_CRITICAL_ID)
+        {
+            delay = step;
+            continue;
+        }
+        /* the stream must never be reordered */
+        if (!first)
+        {
+            uassert_int_equal((rt_uint8_t)(last_seq + 1), sent.data[1]);
+        }
+        last_seq = sent.data[1];
+        first = RT_FALSE;
+    }
+
+    return delay;
+}
+
+static void test_can_tx_prio_id(void)
+{
+    int fifo_delay, id_delay;
+
+    fifo_delay = sim_critical_delay(RT_CAN_TX_PRIO_FIFO);
+    id_delay = sim_critical_delay(RT_CAN_TX_PRIO_ID);
+
+    LOG_I("critical frame wait: fifo %d frames, by id %d frames", fifo_delay, id_delay);
+    uassert_true(fifo_delay >= RT_CAN_TX_PRIO_QUEUE_SZ);
+    uassert_true(id_delay >= 0 && id_delay <= CAN_SIM_MAILBOX_NUM);
+}
+
+static void test_can_tx_prio_class(void)
+{
+    struct rt_can_msg sent;
+    rt_uint8_t expect[2] = {0, 0};
+
+    uassert_int_equal(rt_device_control(&_sim.can.parent, RT_CAN_CMD_SET_TX_PRIO, (void *)RT_CAN_TX_PRIO_CLASS), RT_EOK);
+
+    /* occupy the mailboxes so that everything below is queued */
+    sim_send(0x700, 0, 3);
+    sim_send(0x700, 1, 3);
+    sim_send(0x700, 2, 3);
+
+    /* a low class on a high priority ID, a high class on a low priority ID */
+    sim_send(0x001, 0, 3);
+    sim_send(0x7FF, 0, 1);
+    sim_send(0x001, 1, 3);
+    sim_send(0x7FF, 1, 1);
+
+    /* drain the mailboxes */
+    uassert_true(can_sim_bus_step(&_sim, &sent));
+    uassert_true(can_sim_bus_step(&_sim, &sent));
+    uassert_true(can_sim_bus_step(&_sim, &sent));
+
+    while (can_sim_bus_step(&_sim, &sent))
+    {
+        if (sent.id == 0x7FF)
+        {
+            uassert_int_equal(sent.data[1], expect[0]++);
+            /* class 1 is drained before any class 3 frame */
+            uassert_int_equal(expect[1], 0);
+        }
+        else
+        {
+            uassert_int_equal(sent.data[1], expect[1]++);
+        }
+    }
+    uassert_int_equal(expect[0], 2);
+    uassert_int_equal(expect[1], 2);
+}
+
+static void test_can_tx_prio_stat(void)
+{
+    struct rt_can_tx_prio_stat stat;
+
+    uassert_int_equal(rt_device_control(&_sim.can.parent, RT_CAN_CMD_GET_TX_PRIO_STAT, &stat), RT_EOK);
+    uassert_int_equal(stat.pending, 0);
+    uassert_int_equal(stat.dropped, 0);
+    uassert_int_equal(stat.peak, RT_CAN_TX_PRIO_QUEUE_SZ);
+}
+
+static rt_err_t utest_tc_init(void)
+{
+    return can_sim_register(&_sim, "cansim", RT_TRUE);
+}
+
+static rt_err_t utest_tc_cleanup(void)
+{
+    can_sim_unregister(&_sim);
+    return RT_EOK;
+}
+
+static void testcase(void)
+{
+    UTEST_UNIT_RUN(test_can_tx_prio_id);
+    UTEST_UNIT_RUN(test_can_tx_prio_class);
+    UTEST_UNIT_RUN(test_can_tx_prio_stat);
+}
+UTEST_TC_EXPORT(testcase, "components.drivers.can.tx_prio_tc", utest_tc_init, utest_tc_cleanup, 10);
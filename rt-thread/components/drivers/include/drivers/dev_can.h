@@ -414,9 +414,17 @@ struct rt_can_ops;
 #define RT_CAN_CMD_SET_BAUD_FD      0x1B
 #define RT_CAN_CMD_SET_BITTIMING    0x1C
 #define RT_CAN_CMD_START            0x1D
+#define RT_CAN_CMD_SET_TX_PRIO      0x1E
+#define RT_CAN_CMD_GET_TX_PRIO_STAT 0x1F
+#define RT_CAN_CMD_ADD_MSG_HOOK     0x20
+#define RT_CAN_CMD_DEL_MSG_HOOK     0x21
 
 #define RT_DEVICE_CAN_INT_ERR       0x1000
 
+#define RT_CAN_TX_PRIO_FIFO         0   /* submission order */
+#define RT_CAN_TX_PRIO_ID           1   /* bus arbitration order of the identifier */
+#define RT_CAN_TX_PRIO_CLASS        2   /* `priv` field as class, 0 is the highest */
+
 enum RT_CAN_STATUS_MODE
 {
     NORMAL = 0,
@@ -529,6 +537,84 @@ typedef struct rt_can_msg *rt_can_msg_t;
 #define RT_CAN_NB_TX_FIFO_SIZE   (RT_CANMSG_BOX_SZ * sizeof(struct rt_can_msg))
 #endif
 
+#define RT_CAN_MSG_HOOK_RX          0x01    /* frame received */
+#define RT_CAN_MSG_HOOK_TX          0x02    /* frame handed to a mailbox */
+
+#ifdef RT_CAN_USING_MSG_HOOK
+/**
+ * @brief Per-frame message hook, registered with RT_CAN_CMD_ADD_MSG_HOOK.
+ *
+ * Received frames are passed from the CAN ISR. Transmitted frames are passed
+ * from the context that fills the mailbox: the TX done ISR for queued frames,
+ * or the sending thread for direct ones. In every case the hooks are called
+ * with interrupts disabled, so a hook must be short and must not block.
+ * Once RT_CAN_CMD_DEL_MSG_HOOK returns, the hook is not running and will not
+ * be called again, and its memory may be reused.
+ *
+ * For received frames, returning RT_TRUE consumes the frame: it is not stored
+ * in the software RX FIFO and the following hooks do not see it. The return
+ * value is ignored for transmitted frames.
+ */
+struct rt_can_msg_hook
+{
+    rt_slist_t list;                /**< Link into the device hook list. */
+    rt_uint32_t flags;              /**< Directions of interest, RT_CAN_MSG_HOOK_RX/TX. */
+    /**
+     * @param[in] can   The CAN device that carried the frame.
+     * @param[in] msg   The frame.
+     * @param[in] dir   RT_CAN_MSG_HOOK_RX or RT_CAN_MSG_HOOK_TX.
+     * @param[in] args  The `args` field of this hook.
+     */
+    rt_bool_t (*hook)(struct rt_can_device *can, struct rt_can_msg *msg, rt_uint32_t dir, void *args);
+    void *args;                     /**< User argument for the hook. */
+};
+#endif /* RT_CAN_USING_MSG_HOOK */
+
+#ifdef RT_CAN_USING_TX_PRIO
+#ifndef RT_CAN_TX_PRIO_QUEUE_SZ
+#define RT_CAN_TX_PRIO_QUEUE_SZ  16
+#endif
+
+/**
+ * @internal
+ * @brief One pending frame of the priority send queue.
+ */
+struct rt_can_tx_prio_node
+{
+    rt_uint32_t key;                /**< Sort key, a smaller key is sent first. */
+    rt_uint32_t seq;                /**< Submission sequence, keeps equal keys in FIFO order. */
+    struct rt_can_msg msg;          /**< The frame to be sent. */
+};
+
+/**
+ * @internal
+ * @brief Priority send queue, a binary min-heap ordered by (key, seq).
+ */
+struct rt_can_tx_prio_queue
+{
+    struct rt_can_tx_prio_node *heap;   /**< Heap storage, `capacity` nodes. */
+    rt_uint16_t count;                  /**< The number of pending frames. */
+    rt_uint16_t capacity;               /**< The maximum number of pending frames. */
+    rt_uint32_t seq;                    /**< The next submission sequence number. */
+    rt_uint32_t mode;                   /**< The ordering policy, RT_CAN_TX_PRIO_xxx. */
+    rt_uint32_t peak;                   /**< The highest number of frames ever queued. */
+    rt_uint32_t enqueued;               /**< Total frames that went through the queue. */
+    rt_uint32_t dropped;                /**< Total frames dropped because the queue was full. */
+};
+
+/**
+ * @brief Priority send queue statistics, returned by RT_CAN_CMD_GET_TX_PRIO_STAT.
+ */
+struct rt_can_tx_prio_stat
+{
+    rt_uint32_t mode;               /**< The current ordering policy. */
+    rt_uint32_t pending;            /**< The number of frames currently queued. */
+    rt_uint32_t peak;               /**< The highest number of frames ever queued. */
+    rt_uint32_t enqueued;           /**< Total frames that went through the queue. */
+    rt_uint32_t dropped;            /**< Total frames dropped because the queue was full. */
+};
+#endif /* RT_CAN_USING_TX_PRIO */
+
 /**
  * @brief The core CAN device structure.
  */
@@ -550,16 +636,28 @@ struct rt_can_device
 #ifdef RT_CAN_USING_BUS_HOOK
     rt_can_bus_hook bus_hook;           /**< The user-registered periodic bus hook function. */
 #endif /*RT_CAN_USING_BUS_HOOK*/
+#ifdef RT_CAN_USING_MSG_HOOK
+    rt_slist_t msg_hooks;               /**< The registered per-frame message hooks. */
+#endif /*RT_CAN_USING_MSG_HOOK*/
     struct rt_mutex lock;               /**< A mutex for thread-safe access to the device. */
     void *can_rx;                       /**< A pointer to the software receive FIFO structure (`rt_can_rx_fifo`). */
     void *can_tx;                       /**< A pointer to the software transmit FIFO structure (`rt_can_tx_fifo`). */
 
+#ifdef RT_CAN_USING_TX_PRIO
+    struct rt_can_tx_prio_queue nb_tx_pq; /**< The priority queue for non-blocking transmissions. */
+#ifdef RT_CAN_MALLOC_NB_TX_BUFFER
+    struct rt_can_tx_prio_node *nb_tx_pq_pool; /**< A pointer to the dynamically allocated pool for the priority queue. */
+#else
+    struct rt_can_tx_prio_node nb_tx_pq_pool[RT_CAN_TX_PRIO_QUEUE_SZ]; /**< The statically allocated pool for the priority queue. */
+#endif /* RT_CAN_MALLOC_NB_TX_BUFFER  */
+#else
     struct rt_ringbuffer nb_tx_rb;      /**< The ring buffer for non-blocking transmissions. */
 #ifdef RT_CAN_MALLOC_NB_TX_BUFFER
     rt_uint8_t *nb_tx_rb_pool;          /**< A pointer to the dynamically allocated pool for the non-blocking TX ring buffer. */
 #else
     rt_uint8_t nb_tx_rb_pool[RT_CAN_NB_TX_FIFO_SIZE]; /**< The statically allocated pool for the non-blocking TX ring buffer. */
 #endif /* RT_CAN_MALLOC_NB_TX_BUFFER  */
+#endif /* RT_CAN_USING_TX_PRIO */
 };
 typedef struct rt_can_device *rt_can_t;
 
@@ -20,6 +20,12 @@ struct spi_flash_device
     struct rt_device_blk_geometry   geometry;
     struct rt_spi_device *          rt_spi_device;
     struct rt_mutex                 lock;
+#ifdef RT_SFUD_USING_ERASE_SUSPEND
+    rt_atomic_t                     read_waiting;
+    rt_uint16_t                     lock_depth;     /* the times the owner holds the lock */
+#endif
+    /* the flash is changed by the block device or the 'sf' command, the range is aligned to the erase size */
+    void (*changed_hook)(struct spi_flash_device *flash_dev, rt_uint32_t addr, rt_size_t size);
     void *                          user_data;
 };
 
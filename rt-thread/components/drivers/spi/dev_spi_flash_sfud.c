@@ -41,6 +41,24 @@
 }
 #endif /* SFUD_USING_QSPI */
 
+/**
+ * Call the changed hook of the flash after the block device or the 'sf' command writes or erases it. The range is
+ * rounded to the erase granularity, as the erase and the block device write change the whole sectors.
+ */
+static void flash_changed(const sfud_flash *sfud_dev, uint32_t addr, size_t size) {
+    rt_spi_flash_device_t rtt_dev = (rt_spi_flash_device_t) sfud_dev->user_data;
+    uint32_t start = addr, end = addr + size;
+
+    if (rtt_dev == RT_NULL || rtt_dev->changed_hook == RT_NULL) {
+        return;
+    }
+    if (sfud_dev->chip.erase_gran) {
+        start -= start % sfud_dev->chip.erase_gran;
+        end = (end + sfud_dev->chip.erase_gran - 1) / sfud_dev->chip.erase_gran * sfud_dev->chip.erase_gran;
+    }
+    rtt_dev->changed_hook(rtt_dev, start, end - start);
+}
+
 static rt_err_t rt_sfud_control(rt_device_t dev, int cmd, void *args) {
     RT_ASSERT(dev);
 
@@ -63,6 +81,7 @@ static rt_err_t rt_sfud_control(rt_device_t dev, int cmd, void *args) {
         struct spi_flash_device *rtt_dev = (struct spi_flash_device *) (dev->user_data);
         sfud_flash *sfud_dev = (sfud_flash *) (rtt_dev->user_data);
         rt_size_t phy_size;
+        sfud_err result;
 
         if (addrs == RT_NULL || start_addr > end_addr || rtt_dev == RT_NULL || sfud_dev == RT_NULL) {
             return -RT_ERROR;
@@ -75,7 +94,9 @@ static rt_err_t rt_sfud_control(rt_device_t dev, int cmd, void *args) {
         phy_start_addr = start_addr * rtt_dev->geometry.bytes_per_sector;
         phy_size = (end_addr - start_addr) * rtt_dev->geometry.bytes_per_sector;
 
-        if (sfud_erase(sfud_dev, phy_start_addr, phy_size) != SFUD_SUCCESS) {
+        result = sfud_erase(sfud_dev, phy_start_addr, phy_size);
+        flash_changed(sfud_dev, phy_start_addr, phy_size);
+        if (result != SFUD_SUCCESS) {
             return -RT_ERROR;
         }
         break;
@@ -97,7 +118,7 @@ static rt_ssize_t rt_sfud_read(rt_device_t dev, rt_off_t pos, void* buffer, rt_s
     rt_off_t phy_pos = pos * rtt_dev->geometry.bytes_per_sector;
     rt_size_t phy_size = size * rtt_dev->geometry.bytes_per_sector;
 
-    if (sfud_read(sfud_dev, phy_pos, phy_size, buffer) != SFUD_SUCCESS) {
+    if (rt_sfud_flash_read(sfud_dev, phy_pos, phy_size, buffer) != SFUD_SUCCESS) {
         return 0;
     } else {
         return size;
@@ -115,7 +136,10 @@ static rt_ssize_t rt_sfud_write(rt_device_t dev, rt_off_t pos, const void* buffe
     rt_off_t phy_pos = pos * rtt_dev->geometry.bytes_per_sector;
     rt_size_t phy_size = size * rtt_dev->geometry.bytes_per_sector;
 
-    if (sfud_erase_write(sfud_dev, phy_pos, phy_size, buffer) != SFUD_SUCCESS) {
+    sfud_err result = sfud_erase_write(sfud_dev, phy_pos, phy_size, buffer);
+
+    flash_changed(sfud_dev, phy_pos, phy_size);
+    if (result != SFUD_SUCCESS) {
         return 0;
     } else {
         return size;
@@ -177,6 +201,75 @@ static sfud_err spi_write_read(const sfud_spi *spi, const uint8_t *write_buf, si
     return result;
 }
 
+/**
+ * write the command then the data in one CS active period, the data is sent from the caller buffer
+ */
+static sfud_err spi_write_write(const sfud_spi *spi, const uint8_t *cmd_buf, size_t cmd_size, const uint8_t *data_buf,
+        size_t data_size) {
+    sfud_err result = SFUD_SUCCESS;
+    sfud_flash *sfud_dev = (sfud_flash *) (spi->user_data);
+    struct spi_flash_device *rtt_dev = (struct spi_flash_device *) (sfud_dev->user_data);
+
+    RT_ASSERT(spi);
+    RT_ASSERT(sfud_dev);
+    RT_ASSERT(rtt_dev);
+    RT_ASSERT(cmd_buf && cmd_size);
+    if (data_size) {
+        RT_ASSERT(data_buf);
+    }
+#ifdef SFUD_USING_QSPI
+    if(rtt_dev->rt_spi_device->bus->mode & RT_SPI_BUS_MODE_QSPI) {
+        struct rt_qspi_message message;
+
+        /* the command is the instruction and the address, the data is the data stage */
+        message.instruction.content = cmd_buf[0];
+        message.instruction.qspi_lines = 1;
+        if (cmd_size == 5) {
+            message.address.content = (cmd_buf[1] << 24) | (cmd_buf[2] << 16) | (cmd_buf[3] << 8) | (cmd_buf[4]);
+            message.address.size = 32;
+            message.address.qspi_lines = 1;
+        } else if (cmd_size == 4) {
+            message.address.content = (cmd_buf[1] << 16) | (cmd_buf[2] << 8) | (cmd_buf[3]);
+            message.address.size = 24;
+            message.address.qspi_lines = 1;
+        } else {
+            RT_ASSERT(cmd_size == 1);
+            message.address.content = 0;
+            message.address.size = 0;
+            message.address.qspi_lines = 0;
+        }
+        message.alternate_bytes.content = 0;
+        message.alternate_bytes.size = 0;
+        message.alternate_bytes.qspi_lines = 0;
+        message.dummy_cycles = 0;
+        message.qspi_data_lines = data_size ? 1 : 0;
+        message.parent.send_buf = data_buf;
+        message.parent.recv_buf = RT_NULL;
+        message.parent.length = data_size;
+        message.parent.cs_take = 1;
+        message.parent.cs_release = 1;
+        message.parent.next = RT_NULL;
+        if (rt_qspi_transfer_message((struct rt_qspi_device *) (rtt_dev->rt_spi_device), &message) != data_size) {
+            result = SFUD_ERR_TIMEOUT;
+        }
+    }
+    else
+#endif
+    {
+        if (data_size) {
+            if (rt_spi_send_then_send(rtt_dev->rt_spi_device, cmd_buf, cmd_size, data_buf, data_size) != RT_EOK) {
+                result = SFUD_ERR_TIMEOUT;
+            }
+        } else {
+            if (rt_spi_send(rtt_dev->rt_spi_device, cmd_buf, cmd_size) <= 0) {
+                result = SFUD_ERR_TIMEOUT;
+            }
+        }
+    }
+
+    return result;
+}
+
 #ifdef SFUD_USING_QSPI
 /**
  * QSPI fast read data
@@ -234,6 +327,9 @@ static void spi_lock(const sfud_spi *spi) {
     RT_ASSERT(rtt_dev);
 
     rt_mutex_take(&(rtt_dev->lock), RT_WAITING_FOREVER);
+#ifdef RT_SFUD_USING_ERASE_SUSPEND
+    rtt_dev->lock_depth++;
+#endif
 }
 
 static void spi_unlock(const sfud_spi *spi) {
@@ -244,6 +340,9 @@ static void spi_unlock(const sfud_spi *spi) {
     RT_ASSERT(sfud_dev);
     RT_ASSERT(rtt_dev);
 
+#ifdef RT_SFUD_USING_ERASE_SUSPEND
+    rtt_dev->lock_depth--;
+#endif
     rt_mutex_release(&(rtt_dev->lock));
 }
 
@@ -252,6 +351,29 @@ static void retry_delay_100us(void) {
     rt_thread_delay((RT_TICK_PER_SECOND * 1 + 9999) / 10000);
 }
 
+static void busy_sleep(uint32_t ms) {
+    rt_thread_mdelay(ms);
+}
+
+#ifdef RT_SFUD_USING_ERASE_SUSPEND
+static bool erase_read_pending(const sfud_flash *flash) {
+    struct spi_flash_device *rtt_dev = (struct spi_flash_device *) (flash->user_data);
+
+    /* the lock can be handed over only when the erasing thread holds it once */
+    return rt_atomic_load(&(rtt_dev->read_waiting)) > 0 && rtt_dev->lock_depth == 1;
+}
+
+static void erase_serve_reads(const sfud_flash *flash) {
+    struct spi_flash_device *rtt_dev = (struct spi_flash_device *) (flash->user_data);
+
+    /* the lock is handed over to the waiting threads by priority, and taken back after them */
+    rtt_dev->lock_depth--;
+    rt_mutex_release(&(rtt_dev->lock));
+    rt_mutex_take(&(rtt_dev->lock), RT_WAITING_FOREVER);
+    rtt_dev->lock_depth++;
+}
+#endif /* RT_SFUD_USING_ERASE_SUSPEND */
+
 sfud_err sfud_spi_port_init(sfud_flash *flash) {
     sfud_err result = SFUD_SUCCESS;
 
@@ -259,6 +381,7 @@ sfud_err sfud_spi_port_init(sfud_flash *flash) {
 
     /* port SPI device interface */
     flash->spi.wr = spi_write_read;
+    flash->spi.ww = spi_write_write;
 #ifdef SFUD_USING_QSPI
     flash->spi.qspi_read = qspi_read;
 #endif
@@ -272,10 +395,123 @@ sfud_err sfud_spi_port_init(sfud_flash *flash) {
     flash->retry.delay = retry_delay_100us;
     /* 60 seconds timeout */
     flash->retry.times = 60 * 10000;
+    /* erase and program busy wait sleeps the typical time then backs off */
+    flash->retry.sleep = busy_sleep;
+#ifdef RT_SFUD_USING_ERASE_SUSPEND
+    /* the erase is suspended for the reads by rt_sfud_flash_read() */
+    flash->erase_suspend.pending = erase_read_pending;
+    flash->erase_suspend.serve = erase_serve_reads;
+#endif
 
     return result;
 }
 
+sfud_err rt_sfud_flash_read(sfud_flash_t sfud_dev, rt_uint32_t addr, rt_size_t size, rt_uint8_t *data) {
+#ifdef RT_SFUD_USING_ERASE_SUSPEND
+    struct spi_flash_device *rtt_dev;
+    sfud_err result;
+
+    RT_ASSERT(sfud_dev);
+
+    rtt_dev = (struct spi_flash_device *) (sfud_dev->user_data);
+    /* the read is counted until it is done, the erasing thread suspends the erase for it */
+    rt_atomic_add(&(rtt_dev->read_waiting), 1);
+    result = sfud_read(sfud_dev, addr, size, data);
+    rt_atomic_sub(&(rtt_dev->read_waiting), 1);
+
+    return result;
+#else
+    return sfud_read(sfud_dev, addr, size, data);
+#endif
+}
+
+#ifdef RT_SFUD_USING_ASYNC
+static struct rt_workqueue *async_queue = RT_NULL;
+
+/* the erase or program size of one flash command at addr */
+static rt_size_t async_cmd_size(struct rt_sfud_async_op *op, rt_uint32_t addr, rt_size_t size) {
+    rt_size_t unit = SFUD_WRITE_MAX_PAGE_SIZE;
+
+    if (op->type == RT_SFUD_ASYNC_ERASE) {
+        unit = op->sfud_dev->chip.erase_gran;
+#ifdef SFUD_USING_SFDP
+        if (op->sfud_dev->sfdp.available) {
+            unit = op->sfud_dev->sfdp.eraser[sfud_sfdp_get_suitable_eraser(op->sfud_dev, addr, size)].size;
+        }
+#endif
+    }
+    unit -= addr % unit;
+
+    return unit < size ? unit : size;
+}
+
+static void async_work(struct rt_work *work, void *work_data) {
+    struct rt_sfud_async_op *op = (struct rt_sfud_async_op *) work_data;
+    rt_uint32_t addr = op->addr, end = op->addr + op->size;
+    rt_size_t cur_size;
+    sfud_err result = SFUD_SUCCESS;
+
+    /* each command takes the flash lock by itself, so the reads waiting for the lock go between the commands */
+    while (addr < end && result == SFUD_SUCCESS) {
+        cur_size = async_cmd_size(op, addr, end - addr);
+        if (op->type == RT_SFUD_ASYNC_ERASE) {
+            result = sfud_erase(op->sfud_dev, addr, cur_size);
+        } else {
+            result = sfud_write(op->sfud_dev, addr, cur_size, op->data + (addr - op->addr));
+        }
+        addr += cur_size;
+    }
+
+    op->result = result;
+    rt_completion_done(&op->completion);
+}
+
+static rt_err_t async_submit(sfud_flash_t sfud_dev, struct rt_sfud_async_op *op, enum rt_sfud_async_type type,
+        rt_uint32_t addr, const rt_uint8_t *data, rt_size_t size) {
+    RT_ASSERT(sfud_dev);
+    RT_ASSERT(sfud_dev->init_ok);
+    RT_ASSERT(op);
+
+    if (async_queue == RT_NULL) {
+        return -RT_ENOSYS;
+    }
+    if (addr + size > sfud_dev->chip.capacity) {
+        return -RT_EINVAL;
+    }
+    op->sfud_dev = sfud_dev;
+    op->type = type;
+    op->addr = addr;
+    op->size = size;
+    op->data = data;
+    op->result = SFUD_SUCCESS;
+    rt_completion_init(&op->completion);
+    rt_work_init(&op->work, async_work, op);
+
+    return rt_workqueue_submit_work(async_queue, &op->work, 0);
+}
+
+rt_err_t rt_sfud_async_erase(sfud_flash_t sfud_dev, struct rt_sfud_async_op *op, rt_uint32_t addr, rt_size_t size) {
+    return async_submit(sfud_dev, op, RT_SFUD_ASYNC_ERASE, addr, RT_NULL, size);
+}
+
+rt_err_t rt_sfud_async_write(sfud_flash_t sfud_dev, struct rt_sfud_async_op *op, rt_uint32_t addr,
+        const rt_uint8_t *data, rt_size_t size) {
+    RT_ASSERT(data);
+
+    return async_submit(sfud_dev, op, RT_SFUD_ASYNC_WRITE, addr, data, size);
+}
+
+sfud_err rt_sfud_async_wait(struct rt_sfud_async_op *op, rt_int32_t timeout) {
+    RT_ASSERT(op);
+
+    if (rt_completion_wait(&op->completion, timeout) != RT_EOK) {
+        return SFUD_ERR_TIMEOUT;
+    }
+
+    return op->result;
+}
+#endif /* RT_SFUD_USING_ASYNC */
+
 #ifdef RT_USING_DEVICE_OPS
 const static struct rt_device_ops flash_device_ops =
 {
@@ -397,6 +633,16 @@ rt_spi_flash_device_t rt_sfud_flash_probe_ex(const char *spi_flash_dev_name, con
 
         rt_device_register(&(rtt_dev->flash_device), spi_flash_dev_name, RT_DEVICE_FLAG_RDWR | RT_DEVICE_FLAG_STANDALONE);
 
+#ifdef RT_SFUD_USING_ASYNC
+        /* one thread runs the asynchronous operations of all flash devices */
+        if (async_queue == RT_NULL) {
+            async_queue = rt_workqueue_create("sfud", RT_SFUD_ASYNC_THREAD_STACK_SIZE, RT_SFUD_ASYNC_THREAD_PRIORITY);
+            if (async_queue == RT_NULL) {
+                LOG_W("SFUD asynchronous operation thread create failed.");
+            }
+        }
+#endif
+
         LOG_I("Probe SPI flash %s by SPI device %s success.",spi_flash_dev_name, spi_dev_name);
         return rtt_dev;
     } else {
@@ -511,10 +757,93 @@ __error:
     return RT_NULL;
 }
 
+void rt_sfud_flash_set_changed_hook(sfud_flash_t sfud_dev,
+        void (*hook)(rt_spi_flash_device_t flash_dev, rt_uint32_t addr, rt_size_t size)) {
+    rt_spi_flash_device_t rtt_dev;
+
+    RT_ASSERT(sfud_dev);
+
+    rtt_dev = (rt_spi_flash_device_t) sfud_dev->user_data;
+    RT_ASSERT(rtt_dev);
+    rtt_dev->changed_hook = hook;
+}
+
 #if defined(RT_USING_FINSH)
 
 #include <finsh.h>
 
+#ifdef RT_SFUD_USING_ERASE_SUSPEND
+struct sf_suspend_reader {
+    const sfud_flash *sfud_dev;
+    uint32_t addr;
+    volatile bool stop;
+    rt_tick_t max_ms;
+    rt_tick_t total_ms;
+    uint32_t num;
+    struct rt_completion done;
+};
+
+static void sf_suspend_reader_entry(void *parameter) {
+    struct sf_suspend_reader *reader = (struct sf_suspend_reader *) parameter;
+    uint8_t data[16];
+    rt_tick_t start, cast;
+
+    while (!reader->stop) {
+        rt_thread_mdelay(5);
+        start = rt_tick_get_millisecond();
+        rt_sfud_flash_read((sfud_flash_t) reader->sfud_dev, reader->addr, sizeof(data), data);
+        cast = rt_tick_get_millisecond() - start;
+        if (cast > reader->max_ms) {
+            reader->max_ms = cast;
+        }
+        reader->total_ms += cast;
+        reader->num++;
+    }
+    rt_completion_done(&reader->done);
+}
+
+/* erase while a higher priority thread reads behind the erased range, and print the read latency */
+static sfud_err sf_suspend_bench(const sfud_flash *sfud_dev, uint32_t addr, uint32_t size, bool suspend) {
+    struct sf_suspend_reader reader = { 0 };
+    rt_thread_t thread;
+    rt_tick_t start, erase_ms;
+    sfud_err result;
+
+    reader.sfud_dev = sfud_dev;
+    reader.addr = (addr + size) % sfud_dev->chip.capacity;
+    rt_completion_init(&reader.done);
+    thread = rt_thread_create("sf_read", sf_suspend_reader_entry, &reader, 1024,
+            RT_SCHED_PRIV(rt_thread_self()).current_priority - 1, 10);
+    if (!thread) {
+        rt_kprintf("Low memory!\n");
+        return SFUD_ERR_WRITE;
+    }
+    /*
+     * Without suspend, the lock is held around the erase. The erase holds it twice then, so erase_read_pending()
+     * never hands it over and the erase keeps it until it is finished. The shared suspend setting of the flash is not
+     * changed, so the other erases are not affected.
+     */
+    if (!suspend) {
+        spi_lock(&sfud_dev->spi);
+    }
+    rt_thread_startup(thread);
+    start = rt_tick_get_millisecond();
+    result = sfud_erase(sfud_dev, addr, size);
+    erase_ms = rt_tick_get_millisecond() - start;
+    if (!suspend) {
+        spi_unlock(&sfud_dev->spi);
+    }
+    flash_changed(sfud_dev, addr, size);
+    reader.stop = true;
+    rt_completion_wait(&reader.done, RT_WAITING_FOREVER);
+
+    rt_kprintf("Erase %s suspend: %ld ms, %ld reads, read latency avg %ld ms, max %ld ms.\n", suspend ? "with" : "without",
+            erase_ms, reader.num, reader.num ? reader.total_ms / reader.num : 0, reader.max_ms);
+
+    return result;
+}
+#endif /* RT_SFUD_USING_ERASE_SUSPEND */
+
 static void sf(uint8_t argc, char **argv) {
 
 #define __is_print(ch)                ((unsigned int)((ch) - ' ') < 127u - ' ')
@@ -525,6 +854,7 @@ static void sf(uint8_t argc, char **argv) {
 #define CMD_ERASE_INDEX               3
 #define CMD_RW_STATUS_INDEX           4
 #define CMD_BENCH_INDEX               5
+#define CMD_SUSPEND_INDEX             6
 
     sfud_err result = SFUD_SUCCESS;
     static const sfud_flash *sfud_dev = NULL;
@@ -538,6 +868,9 @@ static void sf(uint8_t argc, char **argv) {
             [CMD_ERASE_INDEX]     = "sf erase addr size              - erase 'size' bytes starting at 'addr'",
             [CMD_RW_STATUS_INDEX] = "sf status [<volatile> <status>] - read or write '1:volatile|0:non-volatile' 'status'",
             [CMD_BENCH_INDEX]     = "sf bench                        - full chip benchmark. DANGER: It will erase full chip!",
+#ifdef RT_SFUD_USING_ERASE_SUSPEND
+            [CMD_SUSPEND_INDEX]   = "sf suspend addr size            - erase twice while reading, print the read latency without and with erase suspend",
+#endif
     };
 
     if (argc < 2) {
@@ -633,6 +966,7 @@ static void sf(uint8_t argc, char **argv) {
                             data[i] = strtol(argv[3 + i], NULL, 0);
                         }
                         result = sfud_write(sfud_dev, addr, size, data);
+                        flash_changed(sfud_dev, addr, size);
                         if (result == SFUD_SUCCESS) {
                             rt_kprintf("Write the %s flash data success. Start from 0x%08X, size is %ld.\n",
                                     sfud_dev->name, addr, size);
@@ -655,6 +989,7 @@ static void sf(uint8_t argc, char **argv) {
                     addr = strtol(argv[2], NULL, 0);
                     size = strtol(argv[3], NULL, 0);
                     result = sfud_erase(sfud_dev, addr, size);
+                    flash_changed(sfud_dev, addr, size);
                     if (result == SFUD_SUCCESS) {
                         rt_kprintf("Erase the %s flash data success. Start from 0x%08X, size is %ld.\n", sfud_dev->name,
                                 addr, size);
@@ -727,6 +1062,8 @@ static void sf(uint8_t argc, char **argv) {
                     } else {
                         rt_kprintf("Write benchmark has an error. Error code: %d.\n", result);
                     }
+                    /* the full chip is erased and written */
+                    flash_changed(sfud_dev, addr, size);
                     /* read test */
                     rt_kprintf("Reading the %s %ld bytes data, waiting...\n", sfud_dev->name, size);
                     start_time = rt_tick_get();
@@ -761,6 +1098,19 @@ static void sf(uint8_t argc, char **argv) {
                 }
                 rt_free(write_data);
                 rt_free(read_data);
+#ifdef RT_SFUD_USING_ERASE_SUSPEND
+            } else if (!rt_strcmp(operator, "suspend")) {
+                if (argc < 4) {
+                    rt_kprintf("Usage: %s.\n", sf_help_info[CMD_SUSPEND_INDEX]);
+                    return;
+                }
+                addr = strtol(argv[2], NULL, 0);
+                size = strtol(argv[3], NULL, 0);
+                result = sf_suspend_bench(sfud_dev, addr, size, false);
+                if (result == SFUD_SUCCESS) {
+                    result = sf_suspend_bench(sfud_dev, addr, size, true);
+                }
+#endif /* RT_SFUD_USING_ERASE_SUSPEND */
             } else {
                 rt_kprintf("Usage:\n");
                 for (i = 0; i < sizeof(sf_help_info) / sizeof(char*); i++) {
@@ -71,6 +71,87 @@ sfud_flash_t rt_sfud_flash_find(const char *spi_dev_name);
  */
 sfud_flash_t rt_sfud_flash_find_by_dev_name(const char *flash_dev_name);
 
+/**
+ * Set the hook which is called after the block device or the 'sf' command writes or erases the flash, such as the
+ * FAL SFUD port invalidates the FAL read cache by it. The range is aligned to the erase granularity.
+ *
+ * @param sfud_dev sfud flash device
+ * @param hook the hook, RT_NULL: remove it
+ */
+void rt_sfud_flash_set_changed_hook(sfud_flash_t sfud_dev,
+        void (*hook)(rt_spi_flash_device_t flash_dev, rt_uint32_t addr, rt_size_t size));
+
+/**
+ * Read flash data. The in-flight erase of the flash is suspended for this read when the erase suspend is enabled.
+ *
+ * @param sfud_dev sfud flash device
+ * @param addr start address
+ * @param size read size
+ * @param data read data pointer
+ *
+ * @return result
+ */
+sfud_err rt_sfud_flash_read(sfud_flash_t sfud_dev, rt_uint32_t addr, rt_size_t size, rt_uint8_t *data);
+
+#ifdef RT_SFUD_USING_ASYNC
+enum rt_sfud_async_type
+{
+    RT_SFUD_ASYNC_ERASE,
+    RT_SFUD_ASYNC_WRITE,
+};
+
+/* asynchronous erase or program operation, it is owned by the SFUD until it is done */
+struct rt_sfud_async_op
+{
+    struct rt_work work;
+    sfud_flash_t sfud_dev;
+    enum rt_sfud_async_type type;
+    rt_uint32_t addr;
+    rt_size_t size;
+    const rt_uint8_t *data;
+    sfud_err result;
+    struct rt_completion completion;
+};
+
+/**
+ * Submit an asynchronous erase. The range is erased by the suitable eraser, one erase command at a time.
+ *
+ * @param sfud_dev sfud flash device
+ * @param op operation object, it must be kept until the operation is done
+ * @param addr start address
+ * @param size erase size
+ *
+ * @return the operation status, RT_EOK on submitted
+ */
+rt_err_t rt_sfud_async_erase(sfud_flash_t sfud_dev, struct rt_sfud_async_op *op, rt_uint32_t addr, rt_size_t size);
+
+/**
+ * Submit an asynchronous write (no erase operate). The data is programmed one page at a time.
+ *
+ * @param sfud_dev sfud flash device
+ * @param op operation object, it must be kept until the operation is done
+ * @param addr start address
+ * @param data write data, it must be kept until the operation is done
+ * @param size write size
+ *
+ * @return the operation status, RT_EOK on submitted
+ */
+rt_err_t rt_sfud_async_write(sfud_flash_t sfud_dev, struct rt_sfud_async_op *op, rt_uint32_t addr,
+        const rt_uint8_t *data, rt_size_t size);
+
+/**
+ * Wait an asynchronous operation is done. The SFUD thread doesn't inherit the priority of the waiter, so a thread
+ * which only waits should call sfud_erase()/sfud_write() in its own context instead.
+ *
+ * @param op operation object
+ * @param timeout waiting time (ticks)
+ *
+ * @return the operation result, SFUD_ERR_TIMEOUT when the operation is not done in time, then it is still owned by
+ *         the SFUD
+ */
+sfud_err rt_sfud_async_wait(struct rt_sfud_async_op *op, rt_int32_t timeout);
+#endif /* RT_SFUD_USING_ASYNC */
+
 #ifdef __cplusplus
 }
 #endif
@@ -56,6 +56,13 @@
 #define SFUD_USING_SFDP
 #endif
 
+/**
+ * Suspend the long erase to serve the reads, the erase suspend support is probed by SFDP.
+ */
+#ifdef RT_SFUD_USING_ERASE_SUSPEND
+#define SFUD_USING_ERASE_SUSPEND
+#endif
+
 /**
  * SFUD will support QSPI mode.
  */
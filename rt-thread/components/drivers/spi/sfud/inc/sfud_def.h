@@ -166,6 +166,14 @@ if (!(EXPR))                                                                   \
 #define SFUD_CMD_EXIT_4B_ADDRESS_MODE                  0xE9
 #endif
 
+#ifndef SFUD_CMD_ERASE_SUSPEND
+#define SFUD_CMD_ERASE_SUSPEND                         0x75
+#endif
+
+#ifndef SFUD_CMD_ERASE_RESUME
+#define SFUD_CMD_ERASE_RESUME                          0x7A
+#endif
+
 #ifndef SFUD_WRITE_MAX_PAGE_SIZE
 #define SFUD_WRITE_MAX_PAGE_SIZE                        256
 #endif
@@ -178,6 +186,21 @@ if (!(EXPR))                                                                   \
 /* maximum number of erase type support on JESD216 (V1.0) */
 #define SFUD_SFDP_ERASE_TYPE_MAX_NUM                      4
 
+/* typical page program time (us), when the flash doesn't provide it by SFDP */
+#ifndef SFUD_DEFAULT_PAGE_PROGRAM_TIME
+#define SFUD_DEFAULT_PAGE_PROGRAM_TIME                 400
+#endif
+
+/* typical sector erase time (ms), when the flash doesn't provide it by SFDP */
+#ifndef SFUD_DEFAULT_ERASE_TIME
+#define SFUD_DEFAULT_ERASE_TIME                        45
+#endif
+
+/* the retry delay period (us), the sleeping busy wait times out after retry.times of it */
+#ifndef SFUD_RETRY_DELAY_TIME
+#define SFUD_RETRY_DELAY_TIME                          100
+#endif
+
 /**
  * status register bits
  */
@@ -236,7 +259,15 @@ typedef struct {
     struct {
         uint32_t size;                           /**< erase sector size (bytes). 0x00: not available */
         uint8_t cmd;                             /**< erase command */
+        uint32_t time;                           /**< typical erase time (ms). 0x00: not available */
     } eraser[SFUD_SFDP_ERASE_TYPE_MAX_NUM];      /**< supported eraser types table */
+    uint32_t page_program_time;                  /**< typical page program time (us). 0x00: not available */
+    uint32_t chip_erase_time;                    /**< typical chip erase time (ms). 0x00: not available */
+    bool suspend;                                /**< supports erase suspend and resume */
+    uint8_t suspend_cmd;                         /**< erase suspend command */
+    uint8_t resume_cmd;                          /**< erase resume command */
+    uint32_t suspend_latency;                    /**< maximum erase suspend latency (us) */
+    uint32_t resume_to_suspend;                  /**< minimum erase resume to suspend interval (us) */
     //TODO lots of fast read-related stuff (like modes supported and number of wait states/dummy cycles needed in each)
 } sfud_sfdp, *sfud_sfdp_t;
 #endif
@@ -250,6 +281,10 @@ typedef struct __sfud_spi {
     /* SPI bus write read data function */
     sfud_err (*wr)(const struct __sfud_spi *spi, const uint8_t *write_buf, size_t write_size, uint8_t *read_buf,
                    size_t read_size);
+    /* SPI bus write command then write data function, the CS is kept active between them. NULL: the page program
+     * copies the command and the data into one buffer and sends it by wr */
+    sfud_err (*ww)(const struct __sfud_spi *spi, const uint8_t *cmd_buf, size_t cmd_size, const uint8_t *data_buf,
+                   size_t data_size);
 #ifdef SFUD_USING_QSPI
     /* QSPI fast read function */
     sfud_err (*qspi_read)(const struct __sfud_spi *spi, uint32_t addr, sfud_qspi_read_cmd_format *qspi_read_cmd_format,
@@ -266,7 +301,7 @@ typedef struct __sfud_spi {
 /**
  * serial flash device
  */
-typedef struct {
+typedef struct __sfud_flash {
     char *name;                                  /**< serial flash name */
     size_t index;                                /**< index of flash device information table  @see flash_table */
     sfud_flash_chip chip;                        /**< flash chip information */
@@ -276,6 +311,8 @@ typedef struct {
     struct {
         void (*delay)(void);                     /**< every retry's delay */
         size_t times;                            /**< default times for error retry */
+        void (*sleep)(uint32_t ms);              /**< sleep for the busy wait of erase and program, it times out after
+                                                      retry.times * SFUD_RETRY_DELAY_TIME. NULL: use delay */
     } retry;
     void *user_data;                             /**< some user data */
 
@@ -287,6 +324,16 @@ typedef struct {
     sfud_sfdp sfdp;                              /**< serial flash discoverable parameters by JEDEC standard */
 #endif
 
+#ifdef SFUD_USING_ERASE_SUSPEND
+    struct {
+        /* some reads are waiting for the flash, the erase will be suspended for them. NULL: never suspend */
+        bool (*pending)(const struct __sfud_flash *flash);
+        /* serve the waiting reads while the erase is suspended */
+        void (*serve)(const struct __sfud_flash *flash);
+        volatile bool suspended;                 /**< an erase is suspended, erase and program must wait */
+    } erase_suspend;
+#endif
+
 } sfud_flash, *sfud_flash_t;
 
 #ifdef __cplusplus
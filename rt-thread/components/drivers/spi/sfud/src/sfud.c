@@ -67,7 +67,11 @@ static sfud_err hardware_init(sfud_flash *flash);
 static sfud_err page256_or_1_byte_write(const sfud_flash *flash, uint32_t addr, size_t size, uint16_t write_gran,
         const uint8_t *data);
 static sfud_err aai_write(const sfud_flash *flash, uint32_t addr, size_t size, const uint8_t *data);
-static sfud_err wait_busy(const sfud_flash *flash);
+static sfud_err wait_busy(const sfud_flash *flash, uint32_t typical_time);
+static sfud_err wait_erase(const sfud_flash *flash, uint32_t typical_time);
+static void wait_erase_resumed(const sfud_flash *flash);
+static uint32_t erase_typical_time(const sfud_flash *flash, size_t erase_size);
+static uint32_t page_program_typical_time(const sfud_flash *flash);
 static sfud_err reset(const sfud_flash *flash);
 static sfud_err read_jedec_id(sfud_flash *flash);
 static sfud_err set_write_enabled(const sfud_flash *flash, bool enabled);
@@ -420,7 +424,7 @@ sfud_err sfud_read(const sfud_flash *flash, uint32_t addr, size_t size, uint8_t
         spi->lock(spi);
     }
 
-    result = wait_busy(flash);
+    result = wait_busy(flash, 0);
 
     if (result == SFUD_SUCCESS) {
 #ifdef SFUD_USING_QSPI
@@ -462,6 +466,7 @@ sfud_err sfud_chip_erase(const sfud_flash *flash) {
     if (spi->lock) {
         spi->lock(spi);
     }
+    wait_erase_resumed(flash);
 
     /* set the flash write enable */
     result = set_write_enabled(flash, true);
@@ -483,7 +488,7 @@ sfud_err sfud_chip_erase(const sfud_flash *flash) {
         SFUD_INFO("Error: Flash chip erase SPI communicate error.");
         goto __exit;
     }
-    result = wait_busy(flash);
+    result = wait_erase(flash, erase_typical_time(flash, 0) * 1000);
 
 __exit:
     /* set the flash write disable */
@@ -508,8 +513,6 @@ __exit:
  * @return result
  */
 sfud_err sfud_erase(const sfud_flash *flash, uint32_t addr, size_t size) {
-    extern size_t sfud_sfdp_get_suitable_eraser(const sfud_flash *flash, uint32_t addr, size_t erase_size);
-
     sfud_err result = SFUD_SUCCESS;
     const sfud_spi *spi = &flash->spi;
     uint8_t cmd_data[5], cmd_size, cur_erase_cmd;
@@ -532,6 +535,7 @@ sfud_err sfud_erase(const sfud_flash *flash, uint32_t addr, size_t size) {
     if (spi->lock) {
         spi->lock(spi);
     }
+    wait_erase_resumed(flash);
 
     /* loop erase operate. erase unit is erase granularity */
     while (size) {
@@ -564,7 +568,7 @@ sfud_err sfud_erase(const sfud_flash *flash, uint32_t addr, size_t size) {
             SFUD_INFO("Error: Flash erase SPI communicate error.");
             goto __exit;
         }
-        result = wait_busy(flash);
+        result = wait_erase(flash, erase_typical_time(flash, cur_erase_size) * 1000);
         if (result != SFUD_SUCCESS) {
             goto __exit;
         }
@@ -612,6 +616,7 @@ static sfud_err page256_or_1_byte_write(const sfud_flash *flash, uint32_t addr,
         const uint8_t *data) {
     sfud_err result = SFUD_SUCCESS;
     const sfud_spi *spi = &flash->spi;
+    /* the command and the data are copied into it for the port without the ww op */
     static uint8_t cmd_data[5 + SFUD_WRITE_MAX_PAGE_SIZE];
     uint8_t cmd_size;
     size_t data_size;
@@ -630,6 +635,7 @@ static sfud_err page256_or_1_byte_write(const sfud_flash *flash, uint32_t addr,
     if (spi->lock) {
         spi->lock(spi);
     }
+    wait_erase_resumed(flash);
 
     /* loop write operate. write unit is write granularity */
     while (size) {
@@ -659,14 +665,18 @@ static sfud_err page256_or_1_byte_write(const sfud_flash *flash, uint32_t addr,
         size -= data_size;
         addr += data_size;
 
-        rt_memcpy(&cmd_data[cmd_size], data, data_size);
-
-        result = spi->wr(spi, cmd_data, cmd_size + data_size, NULL, 0);
+        if (spi->ww) {
+            /* the command and the data are sent from their own buffers */
+            result = spi->ww(spi, cmd_data, cmd_size, data, data_size);
+        } else {
+            rt_memcpy(&cmd_data[cmd_size], data, data_size);
+            result = spi->wr(spi, cmd_data, cmd_size + data_size, NULL, 0);
+        }
         if (result != SFUD_SUCCESS) {
             SFUD_INFO("Error: Flash write SPI communicate error.");
             goto __exit;
         }
-        result = wait_busy(flash);
+        result = wait_busy(flash, page_program_typical_time(flash));
         if (result != SFUD_SUCCESS) {
             goto __exit;
         }
@@ -714,6 +724,7 @@ static sfud_err aai_write(const sfud_flash *flash, uint32_t addr, size_t size, c
     if (spi->lock) {
         spi->lock(spi);
     }
+    wait_erase_resumed(flash);
     /* The address must be even for AAI write mode. So it must write one byte first when address is odd. */
     if (addr % 2 != 0) {
         result = page256_or_1_byte_write(flash, addr++, 1, 1, data++);
@@ -748,7 +759,7 @@ static sfud_err aai_write(const sfud_flash *flash, uint32_t addr, size_t size, c
             goto __exit;
         }
 
-        result = wait_busy(flash);
+        result = wait_busy(flash, 0);
         if (result != SFUD_SUCCESS) {
             goto __exit;
         }
@@ -832,7 +843,7 @@ static sfud_err reset(const sfud_flash *flash) {
     cmd_data[0] = SFUD_CMD_ENABLE_RESET;
     result = spi->wr(spi, cmd_data, 1, NULL, 0);
     if (result == SFUD_SUCCESS) {
-        result = wait_busy(flash);
+        result = wait_busy(flash, 0);
     } else {
         SFUD_INFO("Error: Flash device reset failed.");
         return result;
@@ -842,7 +853,7 @@ static sfud_err reset(const sfud_flash *flash) {
     result = spi->wr(spi, &cmd_data[1], 1, NULL, 0);
 
     if (result == SFUD_SUCCESS) {
-        result = wait_busy(flash);
+        result = wait_busy(flash, 0);
     }
 
     if (result == SFUD_SUCCESS) {
@@ -972,20 +983,95 @@ sfud_err sfud_read_status(const sfud_flash *flash, uint8_t *status) {
     return flash->spi.wr(&flash->spi, &cmd, 1, status, 1);
 }
 
-static sfud_err wait_busy(const sfud_flash *flash) {
+/**
+ * get the typical erase time from SFDP parameter, or the default time
+ *
+ * @param flash flash device
+ * @param erase_size erase size of the eraser, 0: the whole chip
+ *
+ * @return typical erase time (ms)
+ */
+static uint32_t erase_typical_time(const sfud_flash *flash, size_t erase_size) {
+#ifdef SFUD_USING_SFDP
+    size_t i;
+
+    if (flash->sfdp.available) {
+        if (erase_size == 0) {
+            if (flash->sfdp.chip_erase_time) {
+                return flash->sfdp.chip_erase_time;
+            }
+        } else {
+            for (i = 0; i < SFUD_SFDP_ERASE_TYPE_MAX_NUM; i++) {
+                if (flash->sfdp.eraser[i].size == erase_size && flash->sfdp.eraser[i].time) {
+                    return flash->sfdp.eraser[i].time;
+                }
+            }
+        }
+    }
+#endif
+    /* the chip erase time is unknown, it is polled by the delay */
+    return erase_size ? SFUD_DEFAULT_ERASE_TIME : 0;
+}
+
+/**
+ * get the typical page program time from SFDP parameter, or the default time
+ *
+ * @param flash flash device
+ *
+ * @return typical page program time (us)
+ */
+static uint32_t page_program_typical_time(const sfud_flash *flash) {
+#ifdef SFUD_USING_SFDP
+    if (flash->sfdp.available && flash->sfdp.page_program_time) {
+        return flash->sfdp.page_program_time;
+    }
+#endif
+    return SFUD_DEFAULT_PAGE_PROGRAM_TIME;
+}
+
+/**
+ * wait the flash is not busy
+ *
+ * When the typical time of the operation is known and the port supports sleep, it will sleep the typical time before
+ * the first status reading, then back off from 1/8 of the typical time up to the typical time between the readings.
+ * The sleeping wait times out after the same time as the delay retries, retry.times * SFUD_RETRY_DELAY_TIME.
+ *
+ * @param flash flash device
+ * @param typical_time typical time of the operation (us), 0: unknown
+ *
+ * @return result
+ */
+static sfud_err wait_busy(const sfud_flash *flash, uint32_t typical_time) {
     sfud_err result = SFUD_SUCCESS;
     uint8_t status;
     size_t retry_times = flash->retry.times;
+    uint32_t sleep_ms = (typical_time + 999) / 1000, step_ms = (sleep_ms + 7) / 8, waited_ms = 0;
+    uint64_t timeout_ms = (uint64_t) flash->retry.times * SFUD_RETRY_DELAY_TIME / 1000;
 
     SFUD_ASSERT(flash);
 
+    if (flash->retry.sleep && sleep_ms) {
+        flash->retry.sleep(sleep_ms);
+        waited_ms = sleep_ms;
+    }
+
     while (true) {
         result = sfud_read_status(flash, &status);
         if (result == SFUD_SUCCESS && ((status & SFUD_STATUS_REGISTER_BUSY)) == 0) {
             break;
         }
         /* retry counts */
-        SFUD_RETRY_PROCESS(flash->retry.delay, retry_times, result);
+        if (flash->retry.sleep && sleep_ms) {
+            if (waited_ms >= timeout_ms) {
+                result = SFUD_ERR_TIMEOUT;
+                break;
+            }
+            flash->retry.sleep(step_ms);
+            waited_ms += step_ms;
+            step_ms = step_ms * 2 < sleep_ms ? step_ms * 2 : sleep_ms;
+        } else {
+            SFUD_RETRY_PROCESS(flash->retry.delay, retry_times, result);
+        }
     }
 
     if (result != SFUD_SUCCESS || ((status & SFUD_STATUS_REGISTER_BUSY)) != 0) {
@@ -995,6 +1081,106 @@ static sfud_err wait_busy(const sfud_flash *flash) {
     return result;
 }
 
+/**
+ * wait the erase is finished, the erase will be suspended to serve the waiting reads
+ *
+ * The status is polled on the same times as wait_busy(), but the waiting reads are checked between them. When some
+ * reads are waiting, the erase is suspended, the reads are served by the port, then the erase is resumed. The erase
+ * runs for the resume to suspend interval at least before the next suspend, so it will be finished anyway. It times
+ * out as wait_busy() when the erase has run for retry.times * SFUD_RETRY_DELAY_TIME, the suspended time is not counted.
+ *
+ * @param flash flash device
+ * @param typical_time typical erase time (us), 0: unknown
+ *
+ * @return result
+ */
+static sfud_err wait_erase(const sfud_flash *flash, uint32_t typical_time) {
+#ifdef SFUD_USING_ERASE_SUSPEND
+    sfud_flash *erasing = (sfud_flash *) flash;
+    const sfud_spi *spi = &flash->spi;
+    sfud_err result = SFUD_SUCCESS;
+    uint8_t status = 0, cmd;
+    uint64_t timeout_ms = (uint64_t) flash->retry.times * SFUD_RETRY_DELAY_TIME / 1000;
+    uint32_t sleep_ms = (typical_time + 999) / 1000, step_ms = (sleep_ms + 7) / 8, waited_ms = 0, poll_ms = sleep_ms;
+    /* the erase runs at least this time between the suspends */
+    uint32_t run_ms = (flash->sfdp.resume_to_suspend + 999) / 1000;
+
+    SFUD_ASSERT(flash);
+
+    if (!flash->sfdp.available || !flash->sfdp.suspend || !flash->erase_suspend.pending || !flash->erase_suspend.serve
+            || !flash->retry.sleep || !sleep_ms) {
+        return wait_busy(flash, typical_time);
+    }
+
+    while (true) {
+        flash->retry.sleep(run_ms);
+        waited_ms += run_ms;
+        if (waited_ms >= poll_ms) {
+            result = sfud_read_status(flash, &status);
+            if (result == SFUD_SUCCESS && ((status & SFUD_STATUS_REGISTER_BUSY)) == 0) {
+                break;
+            }
+            if (waited_ms >= timeout_ms) {
+                result = SFUD_ERR_TIMEOUT;
+                break;
+            }
+            poll_ms = waited_ms + step_ms;
+            step_ms = step_ms * 2 < sleep_ms ? step_ms * 2 : sleep_ms;
+        }
+        if (!flash->erase_suspend.pending(flash)) {
+            continue;
+        }
+        /* the erase is suspended in the suspend latency, or it is finished already */
+        cmd = flash->sfdp.suspend_cmd;
+        result = spi->wr(spi, &cmd, 1, NULL, 0);
+        if (result == SFUD_SUCCESS) {
+            result = wait_busy(flash, 0);
+        }
+        if (result != SFUD_SUCCESS) {
+            break;
+        }
+        erasing->erase_suspend.suspended = true;
+        flash->erase_suspend.serve(flash);
+        erasing->erase_suspend.suspended = false;
+        /* the resume is ignored when the erase is finished, so the status is polled after it */
+        cmd = flash->sfdp.resume_cmd;
+        result = spi->wr(spi, &cmd, 1, NULL, 0);
+        if (result != SFUD_SUCCESS) {
+            break;
+        }
+        poll_ms = waited_ms + run_ms;
+    }
+
+    if (result != SFUD_SUCCESS || ((status & SFUD_STATUS_REGISTER_BUSY)) != 0) {
+        SFUD_INFO("Error: Flash wait erase has an error.");
+    }
+
+    return result;
+#else
+    return wait_busy(flash, typical_time);
+#endif /* SFUD_USING_ERASE_SUSPEND */
+}
+
+/**
+ * wait the suspended erase of other thread is resumed, the erase and program are not allowed while it is suspended
+ *
+ * @param flash flash device
+ */
+static void wait_erase_resumed(const sfud_flash *flash) {
+#ifdef SFUD_USING_ERASE_SUSPEND
+    const sfud_spi *spi = &flash->spi;
+
+    /* the erasing thread takes the lock back after the waiting threads */
+    while (flash->erase_suspend.suspended && spi->lock && spi->unlock) {
+        spi->unlock(spi);
+        flash->retry.delay();
+        spi->lock(spi);
+    }
+#else
+    (void) flash;
+#endif
+}
+
 static void make_address_byte_array(const sfud_flash *flash, uint32_t addr, uint8_t *array) {
     uint8_t len, i;
 
@@ -48,6 +48,10 @@
 #define SUPPORT_MAX_SFDP_MAJOR_REV                  1
 /* the JEDEC basic flash parameter table length is 9 DWORDs (288-bit) on JESD216 (V1.0) initial release standard */
 #define BASIC_TABLE_LEN                             9
+/* the erase and program typical times are in the 10th and 11th DWORDs since JESD216A (V1.5) */
+#define BASIC_TABLE_TIMING_LEN                      11
+/* the suspend and resume parameters are in the 12th and 13th DWORDs since JESD216A (V1.5) */
+#define BASIC_TABLE_SUSPEND_LEN                     13
 /* the smallest eraser in SFDP eraser table */
 #define SMALLEST_ERASER_INDEX                       0
 /**
@@ -189,20 +193,27 @@ static bool read_basic_table(sfud_flash *flash, sfdp_para_header *basic_header)
     /* parameter table address */
     uint32_t table_addr = basic_header->ptp;
     /* parameter table */
-    uint8_t table[BASIC_TABLE_LEN * 4] = { 0 }, i, j;
+    uint8_t table[BASIC_TABLE_SUSPEND_LEN * 4] = { 0 }, i, j;
+    /* the typical times and the suspend parameters are only read when the table has them */
+    uint8_t table_len = basic_header->len >= BASIC_TABLE_SUSPEND_LEN ? BASIC_TABLE_SUSPEND_LEN :
+            (basic_header->len >= BASIC_TABLE_TIMING_LEN ? BASIC_TABLE_TIMING_LEN : BASIC_TABLE_LEN);
+    uint32_t timing, erase_time[SFUD_SFDP_ERASE_TYPE_MAX_NUM] = { 0 };
+    static const uint16_t erase_time_unit[] = { 1, 16, 128, 1000 };
+    static const uint8_t suspend_latency_unit[] = { 0, 1, 8, 64 };
+    static const uint32_t chip_erase_time_unit[] = { 16, 256, 4000, 64000 };
 
     SFUD_ASSERT(flash);
     SFUD_ASSERT(basic_header);
 
     /* read JEDEC basic flash parameter table */
-    if (read_sfdp_data(flash, table_addr, table, sizeof(table)) != SFUD_SUCCESS) {
+    if (read_sfdp_data(flash, table_addr, table, table_len * 4) != SFUD_SUCCESS) {
         SFUD_INFO("Warning: Can't read JEDEC basic flash parameter table.");
         return false;
     }
     /* print JEDEC basic flash parameter table info */
     SFUD_DEBUG("JEDEC basic flash parameter table info:");
     SFUD_DEBUG("MSB-LSB  3    2    1    0");
-    for (i = 0; i < BASIC_TABLE_LEN; i++) {
+    for (i = 0; i < table_len; i++) {
         SFUD_DEBUG("[%04d] 0x%02X 0x%02X 0x%02X 0x%02X", i + 1, table[i * 4 + 3], table[i * 4 + 2], table[i * 4 + 1],
                 table[i * 4]);
     }
@@ -303,11 +314,43 @@ static bool read_basic_table(sfud_flash *flash, sfdp_para_header *basic_header)
         break;
     }
     SFUD_DEBUG("Capacity is %ld Bytes.", sfdp->capacity);
+    /* get erase typical time of each erase type and page program typical time */
+    if (table_len >= BASIC_TABLE_TIMING_LEN) {
+        timing = ((long)table[39] << 24) | ((long)table[38] << 16) | ((long)table[37] << 8) | (long)table[36];
+        for (i = 0; i < SFUD_SFDP_ERASE_TYPE_MAX_NUM; i++) {
+            /* 5 bits count and 2 bits units (1ms, 16ms, 128ms, 1s) from bit 4 */
+            erase_time[i] = (((timing >> (4 + 7 * i)) & 0x1F) + 1) * erase_time_unit[(timing >> (9 + 7 * i)) & 0x03];
+        }
+        /* 5 bits count and 1 bit units (8us, 64us) from bit 8 */
+        sfdp->page_program_time = (table[41] & 0x1F) + 1;
+        sfdp->page_program_time *= (table[41] & 0x20) ? 64 : 8;
+        /* 5 bits count and 2 bits units (16ms, 256ms, 4s, 64s) from bit 24 */
+        sfdp->chip_erase_time = ((table[43] & 0x1F) + 1) * chip_erase_time_unit[(table[43] >> 5) & 0x03];
+        SFUD_DEBUG("Page program typical time is %ldus, chip erase typical time is %ldms.", sfdp->page_program_time,
+                sfdp->chip_erase_time);
+    }
+    /* get erase suspend and resume support, bit 31 of the 12th DWORD is 0 when it is supported */
+    if (table_len >= BASIC_TABLE_SUSPEND_LEN && !(table[47] & 0x80)) {
+        sfdp->suspend = true;
+        /* 5 bits count and 2 bits units (128ns, 1us, 8us, 64us) from bit 24, the 128ns is rounded up to 1us */
+        sfdp->suspend_latency = (table[47] & 0x1F) + 1;
+        sfdp->suspend_latency = ((table[47] >> 5) & 0x03) ? sfdp->suspend_latency
+                * suspend_latency_unit[(table[47] >> 5) & 0x03] : (sfdp->suspend_latency * 128 + 999) / 1000;
+        /* 4 bits count of 64us from bit 20 */
+        sfdp->resume_to_suspend = (((table[46] >> 4) & 0x0F) + 1) * 64;
+        /* the suspend command in bits 31:24 and the resume command in bits 23:16 of the 13th DWORD */
+        sfdp->suspend_cmd = table[51] ? table[51] : SFUD_CMD_ERASE_SUSPEND;
+        sfdp->resume_cmd = table[50] ? table[50] : SFUD_CMD_ERASE_RESUME;
+        SFUD_DEBUG("Erase suspend command is 0x%02X, resume command is 0x%02X, suspend latency is %ldus, "
+                "resume to suspend interval is %ldus.", sfdp->suspend_cmd, sfdp->resume_cmd, sfdp->suspend_latency,
+                sfdp->resume_to_suspend);
+    }
     /* get erase size and erase command  */
     for (i = 0, j = 0; i < SFUD_SFDP_ERASE_TYPE_MAX_NUM; i++) {
         if (table[28 + 2 * i] != 0x00) {
             sfdp->eraser[j].size = 1L << table[28 + 2 * i];
             sfdp->eraser[j].cmd = table[28 + 2 * i + 1];
+            sfdp->eraser[j].time = erase_time[i];
             SFUD_DEBUG("Flash device supports %ldKB block erase. Command is 0x%02X.", sfdp->eraser[j].size / 1024,
                     sfdp->eraser[j].cmd);
             j++;
@@ -321,10 +364,13 @@ static bool read_basic_table(sfud_flash *flash, sfdp_para_header *basic_header)
                     /* swap the small eraser */
                     uint32_t temp_size = sfdp->eraser[i].size;
                     uint8_t temp_cmd = sfdp->eraser[i].cmd;
+                    uint32_t temp_time = sfdp->eraser[i].time;
                     sfdp->eraser[i].size = sfdp->eraser[j].size;
                     sfdp->eraser[i].cmd = sfdp->eraser[j].cmd;
+                    sfdp->eraser[i].time = sfdp->eraser[j].time;
                     sfdp->eraser[j].size = temp_size;
                     sfdp->eraser[j].cmd = temp_cmd;
+                    sfdp->eraser[j].time = temp_time;
                 }
             }
         }
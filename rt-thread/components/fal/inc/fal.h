@@ -120,6 +120,33 @@ int fal_partition_erase_all(const struct fal_partition *part);
  */
 void fal_show_part_table(void);
 
+#ifdef FAL_USING_CACHE
+/**
+ * enable or disable the read cache of the partition, the cache is enabled on all partitions by default
+ *
+ * @param part partition
+ * @param enable RT_TRUE: enable, RT_FALSE: disable
+ */
+void fal_partition_cache_enable(const struct fal_partition *part, rt_bool_t enable);
+
+/**
+ * get the read cache status of the partition
+ *
+ * @param part partition
+ * @param stat the status
+ */
+void fal_partition_cache_stat(const struct fal_partition *part, fal_cache_stat_t stat);
+
+/**
+ * invalidate the cache lines of the flash range, which is written or erased without the partition API
+ *
+ * @param flash_dev flash device
+ * @param offset offset address on flash device
+ * @param size size
+ */
+void fal_cache_invalidate(const struct fal_flash_dev *flash_dev, long offset, rt_size_t size);
+#endif /* FAL_USING_CACHE */
+
 /* =============== API provided to RT-Thread =============== */
 /**
  * create RT-Thread block device by specified partition
@@ -22,6 +22,26 @@
 #define FAL_DEV_BLK_MAX 6
 #endif
 
+#ifdef FAL_USING_CACHE
+/* partition read cache line size and geometry */
+#ifndef FAL_CACHE_LINE_SIZE
+#define FAL_CACHE_LINE_SIZE 256
+#endif
+
+#ifndef FAL_CACHE_SETS
+#define FAL_CACHE_SETS 4
+#endif
+
+#ifndef FAL_CACHE_WAYS
+#define FAL_CACHE_WAYS 4
+#endif
+
+/* a missed line is filled by the reads in a row which are in the line after the previous read start */
+#ifndef FAL_CACHE_FILL_SEQ_NUM
+#define FAL_CACHE_FILL_SEQ_NUM 2
+#endif
+#endif /* FAL_USING_CACHE */
+
 struct flash_blk
 {
     rt_size_t size;
@@ -74,4 +94,18 @@ struct fal_partition
 };
 typedef struct fal_partition *fal_partition_t;
 
+#ifdef FAL_USING_CACHE
+/**
+ * FAL partition read cache status
+ */
+struct fal_cache_stat
+{
+    rt_bool_t enabled;
+    /* the cache lines found and filled by the reads */
+    rt_uint32_t hit;
+    rt_uint32_t miss;
+};
+typedef struct fal_cache_stat *fal_cache_stat_t;
+#endif /* FAL_USING_CACHE */
+
 #endif /* _FAL_DEF_H_ */
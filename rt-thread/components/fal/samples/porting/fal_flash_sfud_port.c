@@ -36,6 +36,14 @@ struct fal_flash_dev nor_flash0 =
     .write_gran = 1
 };
 
+#if defined(RT_USING_SFUD) && defined(FAL_USING_CACHE)
+/* the flash is written or erased by the block device or the 'sf' command, not by the partition API */
+static void flash_changed(rt_spi_flash_device_t flash_dev, rt_uint32_t addr, rt_size_t size)
+{
+    fal_cache_invalidate(&nor_flash0, (long)addr - (long)nor_flash0.addr, size);
+}
+#endif
+
 static int init(void)
 {
 
@@ -56,6 +64,9 @@ static int init(void)
     /* update the flash chip information */
     nor_flash0.blk_size = sfud_dev->chip.erase_gran;
     nor_flash0.len = sfud_dev->chip.capacity;
+#if defined(RT_USING_SFUD) && defined(FAL_USING_CACHE)
+    rt_sfud_flash_set_changed_hook(sfud_dev, flash_changed);
+#endif
 
     return 0;
 }
@@ -64,7 +75,7 @@ static int read(long offset, rt_uint8_t *buf, rt_size_t size)
 {
     RT_ASSERT(sfud_dev);
     RT_ASSERT(sfud_dev->init_ok);
-    sfud_read(sfud_dev, nor_flash0.addr + offset, size, buf);
+    rt_sfud_flash_read(sfud_dev, nor_flash0.addr + offset, size, buf);
 
     return size;
 }
@@ -29,8 +29,36 @@
 struct part_flash_info
 {
     const struct fal_flash_dev *flash_dev;
+#ifdef FAL_USING_CACHE
+    rt_bool_t cache_enabled;
+    rt_uint32_t cache_hit;
+    rt_uint32_t cache_miss;
+#endif
 };
 
+#ifdef FAL_USING_CACHE
+struct cache_line
+{
+    /* NULL: the line is invalid */
+    const struct fal_flash_dev *flash_dev;
+    /* line address on flash device, it is aligned to the line size */
+    long addr;
+    /* the least recently used line is replaced */
+    rt_uint32_t used;
+    rt_uint8_t data[FAL_CACHE_LINE_SIZE];
+};
+
+/* the lines are shared by all partitions, the line address selects the set */
+static struct cache_line cache_lines[FAL_CACHE_SETS][FAL_CACHE_WAYS];
+static rt_uint32_t cache_used = 0;
+/* the last read start, a missed line is filled only by the scan from it */
+static const struct fal_flash_dev *cache_last_dev = NULL;
+static long cache_last_addr = 0;
+/* the reads in a row, each one in the line after the previous read start */
+static rt_uint32_t cache_seq_num = 0;
+static struct rt_mutex cache_lock;
+#endif /* FAL_USING_CACHE */
+
 /**
  * FAL partition table config has defined on 'fal_cfg.h'.
  * When this option is disable, it will auto find the partition table on a specified location in flash partition.
@@ -129,6 +157,12 @@ static int check_and_update_part_cache(const struct fal_partition *table, rt_siz
 
     for (i = 0; i < len; i++)
     {
+#ifdef FAL_USING_CACHE
+        part_flash_cache[i].cache_enabled = RT_TRUE;
+        part_flash_cache[i].cache_hit = 0;
+        part_flash_cache[i].cache_miss = 0;
+#endif
+
         flash_dev = fal_flash_device_find(table[i].flash_name);
         if (flash_dev == NULL)
         {
@@ -301,6 +335,10 @@ int fal_partition_init(void)
         goto _exit;
     }
 
+#ifdef FAL_USING_CACHE
+    rt_mutex_init(&cache_lock, "fal", RT_IPC_FLAG_PRIO);
+#endif
+
     init_ok = 1;
 
 _exit:
@@ -395,6 +433,177 @@ void fal_set_partition_table_temp(struct fal_partition *table, rt_size_t len)
     partition_table = table;
 }
 
+#ifdef FAL_USING_CACHE
+/**
+ * read the flash by the cache lines
+ *
+ * The missed line is filled from the flash device when FAL_CACHE_FILL_SEQ_NUM reads in a row are each in the line
+ * after the previous read start, as the header scan of the databases. The other missed reads go to the flash device
+ * directly, so the random reads, and the header and the value reads of one KV, don't replace the lines.
+ */
+static int cache_read(const struct fal_partition *part, const struct fal_flash_dev *flash_dev, long offset,
+        rt_uint8_t *buf, rt_size_t size)
+{
+    struct part_flash_info *info = &part_flash_cache[part - partition_table];
+    struct cache_line *set, *line;
+    long line_addr, start = offset;
+    rt_size_t cur_size, i;
+    int ret = size;
+
+    rt_mutex_take(&cache_lock, RT_WAITING_FOREVER);
+    if (cache_last_dev == flash_dev && offset >= cache_last_addr && offset < cache_last_addr + FAL_CACHE_LINE_SIZE)
+    {
+        if (cache_seq_num < FAL_CACHE_FILL_SEQ_NUM)
+        {
+            cache_seq_num++;
+        }
+    }
+    else
+    {
+        cache_seq_num = 0;
+    }
+    while (size)
+    {
+        line_addr = offset - offset % FAL_CACHE_LINE_SIZE;
+        cur_size = FAL_CACHE_LINE_SIZE - (offset - line_addr);
+        if (cur_size > size)
+        {
+            cur_size = size;
+        }
+
+        set = cache_lines[(line_addr / FAL_CACHE_LINE_SIZE) % FAL_CACHE_SETS];
+        line = NULL;
+        for (i = 0; i < FAL_CACHE_WAYS; i++)
+        {
+            if (set[i].flash_dev == flash_dev && set[i].addr == line_addr)
+            {
+                line = &set[i];
+                break;
+            }
+        }
+
+        if (line)
+        {
+            info->cache_hit++;
+        }
+        else if (cache_seq_num < FAL_CACHE_FILL_SEQ_NUM)
+        {
+            info->cache_miss++;
+            if (flash_dev->ops.read(offset, buf, cur_size) < 0)
+            {
+                ret = -1;
+                break;
+            }
+            buf += cur_size;
+            offset += cur_size;
+            size -= cur_size;
+            continue;
+        }
+        else
+        {
+            /* replace an invalid line, or the least recently used line */
+            line = &set[0];
+            for (i = 1; i < FAL_CACHE_WAYS && line->flash_dev; i++)
+            {
+                if (set[i].flash_dev == NULL || (rt_int32_t)(set[i].used - line->used) < 0)
+                {
+                    line = &set[i];
+                }
+            }
+            line->flash_dev = NULL;
+            /* the last line of the flash device may be short */
+            if (flash_dev->ops.read(line_addr, line->data, flash_dev->len - line_addr < FAL_CACHE_LINE_SIZE ?
+                    flash_dev->len - line_addr : FAL_CACHE_LINE_SIZE) < 0)
+            {
+                ret = -1;
+                break;
+            }
+            line->flash_dev = flash_dev;
+            line->addr = line_addr;
+            info->cache_miss++;
+        }
+
+        line->used = ++cache_used;
+        memcpy(buf, line->data + (offset - line_addr), cur_size);
+        buf += cur_size;
+        offset += cur_size;
+        size -= cur_size;
+    }
+    cache_last_dev = flash_dev;
+    cache_last_addr = start;
+    rt_mutex_release(&cache_lock);
+
+    return ret;
+}
+
+/**
+ * invalidate the cache lines of the flash range, which is written or erased without the partition API
+ *
+ * @param flash_dev flash device
+ * @param offset offset address on flash device
+ * @param size size
+ */
+void fal_cache_invalidate(const struct fal_flash_dev *flash_dev, long offset, rt_size_t size)
+{
+    struct cache_line *line;
+    rt_size_t i, j;
+
+    RT_ASSERT(flash_dev);
+
+    if (!init_ok)
+    {
+        return;
+    }
+
+    rt_mutex_take(&cache_lock, RT_WAITING_FOREVER);
+    for (i = 0; i < FAL_CACHE_SETS; i++)
+    {
+        for (j = 0; j < FAL_CACHE_WAYS; j++)
+        {
+            line = &cache_lines[i][j];
+            if (line->flash_dev == flash_dev && line->addr < offset + (long)size
+                    && line->addr + FAL_CACHE_LINE_SIZE > offset)
+            {
+                line->flash_dev = NULL;
+            }
+        }
+    }
+    rt_mutex_release(&cache_lock);
+}
+
+/**
+ * enable or disable the read cache of the partition, the cache is enabled on all partitions by default
+ *
+ * @param part partition
+ * @param enable RT_TRUE: enable, RT_FALSE: disable
+ */
+void fal_partition_cache_enable(const struct fal_partition *part, rt_bool_t enable)
+{
+    RT_ASSERT(part >= partition_table);
+    RT_ASSERT(part <= &partition_table[partition_table_len - 1]);
+
+    /* the lines are kept coherent on the disabled partition, so they are not invalidated */
+    part_flash_cache[part - partition_table].cache_enabled = enable;
+}
+
+/**
+ * get the read cache status of the partition
+ *
+ * @param part partition
+ * @param stat the status
+ */
+void fal_partition_cache_stat(const struct fal_partition *part, fal_cache_stat_t stat)
+{
+    RT_ASSERT(part >= partition_table);
+    RT_ASSERT(part <= &partition_table[partition_table_len - 1]);
+    RT_ASSERT(stat);
+
+    stat->enabled = part_flash_cache[part - partition_table].cache_enabled;
+    stat->hit = part_flash_cache[part - partition_table].cache_hit;
+    stat->miss = part_flash_cache[part - partition_table].cache_miss;
+}
+#endif /* FAL_USING_CACHE */
+
 /**
  * read data from partition
  *
@@ -427,7 +636,19 @@ int fal_partition_read(const struct fal_partition *part, rt_uint32_t addr, rt_ui
         return -1;
     }
 
+#ifdef FAL_USING_CACHE
+    /* the large reads go to the flash directly, so they don't flush the cache */
+    if (part_flash_cache[part - partition_table].cache_enabled && size < FAL_CACHE_LINE_SIZE)
+    {
+        ret = cache_read(part, flash_dev, part->offset + addr, buf, size);
+    }
+    else
+    {
+        ret = flash_dev->ops.read(part->offset + addr, buf, size);
+    }
+#else
     ret = flash_dev->ops.read(part->offset + addr, buf, size);
+#endif /* FAL_USING_CACHE */
     if (ret < 0)
     {
         LOG_E("Partition read error! Flash device(%s) read error!", part->flash_name);
@@ -469,6 +690,10 @@ int fal_partition_write(const struct fal_partition *part, rt_uint32_t addr, cons
     }
 
     ret = flash_dev->ops.write(part->offset + addr, buf, size);
+#ifdef FAL_USING_CACHE
+    /* the cache is write-through, the written lines are read from the flash again */
+    fal_cache_invalidate(flash_dev, part->offset + addr, size);
+#endif
     if (ret < 0)
     {
         LOG_E("Partition write error! Flash device(%s) write error!", part->flash_name);
@@ -508,6 +733,19 @@ int fal_partition_erase(const struct fal_partition *part, rt_uint32_t addr, rt_s
     }
 
     ret = flash_dev->ops.erase(part->offset + addr, size);
+#ifdef FAL_USING_CACHE
+    {
+        /* the whole blocks of the range are erased */
+        long start = part->offset + addr, end = start + size;
+
+        if (flash_dev->blk_size)
+        {
+            start -= start % flash_dev->blk_size;
+            end = (end + flash_dev->blk_size - 1) / flash_dev->blk_size * flash_dev->blk_size;
+        }
+        fal_cache_invalidate(flash_dev, start, end - start);
+    }
+#endif
     if (ret < 0)
     {
         LOG_E("Partition erase error! Flash device(%s) erase error!", part->flash_name);
@@ -566,6 +566,7 @@ static void fal(rt_uint8_t argc, char **argv) {
 #define CMD_WRITE_INDEX               2
 #define CMD_ERASE_INDEX               3
 #define CMD_BENCH_INDEX               4
+#define CMD_CACHE_INDEX               5
 
     int result = 0;
     static const struct fal_flash_dev *flash_dev = NULL;
@@ -579,6 +580,9 @@ static void fal(rt_uint8_t argc, char **argv) {
             [CMD_WRITE_INDEX]     = "fal write addr data1 ... dataN   - write some bytes 'data' starting at 'addr'",
             [CMD_ERASE_INDEX]     = "fal erase addr size              - erase 'size' bytes starting at 'addr'",
             [CMD_BENCH_INDEX]     = "fal bench <blk_size>             - benchmark test with per block size",
+#ifdef FAL_USING_CACHE
+            [CMD_CACHE_INDEX]     = "fal cache [on|off]               - show the read cache, or switch it on the probed partition",
+#endif
     };
 
     if (fal_init_check() != 1)
@@ -639,6 +643,33 @@ static void fal(rt_uint8_t argc, char **argv) {
                 fal_show_part_table();
             }
         }
+#ifdef FAL_USING_CACHE
+        else if (!strcmp(operator, "cache"))
+        {
+            const struct fal_partition *part_table;
+            struct fal_cache_stat stat;
+            rt_size_t part_num = 0;
+
+            if (argc >= 3)
+            {
+                if (!part_dev || (strcmp(argv[2], "on") && strcmp(argv[2], "off")))
+                {
+                    rt_kprintf("Usage: %s. The partition must be probed.\n", help_info[CMD_CACHE_INDEX]);
+                    return;
+                }
+                fal_partition_cache_enable(part_dev, !strcmp(argv[2], "on"));
+            }
+            part_table = fal_get_partition_table(&part_num);
+            rt_kprintf("%-*.*s cache        hit       miss  hit rate\n", FAL_DEV_NAME_MAX, FAL_DEV_NAME_MAX, "partition");
+            for (i = 0; i < part_num; i++)
+            {
+                fal_partition_cache_stat(&part_table[i], &stat);
+                rt_kprintf("%-*.*s %-5s %10u %10u %8d%%\n", FAL_DEV_NAME_MAX, FAL_DEV_NAME_MAX, part_table[i].name,
+                        stat.enabled ? "on" : "off", stat.hit, stat.miss,
+                        stat.hit + stat.miss ? (int)((rt_uint64_t)stat.hit * 100 / (stat.hit + stat.miss)) : 0);
+            }
+        }
+#endif /* FAL_USING_CACHE */
         else
         {
             if (!flash_dev && !part_dev)
@@ -729,6 +760,9 @@ static void fal(rt_uint8_t argc, char **argv) {
                         if (flash_dev)
                         {
                             result = flash_dev->ops.write(addr, data, size);
+#ifdef FAL_USING_CACHE
+                            fal_cache_invalidate(flash_dev, addr, size);
+#endif
                         }
                         else if (part_dev)
                         {
@@ -766,6 +800,9 @@ static void fal(rt_uint8_t argc, char **argv) {
                     if (flash_dev)
                     {
                         result = flash_dev->ops.erase(addr, size);
+#ifdef FAL_USING_CACHE
+                        fal_cache_invalidate(flash_dev, addr, size);
+#endif
                     }
                     else if (part_dev)
                     {
@@ -813,6 +850,9 @@ static void fal(rt_uint8_t argc, char **argv) {
                     if (flash_dev)
                     {
                         result = flash_dev->ops.erase(0, size);
+#ifdef FAL_USING_CACHE
+                        fal_cache_invalidate(flash_dev, 0, size);
+#endif
                     }
                     else if (part_dev)
                     {
@@ -844,6 +884,9 @@ static void fal(rt_uint8_t argc, char **argv) {
                         if (flash_dev)
                         {
                             result = flash_dev->ops.write(i, write_data, cur_op_size);
+#ifdef FAL_USING_CACHE
+                            fal_cache_invalidate(flash_dev, i, cur_op_size);
+#endif
                         }
                         else if (part_dev)
                         {
@@ -167,6 +167,11 @@
 #define FAL_PART_HAS_TABLE_CFG
 #define FAL_USING_SFUD_PORT
 #define FAL_USING_NOR_FLASH_DEV_NAME "w25q64"
+#define FAL_USING_CACHE
+#define FAL_CACHE_LINE_SIZE 256
+#define FAL_CACHE_SETS 4
+#define FAL_CACHE_WAYS 4
+#define FAL_CACHE_FILL_SEQ_NUM 2
 
 /* Device Drivers */
 
@@ -188,6 +193,10 @@
 #define RT_SFUD_USING_SFDP
 #define RT_SFUD_USING_FLASH_INFO_TABLE
 #define RT_SFUD_SPI_MAX_HZ 50000000
+#define RT_SFUD_USING_ERASE_SUSPEND
+#define RT_SFUD_USING_ASYNC
+#define RT_SFUD_ASYNC_THREAD_STACK_SIZE 1024
+#define RT_SFUD_ASYNC_THREAD_PRIORITY 24
 #define RT_USING_WDT
 #define RT_USING_PIN
 /* end of Device Drivers */
@@ -591,10 +600,10 @@
 #define BSP_RTC_USING_LEXT
 #define BSP_USING_UART
 #define BSP_USING_UART1
-#define BSP_UART1_RX_USING_DMA
-#define BSP_UART1_TX_USING_DMA
 #define BSP_USING_SPI
 #define BSP_USING_SPI2
+#define BSP_SPI2_TX_USING_DMA
+#define BSP_SPI2_RX_USING_DMA
 #define BSP_USING_CAN
 #define BSP_USING_CAN1
 /* end of On-chip Peripheral Drivers */
@@ -605,10 +614,17 @@
 #define CCMP_USING_D2S
 #define CCMP_USING_EXAMPLE_D2S
 #define CCMP_USING_EBUS
+#define EBUS_MSG_SIZE 64
+#define EBUS_MSG_NUM 32
 #define CCMP_USING_EXAMPLE_EBUS
 #define CCMP_USING_MMGR
 #define CCMP_USING_EXAMPLE_MMGR
 #define CCMP_USING_QSM
+#define QSM_THREAD_STACK_SIZE 1024
+#define QSM_THREAD_PRIORITY 12
+#define QSM_USING_TRACE
+#define QSM_TRACE_NUM 64
+#define QSM_UDS_DID 0xF3A0
 #define CCMP_USING_EXAMPLE_QSM
 /* end of Custom Components */
 